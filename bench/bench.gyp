@@ -0,0 +1,63 @@
+{
+  "targets": [{
+    # Sessions per core for the full Channel pipeline, outside of node
+    "target_name": "capacity_bench",
+    "type": "executable",
+
+    "variables": {
+      "library": "static_library",
+    },
+
+    "dependencies": [
+      "../deps/aec/aec.gyp:aec",
+      "../deps/aec/aec.gyp:agc",
+      "../deps/aec/aec.gyp:ns",
+      "../deps/aec/aec.gyp:signal_processing",
+      "../deps/pa_ringbuffer/pa_ringbuffer.gyp:pa_ringbuffer",
+    ],
+
+    "include_dirs": [ "../src" ],
+    "sources": [
+      "capacity-bench.cc",
+      "../src/channel.cc",
+      "../src/recorder.cc",
+      "../src/trace.cc",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "defines": [ "WEBRTC_LINUX" ],
+        "libraries": [ "-luv", "-lm", "-lrt" ],
+      }],
+    ],
+  }, {
+    # Replays a session log of Channel::StartRecording() at full speed
+    "target_name": "replay",
+    "type": "executable",
+
+    "variables": {
+      "library": "static_library",
+    },
+
+    "dependencies": [
+      "../deps/aec/aec.gyp:aec",
+      "../deps/aec/aec.gyp:agc",
+      "../deps/aec/aec.gyp:ns",
+      "../deps/aec/aec.gyp:signal_processing",
+      "../deps/pa_ringbuffer/pa_ringbuffer.gyp:pa_ringbuffer",
+    ],
+
+    "include_dirs": [ "../src" ],
+    "sources": [
+      "replay.cc",
+      "../src/channel.cc",
+      "../src/recorder.cc",
+      "../src/trace.cc",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "defines": [ "WEBRTC_LINUX" ],
+        "libraries": [ "-luv", "-lm", "-lrt" ],
+      }],
+    ],
+  }]
+}
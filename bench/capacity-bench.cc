@@ -0,0 +1,327 @@
+// How many Channels one core keeps up with. N channels share one thread, as
+// they would share a worker, and every 10 ms each of them gets a capture and a
+// playback chunk and runs Channel::Cycle() on them, one after the other.
+//
+// The signals are synthetic and the same for all channels, each starting at
+// its own offset into the first far-end talk: far-end speech, and a microphone
+// that picks it up through a decaying room impulse response, plus near-end
+// speech and a noise floor. The call cycles through far-end talk, double talk,
+// near-end talk and silence.
+//
+// For each N:
+//   rtf      processing time over the audio time of all N channels
+//   p50...   latency of a chunk, from the tick it is due at to the end of
+//            its Cycle(), in us
+//   misses   chunks that would be done more than one chunk duration after
+//            their tick on a core of their own. Counted on the CPU time of
+//            the thread, so that the time the VM or other processes take
+//            shows in the latencies but does not decide the capacity
+//   erle     echo return loss enhancement of the whole chain, in dB, over the
+//            far-end talk past its first second, and past the first second
+//            of the call
+//
+// N doubles until more than kMaxMissRate of the chunks miss, then the largest
+// N that keeps up is searched for in between.
+//
+// --trace writes the stages of every run in the Chrome trace format, see
+// trace.h.
+//
+// Usage: capacity-bench [--fixed-ns | --post-filter] [--trace file] [seconds]
+
+#include "channel.h"
+#include "trace.h"
+#include "uv.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+using audio::Channel;
+using audio::Trace;
+
+static const int kDefaultSeconds = 10;
+static const int kChunk = Channel::kChunkSize;
+static const int kRate = Channel::kSampleRate;
+static const uint64_t kTick = 1000000000ULL * kChunk / kRate;  // in ns
+static const uint64_t kSpin = 200000;  // in ns, before each tick
+static const double kMaxMissRate = 0.001;
+static const int kWarmup = 100;  // in chunks, left out of the ERLE
+
+// One cycle of the call, in chunks
+enum Segment {
+  kFarTalk,
+  kDoubleTalk,
+  kNearTalk,
+  kSilence
+};
+static const int kSegmentChunks[] = { 300, 100, 100, 100 };
+static const int kCycleChunks = 600;
+
+// Start of channel i in the cycle, so that they do not all run in lockstep
+static const int kOffsetStep = 7;  // in chunks
+static const int kOffsets = 100;  // in chunks
+
+static const int kEchoDelay = 320;  // 20 ms, in samples
+static const int kEchoLength = 1600;  // 100 ms, in samples
+
+struct Signals {
+  std::vector<int16_t> far;
+  std::vector<int16_t> mic;
+  std::vector<Segment> segments;  // per chunk
+};
+
+struct Result {
+  double rtf;
+  uint64_t p50;
+  uint64_t p99;
+  uint64_t p999;
+  int misses;
+  int chunks;
+  double erle;
+};
+
+static double Noise(unsigned* seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return (((*seed >> 8) & 0xffff) - 32768.0) / 32768.0;
+}
+
+// Voiced syllables: a few harmonics of |f0| under a 4 Hz envelope.
+static double Voice(double t, double f0) {
+  double env = sin(2 * M_PI * 4 * t);
+  double v = 0;
+
+  if (env < 0)
+    return 0;
+  for (int h = 1; h <= 6; h++)
+    v += sin(2 * M_PI * f0 * h * t) / h;
+  return env * v;
+}
+
+static uint64_t CpuTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static Segment SegmentAt(int chunk) {
+  chunk %= kCycleChunks;
+  int s = 0;
+  while (chunk >= kSegmentChunks[s]) {
+    chunk -= kSegmentChunks[s];
+    s++;
+  }
+  return static_cast<Segment>(s);
+}
+
+static int16_t Saturate(double v) {
+  if (v > 32767)
+    return 32767;
+  if (v < -32768)
+    return -32768;
+  return static_cast<int16_t>(v);
+}
+
+static void Generate(Signals* s) {
+  const int len = kCycleChunks * kChunk;
+  std::vector<double> far(len);
+  std::vector<double> rir(kEchoLength);
+  unsigned seed = 1;
+
+  for (int i = kEchoDelay; i < kEchoLength; i++) {
+    double decay = exp(-static_cast<double>(i - kEchoDelay) / 400);
+    rir[i] = 0.08 * decay * Noise(&seed);
+  }
+
+  s->far.resize(len);
+  s->mic.resize(len);
+  s->segments.resize(kCycleChunks);
+  for (int c = 0; c < kCycleChunks; c++)
+    s->segments[c] = SegmentAt(c);
+
+  for (int i = 0; i < len; i++) {
+    Segment seg = s->segments[i / kChunk];
+    double t = static_cast<double>(i) / kRate;
+
+    far[i] = seg == kFarTalk || seg == kDoubleTalk ?
+        8000 * Voice(t, 120) : 0;
+    s->far[i] = Saturate(far[i]);
+  }
+
+  // The cycle repeats, so the echo wraps around it too
+  for (int i = 0; i < len; i++) {
+    Segment seg = s->segments[i / kChunk];
+    double t = static_cast<double>(i) / kRate;
+    double echo = 0;
+
+    for (int j = kEchoDelay; j < kEchoLength; j++)
+      echo += rir[j] * far[(i - j + len) % len];
+    double near = seg == kNearTalk || seg == kDoubleTalk ?
+        6000 * Voice(t + 0.1, 210) : 0;
+    s->mic[i] = Saturate(echo + near + 30 * Noise(&seed));
+  }
+}
+
+// Runs |n| channels for |chunks| ticks at the real 10 ms cadence.
+static Result Run(const Channel::Config& config,
+                  const Signals& signals,
+                  int n,
+                  int chunks) {
+  std::vector<Channel*> channels(n);
+  std::vector<uint64_t> latencies;
+  double mic_energy = 0;
+  double out_energy = 0;
+  uint64_t busy = 0;
+  uint64_t backlog = 0;  // in ns of CPU time
+  Result r;
+
+  for (int i = 0; i < n; i++) {
+    channels[i] = new Channel();
+    channels[i]->Init(config);
+  }
+  latencies.reserve(static_cast<size_t>(n) * chunks);
+  r.misses = 0;
+  r.chunks = n * chunks;
+
+  uint64_t due = uv_hrtime() + kTick;
+  for (int c = 0; c < chunks; c++) {
+    // Sleep most of the way and spin the rest, the tick is what counts
+    uint64_t now = uv_hrtime();
+    if (now + kSpin < due)
+      usleep(static_cast<useconds_t>((due - now - kSpin) / 1000));
+    while (uv_hrtime() < due) {
+    }
+    Trace::Instant("Tick");
+
+    uint64_t start = uv_hrtime();
+    uint64_t cpu_start = CpuTime();
+    for (int i = 0; i < n; i++) {
+      Channel* ch = channels[i];
+      int chunk = (c + i * kOffsetStep % kOffsets) % kCycleChunks;
+      const int16_t* far = &signals.far[chunk * kChunk];
+      const int16_t* mic = &signals.mic[chunk * kChunk];
+      int16_t out[kChunk];
+      Channel::Event ev;
+
+      PaUtil_WriteRingBuffer(&ch->aec_.out, far, kChunk);
+      PaUtil_WriteRingBuffer(&ch->aec_.in, mic, kChunk);
+      ch->Cycle(kChunk, kChunk);
+      PaUtil_ReadRingBuffer(&ch->io_.in, out, kChunk);
+      ch->ReadEvent(&ev);
+
+      latencies.push_back(uv_hrtime() - due);
+      if (backlog + (CpuTime() - cpu_start) > kTick)
+        r.misses++;
+
+      // Far-end talk starts the cycle, skip the first second of it too: the
+      // gain is still coming down from the near-end talk and the silence
+      if (c >= kWarmup && chunk >= kWarmup &&
+          signals.segments[chunk] == kFarTalk) {
+        for (int k = 0; k < kChunk; k++) {
+          mic_energy += static_cast<double>(mic[k]) * mic[k];
+          out_energy += static_cast<double>(out[k]) * out[k];
+        }
+      }
+    }
+    busy += uv_hrtime() - start;
+    due += kTick;
+
+    // What an overrun tick leaves to the next one
+    backlog += CpuTime() - cpu_start;
+    backlog = backlog > kTick ? backlog - kTick : 0;
+  }
+
+  for (int i = 0; i < n; i++)
+    delete channels[i];
+
+  std::sort(latencies.begin(), latencies.end());
+  r.p50 = latencies[latencies.size() / 2];
+  r.p99 = latencies[latencies.size() * 99 / 100];
+  r.p999 = latencies[latencies.size() * 999 / 1000];
+  r.rtf = static_cast<double>(busy) / (static_cast<double>(kTick) * chunks);
+  r.erle = 10 * log10((mic_energy + 1) / (out_energy + 1));
+  return r;
+}
+
+static bool KeepsUp(const Result& r) {
+  return r.misses <= kMaxMissRate * r.chunks;
+}
+
+static bool Try(const Channel::Config& config,
+                const Signals& signals,
+                int n,
+                int chunks) {
+  Result r = Run(config, signals, n, chunks);
+  printf("%-6d %8.3f %8.0f %8.0f %8.0f %8d %8.1f\n",
+         n,
+         r.rtf,
+         r.p50 / 1e3,
+         r.p99 / 1e3,
+         r.p999 / 1e3,
+         r.misses,
+         r.erle);
+  fflush(stdout);
+  return KeepsUp(r);
+}
+
+int main(int argc, char** argv) {
+  Channel::Config config;
+  const char* trace = NULL;
+  int seconds = kDefaultSeconds;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--fixed-ns") == 0) {
+      config.fixed_ns = true;
+    } else if (strcmp(argv[i], "--post-filter") == 0) {
+      config.post_filter = true;
+    } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      trace = argv[++i];
+    } else {
+      seconds = atoi(argv[i]);
+    }
+  }
+  if (seconds <= 1) {
+    fprintf(stderr,
+            "Usage: %s [--fixed-ns | --post-filter] [--trace file] [seconds], "
+            "more than 1 second\n",
+            argv[0]);
+    return 1;
+  }
+
+  if (trace != NULL && !Trace::Start(trace)) {
+    fprintf(stderr, "Failed to open %s\n", trace);
+    return 1;
+  }
+  Trace::SetThreadName("bench");
+
+  Signals signals;
+  Generate(&signals);
+  int chunks = seconds * kRate / kChunk;
+
+  printf("%-6s %8s %8s %8s %8s %8s %8s\n",
+         "n", "rtf", "p50", "p99", "p999", "misses", "erle");
+
+  // Double until it falls behind, then bisect
+  int good = 0;
+  int bad = 1;
+  while (Try(config, signals, bad, chunks)) {
+    good = bad;
+    bad *= 2;
+  }
+  while (bad - good > 1) {
+    int mid = (good + bad) / 2;
+    if (Try(config, signals, mid, chunks))
+      good = mid;
+    else
+      bad = mid;
+  }
+
+  Trace::Stop();
+  printf("\nsessions per core: %d\n", good);
+  return 0;
+}
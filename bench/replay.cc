@@ -0,0 +1,285 @@
+// Replays a session log, see session-log.h, through a Channel as fast as it
+// goes: a Channel with the logged config, the logged AEC state and every
+// logged cycle with its far and near chunk, one after the other on one thread.
+// Nothing depends on the clock, the same log gives the same output every run.
+//
+// The output is compared with the logged one chunk by chunk. A log started
+// before the first chunk, without dropped records and replayed on the dispatch
+// path it was recorded on is expected to match bit for bit. The path is
+// picked through WEBRTC_DISPATCH from the logged CPU features, unless it is
+// set already.
+//
+// --repeat runs the whole log n times over, for perf and other profilers,
+// and --output writes the replayed output as raw 16-bit samples.
+//
+// Usage: replay [--repeat n] [--output file] log
+
+#include "channel.h"
+#include "session-log.h"
+#include "uv.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using audio::Channel;
+using namespace audio::session;
+
+// The features the dispatchers look at, see cpu_features.cc
+static const uint32_t kDispatchFeatures = (1 << kSSE2) | (1 << kAVX2);
+
+struct Log {
+  const char* data;
+  size_t size;
+  const FileHeader* header;
+  const ConfigRecord* config;
+  int cycles;
+  int gaps;  // of dropped cycles
+};
+
+struct Result {
+  uint64_t time;  // in ns
+  int chunks;  // of output
+  int mismatches;  // chunks that differ from the logged output
+  int first_mismatch;  // sequence number, -1 if none
+};
+
+static const RecordHeader* Next(const Log& log, size_t* offset) {
+  if (*offset + sizeof(RecordHeader) > log.size)
+    return NULL;
+  const RecordHeader* r =
+      reinterpret_cast<const RecordHeader*>(log.data + *offset);
+  size_t end = *offset + sizeof(*r) + r->size;
+
+  // Cut short by a crash, the tail is lost
+  if (end > log.size)
+    return NULL;
+  *offset = *offset + sizeof(*r) + Padded(r->size);
+  return r;
+}
+
+static const char* Payload(const RecordHeader* r) {
+  return reinterpret_cast<const char*>(r + 1);
+}
+
+static bool Parse(Log* log) {
+  if (log->size < sizeof(FileHeader))
+    return false;
+  log->header = reinterpret_cast<const FileHeader*>(log->data);
+  if (memcmp(log->header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      log->header->version != kVersion ||
+      log->header->sample_rate != Channel::kSampleRate) {
+    return false;
+  }
+
+  size_t offset = sizeof(FileHeader);
+  const RecordHeader* r = Next(*log, &offset);
+  if (r == NULL || r->type != kConfig || r->size != sizeof(ConfigRecord))
+    return false;
+  log->config = reinterpret_cast<const ConfigRecord*>(Payload(r));
+  if (log->config->chunk_size != Channel::kChunkSize &&
+      log->config->chunk_size != Channel::kLowLatencyChunkSize) {
+    return false;
+  }
+  if (log->config->overflow < Channel::kDropNewest ||
+      log->config->overflow > Channel::kBlock) {
+    return false;
+  }
+  int chunk = log->config->chunk_size * sizeof(int16_t);
+
+  // Check the sizes once, so that the replay loop does not have to
+  log->cycles = 0;
+  log->gaps = 0;
+  uint32_t sequence = log->config->cycles;
+  while ((r = Next(*log, &offset)) != NULL) {
+    if (r->type != kCycle)
+      continue;
+
+    const CycleRecord* c = reinterpret_cast<const CycleRecord*>(Payload(r));
+    if (r->size < sizeof(*c) ||
+        r->size != sizeof(*c) + chunk * (!!c->has_far + 2 * !!c->has_near)) {
+      return false;
+    }
+    if (c->sequence != sequence)
+      log->gaps++;
+    sequence = c->sequence + 1;
+    log->cycles++;
+  }
+  return true;
+}
+
+static Result Replay(const Log& log, FILE* output) {
+  const ConfigRecord* config = log.config;
+  Channel::Config c;
+  c.low_latency = config->low_latency != 0;
+  c.fixed_ns = config->fixed_ns != 0;
+  c.post_filter = config->post_filter != 0;
+  c.gate_level = config->gate_level;
+  c.render_rate = config->render_rate;
+  c.overflow = static_cast<Channel::Overflow>(config->overflow);
+  int chunk = config->chunk_size;
+
+  Channel* ch = new Channel();
+  ch->Init(c);
+
+  Result res;
+  res.chunks = 0;
+  res.mismatches = 0;
+  res.first_mismatch = -1;
+
+  uint64_t start = uv_hrtime();
+  size_t offset = sizeof(FileHeader);
+  const RecordHeader* r;
+  while ((r = Next(log, &offset)) != NULL) {
+    if (r->type == kState) {
+      if (!ch->RestoreState(Payload(r), r->size))
+        fprintf(stderr, "Failed to restore the AEC state\n");
+      continue;
+    }
+    if (r->type != kCycle)
+      continue;
+
+    const CycleRecord* cycle =
+        reinterpret_cast<const CycleRecord*>(Payload(r));
+    const int16_t* p = reinterpret_cast<const int16_t*>(cycle + 1);
+    if (cycle->has_far) {
+      PaUtil_WriteRingBuffer(&ch->aec_.out, p, chunk);
+      p += chunk;
+    }
+    if (cycle->has_near)
+      PaUtil_WriteRingBuffer(&ch->aec_.in, p, chunk);
+    ch->Cycle(cycle->has_near ? chunk : 0, cycle->has_far ? chunk : 0);
+    if (!cycle->has_near)
+      continue;
+
+    int16_t out[Channel::kChunkSize];
+    Channel::Event ev;
+    PaUtil_ReadRingBuffer(&ch->io_.in, out, chunk);
+    ch->ReadEvent(&ev);
+    res.chunks++;
+
+    if (memcmp(out, p + chunk, sizeof(*out) * chunk) != 0) {
+      if (res.mismatches++ == 0)
+        res.first_mismatch = cycle->sequence;
+    }
+    if (output != NULL)
+      fwrite(out, sizeof(*out), chunk, output);
+  }
+  res.time = uv_hrtime() - start;
+
+  delete ch;
+  return res;
+}
+
+int main(int argc, char** argv) {
+  const char* path = NULL;
+  const char* output_path = NULL;
+  int repeat = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      output_path = argv[++i];
+    } else {
+      path = argv[i];
+    }
+  }
+  if (path == NULL || repeat < 1) {
+    fprintf(stderr,
+            "Usage: %s [--repeat n] [--output file] log\n",
+            argv[0]);
+    return 1;
+  }
+
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) != 0) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return 1;
+  }
+
+  Log log;
+  log.size = st.st_size;
+  void* data = mmap(NULL, log.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "Failed to map %s\n", path);
+    return 1;
+  }
+  madvise(data, log.size, MADV_SEQUENTIAL);
+  log.data = reinterpret_cast<const char*>(data);
+  if (!Parse(&log)) {
+    fprintf(stderr, "%s is not a session log\n", path);
+    return 1;
+  }
+
+  // Before anything reads the CPU features
+  uint32_t logged = log.header->cpu_features & kDispatchFeatures;
+  if (logged & (1 << kAVX2))
+    setenv("WEBRTC_DISPATCH", "avx2", 0);
+  else if (logged & (1 << kSSE2))
+    setenv("WEBRTC_DISPATCH", "sse2", 0);
+  else
+    setenv("WEBRTC_DISPATCH", "c", 0);
+
+  uint32_t features = 0;
+  for (int i = kSSE2; i <= kAVX2; i++) {
+    if (WebRtc_GetCPUInfo(static_cast<CPUFeature>(i)))
+      features |= 1 << i;
+  }
+  features &= kDispatchFeatures;
+
+  bool exact = log.config->cycles == 0 && log.gaps == 0 && features == logged;
+  if (log.config->cycles != 0) {
+    printf("recording started after %u cycles, the NS and AGC start cold\n",
+           log.config->cycles);
+  }
+  if (log.gaps != 0)
+    printf("%d gaps of dropped cycles\n", log.gaps);
+  if (features != logged) {
+    printf("dispatch path differs from the recording (%s), "
+           "the output may differ\n",
+           getenv("WEBRTC_DISPATCH"));
+  }
+
+  FILE* output = NULL;
+  if (output_path != NULL) {
+    output = fopen(output_path, "wb");
+    if (output == NULL) {
+      fprintf(stderr, "Failed to open %s\n", output_path);
+      return 1;
+    }
+  }
+
+  // Every run gives the same output, only the first one is checked
+  Result first;
+  uint64_t time = 0;
+  for (int i = 0; i < repeat; i++) {
+    Result r = Replay(log, i == 0 ? output : NULL);
+    if (i == 0)
+      first = r;
+    time += r.time;
+  }
+  if (output != NULL)
+    fclose(output);
+
+  double audio = static_cast<double>(first.chunks) * log.config->chunk_size /
+                 Channel::kSampleRate;
+  printf("cycles:     %d\n", log.cycles);
+  printf("audio:      %.1f s x %d\n", audio, repeat);
+  printf("time:       %.3f s\n", time / 1e9);
+  printf("speed:      %.1fx real time\n", audio * repeat / (time / 1e9));
+  printf("mismatches: %d of %d chunks", first.mismatches, first.chunks);
+  if (first.first_mismatch != -1)
+    printf(", first in cycle %d", first.first_mismatch);
+  printf("\n");
+
+  munmap(data, log.size);
+  return exact && first.mismatches != 0 ? 1 : 0;
+}
@@ -18,6 +18,8 @@
     "sources": [
       "src/audio.cc",
       "src/channel.cc",
+      "src/recorder.cc",
+      "src/trace.cc",
       "src/unit-common.cc",
     ],
     "conditions": [
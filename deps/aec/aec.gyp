@@ -42,6 +42,32 @@
     "sources": [
       "agc/analog_agc.c",
       "agc/digital_agc.c",
+      "agc/gain_table_cache.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        # The gain table cache lock
+        "link_settings": {
+          "libraries": [ "-lpthread" ],
+        },
+      }],
+      ["target_arch == 'ia32' or target_arch == 'x64'", {
+        "sources": [
+          "agc/digital_agc_sse2.c",
+        ],
+        "dependencies": [ "agc_avx2" ],
+      }],
+    ],
+  }, {
+    "target_name": "agc_avx2",
+    "type": "<(library)",
+    "include_dirs": [ "." ],
+    "cflags": [ "-mavx2" ],
+    "xcode_settings": {
+      "OTHER_CFLAGS": [ "-mavx2" ],
+    },
+    "sources": [
+      "agc/digital_agc_avx2.c",
     ],
   }, {
     "target_name": "ns",
@@ -58,6 +84,7 @@
       "ns/noise_suppression.c",
       "ns/noise_suppression_x.c",
       "ns/ns_core.c",
+      "ns/ns_rdft.c",
       "ns/nsx_core.c",
       "ns/nsx_core_c.c",
     ],
@@ -74,6 +101,169 @@
           "ns/nsx_core_neon_offsets.c",
         ],
       }],
+      ["target_arch == 'ia32' or target_arch == 'x64'", {
+        "sources": [
+          "ns/ns_core_sse2.c",
+          "ns/ns_rdft_sse2.c",
+          "ns/nsx_core_sse2.c",
+        ],
+        "dependencies": [ "ns_avx2" ],
+      }],
+    ],
+  }, {
+    "target_name": "ns_avx2",
+    "type": "<(library)",
+    "include_dirs": [ "." ],
+    "cflags": [ "-mavx2" ],
+    "xcode_settings": {
+      "OTHER_CFLAGS": [ "-mavx2" ],
+    },
+    "sources": [
+      "ns/ns_core_avx2.c",
+      "ns/ns_rdft_avx2.c",
+    ],
+  }, {
+    # Cost and quality of AEC followed by NS against the AEC post-filter.
+    "target_name": "aec_ns_bench",
+    "type": "executable",
+    "dependencies": [ "aec", "ns" ],
+    "sources": [
+      "bench/aec_ns_bench.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm", "-lrt" ],
+      }],
+    ],
+  }, {
+    # Per-call cost of the AGC kernels and per-frame cost of the AGC on each
+    # code path.
+    "target_name": "agc_bench",
+    "type": "executable",
+    "dependencies": [ "agc" ],
+    "sources": [
+      "bench/agc_bench.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm", "-lrt" ],
+      }],
+    ],
+  }, {
+    # Cost of creating the AEC, AGC and NS instances of a session.
+    "target_name": "session_bench",
+    "type": "executable",
+    "dependencies": [ "aec", "agc", "ns" ],
+    "sources": [
+      "bench/session_bench.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lrt" ],
+      }],
+    ],
+  }, {
+    # Per-frame cost of float NS and NSX on each code path.
+    "target_name": "ns_bench",
+    "type": "executable",
+    "dependencies": [ "ns" ],
+    "sources": [
+      "bench/ns_bench.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm", "-lrt" ],
+      }],
+    ],
+  }, {
+    # Per-call cost of the signal processing library primitives on each code
+    # path.
+    "target_name": "spl_bench",
+    "type": "executable",
+    "dependencies": [ "signal_processing" ],
+    "sources": [
+      "bench/spl_bench.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lrt" ],
+      }],
+    ],
+  }, {
+    # Per-call cost, spread and throughput of the hot kernels of a session on
+    # each code path, as a table or as JSON with --json.
+    "target_name": "kernel_bench",
+    "type": "executable",
+    "dependencies": [
+      "aec",
+      "agc",
+      "ns",
+      "signal_processing",
+      "../pa_ringbuffer/pa_ringbuffer.gyp:pa_ringbuffer",
+    ],
+    "sources": [
+      "bench/kernel_bench.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm", "-lrt" ],
+      }],
+    ],
+  }, {
+    # Mismatches of the SIMD AGC paths against the C path, exits with non-zero
+    # status on any.
+    "target_name": "agc_simd_test",
+    "type": "executable",
+    "dependencies": [ "agc" ],
+    "sources": [
+      "test/agc_simd_test.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm" ],
+      }],
+    ],
+  }, {
+    # Error of the SIMD float NS paths against the C path, exits with non-zero
+    # status when a bound is exceeded.
+    "target_name": "ns_simd_test",
+    "type": "executable",
+    "dependencies": [ "ns" ],
+    "sources": [
+      "test/ns_simd_test.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm" ],
+      }],
+    ],
+  }, {
+    # Mismatches of the SIMD signal processing library primitives against the
+    # C versions, exits with non-zero status on any.
+    "target_name": "spl_simd_test",
+    "type": "executable",
+    "dependencies": [ "signal_processing" ],
+    "sources": [
+      "test/spl_simd_test.c",
+    ],
+  }, {
+    # Every dispatch path against the golden outputs in test/golden, exits
+    # with non-zero status on any mismatch. Run from this directory.
+    "target_name": "golden_test",
+    "type": "executable",
+    "dependencies": [
+      "aec",
+      "agc",
+      "ns",
+      "signal_processing",
+    ],
+    "sources": [
+      "test/golden_test.c",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "libraries": [ "-lm" ],
+      }],
     ],
   }, {
     "target_name": "signal_processing",
@@ -111,6 +301,7 @@
       "signal_processing/resample_by_2.c",
       "signal_processing/resample_by_2_internal.c",
       "signal_processing/resample_fractional.c",
+      "signal_processing/resample_polyphase.c",
       "signal_processing/spl_init.c",
       "signal_processing/spl_sqrt.c",
       "signal_processing/spl_sqrt_floor.c",
@@ -144,6 +335,35 @@
           "signal_processing/vector_scaling_operations_neon.S",
         ],
       }],
+      ["target_arch == 'ia32' or target_arch == 'x64'", {
+        "sources": [
+          "signal_processing/complex_fft_sse2.c",
+          "signal_processing/cross_correlation_sse2.c",
+          "signal_processing/downsample_fast_sse2.c",
+          "signal_processing/min_max_operations_sse2.c",
+          "signal_processing/resample_polyphase_sse2.c",
+          "signal_processing/splitting_filter_sse2.c",
+          "signal_processing/vector_scaling_operations_sse2.c",
+        ],
+        "dependencies": [ "signal_processing_avx2" ],
+      }],
+    ],
+  }, {
+    "target_name": "signal_processing_avx2",
+    "type": "<(library)",
+    "include_dirs": [ "." ],
+    "cflags": [ "-mavx2" ],
+    "xcode_settings": {
+      "OTHER_CFLAGS": [ "-mavx2" ],
+    },
+    "sources": [
+      "signal_processing/complex_fft_avx2.c",
+      "signal_processing/cross_correlation_avx2.c",
+      "signal_processing/downsample_fast_avx2.c",
+      "signal_processing/min_max_operations_avx2.c",
+      "signal_processing/resample_polyphase_avx2.c",
+      "signal_processing/splitting_filter_avx2.c",
+      "signal_processing/vector_scaling_operations_avx2.c",
     ],
   }, {
     "target_name": "webrtc_common",
@@ -159,5 +379,23 @@
       "webrtc/fft4g.c",
       "webrtc/ring_buffer.c",
     ],
+    "conditions": [
+      ["target_arch == 'ia32' or target_arch == 'x64'", {
+        "dependencies": [ "webrtc_common_avx2" ],
+      }],
+    ],
+  }, {
+    # Kernels that are only called after a runtime CPU check, built with the
+    # instruction sets they need.
+    "target_name": "webrtc_common_avx2",
+    "type": "<(library)",
+    "include_dirs": [ "." ],
+    "cflags": [ "-mavx2", "-mpopcnt" ],
+    "xcode_settings": {
+      "OTHER_CFLAGS": [ "-mavx2", "-mpopcnt" ],
+    },
+    "sources": [
+      "webrtc/delay_estimator_avx2.c",
+    ],
   }]
 }
@@ -31,9 +31,22 @@
 // Buffer size (samples)
 static const size_t kBufSizePartitions = 250;  // 1 second of audio in 16 kHz.
 
+// Delay agnostic mode
+// Frames to let the delay estimator converge before acting on it.
+static const int kDelayCorrectionStart = 100;
+static const int kInitialShiftOffset = 5;
+// Upper limit of the adaptive quality threshold, 24 bits in Q9.
+static const int kDelayQualityThresholdMax = 24 << 9;
+
 // Metrics
 static const int subCountLen = 4;
 static const int countLen = 50;
+static const int kLightMetricsDecimation = 2;
+
+// Saved state
+static const uint32_t kStateMagic = 0x53434541;  // "AECS"
+static const int32_t kStateVersion = 1;
+enum { kStateArrays = 12 };
 
 // Quantities to control H band scaling for SWB input
 static const int flagHbandCn = 1;  // flag for adding comfort noise in H band
@@ -99,10 +112,17 @@ static const float kTargetSupp[3] = {-6.9f, -11.5f, -18.4f};
 // Two sets of parameters, one for the extended filter mode.
 static const float kExtendedMinOverDrive[3] = {3.0f, 6.0f, 15.0f};
 static const float kNormalMinOverDrive[3] = {1.0f, 2.0f, 5.0f};
-static const float kExtendedSmoothingCoefficients[2][2] = {{0.9f, 0.1f},
-                                                           {0.92f, 0.08f}};
-static const float kNormalSmoothingCoefficients[2][2] = {{0.9f, 0.1f},
-                                                         {0.93f, 0.07f}};
+const float WebRtcAec_kExtendedSmoothingCoefficients[2][2] = {{0.9f, 0.1f},
+                                                             {0.92f, 0.08f}};
+const float WebRtcAec_kNormalSmoothingCoefficients[2][2] = {{0.9f, 0.1f},
+                                                           {0.93f, 0.07f}};
+
+// Post-filter overdrive and lowest gain per level, the same as for NS policies
+// 0, 1 and 2.
+static const float kPostFilterOverdrive[3] = {1.0f, 1.0f, 1.1f};
+static const float kPostFilterBound[3] = {0.5f, 0.25f, 0.125f};
+// Decision-directed smoothing of the prior SNR, as in NS.
+static const float kPostFilterPriorSmoothing = 0.98f;
 
 // Number of partitions forming the NLP's "preferred" bands.
 enum {
@@ -114,12 +134,28 @@ extern int webrtc_aec_instance_count;
 #endif
 
 // "Private" function prototypes.
-static void ProcessBlock(AecCore* aec);
+static void AlignFarend(AecCore* aec,
+                        int knownDelay,
+                        int min_system_delay,
+                        int stuff_elements,
+                        int near_blocks);
+static void ProcessBlock(AecCore* aec,
+                         const int16_t* nearend,
+                         const int16_t* nearendH,
+                         int16_t* output,
+                         int16_t* outputH);
+static void IdleBlock(AecCore* aec,
+                      const int16_t* nearend,
+                      const int16_t* nearendH,
+                      int16_t* output,
+                      int16_t* outputH);
 
 static void NonLinearProcessing(AecCore* aec, short* output, short* outputH);
 
 static void GetHighbandGain(const float* lambda, float* nlpGainHband);
 
+static void PostFilter(AecCore* aec, float efw[2][PART_LEN1]);
+
 // Comfort_noise also computes noise for H band returned in comfortNoiseHband
 static void ComfortNoise(AecCore* aec,
                          float efw[2][PART_LEN1],
@@ -127,10 +163,23 @@ static void ComfortNoise(AecCore* aec,
                          const float* noisePow,
                          const float* lambda);
 
+// Updates the smoothed auto and cross PSDs and computes the subband
+// coherences between near-end/error and far-end/near-end.
+static void SubbandCoherence(AecCore* aec,
+                             float efw[2][PART_LEN1],
+                             float dfw[2][PART_LEN1],
+                             float xfw[2][PART_LEN1],
+                             float* cohde,
+                             float* cohxd,
+                             float* sdSum,
+                             float* seSum);
+
 static void InitLevel(PowerLevel* level);
 static void InitStats(Stats* stats);
 static void InitMetrics(AecCore* aec);
+static float PartitionEnergy(float in[2][PART_LEN1]);
 static void UpdateLevel(PowerLevel* level, float in[2][PART_LEN1]);
+static void UpdateMetricsBlock(AecCore* aec);
 static void UpdateMetrics(AecCore* aec);
 // Convert from time domain to frequency domain. Note that |time_data| are
 // overwritten.
@@ -146,11 +195,42 @@ __inline static float MulIm(float aRe, float aIm, float bRe, float bIm) {
   return aRe * bIm + aIm * bRe;
 }
 
-static int CmpFloat(const void* a, const void* b) {
-  const float* da = (const float*)a;
-  const float* db = (const float*)b;
-
-  return (*da > *db) - (*da < *db);
+// Rearranges |data| such that |data[k]| holds the value it would have in a
+// sorted array, with no larger values in front of it (Hoare's selection).
+// Returns |data[k]|. Runs in expected linear time.
+static float SelectOrderStatistic(float* data, int len, int k) {
+  int left = 0;
+  int right = len - 1;
+
+  assert(k >= 0 && k < len);
+  while (left < right) {
+    const float pivot = data[(left + right) >> 1];
+    int i = left;
+    int j = right;
+    while (i <= j) {
+      while (data[i] < pivot) {
+        i++;
+      }
+      while (data[j] > pivot) {
+        j--;
+      }
+      if (i <= j) {
+        const float tmp = data[i];
+        data[i] = data[j];
+        data[j] = tmp;
+        i++;
+        j--;
+      }
+    }
+    if (k <= j) {
+      right = j;
+    } else if (k >= i) {
+      left = i;
+    } else {
+      break;
+    }
+  }
+  return data[k];
 }
 
 int WebRtcAec_CreateAec(AecCore** aecInst) {
@@ -419,6 +499,9 @@ WebRtcAec_FilterFar_t WebRtcAec_FilterFar;
 WebRtcAec_ScaleErrorSignal_t WebRtcAec_ScaleErrorSignal;
 WebRtcAec_FilterAdaptation_t WebRtcAec_FilterAdaptation;
 WebRtcAec_OverdriveAndSuppress_t WebRtcAec_OverdriveAndSuppress;
+WebRtcAec_SubbandCoherence_t WebRtcAec_SubbandCoherence;
+WebRtcAec_ComfortNoise_t WebRtcAec_ComfortNoise;
+WebRtcAec_PartitionEnergy_t WebRtcAec_PartitionEnergy;
 
 int WebRtcAec_InitAec(AecCore* aec, int sampFreq) {
   int i;
@@ -470,8 +553,21 @@ int WebRtcAec_InitAec(AecCore* aec, int sampFreq) {
     return -1;
   }
   aec->delay_logging_enabled = 0;
+  aec->delay_agnostic_enabled = 0;
+  aec->frame_count = 0;
+  aec->previous_delay = -2;  // (-2): Uninitialized.
+  aec->delay_correction_count = 0;
+  aec->shift_offset = kInitialShiftOffset;
+  aec->delay_quality_threshold = 0;
   memset(aec->delay_histogram, 0, sizeof(aec->delay_histogram));
 
+  aec->post_filter = 0;
+  memset(aec->pfSpeechPow, 0, sizeof(aec->pfSpeechPow));
+  for (i = 0; i < PART_LEN1; i++) {
+    aec->pfGain[i] = 1;
+  }
+  aec->nearend_idle = 0;
+
   aec->extended_filter_enabled = 0;
   aec->num_partitions = kNormalNumPartitions;
 
@@ -557,10 +653,22 @@ int WebRtcAec_InitAec(AecCore* aec, int sampFreq) {
   aec->divergeState = 0;
 
   aec->seed = 777;
+  // Any non-zero, distinct values will do for the xorshift lanes.
+  aec->cn_seed[0] = 777;
+  aec->cn_seed[1] = 0x9E3779B9;
+  aec->cn_seed[2] = 0x7F4A7C15;
+  aec->cn_seed[3] = 0x2545F491;
+
+  aec->freq_avg_ic = freqAvgIc;
+  aec->flag_Hband_cn = flagHbandCn;
+  aec->cn_scale_Hband = cnScaleHband;
+
   aec->delayEstCtr = 0;
 
   // Metrics disabled by default
-  aec->metricsMode = 0;
+  aec->metricsMode = kMetricsOff;
+  aec->metricsBlockCtr = 0;
+  aec->update_metrics = 0;
   InitMetrics(aec);
 
   // Assembly optimization
@@ -568,6 +676,9 @@ int WebRtcAec_InitAec(AecCore* aec, int sampFreq) {
   WebRtcAec_ScaleErrorSignal = ScaleErrorSignal;
   WebRtcAec_FilterAdaptation = FilterAdaptation;
   WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppress;
+  WebRtcAec_SubbandCoherence = SubbandCoherence;
+  WebRtcAec_ComfortNoise = ComfortNoise;
+  WebRtcAec_PartitionEnergy = PartitionEnergy;
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
   if (WebRtc_GetCPUInfo(kSSE2)) {
@@ -609,6 +720,124 @@ int WebRtcAec_MoveFarReadPtr(AecCore* aec, int elements) {
   return elements_moved;
 }
 
+static int SignalBasedDelayCorrection(AecCore* self) {
+  int delay_correction = 0;
+  int last_delay = -2;
+  assert(self != NULL);
+  // Let the delay estimator converge before trusting it.  A low playout level
+  // can otherwise produce a large bogus delay that would break the AEC.
+  if (self->frame_count < kDelayCorrectionStart) {
+    return 0;
+  }
+
+  // 1. Check for a non-negative delay estimate.  The estimates are not
+  //    compensated for lookahead, hence a negative |last_delay| is invalid.
+  // 2. Only act on a changed estimate, and only if the delay is outside the
+  //    region the adaptive filter already covers.
+  // 3. Only allow delay correction if the estimation quality exceeds
+  //    |delay_quality_threshold|.
+  // 4. Verify that the proposed |delay_correction| is feasible with respect to
+  //    the far-end buffer content.
+  last_delay = WebRtc_last_delay(self->delay_estimator);
+  if ((last_delay >= 0) &&
+      (last_delay != self->previous_delay) &&
+      (WebRtc_last_delay_quality(self->delay_estimator) >
+           self->delay_quality_threshold)) {
+    int delay = last_delay - kLookaheadBlocks;
+    // The adaptive filter is |num_partitions| blocks long.  If the delay is
+    // negative or at least 3/4 of the filter length we correct it.
+    const int lower_bound = 0;
+    const int upper_bound = self->num_partitions * 3 / 4;
+    const int do_correction = delay <= lower_bound || delay > upper_bound;
+    if (do_correction == 1) {
+      int available_read = (int)WebRtc_available_read(self->far_buf);
+      // With |shift_offset| we gradually rely on the delay estimates.  For
+      // positive delays we reduce the correction by |shift_offset| to lower
+      // the risk of pushing the AEC into a non causal state.  For negative
+      // delays we rely on the values up to a rounding error, hence compensate
+      // by 1 element to make sure to push the delay into the causal region.
+      delay_correction = -delay;
+      delay_correction += delay > self->shift_offset ? self->shift_offset : 1;
+      self->shift_offset--;
+      self->shift_offset = (self->shift_offset <= 1 ? 1 : self->shift_offset);
+      if (delay_correction > available_read - self->mult - 1) {
+        // There is not enough data in the buffer to perform this shift.
+        // Hence, we do not rely on the delay estimate and do nothing.
+        delay_correction = 0;
+      } else {
+        self->previous_delay = last_delay;
+        ++self->delay_correction_count;
+      }
+    }
+  }
+  // Raise the |delay_quality_threshold| once we have our first delay
+  // correction, so later corrections need at least the same confidence.
+  if (self->delay_correction_count > 0) {
+    int delay_quality = WebRtc_last_delay_quality(self->delay_estimator);
+    delay_quality = (delay_quality > kDelayQualityThresholdMax ?
+        kDelayQualityThresholdMax : delay_quality);
+    self->delay_quality_threshold =
+        (delay_quality > self->delay_quality_threshold ? delay_quality :
+            self->delay_quality_threshold);
+  }
+  return delay_correction;
+}
+
+// Steps 1) and 2) of WebRtcAec_ProcessFrame(): stuffs the far-end buffer by
+// |stuff_elements| partitions if |system_delay| is below |min_system_delay|,
+// and moves the far-end read position according to |knownDelay| or, in delay
+// agnostic mode, the delay estimate.  |near_blocks| is the number of near-end
+// partitions about to be processed.
+static void AlignFarend(AecCore* aec,
+                        int knownDelay,
+                        int min_system_delay,
+                        int stuff_elements,
+                        int near_blocks) {
+  // TODO(bjornv): Investigate how we should round the delay difference; right
+  // now we know that incoming |knownDelay| is underestimated when it's less
+  // than |aec->knownDelay|. We therefore, round (-32) in that direction. In
+  // the other direction, we don't have this situation, but might flush one
+  // partition too little. This can cause non-causality, which should be
+  // investigated. Maybe, allow for a non-symmetric rounding, like -16.
+  int move_elements = (aec->knownDelay - knownDelay - 32) / PART_LEN;
+  int moved_elements = 0;
+  int stuffed_elements = 0;
+
+  // 1) Stuff the far-end buffer if the |system_delay| indicates that there
+  // isn't enough data for the near-end about to be processed.
+  if (aec->system_delay < min_system_delay) {
+    stuffed_elements = WebRtcAec_MoveFarReadPtr(aec, -stuff_elements);
+  }
+
+  if (!aec->delay_agnostic_enabled) {
+    // 2 a) Compensate for a possible change in the system delay.
+    WebRtc_MoveReadPtr(aec->far_buf_windowed, move_elements);
+    moved_elements = WebRtc_MoveReadPtr(aec->far_buf, move_elements);
+    aec->knownDelay -= moved_elements * PART_LEN;
+#ifdef WEBRTC_AEC_DEBUG_DUMP
+    WebRtc_MoveReadPtr(aec->far_time_buf, move_elements);
+#endif
+  } else {
+    // 2 b) Apply signal based delay correction.  Every move of the read
+    // position in this frame, including the stuffing in 1), is mirrored in
+    // the delay estimator history so it doesn't have to reconverge.
+    int far_near_buffer_diff = 0;
+    moved_elements = stuffed_elements +
+        WebRtcAec_MoveFarReadPtr(aec, SignalBasedDelayCorrection(aec));
+    // The delay estimate may be wrong, so unlike 2 a) we can end up short of
+    // far-end data for this frame.  Stuff the buffer if needed.
+    far_near_buffer_diff = (int)WebRtc_available_read(aec->far_buf) -
+        near_blocks;
+    if (far_near_buffer_diff < 0) {
+      moved_elements += WebRtcAec_MoveFarReadPtr(aec, far_near_buffer_diff);
+    }
+    WebRtc_SoftResetDelayEstimatorFarend(aec->delay_estimator_farend,
+                                         moved_elements);
+    WebRtc_SoftResetDelayEstimator(aec->delay_estimator, moved_elements);
+    aec->frame_count++;
+  }
+}
+
 void WebRtcAec_ProcessFrame(AecCore* aec,
                             const short* nearend,
                             const short* nearendH,
@@ -631,15 +860,6 @@ void WebRtcAec_ProcessFrame(AecCore* aec,
   //    amount of data we input and output in audio_processing.
   // 6) Update the outputs.
 
-  // TODO(bjornv): Investigate how we should round the delay difference; right
-  // now we know that incoming |knownDelay| is underestimated when it's less
-  // than |aec->knownDelay|. We therefore, round (-32) in that direction. In
-  // the other direction, we don't have this situation, but might flush one
-  // partition too little. This can cause non-causality, which should be
-  // investigated. Maybe, allow for a non-symmetric rounding, like -16.
-  int move_elements = (aec->knownDelay - knownDelay - 32) / PART_LEN;
-  int moved_elements = 0;
-
   // TODO(bjornv): Change the near-end buffer handling to be the same as for
   // far-end, that is, with a near_pre_buf.
   // Buffer the near-end frame.
@@ -652,22 +872,37 @@ void WebRtcAec_ProcessFrame(AecCore* aec,
   // 1) At most we process |aec->mult|+1 partitions in 10 ms. Make sure we
   // have enough far-end data for that by stuffing the buffer if the
   // |system_delay| indicates others.
-  if (aec->system_delay < FRAME_LEN) {
-    // We don't have enough data so we rewind 10 ms.
-    WebRtcAec_MoveFarReadPtr(aec, -(aec->mult + 1));
-  }
-
   // 2) Compensate for a possible change in the system delay.
-  WebRtc_MoveReadPtr(aec->far_buf_windowed, move_elements);
-  moved_elements = WebRtc_MoveReadPtr(aec->far_buf, move_elements);
-  aec->knownDelay -= moved_elements * PART_LEN;
-#ifdef WEBRTC_AEC_DEBUG_DUMP
-  WebRtc_MoveReadPtr(aec->far_time_buf, move_elements);
-#endif
+  AlignFarend(aec,
+              knownDelay,
+              FRAME_LEN,
+              aec->mult + 1,
+              (int)WebRtc_available_read(aec->nearFrBuf) / PART_LEN);
 
   // 4) Process as many blocks as possible.
   while (WebRtc_available_read(aec->nearFrBuf) >= PART_LEN) {
-    ProcessBlock(aec);
+    int16_t nearend_block[PART_LEN];
+    int16_t nearendH_block[PART_LEN];
+    int16_t* nearend_ptr = NULL;
+    int16_t* nearendH_ptr = NULL;
+    int16_t output[PART_LEN];
+    int16_t outputH[PART_LEN];
+
+    if (aec->sampFreq == 32000) {
+      WebRtc_ReadBuffer(
+          aec->nearFrBufH, (void**)&nearendH_ptr, nearendH_block, PART_LEN);
+    }
+    WebRtc_ReadBuffer(
+        aec->nearFrBuf, (void**)&nearend_ptr, nearend_block, PART_LEN);
+
+    ProcessBlock(aec, nearend_ptr, nearendH_ptr, output, outputH);
+
+    // Store the output block.
+    WebRtc_WriteBuffer(aec->outFrBuf, output, PART_LEN);
+    // For H band
+    if (aec->sampFreq == 32000) {
+      WebRtc_WriteBuffer(aec->outFrBufH, outputH, PART_LEN);
+    }
   }
 
   // 5) Update system delay with respect to the entire frame.
@@ -691,6 +926,31 @@ void WebRtcAec_ProcessFrame(AecCore* aec,
   }
 }
 
+void WebRtcAec_ProcessBlocks(AecCore* aec,
+                             const int16_t* nearend,
+                             const int16_t* nearendH,
+                             int num_blocks,
+                             int knownDelay,
+                             int16_t* out,
+                             int16_t* outH) {
+  int i;
+
+  // Same as WebRtcAec_ProcessFrame(), but every block is read from and
+  // written to the caller's buffers, and the |system_delay| is updated with
+  // exactly the amount of data processed.
+  AlignFarend(aec, knownDelay, num_blocks * PART_LEN, num_blocks, num_blocks);
+
+  for (i = 0; i < num_blocks; i++) {
+    ProcessBlock(aec,
+                 &nearend[PART_LEN * i],
+                 aec->sampFreq == 32000 ? &nearendH[PART_LEN * i] : NULL,
+                 &out[PART_LEN * i],
+                 aec->sampFreq == 32000 ? &outH[PART_LEN * i] : NULL);
+  }
+
+  aec->system_delay -= num_blocks * PART_LEN;
+}
+
 int WebRtcAec_GetDelayMetricsCore(AecCore* self, int* median, int* std) {
   int i = 0;
   int delay_values = 0;
@@ -769,7 +1029,9 @@ void WebRtcAec_SetConfigCore(AecCore* self,
                              int delay_logging) {
   assert(nlp_mode >= 0 && nlp_mode < 3);
   self->nlp_mode = nlp_mode;
+  assert(metrics_mode >= kMetricsOff && metrics_mode <= kMetricsLight);
   self->metricsMode = metrics_mode;
+  self->metricsBlockCtr = 0;
   if (self->metricsMode) {
     InitMetrics(self);
   }
@@ -790,6 +1052,29 @@ int WebRtcAec_delay_correction_enabled(AecCore* self) {
   return self->extended_filter_enabled;
 }
 
+void WebRtcAec_enable_delay_agnostic(AecCore* self, int enable) {
+  self->delay_agnostic_enabled = enable;
+}
+
+int WebRtcAec_delay_agnostic_enabled(AecCore* self) {
+  return self->delay_agnostic_enabled;
+}
+
+void WebRtcAec_enable_post_filter(AecCore* self, int level) {
+  assert(level >= 0 && level <= 3);
+  self->post_filter = level;
+  if (level > 0) {
+    self->post_filter_overdrive = kPostFilterOverdrive[level - 1];
+    self->post_filter_bound = kPostFilterBound[level - 1];
+  }
+}
+
+int WebRtcAec_post_filter_enabled(AecCore* self) { return self->post_filter; }
+
+void WebRtcAec_enable_idle(AecCore* self, int idle) {
+  self->nearend_idle = idle;
+}
+
 int WebRtcAec_system_delay(AecCore* self) { return self->system_delay; }
 
 void WebRtcAec_SetSystemDelay(AecCore* self, int delay) {
@@ -797,7 +1082,168 @@ void WebRtcAec_SetSystemDelay(AecCore* self, int delay) {
   self->system_delay = delay;
 }
 
-static void ProcessBlock(AecCore* aec) {
+// Fixed size part of the saved state.  It is followed by the arrays listed
+// in GetStateArrays().  The blob is stored in native byte order and is only
+// meant to be restored on the same platform.
+typedef struct {
+  uint32_t magic;
+  int32_t version;
+  int32_t samp_freq;
+  int32_t num_partitions;
+  int32_t buffer_partitions;
+  int32_t noise_est_ctr;
+  int32_t hnl_new_min;
+  int32_t hnl_min_ctr;
+  int32_t echo_state;
+  int32_t diverge_state;
+  int32_t delay_correction_count;
+  int32_t shift_offset;
+  int32_t delay_quality_threshold;
+  float hnl_fb_min;
+  float hnl_fb_local_min;
+  float hnl_xd_avg_min;
+  float over_drive;
+  float over_drive_sm;
+} AecStateHeader;
+
+typedef struct {
+  void* data;
+  size_t size;
+} StateArray;
+
+// Lists the arrays of the saved state.  Only the |num_partitions| partitions
+// in use of the filter are included.  The far-end history is not, it is
+// refilled within a filter length of the next call.
+static void GetStateArrays(AecCore* self, StateArray arrays[kStateArrays]) {
+  const size_t filter_size = sizeof(float) * self->num_partitions * PART_LEN1;
+  int i = 0;
+
+  arrays[i].data = self->wfBuf[0];
+  arrays[i++].size = filter_size;
+  arrays[i].data = self->wfBuf[1];
+  arrays[i++].size = filter_size;
+  arrays[i].data = self->xPow;
+  arrays[i++].size = sizeof(self->xPow);
+  arrays[i].data = self->dPow;
+  arrays[i++].size = sizeof(self->dPow);
+  arrays[i].data = self->dMinPow;
+  arrays[i++].size = sizeof(self->dMinPow);
+  arrays[i].data = self->dInitMinPow;
+  arrays[i++].size = sizeof(self->dInitMinPow);
+  arrays[i].data = self->sde;
+  arrays[i++].size = sizeof(self->sde);
+  arrays[i].data = self->sxd;
+  arrays[i++].size = sizeof(self->sxd);
+  arrays[i].data = self->sx;
+  arrays[i++].size = sizeof(self->sx);
+  arrays[i].data = self->sd;
+  arrays[i++].size = sizeof(self->sd);
+  arrays[i].data = self->se;
+  arrays[i++].size = sizeof(self->se);
+  arrays[i].data = self->delay_histogram;
+  arrays[i++].size = sizeof(self->delay_histogram);
+  assert(i == kStateArrays);
+}
+
+int WebRtcAec_StateSizeCore(AecCore* self) {
+  StateArray arrays[kStateArrays];
+  size_t size = sizeof(AecStateHeader);
+  int i = 0;
+
+  GetStateArrays(self, arrays);
+  for (i = 0; i < kStateArrays; i++) {
+    size += arrays[i].size;
+  }
+  return (int)size;
+}
+
+void WebRtcAec_SaveStateCore(AecCore* self, void* state) {
+  StateArray arrays[kStateArrays];
+  AecStateHeader header;
+  char* dst = (char*)state;
+  int i = 0;
+
+  assert(state != NULL);
+
+  memset(&header, 0, sizeof(header));
+  header.magic = kStateMagic;
+  header.version = kStateVersion;
+  header.samp_freq = self->sampFreq;
+  header.num_partitions = self->num_partitions;
+  header.buffer_partitions = self->system_delay / PART_LEN;
+  header.noise_est_ctr = self->noiseEstCtr;
+  header.hnl_new_min = self->hNlNewMin;
+  header.hnl_min_ctr = self->hNlMinCtr;
+  header.echo_state = self->echoState;
+  header.diverge_state = self->divergeState;
+  header.delay_correction_count = self->delay_correction_count;
+  header.shift_offset = self->shift_offset;
+  header.delay_quality_threshold = self->delay_quality_threshold;
+  header.hnl_fb_min = self->hNlFbMin;
+  header.hnl_fb_local_min = self->hNlFbLocalMin;
+  header.hnl_xd_avg_min = self->hNlXdAvgMin;
+  header.over_drive = self->overDrive;
+  header.over_drive_sm = self->overDriveSm;
+  memcpy(dst, &header, sizeof(header));
+  dst += sizeof(header);
+
+  GetStateArrays(self, arrays);
+  for (i = 0; i < kStateArrays; i++) {
+    memcpy(dst, arrays[i].data, arrays[i].size);
+    dst += arrays[i].size;
+  }
+}
+
+int WebRtcAec_RestoreStateCore(AecCore* self, const void* state, int size) {
+  StateArray arrays[kStateArrays];
+  AecStateHeader header;
+  const char* src = (const char*)state;
+  int i = 0;
+
+  assert(state != NULL);
+
+  if (size < (int)sizeof(header)) {
+    return -1;
+  }
+  memcpy(&header, src, sizeof(header));
+  src += sizeof(header);
+  if (header.magic != kStateMagic || header.version != kStateVersion ||
+      header.samp_freq != self->sampFreq ||
+      header.num_partitions != self->num_partitions ||
+      size != WebRtcAec_StateSizeCore(self) || header.buffer_partitions < 0) {
+    return -1;
+  }
+
+  GetStateArrays(self, arrays);
+  for (i = 0; i < kStateArrays; i++) {
+    memcpy(arrays[i].data, src, arrays[i].size);
+    src += arrays[i].size;
+  }
+
+  self->noiseEstCtr = header.noise_est_ctr;
+  self->hNlNewMin = header.hnl_new_min;
+  self->hNlMinCtr = header.hnl_min_ctr;
+  self->echoState = (short)header.echo_state;
+  self->divergeState = (short)header.diverge_state;
+  // The delay estimator itself starts over, but keeps the confidence it
+  // needed in the previous call before it may move the far-end again.
+  self->delay_correction_count = header.delay_correction_count;
+  self->shift_offset = header.shift_offset;
+  self->delay_quality_threshold = header.delay_quality_threshold;
+  self->hNlFbMin = header.hnl_fb_min;
+  self->hNlFbLocalMin = header.hnl_fb_local_min;
+  self->hNlXdAvgMin = header.hnl_xd_avg_min;
+  self->overDrive = header.over_drive;
+  self->overDriveSm = header.over_drive_sm;
+
+  return header.buffer_partitions;
+}
+
+static void ProcessBlock(AecCore* aec,
+                         const int16_t* nearend,
+                         const int16_t* nearendH,
+                         int16_t* output,
+                         int16_t* outputH) {
   int i;
   float d[PART_LEN], y[PART_LEN], e[PART_LEN], dH[PART_LEN];
   float scale;
@@ -818,28 +1264,25 @@ static void ProcessBlock(AecCore* aec) {
   const float ramp = 1.0002f;
   const float gInitNoise[2] = {0.999f, 0.001f};
 
-  int16_t nearend[PART_LEN];
-  int16_t* nearend_ptr = NULL;
-  int16_t output[PART_LEN];
-  int16_t outputH[PART_LEN];
-
   float* xf_ptr = NULL;
 
+  if (aec->nearend_idle) {
+    IdleBlock(aec, nearend, nearendH, output, outputH);
+    return;
+  }
+
   memset(dH, 0, sizeof(dH));
   if (aec->sampFreq == 32000) {
-    // Get the upper band first so we can reuse |nearend|.
-    WebRtc_ReadBuffer(aec->nearFrBufH, (void**)&nearend_ptr, nearend, PART_LEN);
     for (i = 0; i < PART_LEN; i++) {
-      dH[i] = (float)(nearend_ptr[i]);
+      dH[i] = (float)(nearendH[i]);
     }
     memcpy(aec->dBufH + PART_LEN, dH, sizeof(float) * PART_LEN);
   }
-  WebRtc_ReadBuffer(aec->nearFrBuf, (void**)&nearend_ptr, nearend, PART_LEN);
 
   // ---------- Ooura fft ----------
   // Concatenate old and new nearend blocks.
   for (i = 0; i < PART_LEN; i++) {
-    d[i] = (float)(nearend_ptr[i]);
+    d[i] = (float)(nearend[i]);
   }
   memcpy(aec->dBuf + PART_LEN, d, sizeof(float) * PART_LEN);
 
@@ -849,7 +1292,7 @@ static void ProcessBlock(AecCore* aec) {
     int16_t* farend_ptr = NULL;
     WebRtc_ReadBuffer(aec->far_time_buf, (void**)&farend_ptr, farend, 1);
     (void)fwrite(farend_ptr, sizeof(int16_t), PART_LEN, aec->farFile);
-    (void)fwrite(nearend_ptr, sizeof(int16_t), PART_LEN, aec->nearFile);
+    (void)fwrite(nearend, sizeof(int16_t), PART_LEN, aec->nearFile);
   }
 #endif
 
@@ -905,14 +1348,14 @@ static void ProcessBlock(AecCore* aec) {
     aec->noisePow = aec->dMinPow;
   }
 
-  // Block wise delay estimation used for logging
-  if (aec->delay_logging_enabled) {
+  // Block wise delay estimation used for logging and delay agnostic mode
+  if (aec->delay_logging_enabled || aec->delay_agnostic_enabled) {
     int delay_estimate = 0;
     if (WebRtc_AddFarSpectrumFloat(
             aec->delay_estimator_farend, abs_far_spectrum, PART_LEN1) == 0) {
       delay_estimate = WebRtc_DelayEstimatorProcessFloat(
           aec->delay_estimator, abs_near_spectrum, PART_LEN1);
-      if (delay_estimate >= 0) {
+      if (delay_estimate >= 0 && aec->delay_logging_enabled) {
         // Update delay estimate buffer.
         aec->delay_histogram[delay_estimate]++;
       }
@@ -972,7 +1415,8 @@ static void ProcessBlock(AecCore* aec) {
     ef[1][i] = fft[2 * i + 1];
   }
 
-  if (aec->metricsMode == 1) {
+  UpdateMetricsBlock(aec);
+  if (aec->update_metrics) {
     // Note that the first PART_LEN samples in fft (before transformation) are
     // zero. Hence, the scaling by two in UpdateLevel() should not be
     // performed. That scaling is taken care of in UpdateMetrics() instead.
@@ -984,20 +1428,13 @@ static void ProcessBlock(AecCore* aec) {
   WebRtcAec_FilterAdaptation(aec, fft, ef);
   NonLinearProcessing(aec, output, outputH);
 
-  if (aec->metricsMode == 1) {
+  if (aec->update_metrics) {
     // Update power levels and echo metrics
     UpdateLevel(&aec->farlevel, (float(*)[PART_LEN1])xf_ptr);
     UpdateLevel(&aec->nearlevel, df);
     UpdateMetrics(aec);
   }
 
-  // Store the output block.
-  WebRtc_WriteBuffer(aec->outFrBuf, output, PART_LEN);
-  // For H band
-  if (aec->sampFreq == 32000) {
-    WebRtc_WriteBuffer(aec->outFrBufH, outputH, PART_LEN);
-  }
-
 #ifdef WEBRTC_AEC_DEBUG_DUMP
   {
     int16_t eInt16[PART_LEN];
@@ -1012,6 +1449,65 @@ static void ProcessBlock(AecCore* aec) {
 #endif
 }
 
+// Block of a silent near end: only the far-end side is kept running, so that
+// the buffers stay aligned and the far power and spectrum history are current
+// when the near end comes back.  The filter, the NLP and the delay estimator
+// are left as they are and the output is silence.
+static void IdleBlock(AecCore* aec,
+                      const int16_t* nearend,
+                      const int16_t* nearendH,
+                      int16_t* output,
+                      int16_t* outputH) {
+  const float gPow[2] = {0.9f, 0.1f};
+  float xf[2][PART_LEN1];
+  float xfw[2][PART_LEN1];
+  float* xf_ptr = NULL;
+  float* xfw_ptr = NULL;
+  int i;
+
+  assert(WebRtc_available_read(aec->far_buf) > 0);
+  WebRtc_ReadBuffer(aec->far_buf, (void**)&xf_ptr, &xf[0][0], 1);
+  for (i = 0; i < PART_LEN1; i++) {
+    const float far_spectrum = (xf_ptr[i] * xf_ptr[i]) +
+                               (xf_ptr[PART_LEN1 + i] * xf_ptr[PART_LEN1 + i]);
+    aec->xPow[i] =
+        gPow[0] * aec->xPow[i] + gPow[1] * aec->num_partitions * far_spectrum;
+  }
+
+  aec->xfBufBlockPos--;
+  if (aec->xfBufBlockPos == -1) {
+    aec->xfBufBlockPos = aec->num_partitions - 1;
+  }
+  memcpy(aec->xfBuf[0] + aec->xfBufBlockPos * PART_LEN1,
+         xf_ptr,
+         sizeof(float) * PART_LEN1);
+  memcpy(aec->xfBuf[1] + aec->xfBufBlockPos * PART_LEN1,
+         &xf_ptr[PART_LEN1],
+         sizeof(float) * PART_LEN1);
+
+  assert(WebRtc_available_read(aec->far_buf_windowed) > 0);
+  WebRtc_ReadBuffer(aec->far_buf_windowed, (void**)&xfw_ptr, &xfw[0][0], 1);
+  memcpy(aec->xfwBuf, xfw_ptr, sizeof(float) * 2 * PART_LEN1);
+  memmove(aec->xfwBuf + PART_LEN1,
+          aec->xfwBuf,
+          sizeof(aec->xfwBuf) - sizeof(complex_t) * PART_LEN1);
+
+  // The block becomes the old half of the next one, with no echo estimate.
+  for (i = 0; i < PART_LEN; i++) {
+    aec->dBuf[i] = nearend[i];
+  }
+  memcpy(aec->eBuf, aec->dBuf, sizeof(float) * PART_LEN);
+  memset(aec->outBuf, 0, sizeof(aec->outBuf));
+  memset(output, 0, sizeof(*output) * PART_LEN);
+  if (aec->sampFreq == 32000) {
+    for (i = 0; i < PART_LEN; i++) {
+      aec->dBufH[i] = nearendH[i];
+    }
+    memset(outputH, 0, sizeof(*outputH) * PART_LEN);
+  }
+  aec->echoState = 0;
+}
+
 static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
   float efw[2][PART_LEN1], dfw[2][PART_LEN1], xfw[2][PART_LEN1];
   complex_t comfortNoiseHband[PART_LEN1];
@@ -1028,15 +1524,14 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
   float hNlFb = 0, hNlFbLow = 0;
   const float prefBandQuant = 0.75f, prefBandQuantLow = 0.5f;
   const int prefBandSize = kPrefBandSize / aec->mult;
+  const int prefBandQuantIdx = (int)floor(prefBandQuant * (prefBandSize - 1));
+  const int prefBandQuantLowIdx =
+      (int)floor(prefBandQuantLow * (prefBandSize - 1));
   const int minPrefBand = 4 / aec->mult;
 
   // Near and error power sums
   float sdSum = 0, seSum = 0;
 
-  // Power estimate smoothing coefficients.
-  const float* ptrGCoh = aec->extended_filter_enabled
-                             ? kExtendedSmoothingCoefficients[aec->mult - 1]
-                             : kNormalSmoothingCoefficients[aec->mult - 1];
   const float* min_overdrive = aec->extended_filter_enabled
                                    ? kExtendedMinOverDrive
                                    : kNormalMinOverDrive;
@@ -1121,38 +1616,7 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
     efw[1][i] = fft[2 * i + 1];
   }
 
-  // Smoothed PSD
-  for (i = 0; i < PART_LEN1; i++) {
-    aec->sd[i] = ptrGCoh[0] * aec->sd[i] +
-                 ptrGCoh[1] * (dfw[0][i] * dfw[0][i] + dfw[1][i] * dfw[1][i]);
-    aec->se[i] = ptrGCoh[0] * aec->se[i] +
-                 ptrGCoh[1] * (efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i]);
-    // We threshold here to protect against the ill-effects of a zero farend.
-    // The threshold is not arbitrarily chosen, but balances protection and
-    // adverse interaction with the algorithm's tuning.
-    // TODO: investigate further why this is so sensitive.
-    aec->sx[i] =
-        ptrGCoh[0] * aec->sx[i] +
-        ptrGCoh[1] *
-            WEBRTC_SPL_MAX(xfw[0][i] * xfw[0][i] + xfw[1][i] * xfw[1][i], 15);
-
-    aec->sde[i][0] =
-        ptrGCoh[0] * aec->sde[i][0] +
-        ptrGCoh[1] * (dfw[0][i] * efw[0][i] + dfw[1][i] * efw[1][i]);
-    aec->sde[i][1] =
-        ptrGCoh[0] * aec->sde[i][1] +
-        ptrGCoh[1] * (dfw[0][i] * efw[1][i] - dfw[1][i] * efw[0][i]);
-
-    aec->sxd[i][0] =
-        ptrGCoh[0] * aec->sxd[i][0] +
-        ptrGCoh[1] * (dfw[0][i] * xfw[0][i] + dfw[1][i] * xfw[1][i]);
-    aec->sxd[i][1] =
-        ptrGCoh[0] * aec->sxd[i][1] +
-        ptrGCoh[1] * (dfw[0][i] * xfw[1][i] - dfw[1][i] * xfw[0][i]);
-
-    sdSum += aec->sd[i];
-    seSum += aec->se[i];
-  }
+  WebRtcAec_SubbandCoherence(aec, efw, dfw, xfw, cohde, cohxd, &sdSum, &seSum);
 
   // Divergent filter safeguard.
   if (aec->divergeState == 0) {
@@ -1176,16 +1640,6 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
     }
   }
 
-  // Subband coherence
-  for (i = 0; i < PART_LEN1; i++) {
-    cohde[i] =
-        (aec->sde[i][0] * aec->sde[i][0] + aec->sde[i][1] * aec->sde[i][1]) /
-        (aec->sd[i] * aec->se[i] + 1e-10f);
-    cohxd[i] =
-        (aec->sxd[i][0] * aec->sxd[i][0] + aec->sxd[i][1] * aec->sxd[i][1]) /
-        (aec->sx[i] * aec->sd[i] + 1e-10f);
-  }
-
   hNlXdAvg = 0;
   for (i = minPrefBand; i < prefBandSize + minPrefBand; i++) {
     hNlXdAvg += cohxd[i];
@@ -1237,12 +1691,15 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
         hNl[i] = WEBRTC_SPL_MIN(cohde[i], 1 - cohxd[i]);
       }
 
-      // Select an order statistic from the preferred bands.
-      // TODO: Using quicksort now, but a selection algorithm may be preferred.
+      // Select an order statistic from the preferred bands. After selecting
+      // the upper quantile everything in front of it is no larger, so the
+      // lower quantile only has to be searched for in that part.
       memcpy(hNlPref, &hNl[minPrefBand], sizeof(float) * prefBandSize);
-      qsort(hNlPref, prefBandSize, sizeof(float), CmpFloat);
-      hNlFb = hNlPref[(int)floor(prefBandQuant * (prefBandSize - 1))];
-      hNlFbLow = hNlPref[(int)floor(prefBandQuantLow * (prefBandSize - 1))];
+      hNlFb = SelectOrderStatistic(hNlPref, prefBandSize, prefBandQuantIdx);
+      hNlFbLow = prefBandQuantLowIdx < prefBandQuantIdx
+                     ? SelectOrderStatistic(
+                           hNlPref, prefBandQuantIdx, prefBandQuantLowIdx)
+                     : hNlFb;
     }
   }
 
@@ -1279,17 +1736,24 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
   WebRtcAec_OverdriveAndSuppress(aec, hNl, hNlFb, efw);
 
   // Add comfort noise.
-  ComfortNoise(aec, efw, comfortNoiseHband, aec->noisePow, hNl);
+  WebRtcAec_ComfortNoise(aec, efw, comfortNoiseHband, aec->noisePow, hNl);
 
   // TODO(bjornv): Investigate how to take the windowing below into account if
   // needed.
-  if (aec->metricsMode == 1) {
+  if (aec->update_metrics) {
     // Note that we have a scaling by two in the time domain |eBuf|.
     // In addition the time domain signal is windowed before transformation,
     // losing half the energy on the average. We take care of the first
     // scaling only in UpdateMetrics().
     UpdateLevel(&aec->nlpoutlevel, efw);
   }
+
+  // Suppress the near-end noise after the metrics, they only measure the echo
+  // suppression.
+  if (aec->post_filter) {
+    PostFilter(aec, efw);
+  }
+
   // Inverse error fft.
   fft[0] = efw[0][0];
   fft[1] = efw[0][PART_LEN];
@@ -1321,6 +1785,11 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
     // average nlp over low band: average over second half of freq spectrum
     // (4->8khz)
     GetHighbandGain(hNl, &nlpGainHband);
+    if (aec->post_filter) {
+      float pfGainHband;
+      GetHighbandGain(aec->pfGain, &pfGainHband);
+      nlpGainHband *= pfGainHband;
+    }
 
     // Inverse comfort_noise
     if (flagHbandCn == 1) {
@@ -1365,6 +1834,68 @@ static void NonLinearProcessing(AecCore* aec, short* output, short* outputH) {
           sizeof(aec->xfwBuf) - sizeof(complex_t) * PART_LEN1);
 }
 
+static void SubbandCoherence(AecCore* aec,
+                             float efw[2][PART_LEN1],
+                             float dfw[2][PART_LEN1],
+                             float xfw[2][PART_LEN1],
+                             float* cohde,
+                             float* cohxd,
+                             float* sdSum,
+                             float* seSum) {
+  // Power estimate smoothing coefficients.
+  const float* ptrGCoh =
+      aec->extended_filter_enabled
+          ? WebRtcAec_kExtendedSmoothingCoefficients[aec->mult - 1]
+          : WebRtcAec_kNormalSmoothingCoefficients[aec->mult - 1];
+  int i;
+
+  *sdSum = 0;
+  *seSum = 0;
+
+  // Smoothed PSD
+  for (i = 0; i < PART_LEN1; i++) {
+    aec->sd[i] = ptrGCoh[0] * aec->sd[i] +
+                 ptrGCoh[1] * (dfw[0][i] * dfw[0][i] + dfw[1][i] * dfw[1][i]);
+    aec->se[i] = ptrGCoh[0] * aec->se[i] +
+                 ptrGCoh[1] * (efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i]);
+    // We threshold here to protect against the ill-effects of a zero farend.
+    // The threshold is not arbitrarily chosen, but balances protection and
+    // adverse interaction with the algorithm's tuning.
+    // TODO: investigate further why this is so sensitive.
+    aec->sx[i] =
+        ptrGCoh[0] * aec->sx[i] +
+        ptrGCoh[1] *
+            WEBRTC_SPL_MAX(xfw[0][i] * xfw[0][i] + xfw[1][i] * xfw[1][i], 15);
+
+    aec->sde[i][0] =
+        ptrGCoh[0] * aec->sde[i][0] +
+        ptrGCoh[1] * (dfw[0][i] * efw[0][i] + dfw[1][i] * efw[1][i]);
+    aec->sde[i][1] =
+        ptrGCoh[0] * aec->sde[i][1] +
+        ptrGCoh[1] * (dfw[0][i] * efw[1][i] - dfw[1][i] * efw[0][i]);
+
+    aec->sxd[i][0] =
+        ptrGCoh[0] * aec->sxd[i][0] +
+        ptrGCoh[1] * (dfw[0][i] * xfw[0][i] + dfw[1][i] * xfw[1][i]);
+    aec->sxd[i][1] =
+        ptrGCoh[0] * aec->sxd[i][1] +
+        ptrGCoh[1] * (dfw[0][i] * xfw[1][i] - dfw[1][i] * xfw[0][i]);
+
+    *sdSum += aec->sd[i];
+    *seSum += aec->se[i];
+  }
+
+  // Subband coherence
+  for (i = 0; i < PART_LEN1; i++) {
+    cohde[i] =
+        (aec->sde[i][0] * aec->sde[i][0] + aec->sde[i][1] * aec->sde[i][1]) /
+        (aec->sd[i] * aec->se[i] + 1e-10f);
+    cohxd[i] =
+        (aec->sxd[i][0] * aec->sxd[i][0] + aec->sxd[i][1] * aec->sxd[i][1]) /
+        (aec->sx[i] * aec->sd[i] + 1e-10f);
+  }
+}
+
 static void GetHighbandGain(const float* lambda, float* nlpGainHband) {
   int i;
 
@@ -1375,6 +1906,36 @@ static void GetHighbandGain(const float* lambda, float* nlpGainHband) {
   nlpGainHband[0] /= (float)(PART_LEN1 - 1 - freqAvgIc);
 }
 
+// Wiener filter on the error spectrum, with the prior SNR estimated in the
+// decision-directed way of NS and the near-end noise estimate of the AEC. The
+// comfort noise is already in |efw|, so it is brought down to the same floor as
+// the rest of the noise.
+static void PostFilter(AecCore* aec, float efw[2][PART_LEN1]) {
+  const float dd = kPostFilterPriorSmoothing;
+  int i;
+
+  for (i = 0; i < PART_LEN1; i++) {
+    const float noise = aec->noisePow[i] + 1e-10f;
+    const float power = efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i];
+    float snrPost = power / noise - 1;
+    float snrPrior, gain;
+
+    if (snrPost < 0) {
+      snrPost = 0;
+    }
+    snrPrior = dd * aec->pfSpeechPow[i] / noise + (1 - dd) * snrPost;
+    gain = snrPrior / (aec->post_filter_overdrive + snrPrior);
+    if (gain < aec->post_filter_bound) {
+      gain = aec->post_filter_bound;
+    }
+
+    efw[0][i] *= gain;
+    efw[1][i] *= gain;
+    aec->pfSpeechPow[i] = gain * gain * power;
+    aec->pfGain[i] = gain;
+  }
+}
+
 static void ComfortNoise(AecCore* aec,
                          float efw[2][PART_LEN1],
                          complex_t* comfortNoiseHband,
@@ -1499,7 +2060,7 @@ static void InitMetrics(AecCore* self) {
   InitStats(&self->rerl);
 }
 
-static void UpdateLevel(PowerLevel* level, float in[2][PART_LEN1]) {
+static float PartitionEnergy(float in[2][PART_LEN1]) {
   // Do the energy calculation in the frequency domain. The FFT is performed on
   // a segment of PART_LEN2 samples due to overlap, but we only want the energy
   // of half that data (the last PART_LEN samples). Parseval's relation states
@@ -1534,6 +2095,12 @@ static void UpdateLevel(PowerLevel* level, float in[2][PART_LEN1]) {
   }
   energy /= PART_LEN2;
 
+  return energy;
+}
+
+static void UpdateLevel(PowerLevel* level, float in[2][PART_LEN1]) {
+  const float energy = WebRtcAec_PartitionEnergy(in);
+
   level->sfrsum += energy;
   level->sfrcounter++;
 
@@ -1558,6 +2125,21 @@ static void UpdateLevel(PowerLevel* level, float in[2][PART_LEN1]) {
   }
 }
 
+// Decides whether the power levels are updated for the current block.  The
+// light mode samples every |kLightMetricsDecimation|th block, for all levels
+// alike, so the level ratios behind ERL, ERLE and A_NLP are unaffected.
+static void UpdateMetricsBlock(AecCore* aec) {
+  if (aec->metricsMode == kMetricsLight) {
+    aec->update_metrics = (aec->metricsBlockCtr == 0);
+    aec->metricsBlockCtr++;
+    if (aec->metricsBlockCtr == kLightMetricsDecimation) {
+      aec->metricsBlockCtr = 0;
+    }
+  } else {
+    aec->update_metrics = (aec->metricsMode == kMetricsFull);
+  }
+}
+
 static void UpdateMetrics(AecCore* aec) {
   float dtmp, dtmp2;
 
@@ -47,6 +47,14 @@ enum {
   kOffsetLevel = -100
 };
 
+// Metrics modes.  The light mode updates the power levels on every
+// |kLightMetricsDecimation|th block only.
+enum {
+  kMetricsOff = 0,
+  kMetricsFull,
+  kMetricsLight
+};
+
 typedef struct Stats {
   float instant;
   float average;
@@ -74,6 +82,18 @@ void WebRtcAec_ProcessFrame(AecCore* aec,
                             int16_t* out,
                             int16_t* outH);
 
+// Processes |num_blocks| partitions of PART_LEN near-end samples directly from
+// |nearend| (and |nearendH| at 32 kHz) into |out| (and |outH|), bypassing the
+// FRAME_LEN regrouping buffers.  Adds no latency, but must not be mixed with
+// WebRtcAec_ProcessFrame() on the same instance.
+void WebRtcAec_ProcessBlocks(AecCore* aec,
+                             const int16_t* nearend,
+                             const int16_t* nearendH,
+                             int num_blocks,
+                             int knownDelay,
+                             int16_t* out,
+                             int16_t* outH);
+
 // A helper function to call WebRtc_MoveReadPtr() for all far-end buffers.
 // Returns the number of elements moved, and adjusts |system_delay| by the
 // corresponding amount in ms.
@@ -86,6 +106,21 @@ int WebRtcAec_GetDelayMetricsCore(AecCore* self, int* median, int* std);
 // Returns the echo state (1: echo, 0: no echo).
 int WebRtcAec_echo_state(AecCore* self);
 
+// Returns the size in bytes of the state written by WebRtcAec_SaveStateCore()
+// with the current sample rate and filter length.
+int WebRtcAec_StateSizeCore(AecCore* self);
+
+// Writes the converged state (filter taps, noise and NLP smoothing, delay
+// agnostic thresholds and the delay histogram) together with the far-end
+// buffer size to |state|, which must hold WebRtcAec_StateSizeCore() bytes.
+void WebRtcAec_SaveStateCore(AecCore* self, void* state);
+
+// Restores a state written by WebRtcAec_SaveStateCore() on an initialized
+// instance.  Returns the far-end buffer size, in partitions, the state was
+// saved with, or -1 if |state| is malformed or was saved with another sample
+// rate or filter length.
+int WebRtcAec_RestoreStateCore(AecCore* self, const void* state, int size);
+
 // Gets statistics of the echo metrics ERL, ERLE, A_NLP.
 void WebRtcAec_GetEchoStats(AecCore* self,
                             Stats* erl,
@@ -110,6 +145,26 @@ void WebRtcAec_enable_delay_correction(AecCore* self, int enable);
 // Returns non-zero if delay correction is enabled and zero if disabled.
 int WebRtcAec_delay_correction_enabled(AecCore* self);
 
+// Enables or disables the delay agnostic mode.  When enabled the far-end read
+// position is moved according to the signal based delay estimate and the
+// |knownDelay| passed to WebRtcAec_ProcessFrame() is ignored.  Non-zero
+// enables, zero disables.
+void WebRtcAec_enable_delay_agnostic(AecCore* self, int enable);
+
+// Returns non-zero if delay agnostic mode is enabled and zero if disabled.
+int WebRtcAec_delay_agnostic_enabled(AecCore* self);
+
+// Sets the level of the noise suppressing post-filter, one of the
+// kAecPostFilter* values.  Zero disables it.
+void WebRtcAec_enable_post_filter(AecCore* self, int level);
+
+// Returns the level of the post-filter, zero if it is disabled.
+int WebRtcAec_post_filter_enabled(AecCore* self);
+
+// Marks the near end as silent, non-zero, or not, zero.  While it is silent
+// only the far-end buffering and power tracking run and the output is zero.
+void WebRtcAec_enable_idle(AecCore* self, int idle);
+
 // Returns the current |system_delay|, i.e., the buffered difference between
 // far-end and near-end.
 int WebRtcAec_system_delay(AecCore* self);
@@ -94,6 +94,7 @@ struct AecCore {
   int mult;  // sampling frequency multiple
   int sampFreq;
   uint32_t seed;
+  uint32_t cn_seed[4];  // Per-lane xorshift state for vectorized comfort noise.
 
   float normal_mu;               // stepsize
   float normal_error_threshold;  // error threshold
@@ -106,6 +107,8 @@ struct AecCore {
   PowerLevel nlpoutlevel;
 
   int metricsMode;
+  int metricsBlockCtr;  // Block counter for decimated light metrics.
+  int update_metrics;   // Levels are updated for the current block.
   int stateCounter;
   Stats erl;
   Stats erle;
@@ -122,6 +125,26 @@ struct AecCore {
   void* delay_estimator_farend;
   void* delay_estimator;
 
+  // Delay agnostic mode: the far-end read position follows the delay
+  // estimator instead of the reported delay.
+  int delay_agnostic_enabled;
+  int frame_count;
+  int previous_delay;
+  int delay_correction_count;
+  int shift_offset;
+  int delay_quality_threshold;  // Q9, see WebRtc_last_delay_quality().
+
+  // Noise suppressing post-filter, 0 = disabled, else a kAecPostFilter* level.
+  int post_filter;
+  float post_filter_overdrive;
+  float post_filter_bound;     // lowest gain
+  float pfSpeechPow[PART_LEN1];  // speech power estimate of the last block
+  float pfGain[PART_LEN1];
+
+  // Non-zero while the caller knows the near end to be silent, see
+  // WebRtcAec_set_nearend_idle().
+  int nearend_idle;
+
   // 1 = extended filter mode enabled, 0 = disabled.
   int extended_filter_enabled;
   // Runtime selection of number of filter partitions.
@@ -150,5 +173,22 @@ typedef void (*WebRtcAec_OverdriveAndSuppress_t)(AecCore* aec,
                                                  const float hNlFb,
                                                  float efw[2][PART_LEN1]);
 extern WebRtcAec_OverdriveAndSuppress_t WebRtcAec_OverdriveAndSuppress;
+typedef void (*WebRtcAec_SubbandCoherence_t)(AecCore* aec,
+                                             float efw[2][PART_LEN1],
+                                             float dfw[2][PART_LEN1],
+                                             float xfw[2][PART_LEN1],
+                                             float* cohde,
+                                             float* cohxd,
+                                             float* sdSum,
+                                             float* seSum);
+extern WebRtcAec_SubbandCoherence_t WebRtcAec_SubbandCoherence;
+typedef void (*WebRtcAec_ComfortNoise_t)(AecCore* aec,
+                                         float efw[2][PART_LEN1],
+                                         complex_t* comfortNoiseHband,
+                                         const float* noisePow,
+                                         const float* lambda);
+extern WebRtcAec_ComfortNoise_t WebRtcAec_ComfortNoise;
+typedef float (*WebRtcAec_PartitionEnergy_t)(float in[2][PART_LEN1]);
+extern WebRtcAec_PartitionEnergy_t WebRtcAec_PartitionEnergy;
 
 #endif  // WEBRTC_MODULES_AUDIO_PROCESSING_AEC_AEC_CORE_INTERNAL_H_
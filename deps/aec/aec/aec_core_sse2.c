@@ -20,6 +20,7 @@
 
 #include "aec_core_internal.h"
 #include "aec_rdft.h"
+#include "signal_processing/include/signal_processing_library.h"
 
 __inline static float MulRe(float aRe, float aIm, float bRe, float bIm) {
   return aRe * bRe - aIm * bIm;
@@ -423,9 +424,310 @@ static void OverdriveAndSuppressSSE2(AecCore* aec,
   }
 }
 
+extern const float WebRtcAec_kExtendedSmoothingCoefficients[2][2];
+extern const float WebRtcAec_kNormalSmoothingCoefficients[2][2];
+
+// Sums the four lanes of |a|.
+static float mm_hsum_ps(__m128 a) {
+  const __m128 b = _mm_add_ps(a, _mm_movehl_ps(a, a));
+  const __m128 c = _mm_add_ss(b, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(c);
+}
+
+static void SubbandCoherenceSSE2(AecCore* aec,
+                                 float efw[2][PART_LEN1],
+                                 float dfw[2][PART_LEN1],
+                                 float xfw[2][PART_LEN1],
+                                 float* cohde,
+                                 float* cohxd,
+                                 float* sdSum,
+                                 float* seSum) {
+  const float* ptrGCoh =
+      aec->extended_filter_enabled
+          ? WebRtcAec_kExtendedSmoothingCoefficients[aec->mult - 1]
+          : WebRtcAec_kNormalSmoothingCoefficients[aec->mult - 1];
+  const __m128 vec_GCoh0 = _mm_set1_ps(ptrGCoh[0]);
+  const __m128 vec_GCoh1 = _mm_set1_ps(ptrGCoh[1]);
+  const __m128 vec_15 = _mm_set1_ps(15.0f);
+  const __m128 vec_1eminus10 = _mm_set1_ps(1e-10f);
+  __m128 vec_sdSum = _mm_setzero_ps();
+  __m128 vec_seSum = _mm_setzero_ps();
+  int i;
+
+  // vectorized code (four at once)
+  for (i = 0; i + 3 < PART_LEN1; i += 4) {
+    const __m128 vec_dfw0 = _mm_loadu_ps(&dfw[0][i]);
+    const __m128 vec_dfw1 = _mm_loadu_ps(&dfw[1][i]);
+    const __m128 vec_efw0 = _mm_loadu_ps(&efw[0][i]);
+    const __m128 vec_efw1 = _mm_loadu_ps(&efw[1][i]);
+    const __m128 vec_xfw0 = _mm_loadu_ps(&xfw[0][i]);
+    const __m128 vec_xfw1 = _mm_loadu_ps(&xfw[1][i]);
+    __m128 vec_sd = _mm_mul_ps(_mm_loadu_ps(&aec->sd[i]), vec_GCoh0);
+    __m128 vec_se = _mm_mul_ps(_mm_loadu_ps(&aec->se[i]), vec_GCoh0);
+    __m128 vec_sx = _mm_mul_ps(_mm_loadu_ps(&aec->sx[i]), vec_GCoh0);
+    __m128 vec_dfw_sumsq = _mm_mul_ps(vec_dfw0, vec_dfw0);
+    __m128 vec_efw_sumsq = _mm_mul_ps(vec_efw0, vec_efw0);
+    __m128 vec_xfw_sumsq = _mm_mul_ps(vec_xfw0, vec_xfw0);
+    vec_dfw_sumsq = _mm_add_ps(vec_dfw_sumsq, _mm_mul_ps(vec_dfw1, vec_dfw1));
+    vec_efw_sumsq = _mm_add_ps(vec_efw_sumsq, _mm_mul_ps(vec_efw1, vec_efw1));
+    vec_xfw_sumsq = _mm_add_ps(vec_xfw_sumsq, _mm_mul_ps(vec_xfw1, vec_xfw1));
+    // Same far-end threshold as in the generic code.
+    vec_xfw_sumsq = _mm_max_ps(vec_xfw_sumsq, vec_15);
+    vec_sd = _mm_add_ps(vec_sd, _mm_mul_ps(vec_dfw_sumsq, vec_GCoh1));
+    vec_se = _mm_add_ps(vec_se, _mm_mul_ps(vec_efw_sumsq, vec_GCoh1));
+    vec_sx = _mm_add_ps(vec_sx, _mm_mul_ps(vec_xfw_sumsq, vec_GCoh1));
+    _mm_storeu_ps(&aec->sd[i], vec_sd);
+    _mm_storeu_ps(&aec->se[i], vec_se);
+    _mm_storeu_ps(&aec->sx[i], vec_sx);
+    vec_sdSum = _mm_add_ps(vec_sdSum, vec_sd);
+    vec_seSum = _mm_add_ps(vec_seSum, vec_se);
+
+    {
+      // |sde| and |sxd| are stored interleaved; split them into real and
+      // imaginary parts, update, and interleave them back.
+      const __m128 vec_sde_3210 = _mm_loadu_ps(&aec->sde[i][0]);
+      const __m128 vec_sde_7654 = _mm_loadu_ps(&aec->sde[i + 2][0]);
+      const __m128 vec_sxd_3210 = _mm_loadu_ps(&aec->sxd[i][0]);
+      const __m128 vec_sxd_7654 = _mm_loadu_ps(&aec->sxd[i + 2][0]);
+      __m128 vec_sde_0 = _mm_shuffle_ps(
+          vec_sde_3210, vec_sde_7654, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 vec_sde_1 = _mm_shuffle_ps(
+          vec_sde_3210, vec_sde_7654, _MM_SHUFFLE(3, 1, 3, 1));
+      __m128 vec_sxd_0 = _mm_shuffle_ps(
+          vec_sxd_3210, vec_sxd_7654, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 vec_sxd_1 = _mm_shuffle_ps(
+          vec_sxd_3210, vec_sxd_7654, _MM_SHUFFLE(3, 1, 3, 1));
+      __m128 vec_dfwefw0011 = _mm_mul_ps(vec_dfw0, vec_efw0);
+      __m128 vec_dfwxfw0011 = _mm_mul_ps(vec_dfw0, vec_xfw0);
+      __m128 vec_dfwefw0110 = _mm_mul_ps(vec_dfw0, vec_efw1);
+      __m128 vec_dfwxfw0110 = _mm_mul_ps(vec_dfw0, vec_xfw1);
+      __m128 vec_a, vec_b;
+      vec_dfwefw0011 =
+          _mm_add_ps(vec_dfwefw0011, _mm_mul_ps(vec_dfw1, vec_efw1));
+      vec_dfwxfw0011 =
+          _mm_add_ps(vec_dfwxfw0011, _mm_mul_ps(vec_dfw1, vec_xfw1));
+      vec_dfwefw0110 =
+          _mm_sub_ps(vec_dfwefw0110, _mm_mul_ps(vec_dfw1, vec_efw0));
+      vec_dfwxfw0110 =
+          _mm_sub_ps(vec_dfwxfw0110, _mm_mul_ps(vec_dfw1, vec_xfw0));
+      vec_sde_0 = _mm_add_ps(_mm_mul_ps(vec_sde_0, vec_GCoh0),
+                             _mm_mul_ps(vec_dfwefw0011, vec_GCoh1));
+      vec_sde_1 = _mm_add_ps(_mm_mul_ps(vec_sde_1, vec_GCoh0),
+                             _mm_mul_ps(vec_dfwefw0110, vec_GCoh1));
+      vec_sxd_0 = _mm_add_ps(_mm_mul_ps(vec_sxd_0, vec_GCoh0),
+                             _mm_mul_ps(vec_dfwxfw0011, vec_GCoh1));
+      vec_sxd_1 = _mm_add_ps(_mm_mul_ps(vec_sxd_1, vec_GCoh0),
+                             _mm_mul_ps(vec_dfwxfw0110, vec_GCoh1));
+      _mm_storeu_ps(&aec->sde[i][0], _mm_unpacklo_ps(vec_sde_0, vec_sde_1));
+      _mm_storeu_ps(&aec->sde[i + 2][0],
+                    _mm_unpackhi_ps(vec_sde_0, vec_sde_1));
+      _mm_storeu_ps(&aec->sxd[i][0], _mm_unpacklo_ps(vec_sxd_0, vec_sxd_1));
+      _mm_storeu_ps(&aec->sxd[i + 2][0],
+                    _mm_unpackhi_ps(vec_sxd_0, vec_sxd_1));
+
+      // Subband coherence
+      vec_a = _mm_add_ps(_mm_mul_ps(vec_sde_0, vec_sde_0),
+                         _mm_mul_ps(vec_sde_1, vec_sde_1));
+      vec_b = _mm_add_ps(_mm_mul_ps(vec_sd, vec_se), vec_1eminus10);
+      _mm_storeu_ps(&cohde[i], _mm_div_ps(vec_a, vec_b));
+      vec_a = _mm_add_ps(_mm_mul_ps(vec_sxd_0, vec_sxd_0),
+                         _mm_mul_ps(vec_sxd_1, vec_sxd_1));
+      vec_b = _mm_add_ps(_mm_mul_ps(vec_sx, vec_sd), vec_1eminus10);
+      _mm_storeu_ps(&cohxd[i], _mm_div_ps(vec_a, vec_b));
+    }
+  }
+  *sdSum = mm_hsum_ps(vec_sdSum);
+  *seSum = mm_hsum_ps(vec_seSum);
+
+  // scalar code for the remaining items.
+  for (; i < PART_LEN1; i++) {
+    aec->sd[i] = ptrGCoh[0] * aec->sd[i] +
+                 ptrGCoh[1] * (dfw[0][i] * dfw[0][i] + dfw[1][i] * dfw[1][i]);
+    aec->se[i] = ptrGCoh[0] * aec->se[i] +
+                 ptrGCoh[1] * (efw[0][i] * efw[0][i] + efw[1][i] * efw[1][i]);
+    aec->sx[i] =
+        ptrGCoh[0] * aec->sx[i] +
+        ptrGCoh[1] *
+            WEBRTC_SPL_MAX(xfw[0][i] * xfw[0][i] + xfw[1][i] * xfw[1][i], 15);
+
+    aec->sde[i][0] =
+        ptrGCoh[0] * aec->sde[i][0] +
+        ptrGCoh[1] * (dfw[0][i] * efw[0][i] + dfw[1][i] * efw[1][i]);
+    aec->sde[i][1] =
+        ptrGCoh[0] * aec->sde[i][1] +
+        ptrGCoh[1] * (dfw[0][i] * efw[1][i] - dfw[1][i] * efw[0][i]);
+
+    aec->sxd[i][0] =
+        ptrGCoh[0] * aec->sxd[i][0] +
+        ptrGCoh[1] * (dfw[0][i] * xfw[0][i] + dfw[1][i] * xfw[1][i]);
+    aec->sxd[i][1] =
+        ptrGCoh[0] * aec->sxd[i][1] +
+        ptrGCoh[1] * (dfw[0][i] * xfw[1][i] - dfw[1][i] * xfw[0][i]);
+
+    *sdSum += aec->sd[i];
+    *seSum += aec->se[i];
+
+    cohde[i] =
+        (aec->sde[i][0] * aec->sde[i][0] + aec->sde[i][1] * aec->sde[i][1]) /
+        (aec->sd[i] * aec->se[i] + 1e-10f);
+    cohxd[i] =
+        (aec->sxd[i][0] * aec->sxd[i][0] + aec->sxd[i][1] * aec->sxd[i][1]) /
+        (aec->sx[i] * aec->sd[i] + 1e-10f);
+  }
+}
+
+// Returns four uniform random numbers in [0, 1) and advances the xorshift32
+// generators held in |state|, one per lane.
+static __m128 mm_rand_ps(__m128i* state) {
+  static const ALIGN16_BEG int one_bits[4] ALIGN16_END = {
+      0x3F800000, 0x3F800000, 0x3F800000, 0x3F800000};
+  __m128i x = *state;
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+  *state = x;
+  // Use the top 23 bits as mantissa of a float in [1, 2) and shift it down.
+  return _mm_sub_ps(
+      _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(x, 9),
+                                    *((__m128i*)one_bits))),
+      *((__m128*)one_bits));
+}
+
+// Computes cos(2 * pi * r) and sin(2 * pi * r) for r in [0, 1).
+static void mm_sincos_2pi_ps(__m128 r, __m128* cos_out, __m128* sin_out) {
+  // Split the angle in quadrants: 2 * pi * r = q * pi / 2 + y, with the
+  // integer q in [0, 4] and y in [-pi / 4, pi / 4]. sin(y) and cos(y) are then
+  // approximated with the minimax polynomials from Cephes, which have a
+  // maximum error well below 1e-6 in that range.
+  static const ALIGN16_BEG int sign_mask[4] ALIGN16_END = {
+      (int)0x80000000, (int)0x80000000, (int)0x80000000, (int)0x80000000};
+  const __m128 x = _mm_mul_ps(r, _mm_set1_ps(4.0f));
+  const __m128i q = _mm_cvtps_epi32(x);
+  const __m128 y =
+      _mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(q)), _mm_set1_ps(1.5707963f));
+  const __m128 y2 = _mm_mul_ps(y, y);
+  __m128 s, c, swap, cos_sign, sin_sign;
+
+  s = _mm_add_ps(_mm_mul_ps(y2, _mm_set1_ps(-1.9515295891e-4f)),
+                 _mm_set1_ps(8.3321608736e-3f));
+  s = _mm_add_ps(_mm_mul_ps(s, y2), _mm_set1_ps(-1.6666654611e-1f));
+  s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, y2), y), y);
+
+  c = _mm_add_ps(_mm_mul_ps(y2, _mm_set1_ps(2.443315711809948e-5f)),
+                 _mm_set1_ps(-1.388731625493765e-3f));
+  c = _mm_add_ps(_mm_mul_ps(c, y2), _mm_set1_ps(4.166664568298827e-2f));
+  c = _mm_mul_ps(_mm_mul_ps(c, y2), y2);
+  c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(y2, _mm_set1_ps(0.5f))),
+                 _mm_set1_ps(1.0f));
+
+  // Odd quadrants swap sine and cosine; quadrants 1 and 2 negate the cosine,
+  // quadrants 2 and 3 negate the sine.
+  swap = _mm_castsi128_ps(_mm_cmpeq_epi32(
+      _mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+  cos_sign = _mm_castsi128_ps(_mm_slli_epi32(
+      _mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)),
+      30));
+  sin_sign = _mm_castsi128_ps(
+      _mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+  cos_sign = _mm_and_ps(cos_sign, *((__m128*)sign_mask));
+  sin_sign = _mm_and_ps(sin_sign, *((__m128*)sign_mask));
+
+  *cos_out = _mm_xor_ps(
+      _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cos_sign);
+  *sin_out = _mm_xor_ps(
+      _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sin_sign);
+}
+
+static void ComfortNoiseSSE2(AecCore* aec,
+                             float efw[2][PART_LEN1],
+                             complex_t* comfortNoiseHband,
+                             const float* noisePow,
+                             const float* lambda) {
+  int i;
+  // Random phase, noise magnitude and NLP weight for bins 1 to PART_LEN.
+  float u_re[PART_LEN], u_im[PART_LEN];
+  float noise[PART_LEN], weight[PART_LEN];
+  const float efw_im_last = efw[1][PART_LEN];
+  const __m128 vec_one = _mm_set1_ps(1.0f);
+  const __m128 vec_zero = _mm_setzero_ps();
+  __m128i vec_seed = _mm_loadu_si128((const __m128i*)aec->cn_seed);
+
+  // Bin 0 is left untouched (LF noise is rejected), hence the offset by one.
+  for (i = 0; i < PART_LEN; i += 4) {
+    __m128 vec_cos, vec_sin;
+    const __m128 vec_noise = _mm_sqrt_ps(_mm_loadu_ps(&noisePow[i + 1]));
+    const __m128 vec_lambda = _mm_loadu_ps(&lambda[i + 1]);
+    // This is the proper weighting to match the background noise power
+    const __m128 vec_weight = _mm_sqrt_ps(_mm_max_ps(
+        _mm_sub_ps(vec_one, _mm_mul_ps(vec_lambda, vec_lambda)), vec_zero));
+    const __m128 vec_gain = _mm_mul_ps(vec_noise, vec_weight);
+    __m128 vec_efw_re = _mm_loadu_ps(&efw[0][i + 1]);
+    __m128 vec_efw_im = _mm_loadu_ps(&efw[1][i + 1]);
+
+    mm_sincos_2pi_ps(mm_rand_ps(&vec_seed), &vec_cos, &vec_sin);
+    vec_efw_re = _mm_add_ps(vec_efw_re, _mm_mul_ps(vec_gain, vec_cos));
+    vec_efw_im = _mm_sub_ps(vec_efw_im, _mm_mul_ps(vec_gain, vec_sin));
+    _mm_storeu_ps(&efw[0][i + 1], vec_efw_re);
+    _mm_storeu_ps(&efw[1][i + 1], vec_efw_im);
+
+    _mm_storeu_ps(&u_re[i], vec_cos);
+    _mm_storeu_ps(&u_im[i], vec_sin);
+    _mm_storeu_ps(&noise[i], vec_noise);
+    _mm_storeu_ps(&weight[i], vec_weight);
+  }
+  _mm_storeu_si128((__m128i*)aec->cn_seed, vec_seed);
+  // The imaginary part of the last bin carries no noise.
+  efw[1][PART_LEN] = efw_im_last;
+
+  // For H band comfort noise, reuse the magnitudes and weights from above
+  // averaged over the second half of the spectrum (i.e., 4->8khz).
+  if (aec->sampFreq == 32000 && aec->flag_Hband_cn == 1) {
+    const int num = PART_LEN1 - (PART_LEN1 >> 1);
+    float noiseAvg = 0;
+    float tmpAvg = 0;
+    float gainAvg;
+    for (i = (PART_LEN1 >> 1) - 1; i < PART_LEN; i++) {
+      noiseAvg += noise[i];
+      tmpAvg += weight[i];
+    }
+    gainAvg = (noiseAvg / num) * (tmpAvg / num);
+
+    comfortNoiseHband[0][0] = 0;
+    comfortNoiseHband[0][1] = 0;
+    for (i = 1; i < PART_LEN1; i++) {
+      comfortNoiseHband[i][0] = gainAvg * u_re[i - 1];
+      comfortNoiseHband[i][1] = -gainAvg * u_im[i - 1];
+    }
+    comfortNoiseHband[PART_LEN][1] = 0;
+  }
+}
+
+static float PartitionEnergySSE2(float in[2][PART_LEN1]) {
+  // See PartitionEnergy() for the scaling.  Bins [0, PART_LEN) are summed in
+  // full and the end points are corrected afterwards.
+  __m128 vec_energy_re = _mm_setzero_ps();
+  __m128 vec_energy_im = _mm_setzero_ps();
+  float energy;
+  int k;
+
+  for (k = 0; k < PART_LEN; k += 4) {
+    const __m128 re = _mm_loadu_ps(&in[0][k]);
+    const __m128 im = _mm_loadu_ps(&in[1][k]);
+    vec_energy_re = _mm_add_ps(vec_energy_re, _mm_mul_ps(re, re));
+    vec_energy_im = _mm_add_ps(vec_energy_im, _mm_mul_ps(im, im));
+  }
+  energy = mm_hsum_ps(_mm_add_ps(vec_energy_re, vec_energy_im));
+  energy -= (in[0][0] * in[0][0]) / 2 + in[1][0] * in[1][0];
+  energy += (in[0][PART_LEN] * in[0][PART_LEN]) / 2;
+  return energy / PART_LEN2;
+}
+
 void WebRtcAec_InitAec_SSE2(void) {
   WebRtcAec_FilterFar = FilterFarSSE2;
   WebRtcAec_ScaleErrorSignal = ScaleErrorSignalSSE2;
   WebRtcAec_FilterAdaptation = FilterAdaptationSSE2;
   WebRtcAec_OverdriveAndSuppress = OverdriveAndSuppressSSE2;
+  WebRtcAec_SubbandCoherence = SubbandCoherenceSSE2;
+  WebRtcAec_ComfortNoise = ComfortNoiseSSE2;
+  WebRtcAec_PartitionEnergy = PartitionEnergySSE2;
 }
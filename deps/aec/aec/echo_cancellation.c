@@ -92,6 +92,8 @@ static const int kMaxTrustedDelayMs = 500;
 #define MAX_RESAMP_LEN (5 * FRAME_LEN)
 
 static const int kMaxBufSizeStart = 62;  // In partitions
+// Largest near-end or far-end chunk of the partition aligned API.
+static const int kMaxPartitionSamples = 4 * PART_LEN;
 static const int sampMsNb = 8;           // samples per ms in nb
 static const int initCheck = 42;
 
@@ -110,7 +112,8 @@ static int ProcessNormal(aecpc_t* self,
                          int16_t* out_high,
                          int16_t num_samples,
                          int16_t reported_delay_ms,
-                         int32_t skew);
+                         int32_t skew,
+                         int partition_aligned);
 static void ProcessExtended(aecpc_t* self,
                             const int16_t* near,
                             const int16_t* near_high,
@@ -118,7 +121,25 @@ static void ProcessExtended(aecpc_t* self,
                             int16_t* out_high,
                             int16_t num_samples,
                             int16_t reported_delay_ms,
-                            int32_t skew);
+                            int32_t skew,
+                            int partition_aligned);
+static void ProcessCore(aecpc_t* self,
+                        const int16_t* near,
+                        const int16_t* near_high,
+                        int16_t* out,
+                        int16_t* out_high,
+                        int num_samples,
+                        int known_delay,
+                        int partition_aligned);
+static int32_t ProcessNearend(aecpc_t* aecpc,
+                              const int16_t* nearend,
+                              const int16_t* nearendH,
+                              int16_t* out,
+                              int16_t* outH,
+                              int16_t nrOfSamples,
+                              int16_t msInSndCardBuf,
+                              int32_t skew,
+                              int partition_aligned);
 
 int32_t WebRtcAec_Create(void** aecInst) {
   aecpc_t* aecpc;
@@ -275,6 +296,8 @@ int32_t WebRtcAec_Init(void* aecInst, int32_t sampFreq, int32_t scSampFreq) {
   aecConfig.skewMode = kAecFalse;
   aecConfig.metricsMode = kAecFalse;
   aecConfig.delay_logging = kAecFalse;
+  aecConfig.delay_agnostic = kAecFalse;
+  aecConfig.post_filter = kAecPostFilterOff;
 
   if (WebRtcAec_set_config(aecpc, aecConfig) == -1) {
     aecpc->lastError = AEC_UNSPECIFIED_ERROR;
@@ -371,6 +394,56 @@ int32_t WebRtcAec_BufferFarend(void* aecInst,
   return retVal;
 }
 
+int32_t WebRtcAec_BufferFarendPartitions(void* aecInst,
+                                         const int16_t* farend,
+                                         int16_t nrOfSamples) {
+  aecpc_t* aecpc = aecInst;
+  // The overlap from the previous call followed by |farend|.
+  float fft_input[PART_LEN + kMaxPartitionSamples];
+  int i = 0;
+
+  if (farend == NULL) {
+    aecpc->lastError = AEC_NULL_POINTER_ERROR;
+    return -1;
+  }
+
+  if (aecpc->initFlag != initCheck) {
+    aecpc->lastError = AEC_UNINITIALIZED_ERROR;
+    return -1;
+  }
+
+  if (aecpc->skewMode == kAecTrue) {
+    aecpc->lastError = AEC_UNSUPPORTED_FUNCTION_ERROR;
+    return -1;
+  }
+
+  if (nrOfSamples <= 0 || nrOfSamples > kMaxPartitionSamples ||
+      nrOfSamples % PART_LEN != 0) {
+    aecpc->lastError = AEC_BAD_PARAMETER_ERROR;
+    return -1;
+  }
+
+  aecpc->farend_started = 1;
+  WebRtcAec_SetSystemDelay(aecpc->aec,
+                           WebRtcAec_system_delay(aecpc->aec) + nrOfSamples);
+
+  // |far_pre_buf| only holds the PART_LEN samples of overlap here, the new
+  // partitions are transformed straight from |fft_input|.
+  WebRtc_ReadBuffer(aecpc->far_pre_buf, NULL, fft_input, PART_LEN);
+  for (i = 0; i < nrOfSamples; i++) {
+    fft_input[PART_LEN + i] = (float)farend[i];
+  }
+  for (i = 0; i < nrOfSamples; i += PART_LEN) {
+    WebRtcAec_BufferFarendPartition(aecpc->aec, &fft_input[i]);
+#ifdef WEBRTC_AEC_DEBUG_DUMP
+    WebRtc_WriteBuffer(WebRtcAec_far_time_buf(aecpc->aec), &farend[i], 1);
+#endif
+  }
+  WebRtc_WriteBuffer(aecpc->far_pre_buf, &fft_input[nrOfSamples], PART_LEN);
+
+  return 0;
+}
+
 int32_t WebRtcAec_Process(void* aecInst,
                           const int16_t* nearend,
                           const int16_t* nearendH,
@@ -379,7 +452,44 @@ int32_t WebRtcAec_Process(void* aecInst,
                           int16_t nrOfSamples,
                           int16_t msInSndCardBuf,
                           int32_t skew) {
-  aecpc_t* aecpc = aecInst;
+  return ProcessNearend(aecInst,
+                        nearend,
+                        nearendH,
+                        out,
+                        outH,
+                        nrOfSamples,
+                        msInSndCardBuf,
+                        skew,
+                        0);
+}
+
+int32_t WebRtcAec_ProcessPartitions(void* aecInst,
+                                    const int16_t* nearend,
+                                    const int16_t* nearendH,
+                                    int16_t* out,
+                                    int16_t* outH,
+                                    int16_t nrOfSamples,
+                                    int16_t msInSndCardBuf) {
+  return ProcessNearend(aecInst,
+                        nearend,
+                        nearendH,
+                        out,
+                        outH,
+                        nrOfSamples,
+                        msInSndCardBuf,
+                        0,
+                        1);
+}
+
+static int32_t ProcessNearend(aecpc_t* aecpc,
+                              const int16_t* nearend,
+                              const int16_t* nearendH,
+                              int16_t* out,
+                              int16_t* outH,
+                              int16_t nrOfSamples,
+                              int16_t msInSndCardBuf,
+                              int32_t skew,
+                              int partition_aligned) {
   int32_t retVal = 0;
   if (nearend == NULL) {
     aecpc->lastError = AEC_NULL_POINTER_ERROR;
@@ -396,8 +506,18 @@ int32_t WebRtcAec_Process(void* aecInst,
     return -1;
   }
 
-  // number of samples == 160 for SWB input
-  if (nrOfSamples != 80 && nrOfSamples != 160) {
+  if (partition_aligned) {
+    if (aecpc->skewMode == kAecTrue) {
+      aecpc->lastError = AEC_UNSUPPORTED_FUNCTION_ERROR;
+      return -1;
+    }
+    if (nrOfSamples <= 0 || nrOfSamples > kMaxPartitionSamples ||
+        nrOfSamples % PART_LEN != 0) {
+      aecpc->lastError = AEC_BAD_PARAMETER_ERROR;
+      return -1;
+    }
+  } else if (nrOfSamples != 80 && nrOfSamples != 160) {
+    // number of samples == 160 for SWB input
     aecpc->lastError = AEC_BAD_PARAMETER_ERROR;
     return -1;
   }
@@ -420,8 +540,15 @@ int32_t WebRtcAec_Process(void* aecInst,
 
   // This returns the value of aec->extended_filter_enabled.
   if (WebRtcAec_delay_correction_enabled(aecpc->aec)) {
-    ProcessExtended(
-        aecpc, nearend, nearendH, out, outH, nrOfSamples, msInSndCardBuf, skew);
+    ProcessExtended(aecpc,
+                    nearend,
+                    nearendH,
+                    out,
+                    outH,
+                    nrOfSamples,
+                    msInSndCardBuf,
+                    skew,
+                    partition_aligned);
   } else {
     if (ProcessNormal(aecpc,
                       nearend,
@@ -430,7 +557,8 @@ int32_t WebRtcAec_Process(void* aecInst,
                       outH,
                       nrOfSamples,
                       msInSndCardBuf,
-                      skew) != 0) {
+                      skew,
+                      partition_aligned) != 0) {
       retVal = -1;
     }
   }
@@ -468,7 +596,8 @@ int WebRtcAec_set_config(void* handle, AecConfig config) {
     return -1;
   }
 
-  if (config.metricsMode != kAecFalse && config.metricsMode != kAecTrue) {
+  if (config.metricsMode != kAecFalse && config.metricsMode != kAecTrue &&
+      config.metricsMode != kAecMetricsLight) {
     self->lastError = AEC_BAD_PARAMETER_ERROR;
     return -1;
   }
@@ -478,8 +607,22 @@ int WebRtcAec_set_config(void* handle, AecConfig config) {
     return -1;
   }
 
+  if (config.delay_agnostic != kAecFalse &&
+      config.delay_agnostic != kAecTrue) {
+    self->lastError = AEC_BAD_PARAMETER_ERROR;
+    return -1;
+  }
+
+  if (config.post_filter < kAecPostFilterOff ||
+      config.post_filter > kAecPostFilterAggressive) {
+    self->lastError = AEC_BAD_PARAMETER_ERROR;
+    return -1;
+  }
+
   WebRtcAec_SetConfigCore(
       self->aec, config.nlpMode, config.metricsMode, config.delay_logging);
+  WebRtcAec_enable_delay_agnostic(self->aec, config.delay_agnostic);
+  WebRtcAec_enable_post_filter(self->aec, config.post_filter);
   return 0;
 }
 
@@ -499,6 +642,18 @@ int WebRtcAec_get_echo_status(void* handle, int* status) {
   return 0;
 }
 
+int WebRtcAec_set_nearend_idle(void* handle, int idle) {
+  aecpc_t* self = (aecpc_t*)handle;
+  if (self->initFlag != initCheck) {
+    self->lastError = AEC_UNINITIALIZED_ERROR;
+    return -1;
+  }
+
+  WebRtcAec_enable_idle(self->aec, idle != 0);
+
+  return 0;
+}
+
 int WebRtcAec_GetMetrics(void* handle, AecMetrics* metrics) {
   const float kUpWeight = 0.7f;
   float dtmp;
@@ -619,6 +774,64 @@ int WebRtcAec_GetDelayMetrics(void* handle, int* median, int* std) {
   return 0;
 }
 
+int WebRtcAec_GetStateSize(void* handle) {
+  aecpc_t* self = handle;
+  if (self->initFlag != initCheck) {
+    self->lastError = AEC_UNINITIALIZED_ERROR;
+    return -1;
+  }
+  return WebRtcAec_StateSizeCore(self->aec);
+}
+
+int WebRtcAec_SaveState(void* handle, void* state, int size) {
+  aecpc_t* self = handle;
+  int state_size = 0;
+  if (state == NULL) {
+    self->lastError = AEC_NULL_POINTER_ERROR;
+    return -1;
+  }
+  if (self->initFlag != initCheck) {
+    self->lastError = AEC_UNINITIALIZED_ERROR;
+    return -1;
+  }
+  state_size = WebRtcAec_StateSizeCore(self->aec);
+  if (size < state_size) {
+    self->lastError = AEC_BAD_PARAMETER_ERROR;
+    return -1;
+  }
+  WebRtcAec_SaveStateCore(self->aec, state);
+  return state_size;
+}
+
+int WebRtcAec_RestoreState(void* handle, const void* state, int size) {
+  aecpc_t* self = handle;
+  int buffer_partitions = 0;
+  if (state == NULL) {
+    self->lastError = AEC_NULL_POINTER_ERROR;
+    return -1;
+  }
+  if (self->initFlag != initCheck) {
+    self->lastError = AEC_UNINITIALIZED_ERROR;
+    return -1;
+  }
+  if (!self->startup_phase) {
+    // The far-end buffer size is only applied when the AEC starts.
+    self->lastError = AEC_UNSUPPORTED_FUNCTION_ERROR;
+    return -1;
+  }
+  buffer_partitions = WebRtcAec_RestoreStateCore(self->aec, state, size);
+  if (buffer_partitions == -1) {
+    self->lastError = AEC_BAD_PARAMETER_ERROR;
+    return -1;
+  }
+
+  // Skip the wait for a stable reported delay and start with the far-end
+  // buffer size of the saved call.
+  self->bufSizeStart = WEBRTC_SPL_MIN(buffer_partitions, kMaxBufSizeStart);
+  self->checkBuffSize = 0;
+  return 0;
+}
+
 int32_t WebRtcAec_get_error_code(void* aecInst) {
   aecpc_t* aecpc = aecInst;
   return aecpc->lastError;
@@ -638,11 +851,10 @@ static int ProcessNormal(aecpc_t* aecpc,
                          int16_t* outH,
                          int16_t nrOfSamples,
                          int16_t msInSndCardBuf,
-                         int32_t skew) {
+                         int32_t skew,
+                         int partition_aligned) {
   int retVal = 0;
-  short i;
   short nBlocks10ms;
-  short nFrames;
   // Limit resampling to doubling/halving of signal
   const float minSkewEst = -0.5f;
   const float maxSkewEst = 1.0f;
@@ -683,8 +895,25 @@ static int ProcessNormal(aecpc_t* aecpc,
     }
   }
 
-  nFrames = nrOfSamples / FRAME_LEN;
-  nBlocks10ms = nFrames / aecpc->rate_factor;
+  // Partition aligned chunks need not be a multiple of 10 ms, round them and
+  // count at least one block.
+  nBlocks10ms = (nrOfSamples + FRAME_LEN * aecpc->rate_factor / 2) /
+                (FRAME_LEN * aecpc->rate_factor);
+  nBlocks10ms = WEBRTC_SPL_MAX(nBlocks10ms, 1);
+
+  if (aecpc->startup_phase && aecpc->farend_started &&
+      WebRtcAec_delay_agnostic_enabled(aecpc->aec)) {
+    // In delay agnostic mode there is no reported delay to wait for.  Start
+    // |bufSizeStart| partitions behind the most recent far-end data, which is
+    // zero unless a saved state has been restored, and let the signal based
+    // delay correction pull the read position to the echo path.
+    int overhead_elements =
+        WebRtcAec_system_delay(aecpc->aec) / PART_LEN - aecpc->bufSizeStart;
+    if (overhead_elements >= 0) {
+      WebRtcAec_MoveFarReadPtr(aecpc->aec, overhead_elements);
+      aecpc->startup_phase = 0;
+    }
+  }
 
   if (aecpc->startup_phase) {
     // Only needed if they don't already point to the same place.
@@ -698,8 +927,10 @@ static int ProcessNormal(aecpc_t* aecpc,
     // The AEC is in the start up mode
     // AEC is disabled until the system delay is OK
 
-    // Mechanism to ensure that the system delay is reasonably stable.
-    if (aecpc->checkBuffSize) {
+    // Mechanism to ensure that the system delay is reasonably stable.  The
+    // reported delay is not used in delay agnostic mode.
+    if (aecpc->checkBuffSize &&
+        !WebRtcAec_delay_agnostic_enabled(aecpc->aec)) {
       aecpc->checkBufSizeCtr++;
       // Before we fill up the far-end buffer we require the system delay
       // to be stable (+/-8 ms) compared to the first value. This
@@ -766,21 +997,21 @@ static int ProcessNormal(aecpc_t* aecpc,
     }
   } else {
     // AEC is enabled.
-    EstBufDelayNormal(aecpc);
-
-    // Note that 1 frame is supported for NB and 2 frames for WB.
-    for (i = 0; i < nFrames; i++) {
-      // Call the AEC.
-      WebRtcAec_ProcessFrame(aecpc->aec,
-                             &nearend[FRAME_LEN * i],
-                             &nearendH[FRAME_LEN * i],
-                             aecpc->knownDelay,
-                             &out[FRAME_LEN * i],
-                             &outH[FRAME_LEN * i]);
-      // TODO(bjornv): Re-structure such that we don't have to pass
-      // |aecpc->knownDelay| as input. Change name to something like
-      // |system_buffer_diff|.
+    if (!WebRtcAec_delay_agnostic_enabled(aecpc->aec)) {
+      EstBufDelayNormal(aecpc);
     }
+
+    // TODO(bjornv): Re-structure such that we don't have to pass
+    // |aecpc->knownDelay| as input. Change name to something like
+    // |system_buffer_diff|.
+    ProcessCore(aecpc,
+                nearend,
+                nearendH,
+                out,
+                outH,
+                nrOfSamples,
+                aecpc->knownDelay,
+                partition_aligned);
   }
 
   return retVal;
@@ -793,9 +1024,8 @@ static void ProcessExtended(aecpc_t* self,
                             int16_t* out_high,
                             int16_t num_samples,
                             int16_t reported_delay_ms,
-                            int32_t skew) {
-  int i;
-  const int num_frames = num_samples / FRAME_LEN;
+                            int32_t skew,
+                            int partition_aligned) {
 #if defined(WEBRTC_UNTRUSTED_DELAY)
   const int delay_diff_offset = kDelayDiffOffsetSamples;
   reported_delay_ms = kFixedDelayMs;
@@ -833,16 +1063,24 @@ static void ProcessExtended(aecpc_t* self,
     // action on the first frame. In the trusted delay case, we'll take the
     // current reported delay, unless it's less then our conservative
     // measurement.
+    // In delay agnostic mode we start |bufSizeStart| partitions behind the
+    // most recent far-end data, zero unless a saved state has been restored.
     int startup_size_ms =
         reported_delay_ms < kFixedDelayMs ? kFixedDelayMs : reported_delay_ms;
     int overhead_elements = (WebRtcAec_system_delay(self->aec) -
                              startup_size_ms / 2 * self->rate_factor * 8) /
                             PART_LEN;
+    if (WebRtcAec_delay_agnostic_enabled(self->aec)) {
+      overhead_elements =
+          WebRtcAec_system_delay(self->aec) / PART_LEN - self->bufSizeStart;
+    }
     WebRtcAec_MoveFarReadPtr(self->aec, overhead_elements);
     self->startup_phase = 0;
   }
 
-  EstBufDelayExtended(self);
+  if (!WebRtcAec_delay_agnostic_enabled(self->aec)) {
+    EstBufDelayExtended(self);
+  }
 
   {
     // |delay_diff_offset| gives us the option to manually rewind the delay on
@@ -851,14 +1089,46 @@ static void ProcessExtended(aecpc_t* self,
     const int adjusted_known_delay =
         WEBRTC_SPL_MAX(0, self->knownDelay + delay_diff_offset);
 
-    for (i = 0; i < num_frames; ++i) {
-      WebRtcAec_ProcessFrame(self->aec,
-                             &near[FRAME_LEN * i],
-                             &near_high[FRAME_LEN * i],
-                             adjusted_known_delay,
-                             &out[FRAME_LEN * i],
-                             &out_high[FRAME_LEN * i]);
-    }
+    ProcessCore(self,
+                near,
+                near_high,
+                out,
+                out_high,
+                num_samples,
+                adjusted_known_delay,
+                partition_aligned);
+  }
+}
+
+static void ProcessCore(aecpc_t* self,
+                        const int16_t* near,
+                        const int16_t* near_high,
+                        int16_t* out,
+                        int16_t* out_high,
+                        int num_samples,
+                        int known_delay,
+                        int partition_aligned) {
+  int i;
+
+  if (partition_aligned) {
+    WebRtcAec_ProcessBlocks(self->aec,
+                            near,
+                            near_high,
+                            num_samples / PART_LEN,
+                            known_delay,
+                            out,
+                            out_high);
+    return;
+  }
+
+  // Note that 1 frame is supported for NB and 2 frames for WB.
+  for (i = 0; i < num_samples / FRAME_LEN; i++) {
+    WebRtcAec_ProcessFrame(self->aec,
+                           &near[FRAME_LEN * i],
+                           &near_high[FRAME_LEN * i],
+                           known_delay,
+                           &out[FRAME_LEN * i],
+                           &out_high[FRAME_LEN * i]);
   }
 }
 
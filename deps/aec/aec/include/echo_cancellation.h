@@ -34,11 +34,30 @@ enum {
   kAecTrue
 };
 
+// AecConfig.metricsMode may also be set to kAecMetricsLight, which gathers the
+// same metrics from a decimated set of blocks at a fraction of the cost.
+enum {
+  kAecMetricsLight = 2
+};
+
+// AecConfig.post_filter runs a noise suppressor on the error spectrum inside
+// the AEC, with the AEC's own near-end noise estimate, so that no separate NS
+// stage is needed after it. The levels use the gain limits of NS policies 0, 1
+// and 2.
+enum {
+  kAecPostFilterOff = 0,
+  kAecPostFilterMild,
+  kAecPostFilterMedium,
+  kAecPostFilterAggressive
+};
+
 typedef struct {
   int16_t nlpMode;      // default kAecNlpModerate
   int16_t skewMode;     // default kAecFalse
-  int16_t metricsMode;  // default kAecFalse
+  int16_t metricsMode;  // default kAecFalse, see kAecMetricsLight
   int delay_logging;    // default kAecFalse
+  int delay_agnostic;   // default kAecFalse
+  int post_filter;      // default kAecPostFilterOff
   // float realSkew;
 } AecConfig;
 
@@ -162,6 +181,63 @@ int32_t WebRtcAec_Process(void* aecInst,
                           int16_t msInSndCardBuf,
                           int32_t skew);
 
+/*
+ * Inserts a multiple of 64 samples (up to 256) into the farend buffer.  Unlike
+ * WebRtcAec_BufferFarend() the partitions are transformed directly from
+ * |farend| without passing through the intermediate frame buffer.  Not
+ * available in skew mode.
+ *
+ * Inputs                       Description
+ * -------------------------------------------------------------------
+ * void*         aecInst        Pointer to the AEC instance
+ * int16_t*      farend         In buffer containing one chunk of
+ *                              farend signal for L band
+ * int16_t       nrOfSamples    Number of samples in farend buffer
+ *
+ * Outputs                      Description
+ * -------------------------------------------------------------------
+ * int32_t       return          0: OK
+ *                              -1: error
+ */
+int32_t WebRtcAec_BufferFarendPartitions(void* aecInst,
+                                         const int16_t* farend,
+                                         int16_t nrOfSamples);
+
+/*
+ * Runs the echo canceller on a multiple of 64 samples (up to 256).  The
+ * partitions are processed directly from |nearend| into |out|, so unlike
+ * WebRtcAec_Process() no latency is added for regrouping 10 ms frames into
+ * partitions.  Must not be mixed with WebRtcAec_Process() on the same
+ * instance, and is not available in skew mode.
+ *
+ * Inputs                       Description
+ * -------------------------------------------------------------------
+ * void*         aecInst        Pointer to the AEC instance
+ * int16_t*      nearend        In buffer containing one chunk of
+ *                              nearend+echo signal for L band
+ * int16_t*      nearendH       In buffer containing one chunk of
+ *                              nearend+echo signal for H band
+ * int16_t       nrOfSamples    Number of samples in nearend buffer
+ * int16_t       msInSndCardBuf Delay estimate for sound card and
+ *                              system buffers
+ *
+ * Outputs                      Description
+ * -------------------------------------------------------------------
+ * int16_t*      out            Out buffer, one chunk of processed nearend
+ *                              for L band
+ * int16_t*      outH           Out buffer, one chunk of processed nearend
+ *                              for H band
+ * int32_t       return          0: OK
+ *                              -1: error
+ */
+int32_t WebRtcAec_ProcessPartitions(void* aecInst,
+                                    const int16_t* nearend,
+                                    const int16_t* nearendH,
+                                    int16_t* out,
+                                    int16_t* outH,
+                                    int16_t nrOfSamples,
+                                    int16_t msInSndCardBuf);
+
 /*
  * This function enables the user to set certain parameters on-the-fly.
  *
@@ -194,6 +270,24 @@ int WebRtcAec_set_config(void* handle, AecConfig config);
  */
 int WebRtcAec_get_echo_status(void* handle, int* status);
 
+/*
+ * Tells the AEC that the nearend is silent, e.g. below the noise floor of a
+ * muted microphone. While it is set the far end is still buffered and tracked,
+ * so that the AEC is ready when the nearend comes back, but no echo is
+ * estimated or suppressed and the output is zero.
+ *
+ * Inputs                       Description
+ * -------------------------------------------------------------------
+ * void           *handle       Pointer to the AEC instance
+ * int            idle          1: nearend is silent, 0: it is not
+ *
+ * Outputs                      Description
+ * -------------------------------------------------------------------
+ * int            return         0: OK
+ *                              -1: error
+ */
+int WebRtcAec_set_nearend_idle(void* handle, int idle);
+
 /*
  * Gets the current echo metrics for the session.
  *
@@ -227,6 +321,59 @@ int WebRtcAec_GetMetrics(void* handle, AecMetrics* metrics);
  */
 int WebRtcAec_GetDelayMetrics(void* handle, int* median, int* std);
 
+/*
+ * Gets the size of the state saved by WebRtcAec_SaveState() for the current
+ * sample rate and filter length.
+ *
+ * Inputs                       Description
+ * -------------------------------------------------------------------
+ * void*      handle            Pointer to the AEC instance
+ *
+ * Outputs                      Description
+ * -------------------------------------------------------------------
+ * int        return            State size in bytes
+ *                              -1: error
+ */
+int WebRtcAec_GetStateSize(void* handle);
+
+/*
+ * Saves the converged state of the AEC, i.e., the adaptive filter, the noise
+ * and NLP smoothing, the delay histogram and the far-end buffer size, so that
+ * a later call in the same acoustic setup can start from it.  The state is in
+ * native byte order.
+ *
+ * Inputs                       Description
+ * -------------------------------------------------------------------
+ * void*      handle            Pointer to the AEC instance
+ * int        size              Size of |state| in bytes
+ *
+ * Outputs                      Description
+ * -------------------------------------------------------------------
+ * void*      state             The saved state
+ * int        return            Number of bytes written
+ *                              -1: error
+ */
+int WebRtcAec_SaveState(void* handle, void* state, int size);
+
+/*
+ * Restores a state saved by WebRtcAec_SaveState().  Must be called after
+ * WebRtcAec_Init() and WebRtcAec_set_config() and before the first call to
+ * WebRtcAec_Process().  The sample rate and extended filter mode must match
+ * the saved instance.
+ *
+ * Inputs                       Description
+ * -------------------------------------------------------------------
+ * void*      handle            Pointer to the AEC instance
+ * const void* state            The saved state
+ * int        size              Size of |state| in bytes
+ *
+ * Outputs                      Description
+ * -------------------------------------------------------------------
+ * int        return             0: OK
+ *                              -1: error
+ */
+int WebRtcAec_RestoreState(void* handle, const void* state, int size);
+
 /*
  * Gets the last error code.
  *
@@ -113,10 +113,10 @@ static const int32_t kTargetLevelTable[64] = {134209536, 106606424, 84680493, 67
 int WebRtcAgc_AddMic(void *state, int16_t *in_mic, int16_t *in_mic_H,
                      int16_t samples)
 {
-    int32_t nrg, max_nrg, sample, tmp32;
+    int32_t tmp32;
     int32_t *ptr;
     uint16_t targetGainIdx, gain;
-    int16_t i, n, L, M, subFrames, tmp16, tmp_speech[16];
+    int16_t i, L, M, subFrames, tmp16, tmp_speech[16];
     Agc_t *stt;
     stt = (Agc_t *)state;
 
@@ -225,38 +225,10 @@ int WebRtcAgc_AddMic(void *state, int16_t *in_mic, int16_t *in_mic_H,
         /* Q12 */
         gain = kGainTableAnalog[stt->gainTableIdx];
 
-        for (i = 0; i < samples; i++)
+        WebRtcAgc_ScaleSaturate(in_mic, samples, gain);
+        if (stt->fs == 32000)
         {
-            // For lower band
-            tmp32 = WEBRTC_SPL_MUL_16_U16(in_mic[i], gain);
-            sample = WEBRTC_SPL_RSHIFT_W32(tmp32, 12);
-            if (sample > 32767)
-            {
-                in_mic[i] = 32767;
-            } else if (sample < -32768)
-            {
-                in_mic[i] = -32768;
-            } else
-            {
-                in_mic[i] = (int16_t)sample;
-            }
-
-            // For higher band
-            if (stt->fs == 32000)
-            {
-                tmp32 = WEBRTC_SPL_MUL_16_U16(in_mic_H[i], gain);
-                sample = WEBRTC_SPL_RSHIFT_W32(tmp32, 12);
-                if (sample > 32767)
-                {
-                    in_mic_H[i] = 32767;
-                } else if (sample < -32768)
-                {
-                    in_mic_H[i] = -32768;
-                } else
-                {
-                    in_mic_H[i] = (int16_t)sample;
-                }
-            }
+            WebRtcAgc_ScaleSaturate(in_mic_H, samples, gain);
         }
     } else
     {
@@ -272,20 +244,7 @@ int WebRtcAgc_AddMic(void *state, int16_t *in_mic, int16_t *in_mic_H,
         ptr = stt->env[0];
     }
 
-    for (i = 0; i < M; i++)
-    {
-        /* iterate over samples */
-        max_nrg = 0;
-        for (n = 0; n < L; n++)
-        {
-            nrg = WEBRTC_SPL_MUL_16_16(in_mic[i * L + n], in_mic[i * L + n]);
-            if (nrg > max_nrg)
-            {
-                max_nrg = nrg;
-            }
-        }
-        ptr[i] = max_nrg;
-    }
+    WebRtcAgc_Envelope(in_mic, L, M, ptr);
 
     /* compute energy */
     if ((M == 10) && (stt->inQueue > 0))
@@ -296,17 +255,18 @@ int WebRtcAgc_AddMic(void *state, int16_t *in_mic, int16_t *in_mic_H,
         ptr = stt->Rxx16w32_array[0];
     }
 
-    for (i = 0; i < WEBRTC_SPL_RSHIFT_W16(M, 1); i++)
+    if (stt->fs == 16000)
     {
-        if (stt->fs == 16000)
+        for (i = 0; i < WEBRTC_SPL_RSHIFT_W16(M, 1); i++)
         {
             WebRtcSpl_DownsampleBy2(&in_mic[i * 32], 32, tmp_speech, stt->filterState);
-        } else
-        {
-            memcpy(tmp_speech, &in_mic[i * 16], 16 * sizeof(short));
+            /* Compute energy in blocks of 16 samples */
+            WebRtcAgc_BlockEnergy(tmp_speech, 1, &ptr[i]);
         }
+    } else
+    {
         /* Compute energy in blocks of 16 samples */
-        ptr[i] = WebRtcSpl_DotProductWithScale(tmp_speech, tmp_speech, 16, 4);
+        WebRtcAgc_BlockEnergy(in_mic, WEBRTC_SPL_RSHIFT_W16(M, 1), ptr);
     }
 
     /* update queue information */
@@ -587,6 +547,25 @@ void WebRtcAgc_UpdateAgcThresholds(Agc_t *stt)
     stt->lowerLimit = stt->startLowerLimit;
 }
 
+/* Swaps the gain table for the shared one of the current settings, computed
+ * only if no other instance holds it, see WebRtcAgc_AcquireGainTable().
+ */
+int WebRtcAgc_UpdateGainTable(Agc_t *stt)
+{
+    const int32_t *table = WebRtcAgc_AcquireGainTable(stt->compressionGaindB,
+                                                      stt->targetLevelDbfs,
+                                                      stt->limiterEnable,
+                                                      stt->analogTarget);
+    if (table == NULL)
+    {
+        return -1;
+    }
+    WebRtcAgc_ReleaseGainTable(stt->digitalAgc.gainTable);
+    stt->digitalAgc.gainTable = table;
+
+    return 0;
+}
+
 void WebRtcAgc_SaturationCtrl(Agc_t *stt, uint8_t *saturated, int32_t *env)
 {
     int16_t i, tmpW16;
@@ -1201,9 +1180,7 @@ int32_t WebRtcAgc_ProcessAnalog(void *state, int32_t inMicLevel,
                 stt->micLvlSat = 1;
                 fprintf(stderr, "target before = %d (%d)\n", stt->analogTargetLevel, stt->targetIdx);
                 WebRtcAgc_UpdateAgcThresholds(stt);
-                WebRtcAgc_CalculateGainTable(&(stt->digitalAgc.gainTable[0]),
-                        stt->compressionGaindB, stt->targetLevelDbfs, stt->limiterEnable,
-                        stt->analogTarget);
+                WebRtcAgc_UpdateGainTable(stt);
                 stt->numBlocksMicLvlSat = 0;
                 stt->micLvlSat = 0;
                 fprintf(stderr, "target offset = %d\n", stt->targetIdxOffset);
@@ -1433,8 +1410,7 @@ int WebRtcAgc_set_config(void *agcInst, WebRtcAgc_config_t agcConfig)
     WebRtcAgc_UpdateAgcThresholds(stt);
 
     /* Recalculate gain table */
-    if (WebRtcAgc_CalculateGainTable(&(stt->digitalAgc.gainTable[0]), stt->compressionGaindB,
-                           stt->targetLevelDbfs, stt->limiterEnable, stt->analogTarget) == -1)
+    if (WebRtcAgc_UpdateGainTable(stt) == -1)
     {
 #ifdef AGC_DEBUG//test log
         fprintf(stt->fpt, "AGC->set_config, frame %d: Error from calcGainTable\n\n", stt->fcount);
@@ -1478,6 +1454,35 @@ int WebRtcAgc_get_config(void *agcInst, WebRtcAgc_config_t *config)
     return 0;
 }
 
+int WebRtcAgc_get_vad(void *agcInst, int16_t *logRatio, int16_t *active)
+{
+    Agc_t *stt;
+    stt = (Agc_t *)agcInst;
+
+    if (stt == NULL)
+    {
+        return -1;
+    }
+
+    if (logRatio == NULL || active == NULL)
+    {
+        stt->lastError = AGC_NULL_POINTER_ERROR;
+        return -1;
+    }
+
+    if (stt->initFlag != kInitCheck)
+    {
+        stt->lastError = AGC_UNINITIALIZED_ERROR;
+        return -1;
+    }
+
+    /* Same decision as in WebRtcAgc_ProcessAnalog() */
+    *logRatio = stt->vadMic.logRatio;
+    *active = stt->vadMic.logRatio > stt->vadThreshold;
+
+    return 0;
+}
+
 int WebRtcAgc_Create(void **agcInst)
 {
     Agc_t *stt;
@@ -1501,6 +1506,7 @@ int WebRtcAgc_Create(void **agcInst)
 
     stt->initFlag = 0;
     stt->lastError = 0;
+    stt->digitalAgc.gainTable = NULL;
 
     return 0;
 }
@@ -1515,6 +1521,7 @@ int WebRtcAgc_Free(void *state)
     fclose(stt->agcLog);
     fclose(stt->digitalAgc.logFile);
 #endif
+    WebRtcAgc_ReleaseGainTable(stt->digitalAgc.gainTable);
     free(stt);
 
     return 0;
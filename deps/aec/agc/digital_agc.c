@@ -21,6 +21,7 @@
 #endif
 
 #include "agc/include/gain_control.h"
+#include "webrtc/cpu_features_wrapper.h"
 
 // To generate the gaintable, copy&paste the following lines to a Matlab window:
 // MaxGain = 6; MinGain = 0; CompRatio = 3; Knee = 1;
@@ -258,6 +259,88 @@ int32_t WebRtcAgc_CalculateGainTable(int32_t *gainTable, // Q16
     return 0;
 }
 
+static void EnvelopeC(const int16_t *in, int16_t len, int16_t subframes,
+                      int32_t *env)
+{
+    int32_t nrg, max_nrg;
+    int16_t k, n;
+
+    // iterate over sub frames
+    for (k = 0; k < subframes; k++)
+    {
+        // iterate over samples
+        max_nrg = 0;
+        for (n = 0; n < len; n++)
+        {
+            nrg = WEBRTC_SPL_MUL_16_16(in[k * len + n], in[k * len + n]);
+            if (nrg > max_nrg)
+            {
+                max_nrg = nrg;
+            }
+        }
+        env[k] = max_nrg;
+    }
+}
+
+static void BlockEnergyC(const int16_t *in, int16_t blocks, int32_t *nrg)
+{
+    int16_t k;
+
+    for (k = 0; k < blocks; k++)
+    {
+        nrg[k] = WebRtcSpl_DotProductWithScale(&in[k * 16], &in[k * 16], 16, 4);
+    }
+}
+
+static void ScaleSaturateC(int16_t *io, int16_t len, uint16_t gain)
+{
+    int32_t sample, tmp32;
+    int16_t n;
+
+    for (n = 0; n < len; n++)
+    {
+        tmp32 = WEBRTC_SPL_MUL_16_U16(io[n], gain);
+        sample = WEBRTC_SPL_RSHIFT_W32(tmp32, 12);
+        if (sample > 32767)
+        {
+            io[n] = 32767;
+        } else if (sample < -32768)
+        {
+            io[n] = -32768;
+        } else
+        {
+            io[n] = (int16_t)sample;
+        }
+    }
+}
+
+static void ApplyGainsC(const int32_t *gains, int16_t L2, int16_t *io)
+{
+    int32_t gain32, delta, tmp32;
+    int16_t k, n;
+    int16_t L = 1 << L2;
+
+    // iterate over subframes
+    for (k = 1; k < 10; k++)
+    {
+        delta = WEBRTC_SPL_LSHIFT_W32(gains[k+1] - gains[k], (4 - L2));
+        gain32 = WEBRTC_SPL_LSHIFT_W32(gains[k], 4);
+        // iterate over samples
+        for (n = 0; n < L; n++)
+        {
+            tmp32 = WEBRTC_SPL_MUL((int32_t)io[k * L + n],
+                                   WEBRTC_SPL_RSHIFT_W32(gain32, 4));
+            io[k * L + n] = (int16_t)WEBRTC_SPL_RSHIFT_W32(tmp32 , 16);
+            gain32 += delta;
+        }
+    }
+}
+
+WebRtcAgc_Envelope_t WebRtcAgc_Envelope;
+WebRtcAgc_BlockEnergy_t WebRtcAgc_BlockEnergy;
+WebRtcAgc_ScaleSaturate_t WebRtcAgc_ScaleSaturate;
+WebRtcAgc_ApplyGains_t WebRtcAgc_ApplyGains;
+
 int32_t WebRtcAgc_InitDigital(DigitalAgc_t *stt, int16_t agcMode)
 {
 
@@ -282,6 +365,23 @@ int32_t WebRtcAgc_InitDigital(DigitalAgc_t *stt, int16_t agcMode)
     WebRtcAgc_InitVad(&stt->vadNearend);
     WebRtcAgc_InitVad(&stt->vadFarend);
 
+    // Initialize function pointers.
+    WebRtcAgc_Envelope = EnvelopeC;
+    WebRtcAgc_BlockEnergy = BlockEnergyC;
+    WebRtcAgc_ScaleSaturate = ScaleSaturateC;
+    WebRtcAgc_ApplyGains = ApplyGainsC;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (WebRtc_GetCPUInfo(kSSE2))
+    {
+        WebRtcAgc_InitSSE2();
+    }
+    if (WebRtc_GetCPUInfo(kAVX2))
+    {
+        WebRtcAgc_InitAVX2();
+    }
+#endif
+
     return 0;
 }
 
@@ -310,7 +410,6 @@ int32_t WebRtcAgc_ProcessDigital(DigitalAgc_t *stt, const int16_t *in_near,
 
     int32_t out_tmp, tmp32;
     int32_t env[10];
-    int32_t nrg, max_nrg;
     int32_t cur_level;
     int32_t gain32, delta;
     int16_t logratio;
@@ -407,21 +506,7 @@ int32_t WebRtcAgc_ProcessDigital(DigitalAgc_t *stt, const int16_t *in_near,
     fprintf(stt->logFile, "%5.2f\t%d\t%d\t%d\t", (float)(stt->frameCounter) / 100, logratio, decay, stt->vadNearend.stdLongTerm);
 #endif
     // Find max amplitude per sub frame
-    // iterate over sub frames
-    for (k = 0; k < 10; k++)
-    {
-        // iterate over samples
-        max_nrg = 0;
-        for (n = 0; n < L; n++)
-        {
-            nrg = WEBRTC_SPL_MUL_16_16(out[k * L + n], out[k * L + n]);
-            if (nrg > max_nrg)
-            {
-                max_nrg = nrg;
-            }
-        }
-        env[k] = max_nrg;
-    }
+    WebRtcAgc_Envelope(out, L, 10, env);
 
     // Calculate gain per sub frame
     gains[0] = stt->gain;
@@ -608,26 +693,10 @@ int32_t WebRtcAgc_ProcessDigital(DigitalAgc_t *stt, const int16_t *in_near,
         gain32 += delta;
     }
     // iterate over subframes
-    for (k = 1; k < 10; k++)
+    WebRtcAgc_ApplyGains(gains, L2, out);
+    if (FS == 32000)
     {
-        delta = WEBRTC_SPL_LSHIFT_W32(gains[k+1] - gains[k], (4 - L2));
-        gain32 = WEBRTC_SPL_LSHIFT_W32(gains[k], 4);
-        // iterate over samples
-        for (n = 0; n < L; n++)
-        {
-            // For lower band
-            tmp32 = WEBRTC_SPL_MUL((int32_t)out[k * L + n],
-                                   WEBRTC_SPL_RSHIFT_W32(gain32, 4));
-            out[k * L + n] = (int16_t)WEBRTC_SPL_RSHIFT_W32(tmp32 , 16);
-            // For higher band
-            if (FS == 32000)
-            {
-                tmp32 = WEBRTC_SPL_MUL((int32_t)out_H[k * L + n],
-                                       WEBRTC_SPL_RSHIFT_W32(gain32, 4));
-                out_H[k * L + n] = (int16_t)WEBRTC_SPL_RSHIFT_W32(tmp32 , 16);
-            }
-            gain32 += delta;
-        }
+        WebRtcAgc_ApplyGains(gains, L2, out_H);
     }
 
     return 0;
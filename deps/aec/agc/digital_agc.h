@@ -41,7 +41,7 @@ typedef struct
     int32_t capacitorSlow;
     int32_t capacitorFast;
     int32_t gain;
-    int32_t gainTable[32];
+    const int32_t *gainTable; // Q16, see WebRtcAgc_AcquireGainTable()
     int16_t gatePrevious;
     int16_t agcMode;
     AgcVad_t      vadNearend;
@@ -69,10 +69,63 @@ int16_t WebRtcAgc_ProcessVad(AgcVad_t *vadInst, // (i) VAD state
                              const int16_t *in, // (i) Speech signal
                              int16_t nrSamples); // (i) number of samples
 
+// code path selection function pointers, set by WebRtcAgc_InitDigital()
+
+// Largest squared sample of each of |subframes| sub frames of |len| samples,
+// the signal envelope of both the analog and the digital AGC.
+typedef void (*WebRtcAgc_Envelope_t)(const int16_t* in,
+                                     int16_t len,
+                                     int16_t subframes,
+                                     int32_t* env);
+extern WebRtcAgc_Envelope_t WebRtcAgc_Envelope;
+
+// Energy of each of |blocks| blocks of 16 samples, with every square shifted
+// down by 4 as in WebRtcSpl_DotProductWithScale().
+typedef void (*WebRtcAgc_BlockEnergy_t)(const int16_t* in,
+                                        int16_t blocks,
+                                        int32_t* nrg);
+extern WebRtcAgc_BlockEnergy_t WebRtcAgc_BlockEnergy;
+
+// Multiplies |len| samples in place by |gain| in Q12, saturating to 16 bits.
+typedef void (*WebRtcAgc_ScaleSaturate_t)(int16_t* io,
+                                          int16_t len,
+                                          uint16_t gain);
+extern WebRtcAgc_ScaleSaturate_t WebRtcAgc_ScaleSaturate;
+
+// Multiplies sub frames 1 to 9 of |io|, each of 1 << |L2| samples, in place
+// by a gain that goes linearly from gains[k] to gains[k + 1] over sub frame k.
+// Sub frame 0 also needs saturation and is left to the caller.
+typedef void (*WebRtcAgc_ApplyGains_t)(const int32_t* gains,
+                                       int16_t L2,
+                                       int16_t* io);
+extern WebRtcAgc_ApplyGains_t WebRtcAgc_ApplyGains;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Install the SSE2 and AVX2 versions of the above function pointers, defined
+// in digital_agc_sse2.c and digital_agc_avx2.c.  Only called after a runtime
+// CPU check.
+void WebRtcAgc_InitSSE2(void);
+void WebRtcAgc_InitAVX2(void);
+#endif
+
 int32_t WebRtcAgc_CalculateGainTable(int32_t *gainTable, // Q16
                                      int16_t compressionGaindB, // Q0 (in dB)
                                      int16_t targetLevelDbfs,// Q0 (in dB)
                                      uint8_t limiterEnable,
                                      int16_t analogTarget);
 
+// Returns the 32-entry gain table for the arguments of
+// WebRtcAgc_CalculateGainTable(), shared by every caller with the same
+// arguments and computed only when none holds it yet.  The table must not be
+// written to and is given back with WebRtcAgc_ReleaseGainTable().  Returns
+// NULL on failure.  Thread safe, defined in gain_table_cache.c.
+const int32_t *WebRtcAgc_AcquireGainTable(int16_t compressionGaindB,
+                                          int16_t targetLevelDbfs,
+                                          uint8_t limiterEnable,
+                                          int16_t analogTarget);
+
+// Drops one reference to |table|, freeing it with the last one.  NULL is
+// ignored.
+void WebRtcAgc_ReleaseGainTable(const int32_t *table);
+
 #endif // WEBRTC_MODULES_AUDIO_PROCESSING_AGC_MAIN_SOURCE_ANALOG_AGC_H_
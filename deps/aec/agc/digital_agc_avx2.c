@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The AGC envelope, energy and gain kernels, AVX2 versions.  All of them are
+ * bit-exact with the generic C versions in digital_agc.c and follow
+ * digital_agc_sse2.c.  At 8 kHz a sub frame is only eight samples, so each
+ * 128-bit half of a register holds one sub frame there.
+ */
+
+#include "agc/digital_agc.h"
+
+#include <assert.h>
+#include <immintrin.h>
+
+// Largest and smallest of the eight lanes of each 128-bit half, in every lane
+// of that half.
+static __inline __m256i HorizontalMax(__m256i x) {
+  x = _mm256_max_epi16(x, _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm256_max_epi16(x, _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm256_max_epi16(x,
+                          _mm256_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static __inline __m256i HorizontalMin(__m256i x) {
+  x = _mm256_min_epi16(x, _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm256_min_epi16(x, _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm256_min_epi16(x,
+                          _mm256_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static __inline int32_t Square(int16_t x) {
+  return WEBRTC_SPL_MUL_16_16(x, x);
+}
+
+// Largest square of the sub frame in each half of |max| and |min|, into
+// env[0] and env[1].  Only env[0] is written when |pair| is zero.
+static __inline void StoreEnvelope(__m256i max,
+                                   __m256i min,
+                                   int pair,
+                                   int32_t* env) {
+  const __m256i hi = HorizontalMax(max);
+  const __m256i lo = HorizontalMin(min);
+  const int32_t hi0 = Square((int16_t)_mm256_extract_epi16(hi, 0));
+  const int32_t lo0 = Square((int16_t)_mm256_extract_epi16(lo, 0));
+
+  env[0] = hi0 > lo0 ? hi0 : lo0;
+  if (pair) {
+    const int32_t hi1 = Square((int16_t)_mm256_extract_epi16(hi, 8));
+    const int32_t lo1 = Square((int16_t)_mm256_extract_epi16(lo, 8));
+    env[1] = hi1 > lo1 ? hi1 : lo1;
+  }
+}
+
+// See EnvelopeSSE2().
+static void EnvelopeAVX2(const int16_t* in,
+                         int16_t len,
+                         int16_t subframes,
+                         int32_t* env) {
+  int k, n;
+
+  assert(len % 8 == 0);
+  if (len == 8) {
+    for (k = 0; k + 2 <= subframes; k += 2) {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)&in[k * 8]);
+      StoreEnvelope(x, x, 1, &env[k]);
+    }
+    if (k < subframes) {
+      const __m256i x = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128((const __m128i*)&in[k * 8]));
+      StoreEnvelope(x, x, 0, &env[k]);
+    }
+    return;
+  }
+
+  for (k = 0; k < subframes; k++) {
+    const int16_t* x = &in[k * len];
+    __m128i max = _mm_loadu_si128((const __m128i*)x);
+    __m128i min = max;
+
+    for (n = 8; n < len; n += 8) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)&x[n]);
+      max = _mm_max_epi16(max, v);
+      min = _mm_min_epi16(min, v);
+    }
+    StoreEnvelope(_mm256_castsi128_si256(max),
+                  _mm256_castsi128_si256(min),
+                  0,
+                  &env[k]);
+  }
+}
+
+// One block of 16 samples per register, see BlockEnergySSE2().
+static void BlockEnergyAVX2(const int16_t* in, int16_t blocks, int32_t* nrg) {
+  int k;
+
+  for (k = 0; k < blocks; k++) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)&in[k * 16]);
+    const __m256i lo = _mm256_mullo_epi16(x, x);
+    const __m256i hi = _mm256_mulhi_epi16(x, x);
+    const __m256i sum8 = _mm256_add_epi32(
+        _mm256_srai_epi32(_mm256_unpacklo_epi16(lo, hi), 4),
+        _mm256_srai_epi32(_mm256_unpackhi_epi16(lo, hi), 4));
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum8),
+                                _mm256_extracti128_si256(sum8, 1));
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    nrg[k] = _mm_cvtsi128_si32(sum);
+  }
+}
+
+// See ScaleSaturateSSE2().
+static void ScaleSaturateAVX2(int16_t* io, int16_t len, uint16_t gain) {
+  const __m256i g = _mm256_set1_epi16((int16_t)gain);
+  int n;
+
+  assert(gain < 32768);
+  for (n = 0; n + 16 <= len; n += 16) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)&io[n]);
+    const __m256i lo = _mm256_mullo_epi16(x, g);
+    const __m256i hi = _mm256_mulhi_epi16(x, g);
+    const __m256i p0 = _mm256_srai_epi32(_mm256_unpacklo_epi16(lo, hi), 12);
+    const __m256i p1 = _mm256_srai_epi32(_mm256_unpackhi_epi16(lo, hi), 12);
+    // The unpacks and the pack both work within 128-bit halves, so the
+    // samples come back in order.
+    _mm256_storeu_si256((__m256i*)&io[n], _mm256_packs_epi32(p0, p1));
+  }
+  for (; n < len; n++) {
+    const int32_t sample = WEBRTC_SPL_MUL_16_U16(io[n], gain) >> 12;
+    io[n] = (int16_t)WEBRTC_SPL_SAT(32767, sample, -32768);
+  }
+}
+
+// See MulHigh32() in digital_agc_sse2.c.  The pack works within 128-bit
+// halves, so |g0| holds the gains of lanes 0 to 3 and 8 to 11 of |x| and |g1|
+// those of lanes 4 to 7 and 12 to 15.
+static __inline __m256i MulHigh32(__m256i x, __m256i g0, __m256i g1) {
+  const __m256i gh = _mm256_packs_epi32(_mm256_srai_epi32(g0, 16),
+                                        _mm256_srai_epi32(g1, 16));
+  const __m256i gl = _mm256_packs_epi32(
+      _mm256_srai_epi32(_mm256_slli_epi32(g0, 16), 16),
+      _mm256_srai_epi32(_mm256_slli_epi32(g1, 16), 16));
+  const __m256i hi = _mm256_sub_epi16(
+      _mm256_mulhi_epu16(x, gl),
+      _mm256_and_si256(_mm256_srai_epi16(x, 15), gl));
+  return _mm256_add_epi16(_mm256_mullo_epi16(x, gh), hi);
+}
+
+// Applies the gain ramp that starts at |gain32| and steps by |delta| to the
+// |len| samples at |io|, 8 or 16.  With |split| set each 128-bit half of
+// |gain32| and |delta| holds the ramp of its own 8-sample sub frame, otherwise
+// all lanes hold the one ramp of a 16-sample run.
+static __inline void ApplyRamp(__m256i gain32,
+                               __m256i delta,
+                               int split,
+                               int len,
+                               int16_t* io) {
+  const __m256i steps0 = split ? _mm256_setr_epi32(0, 1, 2, 3, 0, 1, 2, 3)
+                               : _mm256_setr_epi32(0, 1, 2, 3, 8, 9, 10, 11);
+  const __m256i steps1 = split ? _mm256_setr_epi32(4, 5, 6, 7, 4, 5, 6, 7)
+                               : _mm256_setr_epi32(4, 5, 6, 7, 12, 13, 14, 15);
+  const __m256i g0 = _mm256_srai_epi32(
+      _mm256_add_epi32(gain32, _mm256_mullo_epi32(steps0, delta)), 4);
+  const __m256i g1 = _mm256_srai_epi32(
+      _mm256_add_epi32(gain32, _mm256_mullo_epi32(steps1, delta)), 4);
+
+  if (len == 8) {
+    const __m256i x = _mm256_castsi128_si256(
+        _mm_loadu_si128((const __m128i*)io));
+    _mm_storeu_si128((__m128i*)io,
+                     _mm256_castsi256_si128(MulHigh32(x, g0, g1)));
+  } else {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)io);
+    _mm256_storeu_si256((__m256i*)io, MulHigh32(x, g0, g1));
+  }
+}
+
+static void ApplyGainsAVX2(const int32_t* gains, int16_t L2, int16_t* io) {
+  const int L = 1 << L2;
+  int k;
+
+  if (L == 8) {
+    // Two sub frames per register, the last one on its own.
+    for (k = 1; k < 10; k += 2) {
+      const int last = k == 9;
+      const int32_t gain0 = gains[k] << 4;
+      const int32_t delta0 = (gains[k + 1] - gains[k]) << 1;
+      const int32_t gain1 = last ? 0 : gains[k + 1] << 4;
+      const int32_t delta1 = last ? 0 : (gains[k + 2] - gains[k + 1]) << 1;
+      const __m256i gain32 = _mm256_setr_epi32(gain0, gain0, gain0, gain0,
+                                               gain1, gain1, gain1, gain1);
+      const __m256i delta = _mm256_setr_epi32(delta0, delta0, delta0, delta0,
+                                              delta1, delta1, delta1, delta1);
+
+      ApplyRamp(gain32, delta, 1, last ? 8 : 16, &io[k * 8]);
+    }
+    return;
+  }
+
+  for (k = 1; k < 10; k++) {
+    const int32_t delta = (gains[k + 1] - gains[k]) << (4 - L2);
+    int32_t gain32 = gains[k] << 4;
+    int n;
+
+    for (n = 0; n < L; n += 16) {
+      ApplyRamp(_mm256_set1_epi32(gain32),
+                _mm256_set1_epi32(delta),
+                0,
+                16,
+                &io[k * L + n]);
+      gain32 += 16 * delta;
+    }
+  }
+}
+
+void WebRtcAgc_InitAVX2(void) {
+  WebRtcAgc_Envelope = EnvelopeAVX2;
+  WebRtcAgc_BlockEnergy = BlockEnergyAVX2;
+  WebRtcAgc_ScaleSaturate = ScaleSaturateAVX2;
+  WebRtcAgc_ApplyGains = ApplyGainsAVX2;
+}
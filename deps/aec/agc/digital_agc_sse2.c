@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The AGC envelope, energy and gain kernels, SSE2 versions.  All of them are
+ * bit-exact with the generic C versions in digital_agc.c.
+ */
+
+#include "agc/digital_agc.h"
+
+#include <assert.h>
+#include <emmintrin.h>
+
+// Largest and smallest of the eight lanes, in every lane.
+static __inline __m128i HorizontalMax(__m128i x) {
+  x = _mm_max_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_max_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_max_epi16(x, _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static __inline __m128i HorizontalMin(__m128i x) {
+  x = _mm_min_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_min_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_min_epi16(x, _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+// The largest square of a sub frame is the square of either its largest or
+// its smallest sample, so only those two are searched for.
+static void EnvelopeSSE2(const int16_t* in,
+                         int16_t len,
+                         int16_t subframes,
+                         int32_t* env) {
+  int k, n;
+
+  assert(len % 8 == 0);
+  for (k = 0; k < subframes; k++) {
+    const int16_t* x = &in[k * len];
+    __m128i max = _mm_loadu_si128((const __m128i*)x);
+    __m128i min = max;
+    int16_t hi, lo;
+
+    for (n = 8; n < len; n += 8) {
+      const __m128i v = _mm_loadu_si128((const __m128i*)&x[n]);
+      max = _mm_max_epi16(max, v);
+      min = _mm_min_epi16(min, v);
+    }
+    hi = (int16_t)_mm_cvtsi128_si32(HorizontalMax(max));
+    lo = (int16_t)_mm_cvtsi128_si32(HorizontalMin(min));
+    env[k] = WEBRTC_SPL_MAX(WEBRTC_SPL_MUL_16_16(hi, hi),
+                            WEBRTC_SPL_MUL_16_16(lo, lo));
+  }
+}
+
+// (x * x) >> 4 for the eight lanes of |x|, added up in four 32-bit lanes.
+static __inline __m128i SquaresRsft4(__m128i x) {
+  const __m128i lo = _mm_mullo_epi16(x, x);
+  const __m128i hi = _mm_mulhi_epi16(x, x);
+  return _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 4),
+                       _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 4));
+}
+
+static void BlockEnergySSE2(const int16_t* in, int16_t blocks, int32_t* nrg) {
+  int k;
+
+  for (k = 0; k < blocks; k++) {
+    const __m128i x0 = _mm_loadu_si128((const __m128i*)&in[k * 16]);
+    const __m128i x1 = _mm_loadu_si128((const __m128i*)&in[k * 16 + 8]);
+    __m128i sum = _mm_add_epi32(SquaresRsft4(x0), SquaresRsft4(x1));
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    nrg[k] = _mm_cvtsi128_si32(sum);
+  }
+}
+
+// The analog gains are all below 2^15, so a signed multiply does.
+static void ScaleSaturateSSE2(int16_t* io, int16_t len, uint16_t gain) {
+  const __m128i g = _mm_set1_epi16((int16_t)gain);
+  int n;
+
+  assert(gain < 32768);
+  for (n = 0; n + 8 <= len; n += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)&io[n]);
+    const __m128i lo = _mm_mullo_epi16(x, g);
+    const __m128i hi = _mm_mulhi_epi16(x, g);
+    const __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 12);
+    const __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 12);
+    _mm_storeu_si128((__m128i*)&io[n], _mm_packs_epi32(p0, p1));
+  }
+  for (; n < len; n++) {
+    const int32_t sample = WEBRTC_SPL_MUL_16_U16(io[n], gain) >> 12;
+    io[n] = (int16_t)WEBRTC_SPL_SAT(32767, sample, -32768);
+  }
+}
+
+// Bits 16 to 31 of x * g for the 16-bit |x| and the eight 32-bit gains in
+// |g0| and |g1|, which is what the C version keeps.  With g = gh * 2^16 + gl
+// those bits are x * gh plus the high half of x times the unsigned gl, all
+// modulo 2^16, so no lane needs to be wider than 16 bits.
+static __inline __m128i MulHigh32(__m128i x, __m128i g0, __m128i g1) {
+  const __m128i gh = _mm_packs_epi32(_mm_srai_epi32(g0, 16),
+                                     _mm_srai_epi32(g1, 16));
+  const __m128i gl = _mm_packs_epi32(
+      _mm_srai_epi32(_mm_slli_epi32(g0, 16), 16),
+      _mm_srai_epi32(_mm_slli_epi32(g1, 16), 16));
+  // mulhi_epu16() treats negative x as x + 2^16, which adds gl too many.
+  const __m128i hi = _mm_sub_epi16(_mm_mulhi_epu16(x, gl),
+                                   _mm_and_si128(_mm_srai_epi16(x, 15), gl));
+  return _mm_add_epi16(_mm_mullo_epi16(x, gh), hi);
+}
+
+static void ApplyGainsSSE2(const int32_t* gains, int16_t L2, int16_t* io) {
+  const int L = 1 << L2;
+  int k, n;
+
+  assert(L % 8 == 0);
+  for (k = 1; k < 10; k++) {
+    const int32_t delta = (gains[k + 1] - gains[k]) << (4 - L2);
+    const __m128i step = _mm_set1_epi32(4 * delta);
+    // gain32 of the first four samples, then advanced by four at a time
+    __m128i gain32 = _mm_add_epi32(_mm_set1_epi32(gains[k] << 4),
+                                   _mm_setr_epi32(0, delta, 2 * delta,
+                                                  3 * delta));
+
+    for (n = 0; n < L; n += 8) {
+      int16_t* x = &io[k * L + n];
+      const __m128i g0 = _mm_srai_epi32(gain32, 4);
+      const __m128i g1 = _mm_srai_epi32(_mm_add_epi32(gain32, step), 4);
+      const __m128i v = _mm_loadu_si128((const __m128i*)x);
+
+      _mm_storeu_si128((__m128i*)x, MulHigh32(v, g0, g1));
+      gain32 = _mm_add_epi32(gain32, _mm_add_epi32(step, step));
+    }
+  }
+}
+
+void WebRtcAgc_InitSSE2(void) {
+  WebRtcAgc_Envelope = EnvelopeSSE2;
+  WebRtcAgc_BlockEnergy = BlockEnergySSE2;
+  WebRtcAgc_ScaleSaturate = ScaleSaturateSSE2;
+  WebRtcAgc_ApplyGains = ApplyGainsSSE2;
+}
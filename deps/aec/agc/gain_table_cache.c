@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/* gain_table_cache.c
+ *
+ * Process-wide cache of the compressor gain tables, so that AGC instances
+ * with the same settings share one read-only table instead of computing and
+ * storing their own.  Entries are reference counted and freed with the last
+ * instance that uses them.
+ */
+
+#include "agc/digital_agc.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void Lock(void) {
+  pthread_mutex_lock(&lock);
+}
+
+static void Unlock(void) {
+  pthread_mutex_unlock(&lock);
+}
+
+#elif defined(_WIN32)
+#include <windows.h>
+
+/* Statically initialized for the same reason as in spl_init.c. */
+static CRITICAL_SECTION lock = {(void *)((size_t)-1), -1, 0, 0, 0, 0};
+
+static void Lock(void) {
+  EnterCriticalSection(&lock);
+}
+
+static void Unlock(void) {
+  LeaveCriticalSection(&lock);
+}
+
+/* There's no fallback version as an #else block here to ensure thread safety,
+ * see spl_init.c.
+ */
+#endif  /* WEBRTC_POSIX */
+
+typedef struct GainTableEntry
+{
+    int32_t table[32]; // Q16, first so that the table points to its entry
+    int16_t compressionGaindB;
+    int16_t targetLevelDbfs;
+    uint8_t limiterEnable;
+    int16_t analogTarget;
+    int refs;
+    struct GainTableEntry *next;
+} GainTableEntry;
+
+static GainTableEntry *entries = NULL;
+
+const int32_t *WebRtcAgc_AcquireGainTable(int16_t compressionGaindB,
+                                          int16_t targetLevelDbfs,
+                                          uint8_t limiterEnable,
+                                          int16_t analogTarget)
+{
+    GainTableEntry *entry;
+
+    Lock();
+    for (entry = entries; entry != NULL; entry = entry->next)
+    {
+        if (entry->compressionGaindB == compressionGaindB &&
+            entry->targetLevelDbfs == targetLevelDbfs &&
+            entry->limiterEnable == limiterEnable &&
+            entry->analogTarget == analogTarget)
+        {
+            entry->refs++;
+            Unlock();
+            return entry->table;
+        }
+    }
+
+    // Computed under the lock, so that instances created at the same time
+    // with the same settings don't both compute it.
+    entry = (GainTableEntry *)malloc(sizeof(*entry));
+    if (entry == NULL ||
+        WebRtcAgc_CalculateGainTable(entry->table, compressionGaindB,
+                                     targetLevelDbfs, limiterEnable,
+                                     analogTarget) == -1)
+    {
+        Unlock();
+        free(entry);
+        return NULL;
+    }
+    entry->compressionGaindB = compressionGaindB;
+    entry->targetLevelDbfs = targetLevelDbfs;
+    entry->limiterEnable = limiterEnable;
+    entry->analogTarget = analogTarget;
+    entry->refs = 1;
+    entry->next = entries;
+    entries = entry;
+    Unlock();
+
+    return entry->table;
+}
+
+void WebRtcAgc_ReleaseGainTable(const int32_t *table)
+{
+    GainTableEntry **link;
+
+    if (table == NULL)
+    {
+        return;
+    }
+
+    Lock();
+    for (link = &entries; *link != NULL; link = &(*link)->next)
+    {
+        GainTableEntry *entry = *link;
+
+        if (entry->table == table)
+        {
+            if (--entry->refs == 0)
+            {
+                *link = entry->next;
+                free(entry);
+            }
+            break;
+        }
+    }
+    Unlock();
+}
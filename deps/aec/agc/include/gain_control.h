@@ -210,6 +210,23 @@ int WebRtcAgc_set_config(void* agcInst, WebRtcAgc_config_t config);
  */
 int WebRtcAgc_get_config(void* agcInst, WebRtcAgc_config_t* config);
 
+/*
+ * This function returns the voice activity of the last microphone frame given
+ * to WebRtcAgc_AddMic().
+ *
+ * Input:
+ *      - agcInst           : AGC instance
+ *
+ * Output:
+ *      - logRatio          : log(P(speech) / P(non-speech)) in Q10
+ *      - active            : 1 if the AGC treats the frame as speech, else 0
+ *
+ * Return value:
+ *                          :  0 - Normal operation.
+ *                          : -1 - Error
+ */
+int WebRtcAgc_get_vad(void* agcInst, int16_t* logRatio, int16_t* active);
+
 /*
  * This function creates an AGC instance, which will contain the state
  * information for one (duplex) channel.
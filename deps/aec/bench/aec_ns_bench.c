@@ -0,0 +1,239 @@
+/*
+ * Separate AEC and NS stages against the AEC with its noise suppressing
+ * post-filter, see AecConfig.post_filter. Prints the per-frame cost of each
+ * pipeline and three quality figures over a synthetic call that cycles through
+ * far-end talk, near-end talk, double talk and silence over a noise floor:
+ *
+ *   noise   attenuation of the noise floor in silence, in dB
+ *   echo    attenuation of the microphone signal in far-end talk, in dB
+ *   speech  near-end speech to error ratio in near-end talk, in dB
+ *
+ * Usage: aec_ns_bench [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "aec/include/echo_cancellation.h"
+#include "ns/include/noise_suppression.h"
+
+static const int kDefaultFrames = 8000;
+static const int kSegmentFrames = 200;  // 2 s of each kind of talk
+static const int kEchoDelay = 40;  // in samples at 8 kHz
+static const int kEchoLength = 160;  // in samples at 8 kHz
+static const int kMaxLag = 256;  // of the output behind the input
+
+enum Segment {
+  kFarTalk,
+  kNearTalk,
+  kDoubleTalk,
+  kSilence,
+  kSegments
+};
+
+typedef struct {
+  double cost;  // ns/frame
+  double noise;
+  double echo;
+  double speech;
+} Result;
+
+static double Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double Noise(unsigned* seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return (((*seed >> 8) & 0xffff) - 32768.0) / 32768.0;
+}
+
+// Voiced syllables: a few harmonics of |f0| under a 4 Hz envelope.
+static double Voice(double t, double f0) {
+  double env = sin(2 * M_PI * 4 * t);
+  double v = 0;
+  int h;
+
+  if (env < 0)
+    return 0;
+  for (h = 1; h <= 6; h++)
+    v += sin(2 * M_PI * f0 * h * t) / h;
+  return env * v;
+}
+
+// The whole call at |rate|: far end, microphone and the clean near-end speech
+// that the microphone picks up, |frames| * |rate| / 100 samples each.
+static void Generate(int rate, int frames, short* far, short* mic,
+                     double* speech) {
+  const int len = frames * rate / 100;
+  const int mult = rate / 8000;
+  double* echo_path = calloc(kEchoLength * mult, sizeof(*echo_path));
+  unsigned seed = 1;
+  int i, j;
+
+  for (i = 0; i < kEchoLength * mult; i++) {
+    double decay = exp(-(double) i / (40 * mult));
+    echo_path[i] = i < kEchoDelay * mult ? 0 : 0.4 * decay * Noise(&seed);
+  }
+
+  for (i = 0; i < len; i++) {
+    int segment = (i / (rate / 100) / kSegmentFrames) % kSegments;
+    int far_on = segment == kFarTalk || segment == kDoubleTalk;
+    int near_on = segment == kNearTalk || segment == kDoubleTalk;
+    double t = (double) i / rate;
+    double echo = 0;
+
+    far[i] = (short) (far_on ? 6000 * Voice(t, 210) + 300 * Noise(&seed) : 0);
+    speech[i] = near_on ? 4000 * Voice(t + 0.1, 130) : 0;
+    for (j = 0; j < kEchoLength * mult && j <= i; j++)
+      echo += echo_path[j] * far[i - j];
+    mic[i] = (short) (speech[i] + echo + 150 * Noise(&seed));
+  }
+
+  free(echo_path);
+}
+
+static double Ratio(double num, double den) {
+  return 10 * log10((num + 1) / (den + 1));
+}
+
+// Quality figures of |out| with the output |lag| that best matches the clean
+// speech, found in the near-end talk segments.
+static void Evaluate(int rate, int frames, const short* mic,
+                     const double* speech, const short* out, Result* r) {
+  const int len = frames * rate / 100;
+  const int segment_len = kSegmentFrames * rate / 100;
+  double mic_pow[kSegments] = { 0 };
+  double out_pow[kSegments] = { 0 };
+  double speech_pow = 0;
+  double error_pow = 0;
+  double best = -1;
+  int lag = 0;
+  int i, l;
+
+  for (l = 0; l <= kMaxLag * rate / 8000; l++) {
+    double corr = 0;
+    for (i = 0; i + l < len; i++) {
+      if ((i / segment_len) % kSegments == kNearTalk)
+        corr += speech[i] * out[i + l];
+    }
+    if (corr > best) {
+      best = corr;
+      lag = l;
+    }
+  }
+
+  // Skip the first cycle, while the AEC and the noise estimates converge.
+  for (i = segment_len * kSegments; i + lag < len; i++) {
+    int segment = (i / segment_len) % kSegments;
+
+    mic_pow[segment] += (double) mic[i] * mic[i];
+    out_pow[segment] += (double) out[i + lag] * out[i + lag];
+    if (segment == kNearTalk) {
+      double error = out[i + lag] - speech[i];
+      speech_pow += speech[i] * speech[i];
+      error_pow += error * error;
+    }
+  }
+
+  r->noise = Ratio(mic_pow[kSilence], out_pow[kSilence]);
+  r->echo = Ratio(mic_pow[kFarTalk], out_pow[kFarTalk]);
+  r->speech = Ratio(speech_pow, error_pow);
+}
+
+static void Run(int rate, int frames, int fused, const short* far,
+                const short* mic, const double* speech, Result* r) {
+  const int frame_len = rate / 100;
+  short* out = malloc(frames * frame_len * sizeof(*out));
+  void* aec;
+  NsHandle* ns = NULL;
+  AecConfig config;
+  double total = 0;
+  int i;
+
+  config.nlpMode = kAecNlpModerate;
+  config.skewMode = kAecFalse;
+  config.metricsMode = kAecFalse;
+  config.delay_logging = kAecFalse;
+  config.delay_agnostic = kAecTrue;
+  config.post_filter = fused ? kAecPostFilterMild : kAecPostFilterOff;
+  if (WebRtcAec_Create(&aec) != 0 ||
+      WebRtcAec_Init(aec, rate, rate) != 0 ||
+      WebRtcAec_set_config(aec, config) != 0) {
+    abort();
+  }
+  // NS policy 0 is what kAecPostFilterMild stands for.
+  if (!fused && (WebRtcNs_Create(&ns) != 0 ||
+                 WebRtcNs_Init(ns, rate) != 0 ||
+                 WebRtcNs_set_policy(ns, 0) != 0)) {
+    abort();
+  }
+
+  for (i = 0; i < frames; i++) {
+    const short* near = &mic[i * frame_len];
+    short* frame = &out[i * frame_len];
+    double start;
+
+    if (WebRtcAec_BufferFarend(aec, &far[i * frame_len], frame_len) != 0)
+      abort();
+    start = Now();
+    if (WebRtcAec_Process(aec, near, NULL, frame, NULL, frame_len, 0, 0) != 0)
+      abort();
+    if (ns != NULL && WebRtcNs_Process(ns, frame, NULL, frame, NULL) != 0)
+      abort();
+    total += Now() - start;
+  }
+
+  r->cost = total / frames;
+  Evaluate(rate, frames, mic, speech, out, r);
+
+  if (ns != NULL)
+    WebRtcNs_Free(ns);
+  WebRtcAec_Free(aec);
+  free(out);
+}
+
+int main(int argc, char** argv) {
+  static const int rates[] = { 8000, 16000 };
+  static const char* names[] = { "aec+ns", "fused" };
+  int frames = argc > 1 ? atoi(argv[1]) : kDefaultFrames;
+  size_t i;
+  int fused;
+
+  if (frames < 2 * kSegmentFrames * kSegments) {
+    fprintf(stderr,
+            "Usage: %s [frames], at least %d frames\n",
+            argv[0],
+            2 * kSegmentFrames * kSegments);
+    return 1;
+  }
+
+  printf("%-6s %-8s %10s %8s %8s %8s\n",
+         "rate", "pipeline", "ns/frame", "noise", "echo", "speech");
+  for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    int rate = rates[i];
+    int len = frames * rate / 100;
+    short* far = malloc(len * sizeof(*far));
+    short* mic = malloc(len * sizeof(*mic));
+    double* speech = malloc(len * sizeof(*speech));
+
+    Generate(rate, frames, far, mic, speech);
+    for (fused = 0; fused < 2; fused++) {
+      Result r;
+
+      Run(rate, frames, fused, far, mic, speech, &r);
+      printf("%-6d %-8s %10.0f %8.1f %8.1f %8.1f\n",
+             rate, names[fused], r.cost, r.noise, r.echo, r.speech);
+    }
+
+    free(far);
+    free(mic);
+    free(speech);
+  }
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Cost of the AGC kernels on each x86 code path, per call on one 10 ms frame,
+ * and of a whole analog AGC frame, WebRtcAgc_AddMic()
+ * followed by WebRtcAgc_Process().
+ *
+ * Usage: agc_bench [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "agc/digital_agc.h"
+#include "agc/include/gain_control.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+static const int kDefaultFrames = 20000;
+// Kernel calls per timed batch, a single call is too short to time.
+static const int kBatch = 100;
+
+typedef struct {
+  const char* name;
+  WebRtc_CPUInfo cpu_info;
+} Path;
+
+static WebRtc_CPUInfo host_cpu_info;
+
+static int SSE2Only(CPUFeature feature) {
+  return feature == kSSE2 && host_cpu_info(kSSE2);
+}
+
+static double Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Speech-like bursts over a noise floor, one 10 ms frame at a time.
+static void Generate(short* frame, int len, int index, unsigned* seed) {
+  int i;
+  double env = (index / 50) % 2 ? 0.4 : 0.02;
+
+  for (i = 0; i < len; i++) {
+    double v;
+
+    *seed = *seed * 1103515245u + 12345u;
+    v = (((*seed >> 8) & 0xffff) - 32768.0) / 32.0;
+    v += env * 20000.0 * sin((index * len + i) * 0.07);
+    frame[i] = (short) v;
+  }
+}
+
+// The AGC picks its code path in Init(), so |cpu_info| only has to be in
+// place while the instance is created.
+static void* Create(int rate, WebRtc_CPUInfo cpu_info) {
+  void* agc;
+
+  WebRtc_GetCPUInfo = cpu_info;
+  if (WebRtcAgc_Create(&agc) != 0 ||
+      WebRtcAgc_Init(agc, 0, 255, kAgcModeAdaptiveAnalog, rate) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+
+  return agc;
+}
+
+// ns per call of each kernel on a frame at |rate|, into |cost|.
+static void BenchKernels(int rate, int frames, double cost[4]) {
+  const int L2 = rate == 8000 ? 3 : 4;
+  const int len = 10 << L2;
+  short in[160];
+  short io[160];
+  int32_t out[10];
+  int32_t gains[11];
+  unsigned seed = 1;
+  int i, j;
+
+  memset(cost, 0, 4 * sizeof(*cost));
+  for (i = 0; i < 11; i++) {
+    gains[i] = 40000 + 2000 * i;
+  }
+  for (i = 0; i < frames / kBatch; i++) {
+    double start;
+
+    Generate(in, len, i, &seed);
+    start = Now();
+    for (j = 0; j < kBatch; j++) {
+      WebRtcAgc_Envelope(in, 1 << L2, 10, out);
+    }
+    cost[0] += Now() - start;
+    start = Now();
+    for (j = 0; j < kBatch; j++) {
+      WebRtcAgc_BlockEnergy(in, 5, out);
+    }
+    cost[1] += Now() - start;
+    memcpy(io, in, sizeof(in));
+    start = Now();
+    for (j = 0; j < kBatch; j++) {
+      WebRtcAgc_ScaleSaturate(io, len, 4096);
+    }
+    cost[2] += Now() - start;
+    start = Now();
+    for (j = 0; j < kBatch; j++) {
+      WebRtcAgc_ApplyGains(gains, L2, io);
+    }
+    cost[3] += Now() - start;
+  }
+  for (i = 0; i < 4; i++) {
+    cost[i] /= frames / kBatch * kBatch;
+  }
+}
+
+static double BenchFrame(int rate, int frames, WebRtc_CPUInfo cpu_info) {
+  void* agc = Create(rate, cpu_info);
+  const int len = rate / 100;
+  short in[160];
+  short out[160];
+  int32_t level = 128;
+  unsigned seed = 1;
+  double total = 0;
+  int i;
+
+  for (i = 0; i < frames; i++) {
+    uint8_t warning;
+    double start;
+
+    Generate(in, len, i, &seed);
+    start = Now();
+    if (WebRtcAgc_AddMic(agc, in, NULL, len) != 0 ||
+        WebRtcAgc_Process(agc, in, NULL, len, out, NULL, level, &level, 0,
+                          &warning) != 0) {
+      abort();
+    }
+    total += Now() - start;
+  }
+  WebRtcAgc_Free(agc);
+
+  return total / frames;
+}
+
+int main(int argc, char** argv) {
+  static const int rates[] = { 8000, 16000 };
+  int frames = argc > 1 ? atoi(argv[1]) : kDefaultFrames;
+  Path paths[3];
+  int count = 0;
+  size_t i;
+  int j;
+
+  if (frames < kBatch) {
+    fprintf(stderr, "Usage: %s [frames], at least %d frames\n",
+            argv[0], kBatch);
+    return 1;
+  }
+
+  host_cpu_info = WebRtc_GetCPUInfo;
+
+  paths[count].name = "c";
+  paths[count++].cpu_info = WebRtc_GetCPUInfoNoASM;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (host_cpu_info(kSSE2)) {
+    paths[count].name = "sse2";
+    paths[count++].cpu_info = SSE2Only;
+  }
+  if (host_cpu_info(kAVX2)) {
+    paths[count].name = "avx2";
+    paths[count++].cpu_info = host_cpu_info;
+  }
+#endif
+
+  printf("%-6s %-6s %10s %10s %10s %10s %10s\n",
+         "rate", "path", "envelope", "energy", "scale", "gains", "ns/frame");
+  for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    for (j = 0; j < count; j++) {
+      // The kernels stay installed after the instance is gone.
+      void* agc = Create(rates[i], paths[j].cpu_info);
+      double cost[4];
+
+      WebRtcAgc_Free(agc);
+      BenchKernels(rates[i], frames, cost);
+      printf("%-6d %-6s %10.1f %10.1f %10.1f %10.1f %10.0f\n",
+             rates[i], paths[j].name, cost[0], cost[1], cost[2], cost[3],
+             BenchFrame(rates[i], frames, paths[j].cpu_info));
+    }
+  }
+
+  return 0;
+}
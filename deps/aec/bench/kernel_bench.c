@@ -0,0 +1,484 @@
+/*
+ * Per-call cost of the hot kernels of a session, each timed in isolation on
+ * every code path it has.  A kernel is called in batches long enough to time,
+ * the batch size picked so that one takes about kBatchNs, and the batches are
+ * repeated |runs| times:
+ *
+ *   ns/call   mean over the batches
+ *   stddev    standard deviation over the batches, in % of the mean
+ *   min       fastest batch, in ns/call
+ *   M/s       millions of |unit| per second at the mean
+ *
+ * With --json the same figures are printed as one JSON object, for tracking
+ * them across commits.
+ *
+ * Usage: kernel_bench [--json] [runs]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "aec/aec_core.h"
+#include "aec/aec_core_internal.h"
+#include "aec/aec_rdft.h"
+#include "agc/include/gain_control.h"
+#include "ns/include/noise_suppression.h"
+#include "ns/include/noise_suppression_x.h"
+#include "pa_ringbuffer.h"
+#include "signal_processing/include/signal_processing_library.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+static const int kDefaultRuns = 30;
+static const double kBatchNs = 5e6;
+enum { kRate = 16000, kFrame = 160, kFrames = 50 };
+
+enum Level { kC, kLevelSSE2, kLevelAVX2 };
+
+typedef struct {
+  const char* name;
+  WebRtc_CPUInfo cpu_info;
+  AllPassQMFMulti all_pass_qmf;
+  PolyphaseFIR polyphase_fir;
+} Path;
+
+typedef struct {
+  const char* name;
+  const char* unit;
+  int items;  // |unit|s per call
+  enum Level max_level;  // highest code path the kernel has
+  // Installs |path| and sets up the kernel's state, undone by |teardown|.
+  void (*setup)(const Path* path);
+  void (*run)(void);
+  void (*teardown)(void);
+} Kernel;
+
+static WebRtc_CPUInfo host_cpu_info;
+
+static int SSE2Only(CPUFeature feature) {
+  return feature == kSSE2 && host_cpu_info(kSSE2);
+}
+
+static double Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Speech-like bursts over a noise floor, |kFrames| frames of |kFrame|.
+static short frames[kFrames][kFrame];
+static short out[4 * kFrame];
+static int frame_index = 0;
+static volatile int sink = 0;
+
+static short* NextFrame() {
+  frame_index = (frame_index + 1) % kFrames;
+  return frames[frame_index];
+}
+
+static void Generate() {
+  unsigned seed = 1;
+  int i, j;
+
+  for (i = 0; i < kFrames; i++) {
+    double env = (i / 10) % 2 ? 0.4 : 0.02;
+
+    for (j = 0; j < kFrame; j++) {
+      double v;
+
+      seed = seed * 1103515245u + 12345u;
+      v = (((seed >> 8) & 0xffff) - 32768.0) / 32.0;
+      v += env * 20000.0 * sin((i * kFrame + j) * 0.07);
+      frames[i][j] = (short) v;
+    }
+  }
+}
+
+static float RandomFloat(unsigned* seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return (((*seed >> 8) & 0xffff) - 32768.0f) / 32768.0f;
+}
+
+static void Nothing() {}
+
+// AEC rdft.
+
+static float rdft_in[PART_LEN2];
+static float rdft[PART_LEN2];
+
+static void SetupRdft(const Path* path) {
+  unsigned seed = 1;
+  int i;
+
+  WebRtc_GetCPUInfo = path->cpu_info;
+  aec_rdft_init();
+  WebRtc_GetCPUInfo = host_cpu_info;
+  for (i = 0; i < PART_LEN2; i++) {
+    rdft_in[i] = RandomFloat(&seed);
+  }
+}
+
+// The transforms are in place and scale by up to 64, so each call starts over
+// from a copy of |rdft_in|.
+static void RunRdftForward() {
+  memcpy(rdft, rdft_in, sizeof(rdft));
+  aec_rdft_forward_128(rdft);
+}
+
+static void RunRdftInverse() {
+  memcpy(rdft, rdft_in, sizeof(rdft));
+  aec_rdft_inverse_128(rdft);
+}
+
+// AEC filter kernels, on the state of a fresh AEC core.
+
+static AecCore* aec = NULL;
+static float aec_ef[2][PART_LEN1];
+static float aec_ef_in[2][PART_LEN1];
+static float aec_yf[2][PART_LEN1];
+static float aec_fft[PART_LEN2];
+
+static void SetupAecCore(const Path* path) {
+  unsigned seed = 1;
+  int i;
+
+  WebRtc_GetCPUInfo = path->cpu_info;
+  if (WebRtcAec_CreateAec(&aec) != 0 ||
+      WebRtcAec_InitAec(aec, kRate) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+  for (i = 0; i < aec->num_partitions * PART_LEN1; i++) {
+    aec->xfBuf[0][i] = RandomFloat(&seed);
+    aec->xfBuf[1][i] = RandomFloat(&seed);
+    aec->wfBuf[0][i] = 1e-3f * RandomFloat(&seed);
+    aec->wfBuf[1][i] = 1e-3f * RandomFloat(&seed);
+  }
+  for (i = 0; i < PART_LEN1; i++) {
+    aec->xPow[i] = 1 + RandomFloat(&seed) * RandomFloat(&seed);
+    aec_ef_in[0][i] = 1e-6f * RandomFloat(&seed);
+    aec_ef_in[1][i] = 1e-6f * RandomFloat(&seed);
+  }
+  memcpy(aec_ef, aec_ef_in, sizeof(aec_ef));
+}
+
+static void TeardownAecCore() {
+  WebRtcAec_FreeAec(aec);
+  aec = NULL;
+}
+
+static void RunFilterFar() {
+  WebRtcAec_FilterFar(aec, aec_yf);
+}
+
+// Scales |aec_ef| in place, so it starts over from a copy each call.
+static void RunScaleErrorSignal() {
+  memcpy(aec_ef, aec_ef_in, sizeof(aec_ef));
+  WebRtcAec_ScaleErrorSignal(aec, aec_ef);
+}
+
+static void RunFilterAdaptation() {
+  WebRtcAec_FilterAdaptation(aec, aec_fft, aec_ef);
+}
+
+// Noise suppressors and AGC, one 10 ms frame at 16 kHz.
+
+static NsHandle* ns = NULL;
+static NsxHandle* nsx = NULL;
+static void* agc = NULL;
+static int32_t agc_level = 128;
+
+static void SetupNs(const Path* path) {
+  WebRtc_GetCPUInfo = path->cpu_info;
+  if (WebRtcNs_Create(&ns) != 0 || WebRtcNs_Init(ns, kRate) != 0 ||
+      WebRtcNs_set_policy(ns, 1) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+}
+
+static void TeardownNs() {
+  WebRtcNs_Free(ns);
+  ns = NULL;
+}
+
+static void RunNs() {
+  WebRtcNs_Process(ns, NextFrame(), NULL, out, NULL);
+}
+
+static void SetupNsx(const Path* path) {
+  WebRtc_GetCPUInfo = path->cpu_info;
+  if (WebRtcNsx_Create(&nsx) != 0 || WebRtcNsx_Init(nsx, kRate) != 0 ||
+      WebRtcNsx_set_policy(nsx, 1) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+}
+
+static void TeardownNsx() {
+  WebRtcNsx_Free(nsx);
+  nsx = NULL;
+}
+
+static void RunNsx() {
+  WebRtcNsx_Process(nsx, NextFrame(), NULL, out, NULL);
+}
+
+static void SetupAgc(const Path* path) {
+  WebRtc_GetCPUInfo = path->cpu_info;
+  if (WebRtcAgc_Create(&agc) != 0 ||
+      WebRtcAgc_Init(agc, 0, 255, kAgcModeAdaptiveAnalog, kRate) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+  agc_level = 128;
+}
+
+static void TeardownAgc() {
+  WebRtcAgc_Free(agc);
+  agc = NULL;
+}
+
+// WebRtcAgc_AddMic() followed by WebRtcAgc_Process(), as Channel does.
+static void RunAgc() {
+  short* frame = NextFrame();
+  uint8_t warning;
+
+  if (WebRtcAgc_AddMic(agc, frame, NULL, kFrame) != 0 ||
+      WebRtcAgc_Process(agc, frame, NULL, kFrame, out, NULL, agc_level,
+                        &agc_level, 0, &warning) != 0) {
+    abort();
+  }
+}
+
+// QMF, one 10 ms frame at 32 kHz.
+
+static int32_t qmf_single[4][6];
+static QMFState qmf_state;
+static short qmf_low[2][kFrame];
+static short qmf_high[2][kFrame];
+
+static void SetupSPL(const Path* path) {
+  WebRtcSpl_AllPassQMFMulti = path->all_pass_qmf;
+  WebRtcSpl_PolyphaseFIR = path->polyphase_fir;
+  memset(qmf_single, 0, sizeof(qmf_single));
+  memset(&qmf_state, 0, sizeof(qmf_state));
+}
+
+static void RunAnalysisQMF() {
+  WebRtcSpl_AnalysisQMF(frames[0], 2 * kFrame, qmf_low[0], qmf_high[0],
+                        qmf_single[0], qmf_single[1]);
+}
+
+static void RunSynthesisQMF() {
+  WebRtcSpl_SynthesisQMF(qmf_low[0], qmf_high[0], kFrame, out,
+                         qmf_single[2], qmf_single[3]);
+}
+
+// Near and far end together, as Channel::Cycle() splits them.
+static void RunAnalysisQMFMulti() {
+  const int16_t* in[2] = { frames[0], frames[2] };
+  int16_t* low[2] = { qmf_low[0], qmf_low[1] };
+  int16_t* high[2] = { qmf_high[0], qmf_high[1] };
+
+  WebRtcSpl_AnalysisQMFMulti(in, 2, 2 * kFrame, low, high, &qmf_state);
+}
+
+// Polyphase resampler, 10 ms between 48 kHz and 16 kHz.
+
+static struct PolyphaseResampler* resampler = NULL;
+
+static void SetupDownsampler(const Path* path) {
+  SetupSPL(path);
+  resampler = WebRtcSpl_CreatePolyphaseResampler(48000, 16000, 1);
+}
+
+static void SetupUpsampler(const Path* path) {
+  SetupSPL(path);
+  resampler = WebRtcSpl_CreatePolyphaseResampler(16000, 48000, 1);
+}
+
+static void TeardownResampler() {
+  WebRtcSpl_FreePolyphaseResampler(resampler);
+  resampler = NULL;
+}
+
+static void RunDownsampler() {
+  sink += WebRtcSpl_ResamplePolyphase(resampler, 0, frames[0], 3 * kFrame,
+                                      out);
+}
+
+static void RunUpsampler() {
+  sink += WebRtcSpl_ResamplePolyphase(resampler, 0, frames[0], kFrame, out);
+}
+
+// PortAudio ring buffer, one 10 ms frame of 16-bit samples in and out.
+
+static PaUtilRingBuffer ring;
+static short ring_data[4096];
+
+static void SetupRing(const Path* path) {
+  (void) path;
+  PaUtil_InitializeRingBuffer(&ring, sizeof(short), 4096, ring_data);
+}
+
+static void RunRing() {
+  PaUtil_WriteRingBuffer(&ring, frames[0], kFrame);
+  PaUtil_ReadRingBuffer(&ring, out, kFrame);
+}
+
+static const Kernel kKernels[] = {
+  { "aec_rdft_forward_128", "samples", PART_LEN2, kLevelSSE2,
+    SetupRdft, RunRdftForward, Nothing },
+  { "aec_rdft_inverse_128", "samples", PART_LEN2, kLevelSSE2,
+    SetupRdft, RunRdftInverse, Nothing },
+  { "FilterFar", "samples", PART_LEN, kLevelSSE2,
+    SetupAecCore, RunFilterFar, TeardownAecCore },
+  { "ScaleErrorSignal", "samples", PART_LEN, kLevelSSE2,
+    SetupAecCore, RunScaleErrorSignal, TeardownAecCore },
+  { "FilterAdaptation", "samples", PART_LEN, kLevelSSE2,
+    SetupAecCore, RunFilterAdaptation, TeardownAecCore },
+  { "WebRtcNs_Process", "samples", kFrame, kLevelAVX2,
+    SetupNs, RunNs, TeardownNs },
+  { "WebRtcNsx_Process", "samples", kFrame, kLevelSSE2,
+    SetupNsx, RunNsx, TeardownNsx },
+  { "WebRtcAgc_Process", "samples", kFrame, kLevelAVX2,
+    SetupAgc, RunAgc, TeardownAgc },
+  { "AnalysisQMF", "samples", 2 * kFrame, kC,
+    SetupSPL, RunAnalysisQMF, Nothing },
+  { "SynthesisQMF", "samples", 2 * kFrame, kC,
+    SetupSPL, RunSynthesisQMF, Nothing },
+  { "AnalysisQMFMulti x2", "samples", 4 * kFrame, kLevelAVX2,
+    SetupSPL, RunAnalysisQMFMulti, Nothing },
+  { "ResamplePolyphase 48to16", "samples", 3 * kFrame, kLevelAVX2,
+    SetupDownsampler, RunDownsampler, TeardownResampler },
+  { "ResamplePolyphase 16to48", "samples", kFrame, kLevelAVX2,
+    SetupUpsampler, RunUpsampler, TeardownResampler },
+  { "PaUtil_Write/ReadRingBuffer", "bytes", 2 * kFrame * (int) sizeof(short),
+    kC, SetupRing, RunRing, Nothing },
+};
+
+typedef struct {
+  double mean;
+  double stddev;
+  double min;
+} BatchStats;
+
+static void Measure(const Kernel* kernel, const Path* path, int runs,
+                    BatchStats* stats) {
+  double sum = 0;
+  double sum2 = 0;
+  double start;
+  int calls = 1;
+  int i, r;
+
+  kernel->setup(path);
+  // Doubles the batch until it is long enough, which warms up too.
+  for (;;) {
+    start = Now();
+    for (i = 0; i < calls; i++) {
+      kernel->run();
+    }
+    if (Now() - start >= kBatchNs || calls >= (1 << 24)) {
+      break;
+    }
+    calls <<= 1;
+  }
+
+  stats->min = HUGE_VAL;
+  for (r = 0; r < runs; r++) {
+    double cost;
+
+    start = Now();
+    for (i = 0; i < calls; i++) {
+      kernel->run();
+    }
+    cost = (Now() - start) / calls;
+    sum += cost;
+    sum2 += cost * cost;
+    if (cost < stats->min) {
+      stats->min = cost;
+    }
+  }
+  kernel->teardown();
+
+  stats->mean = sum / runs;
+  stats->stddev = sqrt(fmax(sum2 / runs - stats->mean * stats->mean, 0));
+}
+
+int main(int argc, char** argv) {
+  int json = argc > 1 && strcmp(argv[1], "--json") == 0;
+  int runs = argc > 1 + json ? atoi(argv[1 + json]) : kDefaultRuns;
+  Path paths[3];
+  int count = 0;
+  int first = 1;
+  size_t k;
+  int j;
+
+  if (runs <= 1) {
+    fprintf(stderr, "Usage: %s [--json] [runs], at least 2 runs\n", argv[0]);
+    return 1;
+  }
+
+  host_cpu_info = WebRtc_GetCPUInfo;
+  WebRtcSpl_Init();
+  Generate();
+
+  paths[count].name = "c";
+  paths[count].cpu_info = WebRtc_GetCPUInfoNoASM;
+  paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiC;
+  paths[count++].polyphase_fir = WebRtcSpl_PolyphaseFIRC;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (host_cpu_info(kSSE2)) {
+    paths[count].name = "sse2";
+    paths[count].cpu_info = SSE2Only;
+    paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiSSE2;
+    paths[count++].polyphase_fir = WebRtcSpl_PolyphaseFIRSSE2;
+  }
+  if (host_cpu_info(kAVX2)) {
+    paths[count].name = "avx2";
+    paths[count].cpu_info = host_cpu_info;
+    paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiAVX2;
+    paths[count++].polyphase_fir = WebRtcSpl_PolyphaseFIRAVX2;
+  }
+#endif
+
+  if (json) {
+    printf("{\"runs\": %d, \"batch_ns\": %.0f, \"kernels\": [", runs,
+           kBatchNs);
+  } else {
+    printf("%-28s %-6s %10s %8s %10s %10s\n",
+           "kernel", "path", "ns/call", "stddev", "min", "M/s");
+  }
+  for (k = 0; k < sizeof(kKernels) / sizeof(kKernels[0]); k++) {
+    const Kernel* kernel = &kKernels[k];
+
+    for (j = 0; j < count && j <= (int) kernel->max_level; j++) {
+      BatchStats stats;
+      double throughput;
+
+      Measure(kernel, &paths[j], runs, &stats);
+      throughput = kernel->items * 1e3 / stats.mean;
+      if (json) {
+        printf("%s\n  {\"kernel\": \"%s\", \"path\": \"%s\", "
+               "\"ns_per_call\": %.1f, \"stddev_ns\": %.1f, \"min_ns\": %.1f, "
+               "\"throughput\": %.3f, \"unit\": \"M%s/s\"}",
+               first ? "" : ",", kernel->name, paths[j].name, stats.mean,
+               stats.stddev, stats.min, throughput, kernel->unit);
+        first = 0;
+      } else {
+        printf("%-28s %-6s %10.1f %7.1f%% %10.1f %10.1f %s\n",
+               kernel->name, paths[j].name, stats.mean,
+               100 * stats.stddev / stats.mean, stats.min, throughput,
+               kernel->unit);
+      }
+    }
+  }
+  if (json) {
+    printf("\n]}\n");
+  }
+
+  return sink == -1;
+}
@@ -0,0 +1,152 @@
+/*
+ * Per-frame cost of the noise suppressors: float NS and fixed-point NSX, each
+ * with its x86 code paths.
+ *
+ * Usage: ns_bench [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "ns/include/noise_suppression.h"
+#include "ns/include/noise_suppression_x.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+static const int kDefaultFrames = 20000;
+static const int kPolicy = 1;
+
+static WebRtc_CPUInfo host_cpu_info;
+
+static int SSE2Only(CPUFeature feature) {
+  return feature == kSSE2 && host_cpu_info(kSSE2);
+}
+
+static double Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Speech-like bursts over a noise floor, one 10 ms frame at a time.
+static void Generate(short* frame, int len, int index, unsigned* seed) {
+  int i;
+  double env = (index / 50) % 2 ? 0.4 : 0.02;
+
+  for (i = 0; i < len; i++) {
+    double v;
+
+    *seed = *seed * 1103515245u + 12345u;
+    v = (((*seed >> 8) & 0xffff) - 32768.0) / 32.0;
+    v += env * 20000.0 * sin((index * len + i) * 0.07);
+    frame[i] = (short) v;
+  }
+}
+
+// Both suppressors pick their code path in Init(), so |cpu_info| only has to
+// be in place while the instance is created.
+static double BenchFloat(int rate, int frames, WebRtc_CPUInfo cpu_info) {
+  NsHandle* ns;
+  short in[160];
+  short out[160];
+  unsigned seed = 1;
+  double total = 0;
+  int i;
+
+  WebRtc_GetCPUInfo = cpu_info;
+  if (WebRtcNs_Create(&ns) != 0 ||
+      WebRtcNs_Init(ns, rate) != 0 ||
+      WebRtcNs_set_policy(ns, kPolicy) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+
+  for (i = 0; i < frames; i++) {
+    double start;
+
+    Generate(in, rate / 100, i, &seed);
+    start = Now();
+    WebRtcNs_Process(ns, in, NULL, out, NULL);
+    total += Now() - start;
+  }
+  WebRtcNs_Free(ns);
+
+  return total / frames;
+}
+
+static double BenchFixed(int rate, int frames, WebRtc_CPUInfo cpu_info) {
+  NsxHandle* nsx;
+  short in[160];
+  short out[160];
+  unsigned seed = 1;
+  double total = 0;
+  int i;
+
+  WebRtc_GetCPUInfo = cpu_info;
+  if (WebRtcNsx_Create(&nsx) != 0 ||
+      WebRtcNsx_Init(nsx, rate) != 0 ||
+      WebRtcNsx_set_policy(nsx, kPolicy) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+
+  for (i = 0; i < frames; i++) {
+    double start;
+
+    Generate(in, rate / 100, i, &seed);
+    start = Now();
+    WebRtcNsx_Process(nsx, in, NULL, out, NULL);
+    total += Now() - start;
+  }
+  WebRtcNsx_Free(nsx);
+
+  return total / frames;
+}
+
+int main(int argc, char** argv) {
+  static const int rates[] = { 8000, 16000 };
+  int frames = argc > 1 ? atoi(argv[1]) : kDefaultFrames;
+  size_t i;
+
+  if (frames <= 0) {
+    fprintf(stderr, "Usage: %s [frames]\n", argv[0]);
+    return 1;
+  }
+
+  host_cpu_info = WebRtc_GetCPUInfo;
+
+  printf("%-6s %-10s %12s\n", "rate", "suppressor", "ns/frame");
+  for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    int rate = rates[i];
+
+    printf("%-6d %-10s %12.0f\n",
+           rate,
+           "float-c",
+           BenchFloat(rate, frames, WebRtc_GetCPUInfoNoASM));
+    printf("%-6d %-10s %12.0f\n",
+           rate,
+           "nsx-c",
+           BenchFixed(rate, frames, WebRtc_GetCPUInfoNoASM));
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (host_cpu_info(kSSE2)) {
+      printf("%-6d %-10s %12.0f\n",
+             rate,
+             "float-sse2",
+             BenchFloat(rate, frames, SSE2Only));
+      printf("%-6d %-10s %12.0f\n",
+             rate,
+             "nsx-sse2",
+             BenchFixed(rate, frames, SSE2Only));
+    }
+    if (host_cpu_info(kAVX2)) {
+      printf("%-6d %-10s %12.0f\n",
+             rate,
+             "float-avx2",
+             BenchFloat(rate, frames, host_cpu_info));
+    }
+#endif
+  }
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Cost of setting up a session's worth of audio processing: for each of the
+ * two channels of a Unit, an AEC, an AGC and an NS, created and initialized
+ * as Channel does.  The AGC shares its gain table with the live instances of
+ * the same settings, see WebRtcAgc_AcquireGainTable(), so the first session
+ * is timed apart from the ones created while it is still alive.
+ *
+ *   calc     WebRtcAgc_CalculateGainTable() alone, in ns
+ *   agc      AGC part of a session, in ns
+ *   session  whole session, in ns
+ *
+ * Usage: session_bench [sessions]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "aec/include/echo_cancellation.h"
+#include "agc/digital_agc.h"
+#include "agc/include/gain_control.h"
+#include "ns/include/noise_suppression.h"
+
+static const int kDefaultSessions = 2000;
+static const int kChannels = 2;
+static const int kRate = 8000;
+
+typedef struct {
+  void* aec;
+  void* agc;
+  NsHandle* ns;
+} Channel;
+
+static double Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Same settings as Channel::Init(), adds the time spent on the AGC to
+// |agc_cost|.
+static void Create(Channel* ch, double* agc_cost) {
+  AecConfig config;
+  double start;
+
+  config.nlpMode = kAecNlpModerate;
+  config.skewMode = kAecFalse;
+  config.metricsMode = kAecMetricsLight;
+  config.delay_logging = kAecTrue;
+  config.delay_agnostic = kAecTrue;
+  config.post_filter = kAecPostFilterOff;
+  if (WebRtcAec_Create(&ch->aec) != 0 ||
+      WebRtcAec_Init(ch->aec, kRate, kRate) != 0 ||
+      WebRtcAec_set_config(ch->aec, config) != 0) {
+    abort();
+  }
+  start = Now();
+  if (WebRtcAgc_Create(&ch->agc) != 0 ||
+      WebRtcAgc_Init(ch->agc, 0, 255, kAgcModeAdaptiveAnalog, kRate) != 0) {
+    abort();
+  }
+  *agc_cost += Now() - start;
+  if (WebRtcNs_Create(&ch->ns) != 0 || WebRtcNs_Init(ch->ns, kRate) != 0) {
+    abort();
+  }
+}
+
+static void Free(Channel* ch) {
+  WebRtcAec_Free(ch->aec);
+  WebRtcAgc_Free(ch->agc);
+  WebRtcNs_Free(ch->ns);
+}
+
+// Times |sessions| sessions created one after the other.  With |keep| they
+// stay alive until all are created, otherwise each one is gone before the
+// next, so that nothing is shared.
+static void Run(int sessions, int keep, double* agc_cost, double* cost) {
+  Channel* channels = malloc(sizeof(*channels) * kChannels * sessions);
+  int i, j;
+
+  *agc_cost = 0;
+  *cost = 0;
+  for (i = 0; i < sessions; i++) {
+    Channel* session = &channels[i * kChannels];
+    double start = Now();
+    double agc = 0;
+
+    for (j = 0; j < kChannels; j++) {
+      Create(&session[j], &agc);
+    }
+    *cost += Now() - start;
+    *agc_cost += agc;
+    if (!keep) {
+      for (j = 0; j < kChannels; j++) {
+        Free(&session[j]);
+      }
+    }
+  }
+  if (keep) {
+    for (i = 0; i < kChannels * sessions; i++) {
+      Free(&channels[i]);
+    }
+  }
+  free(channels);
+
+  *agc_cost /= sessions;
+  *cost /= sessions;
+}
+
+int main(int argc, char** argv) {
+  int sessions = argc > 1 ? atoi(argv[1]) : kDefaultSessions;
+  int32_t table[32];
+  double calc;
+  double agc;
+  double cost;
+  double start;
+  int i;
+
+  if (sessions <= 0) {
+    fprintf(stderr, "Usage: %s [sessions]\n", argv[0]);
+    return 1;
+  }
+
+  start = Now();
+  for (i = 0; i < sessions; i++) {
+    // Default settings and the analog target they lead to.
+    WebRtcAgc_CalculateGainTable(table, 9, 3, kAgcTrue, 9);
+  }
+  calc = (Now() - start) / sessions;
+
+  printf("%-8s %10s %10s %10s\n", "sessions", "calc", "agc", "session");
+  Run(sessions, 0, &agc, &cost);
+  printf("%-8s %10.0f %10.0f %10.0f\n", "alone", calc, agc, cost);
+  Run(sessions, 1, &agc, &cost);
+  printf("%-8s %10.0f %10.0f %10.0f\n", "shared", calc, agc, cost);
+
+  return 0;
+}
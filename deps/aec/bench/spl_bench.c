@@ -0,0 +1,308 @@
+/*
+ * Per-call cost of the signal processing library primitives that have x86
+ * versions, on each code path, in ns.  The vectors are 256 samples, an NSX
+ * analysis block at 16 kHz; the cross-correlation is 32 lags of 160 samples
+ * and the downsampler a 32-tap filter, decimating 160 samples by two.
+ *
+ * The second table is the cost of a QMF analysis and synthesis of a 10 ms
+ * frame at 32 kHz for 1, 2 and 4 channels, with WebRtcSpl_AnalysisQMFMulti()
+ * on each path and with WebRtcSpl_AnalysisQMF() once per channel ("single").
+ * The third is the cost of resampling 10 ms of one channel between common
+ * device rates and 16 kHz.  The last is the cost of the real forward and
+ * inverse FFTs of orders 7 and 8, the sizes the fixed-point NS runs at.
+ *
+ * Usage: spl_bench [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "signal_processing/include/real_fft.h"
+#include "signal_processing/include/signal_processing_library.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+static const int kDefaultCalls = 200000;
+enum { kLength = 256, kLags = 32, kTaps = 32 };
+
+typedef struct {
+  const char* name;
+  MaxAbsValueW16 max_abs_w16;
+  MaxValueW32 max_w32;
+  CrossCorrelation cross_correlation;
+  DownsampleFast downsample_fast;
+  ScaleAndAddVectorsWithRound scale_and_add;
+  AllPassQMFMulti all_pass_qmf;
+  PolyphaseFIR polyphase_fir;
+  RealForwardFFT real_forward_fft;
+  RealInverseFFT real_inverse_fft;
+} Path;
+
+static double Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// |sink| keeps the calls from being optimized away.
+static void Bench(const Path* path, int calls, double cost[5]) {
+  int16_t w16[kLength + kTaps];
+  int16_t w16b[kLength];
+  int32_t w32[kLength];
+  int16_t taps[kTaps];
+  int16_t out[kLength];
+  int32_t corr[kLags];
+  unsigned seed = 1;
+  volatile int32_t sink = 0;
+  double start;
+  int i;
+
+  for (i = 0; i < kLength + kTaps; i++) {
+    seed = seed * 1103515245u + 12345u;
+    w16[i] = (int16_t) (seed >> 16);
+  }
+  for (i = 0; i < kLength; i++) {
+    w16b[i] = w16[kLength - 1 - i];
+    w32[i] = w16[i] * 4099;
+  }
+  for (i = 0; i < kTaps; i++) {
+    taps[i] = (int16_t) (4096 / kTaps);
+  }
+
+  start = Now();
+  for (i = 0; i < calls; i++) {
+    sink += path->max_abs_w16(w16, kLength);
+  }
+  cost[0] = (Now() - start) / calls;
+  start = Now();
+  for (i = 0; i < calls; i++) {
+    sink += path->max_w32(w32, kLength);
+  }
+  cost[1] = (Now() - start) / calls;
+  start = Now();
+  for (i = 0; i < calls; i++) {
+    path->cross_correlation(corr, w16, w16b, 160, kLags, 2, 1);
+    sink += corr[0];
+  }
+  cost[2] = (Now() - start) / calls;
+  start = Now();
+  for (i = 0; i < calls; i++) {
+    path->downsample_fast(&w16[kTaps - 1], 160, out, 80, taps, kTaps, 2, 0);
+    sink += out[0];
+  }
+  cost[3] = (Now() - start) / calls;
+  start = Now();
+  for (i = 0; i < calls; i++) {
+    path->scale_and_add(w16, 16384, w16b, 8192, 15, out, kLength);
+    sink += out[0];
+  }
+  cost[4] = (Now() - start) / calls;
+}
+
+// |path| NULL splits the channels one by one.
+static void BenchQMF(const Path* path, int calls, double cost[3]) {
+  static const int kChannels[3] = { 1, 2, 4 };
+  enum { kFrame = 320 };
+  int16_t in[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame];
+  int16_t low[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame / 2];
+  int16_t high[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame / 2];
+  int16_t* low_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int16_t* high_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int16_t* out_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  const int16_t* in_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int32_t single[WEBRTC_SPL_QMF_MAX_CHANNELS][4][6] = { { { 0 } } };
+  QMFState analysis = { { { 0 } } };
+  QMFState synthesis = { { { 0 } } };
+  unsigned seed = 1;
+  volatile int32_t sink = 0;
+  int i, c, n;
+
+  for (c = 0; c < WEBRTC_SPL_QMF_MAX_CHANNELS; c++) {
+    for (i = 0; i < kFrame; i++) {
+      seed = seed * 1103515245u + 12345u;
+      in[c][i] = (int16_t) (seed >> 18);
+    }
+    in_ptr[c] = in[c];
+    low_ptr[c] = low[c];
+    high_ptr[c] = high[c];
+    out_ptr[c] = in[c];
+  }
+  if (path != NULL) {
+    WebRtcSpl_AllPassQMFMulti = path->all_pass_qmf;
+  }
+
+  for (n = 0; n < 3; n++) {
+    const int channels = kChannels[n];
+    double start = Now();
+
+    for (i = 0; i < calls; i++) {
+      if (path != NULL) {
+        WebRtcSpl_AnalysisQMFMulti(in_ptr, channels, kFrame, low_ptr,
+                                   high_ptr, &analysis);
+        WebRtcSpl_SynthesisQMFMulti((const int16_t* const*) low_ptr,
+                                    (const int16_t* const*) high_ptr,
+                                    channels, kFrame / 2, out_ptr,
+                                    &synthesis);
+      } else {
+        for (c = 0; c < channels; c++) {
+          WebRtcSpl_AnalysisQMF(in[c], kFrame, low[c], high[c],
+                                single[c][0], single[c][1]);
+          WebRtcSpl_SynthesisQMF(low[c], high[c], kFrame / 2, in[c],
+                                 single[c][2], single[c][3]);
+        }
+      }
+      sink += in[0][0];
+    }
+    cost[n] = (Now() - start) / calls;
+  }
+}
+
+static void BenchResampler(const Path* path, int calls, double cost[3]) {
+  static const int kRates[3][2] = {
+    { 48000, 16000 }, { 16000, 48000 }, { 44100, 16000 }
+  };
+  int16_t in[480];
+  int16_t out[480];
+  unsigned seed = 1;
+  volatile int32_t sink = 0;
+  int i, n;
+
+  for (i = 0; i < 480; i++) {
+    seed = seed * 1103515245u + 12345u;
+    in[i] = (int16_t) (seed >> 18);
+  }
+  WebRtcSpl_PolyphaseFIR = path->polyphase_fir;
+
+  for (n = 0; n < 3; n++) {
+    struct PolyphaseResampler* resampler =
+        WebRtcSpl_CreatePolyphaseResampler(kRates[n][0], kRates[n][1], 1);
+    double start = Now();
+
+    for (i = 0; i < calls; i++) {
+      sink += WebRtcSpl_ResamplePolyphase(resampler, 0, in,
+                                          kRates[n][0] / 100, out);
+    }
+    cost[n] = (Now() - start) / calls;
+    WebRtcSpl_FreePolyphaseResampler(resampler);
+  }
+}
+
+static void BenchFFT(const Path* path, int calls, double cost[4]) {
+  int16_t in[2 << kMaxFFTOrder];
+  int16_t out[2 << kMaxFFTOrder];
+  unsigned seed = 1;
+  volatile int32_t sink = 0;
+  int i, n;
+
+  for (i = 0; i < (2 << kMaxFFTOrder); i++) {
+    seed = seed * 1103515245u + 12345u;
+    in[i] = (int16_t) (seed >> 18);
+  }
+
+  for (n = 0; n < 2; n++) {
+    struct RealFFT* fft = WebRtcSpl_CreateRealFFTC(7 + n);
+    double start = Now();
+
+    for (i = 0; i < calls; i++) {
+      sink += path->real_forward_fft(fft, in, out);
+    }
+    cost[2 * n] = (Now() - start) / calls;
+    start = Now();
+    for (i = 0; i < calls; i++) {
+      sink += path->real_inverse_fft(fft, in, out);
+    }
+    cost[2 * n + 1] = (Now() - start) / calls;
+    WebRtcSpl_FreeRealFFTC(fft);
+  }
+}
+
+int main(int argc, char** argv) {
+  int calls = argc > 1 ? atoi(argv[1]) : kDefaultCalls;
+  Path paths[3];
+  int count = 0;
+  int j;
+
+  if (calls <= 0) {
+    fprintf(stderr, "Usage: %s [calls]\n", argv[0]);
+    return 1;
+  }
+  // The inverse FFTs scale through WebRtcSpl_MaxAbsValueW16().
+  WebRtcSpl_Init();
+
+  paths[count].name = "c";
+  paths[count].max_abs_w16 = WebRtcSpl_MaxAbsValueW16C;
+  paths[count].max_w32 = WebRtcSpl_MaxValueW32C;
+  paths[count].cross_correlation = WebRtcSpl_CrossCorrelationC;
+  paths[count].downsample_fast = WebRtcSpl_DownsampleFastC;
+  paths[count].scale_and_add = WebRtcSpl_ScaleAndAddVectorsWithRoundC;
+  paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiC;
+  paths[count].polyphase_fir = WebRtcSpl_PolyphaseFIRC;
+  paths[count].real_forward_fft = WebRtcSpl_RealForwardFFTC;
+  paths[count++].real_inverse_fft = WebRtcSpl_RealInverseFFTC;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    paths[count].name = "sse2";
+    paths[count].max_abs_w16 = WebRtcSpl_MaxAbsValueW16SSE2;
+    paths[count].max_w32 = WebRtcSpl_MaxValueW32SSE2;
+    paths[count].cross_correlation = WebRtcSpl_CrossCorrelationSSE2;
+    paths[count].downsample_fast = WebRtcSpl_DownsampleFastSSE2;
+    paths[count].scale_and_add = WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2;
+    paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiSSE2;
+    paths[count].polyphase_fir = WebRtcSpl_PolyphaseFIRSSE2;
+    paths[count].real_forward_fft = WebRtcSpl_RealForwardFFTSSE2;
+    paths[count++].real_inverse_fft = WebRtcSpl_RealInverseFFTSSE2;
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    paths[count].name = "avx2";
+    paths[count].max_abs_w16 = WebRtcSpl_MaxAbsValueW16AVX2;
+    paths[count].max_w32 = WebRtcSpl_MaxValueW32AVX2;
+    paths[count].cross_correlation = WebRtcSpl_CrossCorrelationAVX2;
+    paths[count].downsample_fast = WebRtcSpl_DownsampleFastAVX2;
+    paths[count].scale_and_add = WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2;
+    paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiAVX2;
+    paths[count].polyphase_fir = WebRtcSpl_PolyphaseFIRAVX2;
+    paths[count].real_forward_fft = WebRtcSpl_RealForwardFFTAVX2;
+    paths[count++].real_inverse_fft = WebRtcSpl_RealInverseFFTAVX2;
+  }
+#endif
+
+  printf("%-6s %10s %10s %10s %10s %10s\n",
+         "path", "maxabs16", "max32", "xcorr", "downsample", "scaleadd");
+  for (j = 0; j < count; j++) {
+    double cost[5];
+
+    Bench(&paths[j], calls, cost);
+    printf("%-6s %10.1f %10.1f %10.1f %10.1f %10.1f\n", paths[j].name,
+           cost[0], cost[1], cost[2], cost[3], cost[4]);
+  }
+
+  printf("\n%-6s %10s %10s %10s\n", "path", "qmf1", "qmf2", "qmf4");
+  for (j = -1; j < count; j++) {
+    double cost[3];
+
+    BenchQMF(j < 0 ? NULL : &paths[j], calls / 10, cost);
+    printf("%-6s %10.1f %10.1f %10.1f\n", j < 0 ? "single" : paths[j].name,
+           cost[0], cost[1], cost[2]);
+  }
+
+  printf("\n%-6s %10s %10s %10s\n", "path", "48to16", "16to48", "44to16");
+  for (j = 0; j < count; j++) {
+    double cost[3];
+
+    BenchResampler(&paths[j], calls / 10, cost);
+    printf("%-6s %10.1f %10.1f %10.1f\n", paths[j].name,
+           cost[0], cost[1], cost[2]);
+  }
+
+  printf("\n%-6s %10s %10s %10s %10s\n",
+         "path", "fwd128", "inv128", "fwd256", "inv256");
+  for (j = 0; j < count; j++) {
+    double cost[4];
+
+    BenchFFT(&paths[j], calls / 10, cost);
+    printf("%-6s %10.1f %10.1f %10.1f %10.1f\n", paths[j].name,
+           cost[0], cost[1], cost[2], cost[3]);
+  }
+
+  return 0;
+}
@@ -116,6 +116,18 @@ int WebRtcNs_Process(NsHandle* NS_inst,
  */
 float WebRtcNs_prior_speech_probability(NsHandle* handle);
 
+/* Returns the speech probability of the last processed frame, averaged over
+ * the frequency bins. Frames of zeros are not analyzed and have a probability
+ * of 0.
+ *
+ * Input
+ *      - handle        : Noise suppression instance.
+ *
+ * Return value         : Speech probability in interval [0.0, 1.0].
+ *                        -1 - NULL pointer or uninitialized instance.
+ */
+float WebRtcNs_speech_probability(NsHandle* handle);
+
 #ifdef __cplusplus
 }
 #endif
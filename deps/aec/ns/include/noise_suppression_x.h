@@ -102,6 +102,19 @@ int WebRtcNsx_Process(NsxHandle* nsxInst,
                       short* outFrame,
                       short* outFrameHB);
 
+/*
+ * Returns the speech probability of the last processed frame, averaged over
+ * the frequency bins. Frames of zeros are not analyzed and have a probability
+ * of 0.
+ *
+ * Input
+ *      - nsxInst       : NSx instance.
+ *
+ * Return value         : Speech probability in interval [0.0, 1.0].
+ *                        -1 - NULL pointer or uninitialized instance.
+ */
+float WebRtcNsx_speech_probability(NsxHandle* nsxInst);
+
 #ifdef __cplusplus
 }
 #endif
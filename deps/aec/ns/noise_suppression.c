@@ -59,3 +59,14 @@ float WebRtcNs_prior_speech_probability(NsHandle* handle) {
   }
   return self->priorSpeechProb;
 }
+
+float WebRtcNs_speech_probability(NsHandle* handle) {
+  NSinst_t* self = (NSinst_t*) handle;
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->initFlag == 0) {
+    return -1;
+  }
+  return self->speechProb;
+}
@@ -51,3 +51,11 @@ int WebRtcNsx_Process(NsxHandle* nsxInst, short* speechFrame,
   return WebRtcNsx_ProcessCore(
       (NsxInst_t*)nsxInst, speechFrame, speechFrameHB, outFrame, outFrameHB);
 }
+
+float WebRtcNsx_speech_probability(NsxHandle* nsxInst) {
+  NsxInst_t* self = (NsxInst_t*)nsxInst;
+  if (self == NULL || self->initFlag == 0) {
+    return -1;
+  }
+  return self->speechProb / 256.f;
+}
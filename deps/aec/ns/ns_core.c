@@ -15,8 +15,19 @@
 #include "signal_processing/include/signal_processing_library.h"
 #include "ns/include/noise_suppression.h"
 #include "ns/ns_core.h"
+#include "ns/ns_rdft.h"
 #include "ns/windows_private.h"
-#include "webrtc/fft4g.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+// Generic C versions of the function pointers in ns_core.h.
+static void NoiseEstimationC(NSinst_t* inst, float* magn, float* noise);
+static int SumLogMagnitudeC(const float* in, int len, float* sum);
+static float UpdateLogLrtC(NSinst_t* inst,
+                           const float* snrLocPrior,
+                           const float* snrLocPost);
+static void SpeechProbabilityC(const NSinst_t* inst,
+                               float gainPrior,
+                               float* probSpeechFinal);
 
 // Set Feature Extraction Parameters
 void WebRtcNs_set_feature_extraction_parameters(NSinst_t* inst) {
@@ -108,10 +119,8 @@ int WebRtcNs_InitCore(NSinst_t* inst, uint32_t fs) {
   }
   inst->magnLen = inst->anaLen / 2 + 1; // Number of frequency bins
 
-  // Initialize fft work arrays.
-  inst->ip[0] = 0; // Setting this triggers initialization.
-  memset(inst->dataBuf, 0, sizeof(float) * ANAL_BLOCKL_MAX);
-  WebRtc_rdft(inst->anaLen, 1, inst->dataBuf, inst->ip, inst->wfft);
+  // Pick the fft code path, its tables are constant.
+  ns_rdft_init();
 
   memset(inst->dataBuf, 0, sizeof(float) * ANAL_BLOCKL_MAX);
   memset(inst->syntBuf, 0, sizeof(float) * ANAL_BLOCKL_MAX);
@@ -142,6 +151,7 @@ int WebRtcNs_InitCore(NSinst_t* inst, uint32_t fs) {
 
   //initialize variables for new method
   inst->priorSpeechProb = (float)0.5; //prior prob for speech/noise
+  inst->speechProb = (float)0.0;
   for (i = 0; i < HALF_ANAL_BLOCKL; i++) {
     inst->magnPrev[i]      = (float)0.0; //previous mag spectrum
     inst->noisePrev[i]     = (float)0.0; //previous noise-spectrum
@@ -202,6 +212,21 @@ int WebRtcNs_InitCore(NSinst_t* inst, uint32_t fs) {
 
   memset(inst->outBuf, 0, sizeof(float) * 3 * BLOCKL_MAX);
 
+  // Initialize function pointers.
+  WebRtcNs_NoiseEstimation = NoiseEstimationC;
+  WebRtcNs_SumLogMagnitude = SumLogMagnitudeC;
+  WebRtcNs_UpdateLogLrt = UpdateLogLrtC;
+  WebRtcNs_SpeechProbability = SpeechProbabilityC;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNs_InitSSE2();
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    WebRtcNs_InitAVX2();
+  }
+#endif
+
   inst->initFlag = 1;
   return 0;
 }
@@ -237,7 +262,7 @@ int WebRtcNs_set_policy_core(NSinst_t* inst, int mode) {
 }
 
 // Estimate noise
-void WebRtcNs_NoiseEstimation(NSinst_t* inst, float* magn, float* noise) {
+static void NoiseEstimationC(NSinst_t* inst, float* magn, float* noise) {
   int i, s, offset;
   float lmagn[HALF_ANAL_BLOCKL], delta;
 
@@ -303,6 +328,61 @@ void WebRtcNs_NoiseEstimation(NSinst_t* inst, float* magn, float* noise) {
   }
 }
 
+// Sum of log(in[i]), returns -1 on the log(0) case
+static int SumLogMagnitudeC(const float* in, int len, float* sum) {
+  int i;
+
+  *sum = 0.0;
+  for (i = 0; i < len; i++) {
+    if (in[i] > 0.0) {
+      *sum += (float)log(in[i]);
+    } else {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// Time-smoothed log likelihood ratio factor for each frequency, returns its
+// sum over all frequencies
+static float UpdateLogLrtC(NSinst_t* inst,
+                           const float* snrLocPrior,
+                           const float* snrLocPost) {
+  int i;
+  float tmpFloat1, tmpFloat2, besselTmp;
+  float logLrtTimeAvgKsum = 0.0;
+
+  for (i = 0; i < inst->magnLen; i++) {
+    tmpFloat1 = (float)1.0 + (float)2.0 * snrLocPrior[i];
+    tmpFloat2 = (float)2.0 * snrLocPrior[i] / (tmpFloat1 + (float)0.0001);
+    besselTmp = (snrLocPost[i] + (float)1.0) * tmpFloat2;
+    inst->logLrtTimeAvg[i] += LRT_TAVG * (besselTmp - (float)log(tmpFloat1)
+                                          - inst->logLrtTimeAvg[i]);
+    logLrtTimeAvgKsum += inst->logLrtTimeAvg[i];
+  }
+  return logLrtTimeAvgKsum;
+}
+
+// Final speech probability: combine prior model with LR factor
+static void SpeechProbabilityC(const NSinst_t* inst,
+                               float gainPrior,
+                               float* probSpeechFinal) {
+  int i;
+  float invLrt;
+
+  for (i = 0; i < inst->magnLen; i++) {
+    invLrt = (float)exp(-inst->logLrtTimeAvg[i]);
+    invLrt = (float)gainPrior * invLrt;
+    probSpeechFinal[i] = (float)1.0 / ((float)1.0 + invLrt);
+  }
+}
+
+// Declare function pointers.
+WebRtcNs_NoiseEstimation_t WebRtcNs_NoiseEstimation;
+WebRtcNs_SumLogMagnitude_t WebRtcNs_SumLogMagnitude;
+WebRtcNs_UpdateLogLrt_t WebRtcNs_UpdateLogLrt;
+WebRtcNs_SpeechProbability_t WebRtcNs_SpeechProbability;
+
 // Extract thresholds for feature parameters
 // histograms are computed over some window_size (given by inst->modelUpdatePars[1])
 // thresholds and weights are extracted every window
@@ -541,13 +621,11 @@ void WebRtcNs_ComputeSpectralFlatness(NSinst_t* inst, float* magnIn) {
     avgSpectralFlatnessDen -= magnIn[i];
   }
   // compute log of ratio of the geometric to arithmetic mean: check for log(0) case
-  for (i = shiftLP; i < inst->magnLen; i++) {
-    if (magnIn[i] > 0.0) {
-      avgSpectralFlatnessNum += (float)log(magnIn[i]);
-    } else {
-      inst->featureData[0] -= SPECT_FL_TAVG * inst->featureData[0];
-      return;
-    }
+  if (WebRtcNs_SumLogMagnitude(magnIn + shiftLP,
+                               inst->magnLen - shiftLP,
+                               &avgSpectralFlatnessNum) != 0) {
+    inst->featureData[0] -= SPECT_FL_TAVG * inst->featureData[0];
+    return;
   }
   //normalize
   avgSpectralFlatnessDen = avgSpectralFlatnessDen / inst->magnLen;
@@ -609,11 +687,11 @@ void WebRtcNs_ComputeSpectralDifference(NSinst_t* inst, float* magnIn) {
 //snr loc_post is the post snr for each freq.
 void WebRtcNs_SpeechNoiseProb(NSinst_t* inst, float* probSpeechFinal, float* snrLocPrior,
                               float* snrLocPost) {
-  int i, sgnMap;
-  float invLrt, gainPrior, indPrior;
-  float logLrtTimeAvgKsum, besselTmp;
+  int sgnMap;
+  float gainPrior, indPrior;
+  float logLrtTimeAvgKsum;
   float indicator0, indicator1, indicator2;
-  float tmpFloat1, tmpFloat2;
+  float tmpFloat1;
   float weightIndPrior0, weightIndPrior1, weightIndPrior2;
   float threshPrior0, threshPrior1, threshPrior2;
   float widthPrior, widthPrior0, widthPrior1, widthPrior2;
@@ -638,15 +716,7 @@ void WebRtcNs_SpeechNoiseProb(NSinst_t* inst, float* probSpeechFinal, float* snr
 
   // compute feature based on average LR factor
   // this is the average over all frequencies of the smooth log lrt
-  logLrtTimeAvgKsum = 0.0;
-  for (i = 0; i < inst->magnLen; i++) {
-    tmpFloat1 = (float)1.0 + (float)2.0 * snrLocPrior[i];
-    tmpFloat2 = (float)2.0 * snrLocPrior[i] / (tmpFloat1 + (float)0.0001);
-    besselTmp = (snrLocPost[i] + (float)1.0) * tmpFloat2;
-    inst->logLrtTimeAvg[i] += LRT_TAVG * (besselTmp - (float)log(tmpFloat1)
-                                          - inst->logLrtTimeAvg[i]);
-    logLrtTimeAvgKsum += inst->logLrtTimeAvg[i];
-  }
+  logLrtTimeAvgKsum = WebRtcNs_UpdateLogLrt(inst, snrLocPrior, snrLocPost);
   logLrtTimeAvgKsum = (float)logLrtTimeAvgKsum / (inst->magnLen);
   inst->featureData[3] = logLrtTimeAvgKsum;
   // done with computation of LR factor
@@ -707,11 +777,7 @@ void WebRtcNs_SpeechNoiseProb(NSinst_t* inst, float* probSpeechFinal, float* snr
 
   //final speech probability: combine prior model with LR factor:
   gainPrior = ((float)1.0 - inst->priorSpeechProb) / (inst->priorSpeechProb + (float)0.0001);
-  for (i = 0; i < inst->magnLen; i++) {
-    invLrt = (float)exp(-inst->logLrtTimeAvg[i]);
-    invLrt = (float)gainPrior * invLrt;
-    probSpeechFinal[i] = (float)1.0 / ((float)1.0 + invLrt);
-  }
+  WebRtcNs_SpeechProbability(inst, gainPrior, probSpeechFinal);
 }
 
 int WebRtcNs_ProcessCore(NSinst_t* inst,
@@ -826,6 +892,8 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
       memset(inst->syntBuf + inst->anaLen - inst->blockLen, 0,
              sizeof(float) * inst->blockLen);
 
+      inst->speechProb = (float)0.0;
+
       // out buffer
       inst->outLen = inst->blockLen - inst->blockLen10ms;
       if (inst->blockLen > inst->blockLen10ms) {
@@ -863,7 +931,11 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
     //
     inst->blockInd++; // Update the block index only when we process a block.
     // FFT
-    WebRtc_rdft(inst->anaLen, 1, winData, inst->ip, inst->wfft);
+    if (inst->anaLen == 256) {
+      ns_rdft_forward_256(winData);
+    } else {
+      ns_rdft_forward_128(winData);
+    }
 
     imag[0] = 0;
     real[0] = winData[0];
@@ -1052,6 +1124,11 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
     }
     // compute speech/noise probability
     WebRtcNs_SpeechNoiseProb(inst, probSpeechFinal, snrLocPrior, snrLocPost);
+    inst->speechProb = (float)0.0;
+    for (i = 0; i < inst->magnLen; i++) {
+      inst->speechProb += probSpeechFinal[i];
+    }
+    inst->speechProb /= (float)inst->magnLen;
     // time-avg parameter for noise update
     gammaNoiseTmp = NOISE_UPDATE;
     for (i = 0; i < inst->magnLen; i++) {
@@ -1156,7 +1233,11 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
       winData[2 * i] = real[i];
       winData[2 * i + 1] = imag[i];
     }
-    WebRtc_rdft(inst->anaLen, -1, winData, inst->ip, inst->wfft);
+    if (inst->anaLen == 256) {
+      ns_rdft_inverse_256(winData);
+    } else {
+      ns_rdft_inverse_128(winData);
+    }
 
     for (i = 0; i < inst->anaLen; i++) {
       real[i] = 2.0f * winData[i] / inst->anaLen; // fft scaling
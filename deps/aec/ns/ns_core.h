@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_AUDIO_PROCESSING_NS_MAIN_SOURCE_NS_CORE_H_
 
 #include "ns/defines.h"
+#include "webrtc/typedefs.h"
 
 typedef struct NSParaExtract_t_ {
 
@@ -75,9 +76,6 @@ typedef struct NSinst_t_ {
   float           overdrive;
   float           denoiseBound;
   int             gainmap;
-  // fft work arrays.
-  int             ip[IP_LENGTH];
-  float           wfft[W_LENGTH];
 
   // parameters for new method: some not needed, will reduce/cleanup later
   int32_t         blockInd;                           //frame index counter
@@ -88,6 +86,7 @@ typedef struct NSinst_t_ {
   float           magnPrev[HALF_ANAL_BLOCKL];         //magnitude spectrum of previous frame
   float           logLrtTimeAvg[HALF_ANAL_BLOCKL];    //log lrt factor with time-smoothing
   float           priorSpeechProb;                    //prior speech/noise probability
+  float           speechProb;                         //average speech probability of last frame
   float           featureData[7];                     //data for features
   float           magnAvgPause[HALF_ANAL_BLOCKL];     //conservative noise spectrum estimate
   float           signalEnergy;                       //energy of magn
@@ -172,6 +171,46 @@ int WebRtcNs_ProcessCore(NSinst_t* inst,
                          short* outFrameLow,
                          short* outFrameHigh);
 
+/****************************************************************************
+ * Function pointers for the per-frequency loops that call log() and exp().
+ * The generic C versions are static in ns_core.c, the x86 ones approximate
+ * log and exp with polynomials instead.
+ */
+// Quantile noise estimation.
+typedef void (*WebRtcNs_NoiseEstimation_t)(NSinst_t* inst,
+                                           float* magn,
+                                           float* noise);
+extern WebRtcNs_NoiseEstimation_t WebRtcNs_NoiseEstimation;
+
+// Sum of log(in[i]) for |len| values in |sum|, for the spectral flatness.
+// Returns -1 if one of the values is not positive.
+typedef int (*WebRtcNs_SumLogMagnitude_t)(const float* in,
+                                          int len,
+                                          float* sum);
+extern WebRtcNs_SumLogMagnitude_t WebRtcNs_SumLogMagnitude;
+
+// Update of the time-smoothed log likelihood ratio of each frequency, returns
+// its sum over all frequencies.
+typedef float (*WebRtcNs_UpdateLogLrt_t)(NSinst_t* inst,
+                                         const float* snrLocPrior,
+                                         const float* snrLocPost);
+extern WebRtcNs_UpdateLogLrt_t WebRtcNs_UpdateLogLrt;
+
+// Final speech probability of each frequency, combining the prior model in
+// |gainPrior| with the likelihood ratio.
+typedef void (*WebRtcNs_SpeechProbability_t)(const NSinst_t* inst,
+                                             float gainPrior,
+                                             float* probSpeechFinal);
+extern WebRtcNs_SpeechProbability_t WebRtcNs_SpeechProbability;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Install the SSE2 and AVX2 versions of the above function pointers, defined
+// in ns_core_sse2.c and ns_core_avx2.c.  Only called after a runtime CPU
+// check.
+void WebRtcNs_InitSSE2(void);
+void WebRtcNs_InitAVX2(void);
+#endif
+
 
 #ifdef __cplusplus
 }
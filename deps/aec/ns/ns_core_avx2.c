@@ -0,0 +1,333 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core NS functions, AVX2 versions.  Same approximations as in
+ * ns_core_sse2.c, eight frequencies at a time.
+ */
+
+#include "ns/ns_core.h"
+
+#include <immintrin.h>
+#include <math.h>
+#include <string.h>
+
+// Natural logarithm of eight positive floats.
+static __m256 mm256_log_ps(__m256 x) {
+  // x = m * 2^e with m in [sqrt(1/2), sqrt(2)), then log(x) = log(m) + e *
+  // log(2) where log(1 + f) = f - f^2 / 2 + f^3 * P(f) is the minimax
+  // polynomial from Cephes. Its maximum relative error is below 1e-7 for
+  // normal floats, this code is never given zero or denormals.
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256i bits = _mm256_castps_si256(x);
+  __m256 e = _mm256_cvtepi32_ps(
+      _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+  __m256 m = _mm256_castsi256_ps(_mm256_or_si256(
+      _mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)),
+      _mm256_set1_epi32(0x3F000000)));  // in [0.5, 1)
+  const __m256 small =
+      _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+  __m256 f, z, y;
+
+  // Move m below sqrt(1/2) up an octave so that f = m - 1 is centered.
+  e = _mm256_sub_ps(e, _mm256_and_ps(small, one));
+  f = _mm256_add_ps(_mm256_sub_ps(m, one), _mm256_and_ps(small, m));
+  z = _mm256_mul_ps(f, f);
+
+  y = _mm256_set1_ps(7.0376836292e-2f);
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(-1.1514610310e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(1.1676998740e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(-1.2420140846e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(1.4249322787e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(-1.6668057665e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(2.0000714765e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(-2.4999993993e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, f), _mm256_set1_ps(3.3333331174e-1f));
+  y = _mm256_mul_ps(_mm256_mul_ps(y, f), z);
+
+  // log(2) is split in two parts to keep the precision of e * log(2).
+  y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+  y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+  return _mm256_add_ps(_mm256_add_ps(f, y),
+                       _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+}
+
+// Natural exponential of eight floats.
+static __m256 mm256_exp_ps(__m256 x) {
+  // exp(x) = 2^n * exp(r) with n = round(x / log(2)) and |r| <= log(2) / 2,
+  // exp(r) = 1 + r + r^2 * P(r) is the minimax polynomial from Cephes with a
+  // maximum relative error below 2e-7. The input is clamped so that 2^n stays
+  // a normal float: results saturate at about 1.2e-38 and 1.7e38.
+  __m256 fx, n, z, y;
+  __m256i n_int;
+
+  x = _mm256_min_ps(x, _mm256_set1_ps(88.0f));
+  x = _mm256_max_ps(x, _mm256_set1_ps(-87.3f));
+
+  // n = floor(x * log2(e) + 0.5)
+  fx = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                     _mm256_set1_ps(0.5f));
+  n = _mm256_floor_ps(fx);
+
+  x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+  x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+  z = _mm256_mul_ps(x, x);
+
+  y = _mm256_set1_ps(1.9875691500e-4f);
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507e-3f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073e-3f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894e-2f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459e-1f));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201e-1f));
+  y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, z), x),
+                    _mm256_set1_ps(1.0f));
+
+  n_int = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n_int, 23)));
+}
+
+static float mm256_hsum_ps(__m256 a) {
+  __m128 b = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  b = _mm_add_ps(b, _mm_movehl_ps(b, b));
+  b = _mm_add_ss(b, _mm_shuffle_ps(b, b, 1));
+  return _mm_cvtss_f32(b);
+}
+
+// The last |len| < 8 values of an array, padded with |fill|.
+static __m256 LoadTail(const float* in, int len, float fill) {
+  float tail[8] = { fill, fill, fill, fill, fill, fill, fill, fill };
+  memcpy(tail, in, sizeof(*in) * len);
+  return _mm256_loadu_ps(tail);
+}
+
+static void StoreTail(float* out, int len, __m256 v) {
+  float tail[8];
+  _mm256_storeu_ps(tail, v);
+  memcpy(out, tail, sizeof(*out) * len);
+}
+
+static void LogVector(const float* in, float* out, int len) {
+  int i;
+  for (i = 0; i + 8 <= len; i += 8) {
+    _mm256_storeu_ps(&out[i], mm256_log_ps(_mm256_loadu_ps(&in[i])));
+  }
+  if (i < len) {
+    StoreTail(&out[i], len - i, mm256_log_ps(LoadTail(&in[i], len - i, 1.0f)));
+  }
+}
+
+static void ExpVector(const float* in, float* out, int len) {
+  int i;
+  for (i = 0; i + 8 <= len; i += 8) {
+    _mm256_storeu_ps(&out[i], mm256_exp_ps(_mm256_loadu_ps(&in[i])));
+  }
+  if (i < len) {
+    StoreTail(&out[i], len - i, mm256_exp_ps(LoadTail(&in[i], len - i, 0.0f)));
+  }
+}
+
+// Estimate noise
+static void NoiseEstimationAVX2(NSinst_t* inst, float* magn, float* noise) {
+  int i, s, offset = 0;
+  float lmagn[HALF_ANAL_BLOCKL], delta;
+  const __m256 factor = _mm256_set1_ps(FACTOR);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 quantile_up = _mm256_set1_ps(QUANTILE);
+  const __m256 quantile_down = _mm256_set1_ps((float)1.0 - QUANTILE);
+  const __m256 width = _mm256_set1_ps(WIDTH);
+  const __m256 density_step = _mm256_set1_ps((float)1.0 / ((float)2.0 * WIDTH));
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+  if (inst->updates < END_STARTUP_LONG) {
+    inst->updates++;
+  }
+
+  LogVector(magn, lmagn, inst->magnLen);
+
+  // loop over simultaneous estimates
+  for (s = 0; s < SIMULT; s++) {
+    float* lquantile;
+    float* density;
+    const float counter = (float)inst->counter[s];
+    const float counter_plus_one = (float)(inst->counter[s] + 1);
+    const __m256 vec_counter = _mm256_set1_ps(counter);
+    const __m256 vec_counter_plus_one = _mm256_set1_ps(counter_plus_one);
+
+    offset = s * inst->magnLen;
+    lquantile = inst->lquantile + offset;
+    density = inst->density + offset;
+
+    // newquantest(...)
+    for (i = 0; i + 8 <= inst->magnLen; i += 8) {
+      const __m256 lm = _mm256_loadu_ps(&lmagn[i]);
+      __m256 lq = _mm256_loadu_ps(&lquantile[i]);
+      __m256 dens = _mm256_loadu_ps(&density[i]);
+      __m256 mask, vec_delta, up, down, near;
+
+      // compute delta
+      mask = _mm256_cmp_ps(dens, one, _CMP_GT_OQ);
+      vec_delta = _mm256_div_ps(factor, dens);
+      vec_delta = _mm256_or_ps(_mm256_and_ps(mask, vec_delta),
+                               _mm256_andnot_ps(mask, factor));
+
+      // update log quantile estimate
+      up = _mm256_mul_ps(quantile_up, vec_delta);
+      up = _mm256_add_ps(lq, _mm256_div_ps(up, vec_counter_plus_one));
+      down = _mm256_mul_ps(quantile_down, vec_delta);
+      down = _mm256_sub_ps(lq, _mm256_div_ps(down, vec_counter_plus_one));
+      mask = _mm256_cmp_ps(lm, lq, _CMP_GT_OQ);
+      lq = _mm256_or_ps(_mm256_and_ps(mask, up), _mm256_andnot_ps(mask, down));
+      _mm256_storeu_ps(&lquantile[i], lq);
+
+      // update density estimate
+      near = _mm256_and_ps(_mm256_sub_ps(lm, lq), abs_mask);
+      near = _mm256_cmp_ps(near, width, _CMP_LT_OQ);
+      vec_delta = _mm256_add_ps(_mm256_mul_ps(vec_counter, dens), density_step);
+      vec_delta = _mm256_div_ps(vec_delta, vec_counter_plus_one);
+      dens = _mm256_or_ps(_mm256_and_ps(near, vec_delta),
+                          _mm256_andnot_ps(near, dens));
+      _mm256_storeu_ps(&density[i], dens);
+    }
+    for (; i < inst->magnLen; i++) {
+      if (density[i] > 1.0) {
+        delta = FACTOR * (float)1.0 / density[i];
+      } else {
+        delta = FACTOR;
+      }
+      if (lmagn[i] > lquantile[i]) {
+        lquantile[i] += QUANTILE * delta / counter_plus_one;
+      } else {
+        lquantile[i] -= ((float)1.0 - QUANTILE) * delta / counter_plus_one;
+      }
+      if (fabs(lmagn[i] - lquantile[i]) < WIDTH) {
+        density[i] = (counter * density[i] + (float)1.0 / ((float)2.0 * WIDTH))
+                     / counter_plus_one;
+      }
+    }
+
+    if (inst->counter[s] >= END_STARTUP_LONG) {
+      inst->counter[s] = 0;
+      if (inst->updates >= END_STARTUP_LONG) {
+        ExpVector(lquantile, inst->quantile, inst->magnLen);
+      }
+    }
+
+    inst->counter[s]++;
+  }  // end loop over simultaneous estimates
+
+  // Sequentially update the noise during startup
+  if (inst->updates < END_STARTUP_LONG) {
+    // Use the last "s" to get noise during startup that differ from zero.
+    ExpVector(inst->lquantile + offset, inst->quantile, inst->magnLen);
+  }
+
+  memcpy(noise, inst->quantile, sizeof(*noise) * inst->magnLen);
+}
+
+static int SumLogMagnitudeAVX2(const float* in, int len, float* sum) {
+  const __m256 zero = _mm256_setzero_ps();
+  __m256 acc = zero;
+  __m256 x;
+  int i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    x = _mm256_loadu_ps(&in[i]);
+    if (_mm256_movemask_ps(_mm256_cmp_ps(x, zero, _CMP_LE_OQ)) != 0) {
+      return -1;
+    }
+    acc = _mm256_add_ps(acc, mm256_log_ps(x));
+  }
+  if (i < len) {
+    // Padding with ones adds log(1) = 0
+    x = LoadTail(&in[i], len - i, 1.0f);
+    if (_mm256_movemask_ps(_mm256_cmp_ps(x, zero, _CMP_LE_OQ)) != 0) {
+      return -1;
+    }
+    acc = _mm256_add_ps(acc, mm256_log_ps(x));
+  }
+
+  *sum = mm256_hsum_ps(acc);
+  return 0;
+}
+
+static __m256 UpdateLogLrtBlock(__m256 prior, __m256 post, __m256 lrt) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 two_prior = _mm256_add_ps(prior, prior);
+  const __m256 tmp1 = _mm256_add_ps(one, two_prior);
+  const __m256 tmp2 =
+      _mm256_div_ps(two_prior, _mm256_add_ps(tmp1, _mm256_set1_ps(0.0001f)));
+  const __m256 bessel = _mm256_mul_ps(_mm256_add_ps(post, one), tmp2);
+  const __m256 diff =
+      _mm256_sub_ps(_mm256_sub_ps(bessel, mm256_log_ps(tmp1)), lrt);
+  return _mm256_add_ps(lrt, _mm256_mul_ps(_mm256_set1_ps(LRT_TAVG), diff));
+}
+
+static float UpdateLogLrtAVX2(NSinst_t* inst,
+                              const float* snrLocPrior,
+                              const float* snrLocPost) {
+  const int len = inst->magnLen;
+  float* lrt = inst->logLrtTimeAvg;
+  __m256 acc = _mm256_setzero_ps();
+  __m256 v;
+  int i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    v = UpdateLogLrtBlock(_mm256_loadu_ps(&snrLocPrior[i]),
+                          _mm256_loadu_ps(&snrLocPost[i]),
+                          _mm256_loadu_ps(&lrt[i]));
+    _mm256_storeu_ps(&lrt[i], v);
+    acc = _mm256_add_ps(acc, v);
+  }
+  if (i < len) {
+    // Zero padding gives zero in the unused lanes
+    v = UpdateLogLrtBlock(LoadTail(&snrLocPrior[i], len - i, 0.0f),
+                          LoadTail(&snrLocPost[i], len - i, 0.0f),
+                          LoadTail(&lrt[i], len - i, 0.0f));
+    StoreTail(&lrt[i], len - i, v);
+    acc = _mm256_add_ps(acc, v);
+  }
+
+  return mm256_hsum_ps(acc);
+}
+
+static __m256 SpeechProbabilityBlock(__m256 gain_prior, __m256 lrt) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 neg_lrt = _mm256_sub_ps(_mm256_setzero_ps(), lrt);
+  const __m256 inv_lrt = _mm256_mul_ps(gain_prior, mm256_exp_ps(neg_lrt));
+  return _mm256_div_ps(one, _mm256_add_ps(one, inv_lrt));
+}
+
+static void SpeechProbabilityAVX2(const NSinst_t* inst,
+                                  float gainPrior,
+                                  float* probSpeechFinal) {
+  const int len = inst->magnLen;
+  const __m256 gain_prior = _mm256_set1_ps(gainPrior);
+  int i;
+
+  for (i = 0; i + 8 <= len; i += 8) {
+    _mm256_storeu_ps(&probSpeechFinal[i],
+                     SpeechProbabilityBlock(
+                         gain_prior, _mm256_loadu_ps(&inst->logLrtTimeAvg[i])));
+  }
+  if (i < len) {
+    StoreTail(&probSpeechFinal[i],
+              len - i,
+              SpeechProbabilityBlock(
+                  gain_prior,
+                  LoadTail(&inst->logLrtTimeAvg[i], len - i, 0.0f)));
+  }
+}
+
+void WebRtcNs_InitAVX2(void) {
+  WebRtcNs_NoiseEstimation = NoiseEstimationAVX2;
+  WebRtcNs_SumLogMagnitude = SumLogMagnitudeAVX2;
+  WebRtcNs_UpdateLogLrt = UpdateLogLrtAVX2;
+  WebRtcNs_SpeechProbability = SpeechProbabilityAVX2;
+}
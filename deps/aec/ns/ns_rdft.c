@@ -0,0 +1,362 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * Fixed length real FFTs for the noise suppressor.  Unlike WebRtc_rdft()
+ * there is no table setup at runtime: the twiddle factors and the bit
+ * reversal are compile-time constants.
+ */
+
+#include "ns/ns_rdft.h"
+
+#include "webrtc/cpu_features_wrapper.h"
+
+NS_ALIGN16_BEG const float NS_ALIGN16_END ns_rdft_twiddle[512] = {
+     0.0000000000f,  0.0000000000f,  1.0000000000f,  0.0000000000f,
+     1.0000000000f,  0.0000000000f,  0.0000000000f, -1.0000000000f,
+     1.0000000000f,  0.0000000000f,  0.7071067812f, -0.7071067812f,
+     0.0000000000f, -1.0000000000f, -0.7071067812f, -0.7071067812f,
+     1.0000000000f,  0.0000000000f,  0.9238795325f, -0.3826834324f,
+     0.7071067812f, -0.7071067812f,  0.3826834324f, -0.9238795325f,
+     0.0000000000f, -1.0000000000f, -0.3826834324f, -0.9238795325f,
+    -0.7071067812f, -0.7071067812f, -0.9238795325f, -0.3826834324f,
+     1.0000000000f,  0.0000000000f,  0.9807852804f, -0.1950903220f,
+     0.9238795325f, -0.3826834324f,  0.8314696123f, -0.5555702330f,
+     0.7071067812f, -0.7071067812f,  0.5555702330f, -0.8314696123f,
+     0.3826834324f, -0.9238795325f,  0.1950903220f, -0.9807852804f,
+     0.0000000000f, -1.0000000000f, -0.1950903220f, -0.9807852804f,
+    -0.3826834324f, -0.9238795325f, -0.5555702330f, -0.8314696123f,
+    -0.7071067812f, -0.7071067812f, -0.8314696123f, -0.5555702330f,
+    -0.9238795325f, -0.3826834324f, -0.9807852804f, -0.1950903220f,
+     1.0000000000f,  0.0000000000f,  0.9951847267f, -0.0980171403f,
+     0.9807852804f, -0.1950903220f,  0.9569403357f, -0.2902846773f,
+     0.9238795325f, -0.3826834324f,  0.8819212643f, -0.4713967368f,
+     0.8314696123f, -0.5555702330f,  0.7730104534f, -0.6343932842f,
+     0.7071067812f, -0.7071067812f,  0.6343932842f, -0.7730104534f,
+     0.5555702330f, -0.8314696123f,  0.4713967368f, -0.8819212643f,
+     0.3826834324f, -0.9238795325f,  0.2902846773f, -0.9569403357f,
+     0.1950903220f, -0.9807852804f,  0.0980171403f, -0.9951847267f,
+     0.0000000000f, -1.0000000000f, -0.0980171403f, -0.9951847267f,
+    -0.1950903220f, -0.9807852804f, -0.2902846773f, -0.9569403357f,
+    -0.3826834324f, -0.9238795325f, -0.4713967368f, -0.8819212643f,
+    -0.5555702330f, -0.8314696123f, -0.6343932842f, -0.7730104534f,
+    -0.7071067812f, -0.7071067812f, -0.7730104534f, -0.6343932842f,
+    -0.8314696123f, -0.5555702330f, -0.8819212643f, -0.4713967368f,
+    -0.9238795325f, -0.3826834324f, -0.9569403357f, -0.2902846773f,
+    -0.9807852804f, -0.1950903220f, -0.9951847267f, -0.0980171403f,
+     1.0000000000f,  0.0000000000f,  0.9987954562f, -0.0490676743f,
+     0.9951847267f, -0.0980171403f,  0.9891765100f, -0.1467304745f,
+     0.9807852804f, -0.1950903220f,  0.9700312532f, -0.2429801799f,
+     0.9569403357f, -0.2902846773f,  0.9415440652f, -0.3368898534f,
+     0.9238795325f, -0.3826834324f,  0.9039892931f, -0.4275550934f,
+     0.8819212643f, -0.4713967368f,  0.8577286100f, -0.5141027442f,
+     0.8314696123f, -0.5555702330f,  0.8032075315f, -0.5956993045f,
+     0.7730104534f, -0.6343932842f,  0.7409511254f, -0.6715589548f,
+     0.7071067812f, -0.7071067812f,  0.6715589548f, -0.7409511254f,
+     0.6343932842f, -0.7730104534f,  0.5956993045f, -0.8032075315f,
+     0.5555702330f, -0.8314696123f,  0.5141027442f, -0.8577286100f,
+     0.4713967368f, -0.8819212643f,  0.4275550934f, -0.9039892931f,
+     0.3826834324f, -0.9238795325f,  0.3368898534f, -0.9415440652f,
+     0.2902846773f, -0.9569403357f,  0.2429801799f, -0.9700312532f,
+     0.1950903220f, -0.9807852804f,  0.1467304745f, -0.9891765100f,
+     0.0980171403f, -0.9951847267f,  0.0490676743f, -0.9987954562f,
+     0.0000000000f, -1.0000000000f, -0.0490676743f, -0.9987954562f,
+    -0.0980171403f, -0.9951847267f, -0.1467304745f, -0.9891765100f,
+    -0.1950903220f, -0.9807852804f, -0.2429801799f, -0.9700312532f,
+    -0.2902846773f, -0.9569403357f, -0.3368898534f, -0.9415440652f,
+    -0.3826834324f, -0.9238795325f, -0.4275550934f, -0.9039892931f,
+    -0.4713967368f, -0.8819212643f, -0.5141027442f, -0.8577286100f,
+    -0.5555702330f, -0.8314696123f, -0.5956993045f, -0.8032075315f,
+    -0.6343932842f, -0.7730104534f, -0.6715589548f, -0.7409511254f,
+    -0.7071067812f, -0.7071067812f, -0.7409511254f, -0.6715589548f,
+    -0.7730104534f, -0.6343932842f, -0.8032075315f, -0.5956993045f,
+    -0.8314696123f, -0.5555702330f, -0.8577286100f, -0.5141027442f,
+    -0.8819212643f, -0.4713967368f, -0.9039892931f, -0.4275550934f,
+    -0.9238795325f, -0.3826834324f, -0.9415440652f, -0.3368898534f,
+    -0.9569403357f, -0.2902846773f, -0.9700312532f, -0.2429801799f,
+    -0.9807852804f, -0.1950903220f, -0.9891765100f, -0.1467304745f,
+    -0.9951847267f, -0.0980171403f, -0.9987954562f, -0.0490676743f,
+     1.0000000000f,  0.0000000000f,  0.9996988187f, -0.0245412285f,
+     0.9987954562f, -0.0490676743f,  0.9972904567f, -0.0735645636f,
+     0.9951847267f, -0.0980171403f,  0.9924795346f, -0.1224106752f,
+     0.9891765100f, -0.1467304745f,  0.9852776424f, -0.1709618888f,
+     0.9807852804f, -0.1950903220f,  0.9757021300f, -0.2191012402f,
+     0.9700312532f, -0.2429801799f,  0.9637760658f, -0.2667127575f,
+     0.9569403357f, -0.2902846773f,  0.9495281806f, -0.3136817404f,
+     0.9415440652f, -0.3368898534f,  0.9329927988f, -0.3598950365f,
+     0.9238795325f, -0.3826834324f,  0.9142097557f, -0.4052413140f,
+     0.9039892931f, -0.4275550934f,  0.8932243012f, -0.4496113297f,
+     0.8819212643f, -0.4713967368f,  0.8700869911f, -0.4928981922f,
+     0.8577286100f, -0.5141027442f,  0.8448535652f, -0.5349976199f,
+     0.8314696123f, -0.5555702330f,  0.8175848132f, -0.5758081914f,
+     0.8032075315f, -0.5956993045f,  0.7883464276f, -0.6152315906f,
+     0.7730104534f, -0.6343932842f,  0.7572088465f, -0.6531728430f,
+     0.7409511254f, -0.6715589548f,  0.7242470830f, -0.6895405447f,
+     0.7071067812f, -0.7071067812f,  0.6895405447f, -0.7242470830f,
+     0.6715589548f, -0.7409511254f,  0.6531728430f, -0.7572088465f,
+     0.6343932842f, -0.7730104534f,  0.6152315906f, -0.7883464276f,
+     0.5956993045f, -0.8032075315f,  0.5758081914f, -0.8175848132f,
+     0.5555702330f, -0.8314696123f,  0.5349976199f, -0.8448535652f,
+     0.5141027442f, -0.8577286100f,  0.4928981922f, -0.8700869911f,
+     0.4713967368f, -0.8819212643f,  0.4496113297f, -0.8932243012f,
+     0.4275550934f, -0.9039892931f,  0.4052413140f, -0.9142097557f,
+     0.3826834324f, -0.9238795325f,  0.3598950365f, -0.9329927988f,
+     0.3368898534f, -0.9415440652f,  0.3136817404f, -0.9495281806f,
+     0.2902846773f, -0.9569403357f,  0.2667127575f, -0.9637760658f,
+     0.2429801799f, -0.9700312532f,  0.2191012402f, -0.9757021300f,
+     0.1950903220f, -0.9807852804f,  0.1709618888f, -0.9852776424f,
+     0.1467304745f, -0.9891765100f,  0.1224106752f, -0.9924795346f,
+     0.0980171403f, -0.9951847267f,  0.0735645636f, -0.9972904567f,
+     0.0490676743f, -0.9987954562f,  0.0245412285f, -0.9996988187f,
+     0.0000000000f, -1.0000000000f, -0.0245412285f, -0.9996988187f,
+    -0.0490676743f, -0.9987954562f, -0.0735645636f, -0.9972904567f,
+    -0.0980171403f, -0.9951847267f, -0.1224106752f, -0.9924795346f,
+    -0.1467304745f, -0.9891765100f, -0.1709618888f, -0.9852776424f,
+    -0.1950903220f, -0.9807852804f, -0.2191012402f, -0.9757021300f,
+    -0.2429801799f, -0.9700312532f, -0.2667127575f, -0.9637760658f,
+    -0.2902846773f, -0.9569403357f, -0.3136817404f, -0.9495281806f,
+    -0.3368898534f, -0.9415440652f, -0.3598950365f, -0.9329927988f,
+    -0.3826834324f, -0.9238795325f, -0.4052413140f, -0.9142097557f,
+    -0.4275550934f, -0.9039892931f, -0.4496113297f, -0.8932243012f,
+    -0.4713967368f, -0.8819212643f, -0.4928981922f, -0.8700869911f,
+    -0.5141027442f, -0.8577286100f, -0.5349976199f, -0.8448535652f,
+    -0.5555702330f, -0.8314696123f, -0.5758081914f, -0.8175848132f,
+    -0.5956993045f, -0.8032075315f, -0.6152315906f, -0.7883464276f,
+    -0.6343932842f, -0.7730104534f, -0.6531728430f, -0.7572088465f,
+    -0.6715589548f, -0.7409511254f, -0.6895405447f, -0.7242470830f,
+    -0.7071067812f, -0.7071067812f, -0.7242470830f, -0.6895405447f,
+    -0.7409511254f, -0.6715589548f, -0.7572088465f, -0.6531728430f,
+    -0.7730104534f, -0.6343932842f, -0.7883464276f, -0.6152315906f,
+    -0.8032075315f, -0.5956993045f, -0.8175848132f, -0.5758081914f,
+    -0.8314696123f, -0.5555702330f, -0.8448535652f, -0.5349976199f,
+    -0.8577286100f, -0.5141027442f, -0.8700869911f, -0.4928981922f,
+    -0.8819212643f, -0.4713967368f, -0.8932243012f, -0.4496113297f,
+    -0.9039892931f, -0.4275550934f, -0.9142097557f, -0.4052413140f,
+    -0.9238795325f, -0.3826834324f, -0.9329927988f, -0.3598950365f,
+    -0.9415440652f, -0.3368898534f, -0.9495281806f, -0.3136817404f,
+    -0.9569403357f, -0.2902846773f, -0.9637760658f, -0.2667127575f,
+    -0.9700312532f, -0.2429801799f, -0.9757021300f, -0.2191012402f,
+    -0.9807852804f, -0.1950903220f, -0.9852776424f, -0.1709618888f,
+    -0.9891765100f, -0.1467304745f, -0.9924795346f, -0.1224106752f,
+    -0.9951847267f, -0.0980171403f, -0.9972904567f, -0.0735645636f,
+    -0.9987954562f, -0.0490676743f, -0.9996988187f, -0.0245412285f,
+};
+
+// Bit reversal of the 5-bit group index in ns_cft1st.  Shifted right by one
+// for m = 64, whose indices are one bit shorter.
+const unsigned char ns_rdft_bitrev32[32] = {
+    0, 16, 8, 24, 4, 20, 12, 28, 2, 18, 10, 26, 6, 22, 14, 30,
+    1, 17, 9, 25, 5, 21, 13, 29, 3, 19, 11, 27, 7, 23, 15, 31
+};
+
+// The first two stages have the trivial twiddle factors 1 and -i and are done
+// as one radix-4 butterfly.  Output group q reads the inputs at
+// r = bitrev(4 * q), r + m/2, r + m/4 and r + 3m/4.
+static void cft1st_C(float* z, const float* a, int m) {
+  const int shift = m == 128 ? 0 : 1;
+  int q;
+
+  for (q = 0; q < m / 4; q++) {
+    const float* x0 = &a[2 * (ns_rdft_bitrev32[q] >> shift)];
+    const float* x1 = x0 + m;
+    const float* x2 = x0 + m / 2;
+    const float* x3 = x2 + m;
+    float* y = &z[8 * q];
+    const float y0r = x0[0] + x1[0];
+    const float y0i = x0[1] + x1[1];
+    const float y1r = x0[0] - x1[0];
+    const float y1i = x0[1] - x1[1];
+    const float y2r = x2[0] + x3[0];
+    const float y2i = x2[1] + x3[1];
+    const float y3r = x2[0] - x3[0];
+    const float y3i = x2[1] - x3[1];
+
+    y[0] = y0r + y2r;
+    y[1] = y0i + y2i;
+    y[2] = y1r + y3i;
+    y[3] = y1i - y3r;
+    y[4] = y0r - y2r;
+    y[5] = y0i - y2i;
+    y[6] = y1r - y3i;
+    y[7] = y1i + y3r;
+  }
+}
+
+// (ur, ui), (vr, vi) = u + w * v, u - w * v
+#define BUTTERFLY(ur, ui, vr, vi, w)                 \
+  do {                                               \
+    const float tr = vr * (w)[0] - vi * (w)[1];      \
+    const float ti = vi * (w)[0] + vr * (w)[1];      \
+    vr = ur - tr;                                    \
+    vi = ui - ti;                                    \
+    ur = ur + tr;                                    \
+    ui = ui + ti;                                    \
+  } while (0)
+
+// The stages of span h and 2h are done together where possible, on four
+// values at a time, which saves a pass over |z|.  The arithmetic is the same
+// as for separate radix-2 stages.
+static void cftmdl_C(float* z, int m) {
+  int h, j, k;
+
+  for (h = 4; 2 * h < m; h <<= 2) {
+    const float* w1 = &ns_rdft_twiddle[2 * h];
+    const float* w2 = &ns_rdft_twiddle[4 * h];
+
+    for (k = 0; k < 2 * m; k += 8 * h) {
+      for (j = 0; j < 2 * h; j += 2) {
+        float* p = &z[k + j];
+        float x0r = p[0], x0i = p[1];
+        float x1r = p[2 * h], x1i = p[2 * h + 1];
+        float x2r = p[4 * h], x2i = p[4 * h + 1];
+        float x3r = p[6 * h], x3i = p[6 * h + 1];
+
+        BUTTERFLY(x0r, x0i, x1r, x1i, &w1[j]);
+        BUTTERFLY(x2r, x2i, x3r, x3i, &w1[j]);
+        BUTTERFLY(x0r, x0i, x2r, x2i, &w2[j]);
+        BUTTERFLY(x1r, x1i, x3r, x3i, &w2[j + 2 * h]);
+        p[0] = x0r;
+        p[1] = x0i;
+        p[2 * h] = x1r;
+        p[2 * h + 1] = x1i;
+        p[4 * h] = x2r;
+        p[4 * h + 1] = x2i;
+        p[6 * h] = x3r;
+        p[6 * h + 1] = x3i;
+      }
+    }
+  }
+  for (; h < m; h <<= 1) {
+    const float* w = &ns_rdft_twiddle[2 * h];
+
+    for (k = 0; k < 2 * m; k += 4 * h) {
+      for (j = 0; j < 2 * h; j += 2) {
+        float* p = &z[k + j];
+        float x0r = p[0], x0i = p[1];
+        float x1r = p[2 * h], x1i = p[2 * h + 1];
+
+        BUTTERFLY(x0r, x0i, x1r, x1i, &w[j]);
+        p[0] = x0r;
+        p[1] = x0i;
+        p[2 * h] = x1r;
+        p[2 * h + 1] = x1i;
+      }
+    }
+  }
+}
+
+#undef BUTTERFLY
+
+static void rftfsub_C(float* a, const float* z, int m) {
+  const float* w = &ns_rdft_twiddle[2 * m];
+  int k;
+
+  a[0] = z[0] + z[1];
+  a[1] = z[0] - z[1];
+  for (k = 1; k <= m / 2; k++) {
+    const float* zk = &z[2 * k];
+    const float* zm = &z[2 * (m - k)];
+    const float er = zk[0] + zm[0];
+    const float ei = zk[1] - zm[1];
+    const float dr = zk[0] - zm[0];
+    const float di = zk[1] + zm[1];
+    const float u = w[2 * k] * di + w[2 * k + 1] * dr;
+    const float v = w[2 * k] * dr - w[2 * k + 1] * di;
+
+    a[2 * k] = (er + u) * 0.5f;
+    a[2 * k + 1] = (v - ei) * 0.5f;
+    a[2 * (m - k)] = (er - u) * 0.5f;
+    a[2 * (m - k) + 1] = (v + ei) * 0.5f;
+  }
+}
+
+static void rftbsub_C(float* z, const float* a, int m) {
+  const float* w = &ns_rdft_twiddle[2 * m];
+  int k;
+
+  z[0] = (a[0] - a[1]) * 0.5f;
+  z[1] = (a[0] + a[1]) * 0.5f;
+  for (k = 1; k <= m / 2; k++) {
+    const float* ak = &a[2 * k];
+    const float* am = &a[2 * (m - k)];
+    const float sr = ak[0] + am[0];
+    const float dr = ak[0] - am[0];
+    const float si = ak[1] + am[1];
+    const float di = am[1] - ak[1];
+    const float u = w[2 * k] * si + w[2 * k + 1] * dr;
+    const float v = w[2 * k] * dr - w[2 * k + 1] * si;
+
+    z[2 * k] = (di + v) * 0.5f;
+    z[2 * k + 1] = (sr + u) * 0.5f;
+    z[2 * (m - k)] = (v - di) * 0.5f;
+    z[2 * (m - k) + 1] = (sr - u) * 0.5f;
+  }
+}
+
+static void Forward(float* a, int m) {
+  NS_ALIGN16_BEG float z[256] NS_ALIGN16_END;
+
+  ns_cft1st(z, a, m);
+  ns_cftmdl(z, m);
+  ns_rftfsub(a, z, m);
+}
+
+// The complex inverse FFT is a forward one on swapped real and imaginary
+// parts, the split step leaves them swapped and they are swapped back here.
+static void Inverse(float* a, int m) {
+  NS_ALIGN16_BEG float s[256] NS_ALIGN16_END;
+  NS_ALIGN16_BEG float z[256] NS_ALIGN16_END;
+  int k;
+
+  ns_rftbsub(s, a, m);
+  ns_cft1st(z, s, m);
+  ns_cftmdl(z, m);
+  for (k = 0; k < 2 * m; k += 2) {
+    a[k] = z[k + 1];
+    a[k + 1] = z[k];
+  }
+}
+
+void ns_rdft_forward_128(float* a) {
+  Forward(a, 64);
+}
+
+void ns_rdft_inverse_128(float* a) {
+  Inverse(a, 64);
+}
+
+void ns_rdft_forward_256(float* a) {
+  Forward(a, 128);
+}
+
+void ns_rdft_inverse_256(float* a) {
+  Inverse(a, 128);
+}
+
+// code path selection
+ns_cft1st_t ns_cft1st;
+ns_cftmdl_t ns_cftmdl;
+ns_rftfsub_t ns_rftfsub;
+ns_rftbsub_t ns_rftbsub;
+
+void ns_rdft_init(void) {
+  ns_cft1st = cft1st_C;
+  ns_cftmdl = cftmdl_C;
+  ns_rftfsub = rftfsub_C;
+  ns_rftbsub = rftbsub_C;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    ns_rdft_init_sse2();
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    ns_rdft_init_avx2();
+  }
+#endif
+}
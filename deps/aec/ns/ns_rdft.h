@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_NS_MAIN_SOURCE_NS_RDFT_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_NS_MAIN_SOURCE_NS_RDFT_H_
+
+#include "webrtc/typedefs.h"
+
+#ifdef _MSC_VER /* visual c++ */
+#define NS_ALIGN16_BEG __declspec(align(16))
+#define NS_ALIGN16_END
+#else /* gcc or icc */
+#define NS_ALIGN16_BEG
+#define NS_ALIGN16_END __attribute__((aligned(16)))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Real FFTs of the two NS analysis lengths, with the same input and output
+// layout as WebRtc_rdft() in webrtc/fft4g.h:
+//   forward: a[0] = R[0], a[1] = R[n/2], a[2 * k] = R[k], a[2 * k + 1] = -I[k]
+//   inverse: the same layout in, n/2 times the real signal out.
+// A real FFT of n points is done as a complex FFT of m = n/2 points on the
+// even/odd sample pairs, followed by a split step.
+void ns_rdft_forward_128(float* a);
+void ns_rdft_inverse_128(float* a);
+void ns_rdft_forward_256(float* a);
+void ns_rdft_inverse_256(float* a);
+
+// Twiddle factors W_2h^j = exp(-i * pi * j / h) for h = 1, 2, ..., 128 and
+// j < h, stored as (real, imag) pairs starting at ns_rdft_twiddle[2 * h].
+extern NS_ALIGN16_BEG const float NS_ALIGN16_END ns_rdft_twiddle[512];
+// 5-bit bit reversal, for the groups of four in ns_cft1st.
+extern const unsigned char ns_rdft_bitrev32[32];
+
+// code path selection function pointers
+// Loads |a| into |z| in bit reversed order and does the first two radix-2
+// stages of an m-point complex FFT.
+typedef void (*ns_cft1st_t)(float* z, const float* a, int m);
+extern ns_cft1st_t ns_cft1st;
+// Radix-2 stages of an m-point complex FFT, from butterflies of span 4 up to
+// span m/2.
+typedef void (*ns_cftmdl_t)(float* z, int m);
+extern ns_cftmdl_t ns_cftmdl;
+// Forward split step: m-point complex spectrum |z| to real spectrum |a|.
+typedef void (*ns_rftfsub_t)(float* a, const float* z, int m);
+extern ns_rftfsub_t ns_rftfsub;
+// Inverse split step: real spectrum |a| to m-point complex spectrum |z|, with
+// the real and imaginary parts swapped so that a forward complex FFT inverts
+// it.
+typedef void (*ns_rftbsub_t)(float* z, const float* a, int m);
+extern ns_rftbsub_t ns_rftbsub;
+
+// entry points
+void ns_rdft_init(void);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void ns_rdft_init_sse2(void);
+void ns_rdft_init_avx2(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_NS_MAIN_SOURCE_NS_RDFT_H_
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "ns/ns_rdft.h"
+
+#include <immintrin.h>
+
+// Four butterflies at once: z[j] and z[j + h] for j, ..., j + 3.
+static __inline void Butterfly(float* u, float* v, const float* w) {
+  const __m256 wv = _mm256_loadu_ps(w);
+  const __m256 uv = _mm256_loadu_ps(u);
+  const __m256 vv = _mm256_loadu_ps(v);
+  const __m256 v_swap = _mm256_permute_ps(vv, _MM_SHUFFLE(2, 3, 0, 1));
+  // tr = vr * wr - vi * wi, ti = vi * wr + vr * wi
+  const __m256 t = _mm256_addsub_ps(
+      _mm256_mul_ps(vv, _mm256_moveldup_ps(wv)),
+      _mm256_mul_ps(v_swap, _mm256_movehdup_ps(wv)));
+
+  _mm256_storeu_ps(u, _mm256_add_ps(uv, t));
+  _mm256_storeu_ps(v, _mm256_sub_ps(uv, t));
+}
+
+// Same stage order as cftmdl_C().
+static void cftmdl_AVX2(float* z, int m) {
+  int h, j, k;
+
+  for (h = 4; 2 * h < m; h <<= 2) {
+    const float* w1 = &ns_rdft_twiddle[2 * h];
+    const float* w2 = &ns_rdft_twiddle[4 * h];
+
+    for (k = 0; k < 2 * m; k += 8 * h) {
+      for (j = 0; j < 2 * h; j += 8) {
+        float* p = &z[k + j];
+
+        Butterfly(p, p + 2 * h, &w1[j]);
+        Butterfly(p + 4 * h, p + 6 * h, &w1[j]);
+        Butterfly(p, p + 4 * h, &w2[j]);
+        Butterfly(p + 2 * h, p + 6 * h, &w2[j + 2 * h]);
+      }
+    }
+  }
+  for (; h < m; h <<= 1) {
+    const float* w = &ns_rdft_twiddle[2 * h];
+
+    for (k = 0; k < 2 * m; k += 4 * h) {
+      for (j = 0; j < 2 * h; j += 8) {
+        Butterfly(&z[k + j], &z[k + j + 2 * h], &w[j]);
+      }
+    }
+  }
+}
+
+// Eight complex values starting at |p| as real and imaginary parts, in order
+// or reversed.
+static void Split(const float* p, __m256* re, __m256* im) {
+  const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256 lo = _mm256_permutevar8x32_ps(_mm256_loadu_ps(p), order);
+  const __m256 hi = _mm256_permutevar8x32_ps(_mm256_loadu_ps(p + 8), order);
+
+  *re = _mm256_permute2f128_ps(lo, hi, 0x20);
+  *im = _mm256_permute2f128_ps(lo, hi, 0x31);
+}
+
+static void SplitReversed(const float* p, __m256* re, __m256* im) {
+  const __m256i order = _mm256_setr_epi32(6, 4, 2, 0, 7, 5, 3, 1);
+  const __m256 lo = _mm256_permutevar8x32_ps(_mm256_loadu_ps(p), order);
+  const __m256 hi = _mm256_permutevar8x32_ps(_mm256_loadu_ps(p + 8), order);
+
+  *re = _mm256_permute2f128_ps(hi, lo, 0x20);
+  *im = _mm256_permute2f128_ps(hi, lo, 0x31);
+}
+
+static void Join(float* p, __m256 re, __m256 im) {
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  const __m256 lo = _mm256_permute2f128_ps(re, im, 0x20);
+  const __m256 hi = _mm256_permute2f128_ps(re, im, 0x31);
+
+  _mm256_storeu_ps(p, _mm256_permutevar8x32_ps(lo, order));
+  _mm256_storeu_ps(p + 8, _mm256_permutevar8x32_ps(hi, order));
+}
+
+static void JoinReversed(float* p, __m256 re, __m256 im) {
+  const __m256i order = _mm256_setr_epi32(3, 7, 2, 6, 1, 5, 0, 4);
+  const __m256 lo = _mm256_permute2f128_ps(re, im, 0x31);
+  const __m256 hi = _mm256_permute2f128_ps(re, im, 0x20);
+
+  _mm256_storeu_ps(p, _mm256_permutevar8x32_ps(lo, order));
+  _mm256_storeu_ps(p + 8, _mm256_permutevar8x32_ps(hi, order));
+}
+
+// Eight values of k at once, see rftfsub_SSE2().
+static void rftfsub_AVX2(float* a, const float* z, int m) {
+  const float* w = &ns_rdft_twiddle[2 * m];
+  const __m256 half = _mm256_set1_ps(0.5f);
+  int k;
+
+  a[0] = z[0] + z[1];
+  a[1] = z[0] - z[1];
+  for (k = 1; k <= m / 2; k += 8) {
+    __m256 wr, wi, zkr, zki, zmr, zmi;
+    __m256 er, ei, dr, di, u, v;
+
+    Split(&w[2 * k], &wr, &wi);
+    Split(&z[2 * k], &zkr, &zki);
+    SplitReversed(&z[2 * (m - k - 7)], &zmr, &zmi);
+    er = _mm256_add_ps(zkr, zmr);
+    ei = _mm256_sub_ps(zki, zmi);
+    dr = _mm256_sub_ps(zkr, zmr);
+    di = _mm256_add_ps(zki, zmi);
+    u = _mm256_add_ps(_mm256_mul_ps(wr, di), _mm256_mul_ps(wi, dr));
+    v = _mm256_sub_ps(_mm256_mul_ps(wr, dr), _mm256_mul_ps(wi, di));
+
+    Join(&a[2 * k],
+         _mm256_mul_ps(_mm256_add_ps(er, u), half),
+         _mm256_mul_ps(_mm256_sub_ps(v, ei), half));
+    JoinReversed(&a[2 * (m - k - 7)],
+                 _mm256_mul_ps(_mm256_sub_ps(er, u), half),
+                 _mm256_mul_ps(_mm256_add_ps(v, ei), half));
+  }
+}
+
+static void rftbsub_AVX2(float* z, const float* a, int m) {
+  const float* w = &ns_rdft_twiddle[2 * m];
+  const __m256 half = _mm256_set1_ps(0.5f);
+  int k;
+
+  z[0] = (a[0] - a[1]) * 0.5f;
+  z[1] = (a[0] + a[1]) * 0.5f;
+  for (k = 1; k <= m / 2; k += 8) {
+    __m256 wr, wi, akr, aki, amr, ami;
+    __m256 sr, dr, si, di, u, v;
+
+    Split(&w[2 * k], &wr, &wi);
+    Split(&a[2 * k], &akr, &aki);
+    SplitReversed(&a[2 * (m - k - 7)], &amr, &ami);
+    sr = _mm256_add_ps(akr, amr);
+    dr = _mm256_sub_ps(akr, amr);
+    si = _mm256_add_ps(aki, ami);
+    di = _mm256_sub_ps(ami, aki);
+    u = _mm256_add_ps(_mm256_mul_ps(wr, si), _mm256_mul_ps(wi, dr));
+    v = _mm256_sub_ps(_mm256_mul_ps(wr, dr), _mm256_mul_ps(wi, si));
+
+    // Imaginary part first, see ns_rftbsub_t.
+    Join(&z[2 * k],
+         _mm256_mul_ps(_mm256_add_ps(di, v), half),
+         _mm256_mul_ps(_mm256_add_ps(sr, u), half));
+    JoinReversed(&z[2 * (m - k - 7)],
+                 _mm256_mul_ps(_mm256_sub_ps(v, di), half),
+                 _mm256_mul_ps(_mm256_sub_ps(sr, u), half));
+  }
+}
+
+void ns_rdft_init_avx2(void) {
+  ns_cftmdl = cftmdl_AVX2;
+  ns_rftfsub = rftfsub_AVX2;
+  ns_rftbsub = rftbsub_AVX2;
+}
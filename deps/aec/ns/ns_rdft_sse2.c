@@ -0,0 +1,189 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "ns/ns_rdft.h"
+
+#include <emmintrin.h>
+
+static const NS_ALIGN16_BEG float NS_ALIGN16_END
+    k_neg_real[4] = {-0.f, 0.f, -0.f, 0.f};
+static const NS_ALIGN16_BEG float NS_ALIGN16_END
+    k_neg_last[4] = {0.f, 0.f, 0.f, -0.f};
+
+// One radix-4 butterfly per group, with x0 and x2 in one register and x1 and
+// x3 in the other.
+static void cft1st_SSE2(float* z, const float* a, int m) {
+  const __m128 neg_last = _mm_load_ps(k_neg_last);
+  const int shift = m == 128 ? 0 : 1;
+  int q;
+
+  for (q = 0; q < m / 4; q++) {
+    const float* x0 = &a[2 * (ns_rdft_bitrev32[q] >> shift)];
+    const __m128 x02 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                                                 (const __m64*) x0),
+                                    (const __m64*) (x0 + m / 2));
+    const __m128 x13 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(),
+                                                 (const __m64*) (x0 + m)),
+                                    (const __m64*) (x0 + 3 * m / 2));
+    const __m128 y02 = _mm_add_ps(x02, x13);
+    const __m128 y13 = _mm_sub_ps(x02, x13);
+    // (y0, y1) and (y2, -i * y3)
+    const __m128 y01 = _mm_shuffle_ps(y02, y13, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m128 y23 = _mm_xor_ps(
+        _mm_shuffle_ps(y02, y13, _MM_SHUFFLE(2, 3, 3, 2)), neg_last);
+
+    _mm_store_ps(&z[8 * q], _mm_add_ps(y01, y23));
+    _mm_store_ps(&z[8 * q + 4], _mm_sub_ps(y01, y23));
+  }
+}
+
+// Two butterflies at once: z[j] and z[j + h] for j and j + 1.
+static __inline void Butterfly(float* u, float* v, const float* w) {
+  const __m128 neg_real = _mm_load_ps(k_neg_real);
+  const __m128 wv = _mm_load_ps(w);
+  const __m128 wr = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(2, 2, 0, 0));
+  const __m128 wi = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(3, 3, 1, 1));
+  const __m128 uv = _mm_load_ps(u);
+  const __m128 vv = _mm_load_ps(v);
+  const __m128 v_swap = _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(2, 3, 0, 1));
+  // tr = vr * wr - vi * wi, ti = vi * wr + vr * wi
+  const __m128 t = _mm_add_ps(_mm_mul_ps(vv, wr),
+                              _mm_xor_ps(_mm_mul_ps(v_swap, wi), neg_real));
+
+  _mm_store_ps(u, _mm_add_ps(uv, t));
+  _mm_store_ps(v, _mm_sub_ps(uv, t));
+}
+
+// Same stage order as cftmdl_C().
+static void cftmdl_SSE2(float* z, int m) {
+  int h, j, k;
+
+  for (h = 4; 2 * h < m; h <<= 2) {
+    const float* w1 = &ns_rdft_twiddle[2 * h];
+    const float* w2 = &ns_rdft_twiddle[4 * h];
+
+    for (k = 0; k < 2 * m; k += 8 * h) {
+      for (j = 0; j < 2 * h; j += 4) {
+        float* p = &z[k + j];
+
+        Butterfly(p, p + 2 * h, &w1[j]);
+        Butterfly(p + 4 * h, p + 6 * h, &w1[j]);
+        Butterfly(p, p + 4 * h, &w2[j]);
+        Butterfly(p + 2 * h, p + 6 * h, &w2[j + 2 * h]);
+      }
+    }
+  }
+  for (; h < m; h <<= 1) {
+    const float* w = &ns_rdft_twiddle[2 * h];
+
+    for (k = 0; k < 2 * m; k += 4 * h) {
+      for (j = 0; j < 2 * h; j += 4) {
+        Butterfly(&z[k + j], &z[k + j + 2 * h], &w[j]);
+      }
+    }
+  }
+}
+
+// Four values of k at once, the real and imaginary parts are split into
+// separate registers.  The values at m - k are loaded in reverse order so
+// that each lane pairs k with m - k.
+static void rftfsub_SSE2(float* a, const float* z, int m) {
+  const float* w = &ns_rdft_twiddle[2 * m];
+  const __m128 half = _mm_set1_ps(0.5f);
+  int k;
+
+  a[0] = z[0] + z[1];
+  a[1] = z[0] - z[1];
+  for (k = 1; k <= m / 2; k += 4) {
+    const __m128 w0 = _mm_loadu_ps(&w[2 * k]);
+    const __m128 w4 = _mm_loadu_ps(&w[2 * k + 4]);
+    const __m128 zk0 = _mm_loadu_ps(&z[2 * k]);
+    const __m128 zk4 = _mm_loadu_ps(&z[2 * k + 4]);
+    const __m128 zm0 = _mm_loadu_ps(&z[2 * (m - k - 3)]);
+    const __m128 zm4 = _mm_loadu_ps(&z[2 * (m - k - 1)]);
+    const __m128 wr = _mm_shuffle_ps(w0, w4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 wi = _mm_shuffle_ps(w0, w4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 zkr = _mm_shuffle_ps(zk0, zk4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 zki = _mm_shuffle_ps(zk0, zk4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 zmr = _mm_shuffle_ps(zm4, zm0, _MM_SHUFFLE(0, 2, 0, 2));
+    const __m128 zmi = _mm_shuffle_ps(zm4, zm0, _MM_SHUFFLE(1, 3, 1, 3));
+    const __m128 er = _mm_add_ps(zkr, zmr);
+    const __m128 ei = _mm_sub_ps(zki, zmi);
+    const __m128 dr = _mm_sub_ps(zkr, zmr);
+    const __m128 di = _mm_add_ps(zki, zmi);
+    const __m128 u = _mm_add_ps(_mm_mul_ps(wr, di), _mm_mul_ps(wi, dr));
+    const __m128 v = _mm_sub_ps(_mm_mul_ps(wr, dr), _mm_mul_ps(wi, di));
+    const __m128 akr = _mm_mul_ps(_mm_add_ps(er, u), half);
+    const __m128 aki = _mm_mul_ps(_mm_sub_ps(v, ei), half);
+    const __m128 amr = _mm_mul_ps(_mm_sub_ps(er, u), half);
+    const __m128 ami = _mm_mul_ps(_mm_add_ps(v, ei), half);
+    const __m128 am0 = _mm_unpackhi_ps(amr, ami);
+    const __m128 am4 = _mm_unpacklo_ps(amr, ami);
+
+    // At k = m/2 both sides write the same element, in the same order as the
+    // C version.
+    _mm_storeu_ps(&a[2 * k], _mm_unpacklo_ps(akr, aki));
+    _mm_storeu_ps(&a[2 * k + 4], _mm_unpackhi_ps(akr, aki));
+    _mm_storeu_ps(&a[2 * (m - k - 3)],
+                  _mm_shuffle_ps(am0, am0, _MM_SHUFFLE(1, 0, 3, 2)));
+    _mm_storeu_ps(&a[2 * (m - k - 1)],
+                  _mm_shuffle_ps(am4, am4, _MM_SHUFFLE(1, 0, 3, 2)));
+  }
+}
+
+static void rftbsub_SSE2(float* z, const float* a, int m) {
+  const float* w = &ns_rdft_twiddle[2 * m];
+  const __m128 half = _mm_set1_ps(0.5f);
+  int k;
+
+  z[0] = (a[0] - a[1]) * 0.5f;
+  z[1] = (a[0] + a[1]) * 0.5f;
+  for (k = 1; k <= m / 2; k += 4) {
+    const __m128 w0 = _mm_loadu_ps(&w[2 * k]);
+    const __m128 w4 = _mm_loadu_ps(&w[2 * k + 4]);
+    const __m128 ak0 = _mm_loadu_ps(&a[2 * k]);
+    const __m128 ak4 = _mm_loadu_ps(&a[2 * k + 4]);
+    const __m128 am0 = _mm_loadu_ps(&a[2 * (m - k - 3)]);
+    const __m128 am4 = _mm_loadu_ps(&a[2 * (m - k - 1)]);
+    const __m128 wr = _mm_shuffle_ps(w0, w4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 wi = _mm_shuffle_ps(w0, w4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 akr = _mm_shuffle_ps(ak0, ak4, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 aki = _mm_shuffle_ps(ak0, ak4, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m128 amr = _mm_shuffle_ps(am4, am0, _MM_SHUFFLE(0, 2, 0, 2));
+    const __m128 ami = _mm_shuffle_ps(am4, am0, _MM_SHUFFLE(1, 3, 1, 3));
+    const __m128 sr = _mm_add_ps(akr, amr);
+    const __m128 dr = _mm_sub_ps(akr, amr);
+    const __m128 si = _mm_add_ps(aki, ami);
+    const __m128 di = _mm_sub_ps(ami, aki);
+    const __m128 u = _mm_add_ps(_mm_mul_ps(wr, si), _mm_mul_ps(wi, dr));
+    const __m128 v = _mm_sub_ps(_mm_mul_ps(wr, dr), _mm_mul_ps(wi, si));
+    // Imaginary part first, see ns_rftbsub_t.
+    const __m128 zki = _mm_mul_ps(_mm_add_ps(di, v), half);
+    const __m128 zkr = _mm_mul_ps(_mm_add_ps(sr, u), half);
+    const __m128 zmi = _mm_mul_ps(_mm_sub_ps(v, di), half);
+    const __m128 zmr = _mm_mul_ps(_mm_sub_ps(sr, u), half);
+    const __m128 zm0 = _mm_unpackhi_ps(zmi, zmr);
+    const __m128 zm4 = _mm_unpacklo_ps(zmi, zmr);
+
+    _mm_storeu_ps(&z[2 * k], _mm_unpacklo_ps(zki, zkr));
+    _mm_storeu_ps(&z[2 * k + 4], _mm_unpackhi_ps(zki, zkr));
+    _mm_storeu_ps(&z[2 * (m - k - 3)],
+                  _mm_shuffle_ps(zm0, zm0, _MM_SHUFFLE(1, 0, 3, 2)));
+    _mm_storeu_ps(&z[2 * (m - k - 1)],
+                  _mm_shuffle_ps(zm4, zm4, _MM_SHUFFLE(1, 0, 3, 2)));
+  }
+}
+
+void ns_rdft_init_sse2(void) {
+  ns_cft1st = cft1st_SSE2;
+  ns_cftmdl = cftmdl_SSE2;
+  ns_rftfsub = rftfsub_SSE2;
+  ns_rftbsub = rftbsub_SSE2;
+}
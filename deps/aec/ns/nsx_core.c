@@ -25,11 +25,11 @@ extern const int16_t WebRtcNsx_kLogTable[9];
 extern const int16_t WebRtcNsx_kCounterDiv[201];
 extern const int16_t WebRtcNsx_kLogTableFrac[256];
 #else
-static const int16_t WebRtcNsx_kLogTable[9] = {
+const int16_t WebRtcNsx_kLogTable[9] = {
   0, 177, 355, 532, 710, 887, 1065, 1242, 1420
 };
 
-static const int16_t WebRtcNsx_kCounterDiv[201] = {
+const int16_t WebRtcNsx_kCounterDiv[201] = {
   32767, 16384, 10923, 8192, 6554, 5461, 4681, 4096, 3641, 3277, 2979, 2731,
   2521, 2341, 2185, 2048, 1928, 1820, 1725, 1638, 1560, 1489, 1425, 1365, 1311,
   1260, 1214, 1170, 1130, 1092, 1057, 1024, 993, 964, 936, 910, 886, 862, 840,
@@ -46,7 +46,7 @@ static const int16_t WebRtcNsx_kCounterDiv[201] = {
   172, 172, 171, 170, 169, 168, 167, 166, 165, 165, 164, 163
 };
 
-static const int16_t WebRtcNsx_kLogTableFrac[256] = {
+const int16_t WebRtcNsx_kLogTableFrac[256] = {
   0,   1,   3,   4,   6,   7,   9,  10,  11,  13,  14,  16,  17,  18,  20,  21,
   22,  24,  25,  26,  28,  29,  30,  32,  33,  34,  36,  37,  38,  40,  41,  42,
   44,  45,  46,  47,  49,  50,  51,  52,  54,  55,  56,  57,  59,  60,  61,  62,
@@ -300,7 +300,7 @@ static const int16_t kDeterminantEstMatrix[66] = {
 };
 
 // Update the noise estimation information.
-static void UpdateNoiseEstimate(NsxInst_t* inst, int offset) {
+void WebRtcNsx_UpdateNoiseEstimate(NsxInst_t* inst, int offset) {
   int32_t tmp32no1 = 0;
   int32_t tmp32no2 = 0;
   int16_t tmp16 = 0;
@@ -436,7 +436,7 @@ static void NoiseEstimationC(NsxInst_t* inst,
     if (counter >= END_STARTUP_LONG) {
       inst->noiseEstCounter[s] = 0;
       if (inst->blockIndex >= END_STARTUP_LONG) {
-        UpdateNoiseEstimate(inst, offset);
+        WebRtcNsx_UpdateNoiseEstimate(inst, offset);
       }
     }
     inst->noiseEstCounter[s]++;
@@ -445,7 +445,7 @@ static void NoiseEstimationC(NsxInst_t* inst,
 
   // Sequentially update the noise during startup
   if (inst->blockIndex < END_STARTUP_LONG) {
-    UpdateNoiseEstimate(inst, offset);
+    WebRtcNsx_UpdateNoiseEstimate(inst, offset);
   }
 
   for (i = 0; i < inst->magnLen; i++) {
@@ -702,6 +702,7 @@ int32_t WebRtcNsx_InitCore(NsxInst_t* inst, uint32_t fs) {
 
   //initialize variables for new method
   inst->priorNonSpeechProb = 8192; // Q14(0.5) prior probability for speech/noise
+  inst->speechProb = 0;
   for (i = 0; i < HALF_ANAL_BLOCKL; i++) {
     inst->prevMagnU16[i] = 0;
     inst->prevNoiseU32[i] = 0; //previous noise-spectrum
@@ -784,6 +785,12 @@ int32_t WebRtcNsx_InitCore(NsxInst_t* inst, uint32_t fs) {
   WebRtcNsx_InitMips();
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNsx_InitSSE2();
+  }
+#endif
+
   inst->initFlag = 1;
 
   return 0;
@@ -1586,6 +1593,7 @@ int WebRtcNsx_ProcessCore(NsxInst_t* inst, short* speechFrame, short* speechFram
 
   if (inst->zeroInputSignal) {
     WebRtcNsx_DataSynthesis(inst, outFrame);
+    inst->speechProb = 0;
 
     if (inst->fs == 32000) {
       // update analysis buffer for H band
@@ -1844,6 +1852,11 @@ int WebRtcNsx_ProcessCore(NsxInst_t* inst, short* speechFrame, short* speechFram
 
   //compute speech/noise probability
   WebRtcNsx_SpeechNoiseProb(inst, nonSpeechProbFinal, priorLocSnr, postLocSnr);
+  tmpU32no1 = 0;
+  for (i = 0; i < inst->magnLen; i++) {
+    tmpU32no1 += nonSpeechProbFinal[i]; // Q8
+  }
+  inst->speechProb = (int16_t)(256 - tmpU32no1 / inst->magnLen); // Q8
 
   //time-avg parameter for noise update
   gammaNoise = NOISE_UPDATE_Q8; // Q8
@@ -81,6 +81,8 @@ typedef struct NsxInst_t_ {
   uint16_t                prevMagnU16[HALF_ANAL_BLOCKL];
   // Prior speech/noise probability in Q14.
   int16_t                 priorNonSpeechProb;
+  // Speech probability of the last frame, averaged over frequency, in Q8.
+  int16_t                 speechProb;
 
   int                     blockIndex;  // Frame index counter.
   // Parameter for updating or estimating thresholds/weights for prior model.
@@ -218,6 +220,10 @@ void WebRtcNsx_SpeechNoiseProb(NsxInst_t* inst,
                                uint32_t* priorLocSnr,
                                uint32_t* postLocSnr);
 
+// Convert the log quantiles at |offset| into the noise estimate in Q(qNoise).
+// Intended to be private.
+void WebRtcNsx_UpdateNoiseEstimate(NsxInst_t* inst, int offset);
+
 #if (defined WEBRTC_DETECT_ARM_NEON) || defined (WEBRTC_ARCH_ARM_NEON)
 // For the above function pointers, functions for generic platforms are declared
 // and defined as static in file nsx_core.c, while those for ARM Neon platforms
@@ -255,6 +261,18 @@ void WebRtcNsx_Denormalize_mips(NsxInst_t* inst, int16_t* in, int factor);
 
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Tables shared with the x86 versions of the above function pointers.
+extern const int16_t WebRtcNsx_kLogTable[9];
+extern const int16_t WebRtcNsx_kCounterDiv[201];
+extern const int16_t WebRtcNsx_kLogTableFrac[256];
+
+// Install the SSE2 versions of the above function pointers, defined in
+// nsx_core_sse2.c.  Only called after a runtime CPU check.  There is no AVX2
+// tier: a straight widening of the SSE2 kernels was slower per frame.
+void WebRtcNsx_InitSSE2(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,362 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core NSX functions, SSE2 versions.  All of them are bit-exact with the
+ * generic C versions in nsx_core.c.
+ */
+
+#include "ns/nsx_core.h"
+
+#include <assert.h>
+#include <emmintrin.h>
+
+#include "signal_processing/include/signal_processing_library.h"
+
+// (int16_t)((a * b) >> 14) for each lane, built from the two halves of the
+// 32-bit product so nothing needs to be widened.
+static __inline __m128i MulRsft14(__m128i a, __m128i b) {
+  const __m128i lo = _mm_mullo_epi16(a, b);
+  const __m128i hi = _mm_mulhi_epi16(a, b);
+  return _mm_or_si128(_mm_slli_epi16(hi, 2), _mm_srli_epi16(lo, 14));
+}
+
+// (int32_t)(a * b + round) >> shift for each lane, packed back to 16 bits
+// with saturation.
+static __inline __m128i MulRound(__m128i a,
+                                 __m128i b,
+                                 __m128i round,
+                                 int shift) {
+  const __m128i lo = _mm_mullo_epi16(a, b);
+  const __m128i hi = _mm_mulhi_epi16(a, b);
+  const __m128i p0 = _mm_srai_epi32(
+      _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), shift);
+  const __m128i p1 = _mm_srai_epi32(
+      _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), shift);
+  return _mm_packs_epi32(p0, p1);
+}
+
+// Same as MulRound(), but the result is truncated to 16 bits like an
+// (int16_t) cast instead of saturated.
+static __inline __m128i MulRoundTrunc(__m128i a,
+                                      __m128i b,
+                                      __m128i round,
+                                      int shift) {
+  const __m128i lo = _mm_mullo_epi16(a, b);
+  const __m128i hi = _mm_mulhi_epi16(a, b);
+  __m128i p0 = _mm_srai_epi32(
+      _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), shift);
+  __m128i p1 = _mm_srai_epi32(
+      _mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), shift);
+  p0 = _mm_srai_epi32(_mm_slli_epi32(p0, 16), 16);
+  p1 = _mm_srai_epi32(_mm_slli_epi32(p1, 16), 16);
+  return _mm_packs_epi32(p0, p1);
+}
+
+// Noise Estimation.  The log magnitude is computed as in C since it needs a
+// table lookup per bin; the quantile and density updates for all three
+// simultaneous estimates run eight bins at a time.
+static void NoiseEstimationSSE2(NsxInst_t* inst,
+                                uint16_t* magn,
+                                uint32_t* noise,
+                                int16_t* q_noise) {
+  int16_t lmagn[HALF_ANAL_BLOCKL], counter, countDiv;
+  int16_t countProd, delta, zeros, frac;
+  int16_t log2, tabind, logval, tmp16, tmp16no1, tmp16no2;
+  const int16_t log2_const = 22713; // Q15
+  const int16_t width_factor = 21845;
+  __m128i v_logval, v_count_div, v_count_prod, v_width, v_delta_small;
+  const __m128i v_512 = _mm_set1_epi16(512);
+  const __m128i v_delta_big = _mm_set1_epi16((int16_t)(FACTOR_Q16 >> 9));
+  const __m128i v_one = _mm_set1_epi16(1);
+  const __m128i v_two = _mm_set1_epi16(2);
+  const __m128i v_three = _mm_set1_epi16(3);
+  const __m128i v_width_max = _mm_set1_epi16(WIDTH_Q8);
+  const __m128i v_width_min = _mm_set1_epi16(-WIDTH_Q8);
+  const __m128i v_round15 = _mm_set1_epi32(1 << 14);
+
+  int i, s, offset;
+
+  tabind = inst->stages - inst->normData;
+  assert(tabind < 9);
+  assert(tabind > -9);
+  if (tabind < 0) {
+    logval = -WebRtcNsx_kLogTable[-tabind];
+  } else {
+    logval = WebRtcNsx_kLogTable[tabind];
+  }
+  v_logval = _mm_set1_epi16(logval);
+
+  // lmagn(i)=log(magn(i))=log(2)*log2(magn(i)), see NoiseEstimationC().
+  for (i = 0; i < inst->magnLen; i++) {
+    if (magn[i]) {
+      zeros = WebRtcSpl_NormU32((uint32_t)magn[i]);
+      frac = (int16_t)((((uint32_t)magn[i] << zeros)
+                              & 0x7FFFFFFF) >> 23);
+      assert(frac < 256);
+      log2 = (int16_t)(((31 - zeros) << 8)
+                             + WebRtcNsx_kLogTableFrac[frac]);
+      lmagn[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(log2, log2_const, 15);
+      lmagn[i] += logval;
+    } else {
+      lmagn[i] = logval;
+    }
+  }
+
+  delta = FACTOR_Q7;
+  if (inst->blockIndex < END_STARTUP_LONG) {
+    delta = FACTOR_Q7_STARTUP;
+  }
+  v_delta_small = _mm_set1_epi16(delta);
+
+  // loop over simultaneous estimates
+  for (s = 0; s < SIMULT; s++) {
+    int16_t* quantile;
+    int16_t* density;
+
+    offset = s * inst->magnLen;
+    quantile = inst->noiseEstLogQuantile + offset;
+    density = inst->noiseEstDensity + offset;
+
+    // Get counter values from state
+    counter = inst->noiseEstCounter[s];
+    assert(counter < 201);
+    countDiv = WebRtcNsx_kCounterDiv[counter];
+    countProd = (int16_t)WEBRTC_SPL_MUL_16_16(counter, countDiv);
+    tmp16no2 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+                 width_factor, countDiv, 15);
+    v_count_div = _mm_set1_epi16(countDiv);
+    v_count_prod = _mm_set1_epi16(countProd);
+    v_width = _mm_set1_epi16(tmp16no2);
+
+    for (i = 0; i + 8 <= inst->magnLen; i += 8) {
+      const __m128i lm = _mm_loadu_si128((const __m128i*)&lmagn[i]);
+      const __m128i dens = _mm_loadu_si128((const __m128i*)&density[i]);
+      __m128i q = _mm_loadu_si128((const __m128i*)&quantile[i]);
+      __m128i big, step, up, down, mask, diff;
+      int t;
+
+      // FACTOR_Q16 >> (14 - WebRtcSpl_NormW16(dens)) is FACTOR_Q16 >> 9,
+      // halved once for every power of two |dens| reaches above 512.
+      big = v_delta_big;
+      for (t = 1024; t <= 16384; t <<= 1) {
+        mask = _mm_cmpgt_epi16(dens, _mm_set1_epi16((int16_t)(t - 1)));
+        big = _mm_sub_epi16(big, _mm_and_si128(mask, _mm_srli_epi16(big, 1)));
+      }
+      mask = _mm_cmpgt_epi16(dens, v_512);
+      step = _mm_or_si128(_mm_and_si128(mask, big),
+                          _mm_andnot_si128(mask, v_delta_small));
+
+      // update log quantile estimate
+      step = MulRsft14(step, v_count_div);
+      up = _mm_add_epi16(q, _mm_srai_epi16(_mm_add_epi16(step, v_two), 2));
+      down = _mm_srai_epi16(_mm_add_epi16(step, v_one), 1);
+      down = _mm_srai_epi16(_mm_mullo_epi16(down, v_three), 1);
+      down = _mm_max_epi16(_mm_sub_epi16(q, down), v_logval);
+      mask = _mm_cmpgt_epi16(lm, q);
+      q = _mm_or_si128(_mm_and_si128(mask, up), _mm_andnot_si128(mask, down));
+      _mm_storeu_si128((__m128i*)&quantile[i], q);
+
+      // update density estimate
+      diff = _mm_sub_epi16(lm, q);
+      mask = _mm_and_si128(_mm_cmpgt_epi16(diff, v_width_min),
+                           _mm_cmplt_epi16(diff, v_width_max));
+      step = _mm_add_epi16(MulRound(dens, v_count_prod, v_round15, 15),
+                           v_width);
+      _mm_storeu_si128((__m128i*)&density[i],
+                       _mm_or_si128(_mm_and_si128(mask, step),
+                                    _mm_andnot_si128(mask, dens)));
+    }
+
+    for (; i < inst->magnLen; i++) {
+      if (density[i] > 512) {
+        int factor = WebRtcSpl_NormW16(density[i]);
+        delta = (int16_t)(FACTOR_Q16 >> (14 - factor));
+      } else {
+        delta = FACTOR_Q7;
+        if (inst->blockIndex < END_STARTUP_LONG) {
+          delta = FACTOR_Q7_STARTUP;
+        }
+      }
+
+      tmp16 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(delta, countDiv, 14);
+      if (lmagn[i] > quantile[i]) {
+        tmp16 += 2;
+        quantile[i] += WEBRTC_SPL_RSHIFT_W16(tmp16, 2);
+      } else {
+        tmp16 += 1;
+        tmp16no1 = WEBRTC_SPL_RSHIFT_W16(tmp16, 1);
+        quantile[i] -= (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(tmp16no1, 3, 1);
+        if (quantile[i] < logval) {
+          quantile[i] = logval;
+        }
+      }
+
+      if (WEBRTC_SPL_ABS_W16(lmagn[i] - quantile[i]) < WIDTH_Q8) {
+        tmp16no1 = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT_WITH_ROUND(
+                     density[i], countProd, 15);
+        density[i] = tmp16no1 + tmp16no2;
+      }
+    }
+
+    if (counter >= END_STARTUP_LONG) {
+      inst->noiseEstCounter[s] = 0;
+      if (inst->blockIndex >= END_STARTUP_LONG) {
+        WebRtcNsx_UpdateNoiseEstimate(inst, offset);
+      }
+    }
+    inst->noiseEstCounter[s]++;
+  }
+
+  // Sequentially update the noise during startup
+  if (inst->blockIndex < END_STARTUP_LONG) {
+    WebRtcNsx_UpdateNoiseEstimate(inst, offset);
+  }
+
+  for (i = 0; i < inst->magnLen; i++) {
+    noise[i] = (uint32_t)(inst->noiseEstQuantile[i]); // Q(qNoise)
+  }
+  (*q_noise) = (int16_t)inst->qNoise;
+}
+
+// Filter the data in the frequency domain, and create spectrum.
+static void PrepareSpectrumSSE2(NsxInst_t* inst, int16_t* freq_buf) {
+  const __m128i zero = _mm_setzero_si128();
+  int i = 0;
+
+  for (i = 0; i + 8 <= inst->anaLen2; i += 8) {
+    const __m128i filter =
+        _mm_loadu_si128((const __m128i*)&inst->noiseSupFilter[i]);
+    const __m128i re = MulRsft14(
+        _mm_loadu_si128((const __m128i*)&inst->real[i]), filter);
+    const __m128i im = MulRsft14(
+        _mm_loadu_si128((const __m128i*)&inst->imag[i]), filter);
+    const __m128i neg_im = _mm_sub_epi16(zero, im);
+
+    _mm_storeu_si128((__m128i*)&inst->real[i], re);
+    _mm_storeu_si128((__m128i*)&inst->imag[i], im);
+    _mm_storeu_si128((__m128i*)&freq_buf[2 * i],
+                     _mm_unpacklo_epi16(re, neg_im));
+    _mm_storeu_si128((__m128i*)&freq_buf[2 * i + 8],
+                     _mm_unpackhi_epi16(re, neg_im));
+  }
+  for (; i <= inst->anaLen2; i++) {
+    inst->real[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->real[i],
+        (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+    inst->imag[i] = (int16_t)WEBRTC_SPL_MUL_16_16_RSFT(inst->imag[i],
+        (int16_t)(inst->noiseSupFilter[i]), 14); // Q(normData-stages)
+    freq_buf[2 * i] = inst->real[i];
+    freq_buf[2 * i + 1] = -inst->imag[i];
+  }
+}
+
+// Denormalize the real-valued signal |in|, the output from inverse FFT.
+static void DenormalizeSSE2(NsxInst_t* inst, int16_t* in, int factor) {
+  const int shift = factor - inst->normData;
+  const __m128i count = _mm_cvtsi32_si128(shift >= 0 ? shift : -shift);
+  int i = 0;
+
+  assert(inst->anaLen % 8 == 0);
+  for (i = 0; i < inst->anaLen; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)&in[i]);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+    if (shift >= 0) {
+      lo = _mm_sll_epi32(lo, count);
+      hi = _mm_sll_epi32(hi, count);
+    } else {
+      lo = _mm_sra_epi32(lo, count);
+      hi = _mm_sra_epi32(hi, count);
+    }
+    _mm_storeu_si128((__m128i*)&inst->real[i], _mm_packs_epi32(lo, hi));
+  }
+}
+
+// For the noise supression process, synthesis, read out fully processed
+// segment, and update synthesis buffer.
+static void SynthesisUpdateSSE2(NsxInst_t* inst,
+                                int16_t* out_frame,
+                                int16_t gain_factor) {
+  const __m128i gain = _mm_set1_epi16(gain_factor);
+  const __m128i round14 = _mm_set1_epi32(1 << 13);
+  const __m128i round13 = _mm_set1_epi32(1 << 12);
+  int i = 0;
+
+  // synthesis
+  assert(inst->anaLen % 8 == 0);
+  for (i = 0; i < inst->anaLen; i += 8) {
+    const __m128i window = _mm_loadu_si128((const __m128i*)&inst->window[i]);
+    const __m128i real = _mm_loadu_si128((const __m128i*)&inst->real[i]);
+    const __m128i buf =
+        _mm_loadu_si128((const __m128i*)&inst->synthesisBuffer[i]);
+    __m128i tmp = MulRoundTrunc(window, real, round14, 14); // Q0
+    tmp = MulRound(tmp, gain, round13, 13); // Q0
+    _mm_storeu_si128((__m128i*)&inst->synthesisBuffer[i],
+                     _mm_adds_epi16(buf, tmp));
+  }
+
+  // read out fully processed segment
+  WEBRTC_SPL_MEMCPY_W16(out_frame, inst->synthesisBuffer, inst->blockLen10ms);
+
+  // update synthesis buffer
+  WEBRTC_SPL_MEMCPY_W16(inst->synthesisBuffer,
+                        inst->synthesisBuffer + inst->blockLen10ms,
+                        inst->anaLen - inst->blockLen10ms);
+  WebRtcSpl_ZerosArrayW16(inst->synthesisBuffer
+      + inst->anaLen - inst->blockLen10ms, inst->blockLen10ms);
+}
+
+// Update analysis buffer for lower band, and window data before FFT.
+static void AnalysisUpdateSSE2(NsxInst_t* inst,
+                               int16_t* out,
+                               int16_t* new_speech) {
+  const __m128i round14 = _mm_set1_epi32(1 << 13);
+  int i = 0;
+
+  // For lower band update analysis buffer.
+  WEBRTC_SPL_MEMCPY_W16(inst->analysisBuffer,
+                        inst->analysisBuffer + inst->blockLen10ms,
+                        inst->anaLen - inst->blockLen10ms);
+  WEBRTC_SPL_MEMCPY_W16(inst->analysisBuffer
+      + inst->anaLen - inst->blockLen10ms, new_speech, inst->blockLen10ms);
+
+  // Window data before FFT.
+  assert(inst->anaLen % 8 == 0);
+  for (i = 0; i < inst->anaLen; i += 8) {
+    const __m128i window = _mm_loadu_si128((const __m128i*)&inst->window[i]);
+    const __m128i buf =
+        _mm_loadu_si128((const __m128i*)&inst->analysisBuffer[i]);
+    _mm_storeu_si128((__m128i*)&out[i],
+                     MulRoundTrunc(window, buf, round14, 14)); // Q0
+  }
+}
+
+// Normalize the real-valued signal |in|, the input to forward FFT.
+static void NormalizeRealBufferSSE2(NsxInst_t* inst,
+                                    const int16_t* in,
+                                    int16_t* out) {
+  const __m128i count = _mm_cvtsi32_si128(inst->normData);
+  int i = 0;
+
+  assert(inst->anaLen % 8 == 0);
+  for (i = 0; i < inst->anaLen; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)&in[i]);
+    _mm_storeu_si128((__m128i*)&out[i], _mm_sll_epi16(x, count));
+  }
+}
+
+void WebRtcNsx_InitSSE2(void) {
+  WebRtcNsx_NoiseEstimation = NoiseEstimationSSE2;
+  WebRtcNsx_PrepareSpectrum = PrepareSpectrumSSE2;
+  WebRtcNsx_SynthesisUpdate = SynthesisUpdateSSE2;
+  WebRtcNsx_AnalysisUpdate = AnalysisUpdateSSE2;
+  WebRtcNsx_Denormalize = DenormalizeSSE2;
+  WebRtcNsx_NormalizeRealBuffer = NormalizeRealBufferSSE2;
+}
@@ -0,0 +1,268 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementations of the functions
+ * WebRtcSpl_ComplexFFT() and WebRtcSpl_ComplexIFFT(), bit-exact with the
+ * generic C versions in complex_fft.c in the high accuracy mode.  It follows
+ * complex_fft_sse2.c with eight samples per vector, so the first four
+ * stages are done within blocks of sixteen samples.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "complex_fft_tables.h"
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+#define CFFTSFT 14
+#define CFFTRND2 16384
+
+#define CIFFTSFT 14
+
+static __inline void Butterfly(__m256i* top, __m256i* bottom,
+                               __m256i w1, __m256i w2,
+                               __m256i round, __m128i shift) {
+  const __m256i one = _mm256_set1_epi32(1);  // CFFTRND and CIFFTRND.
+  const __m256i low = _mm256_set1_epi32(0xffff);
+  const __m256i tr = _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_madd_epi16(*bottom, w1), one), 15 - CFFTSFT);
+  const __m256i ti = _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_madd_epi16(*bottom, w2), one), 15 - CFFTSFT);
+  const __m256i qr = _mm256_add_epi32(
+      _mm256_srai_epi32(_mm256_slli_epi32(*top, 16), 16 - CFFTSFT), round);
+  const __m256i qi = _mm256_add_epi32(
+      _mm256_slli_epi32(_mm256_srai_epi32(*top, 16), CFFTSFT), round);
+
+  *top = _mm256_or_si256(
+      _mm256_and_si256(_mm256_sra_epi32(_mm256_add_epi32(qr, tr), shift), low),
+      _mm256_slli_epi32(_mm256_sra_epi32(_mm256_add_epi32(qi, ti), shift),
+                        16));
+  *bottom = _mm256_or_si256(
+      _mm256_and_si256(_mm256_sra_epi32(_mm256_sub_epi32(qr, tr), shift), low),
+      _mm256_slli_epi32(_mm256_sra_epi32(_mm256_sub_epi32(qi, ti), shift),
+                        16));
+}
+
+static __inline int32_t Pack(int16_t low, int16_t high) {
+  return (int32_t) ((uint32_t) (uint16_t) low |
+                    ((uint32_t) (uint16_t) high << 16));
+}
+
+// Twiddle factors of table positions |j|[0..7].
+static __inline void Twiddles(const int* j, int inverse,
+                              __m256i* w1, __m256i* w2) {
+  int32_t a[8], b[8];
+  int q;
+
+  for (q = 0; q < 8; q++) {
+    const int16_t wr = kSinTable1024[j[q] + 256];
+    const int16_t wi = inverse ? kSinTable1024[j[q]] : -kSinTable1024[j[q]];
+
+    a[q] = Pack(wr, (int16_t) -wi);
+    b[q] = Pack(wi, wr);
+  }
+  *w1 = _mm256_loadu_si256((const __m256i*) a);
+  *w2 = _mm256_loadu_si256((const __m256i*) b);
+}
+
+// Table positions m << k of m = |m0|, |m0| + 1, ...
+static __inline void StageTwiddles(int m0, int k, int inverse,
+                                   __m256i* w1, __m256i* w2) {
+  int j[8];
+  int q;
+
+  for (q = 0; q < 8; q++) {
+    j[q] = (m0 + q) << k;
+  }
+  Twiddles(j, inverse, w1, w2);
+}
+
+// Within each 128-bit lane the first two stages shuffle as in the SSE2
+// version, the third one swaps lanes between the two vectors of a block and
+// the fourth pairs the two vectors.
+static void FirstStages(int16_t* frfi, int n, int inverse, int stage,
+                        __m256i round, __m128i shift) {
+  static const int kStage1[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  static const int kStage2[8] = { 0, 256, 0, 256, 0, 256, 0, 256 };
+  static const int kStage3[8] = { 0, 128, 256, 384, 0, 128, 256, 384 };
+  __m256i w1[4], w2[4];
+  int i;
+
+  Twiddles(kStage1, inverse, &w1[0], &w2[0]);
+  Twiddles(kStage2, inverse, &w1[1], &w2[1]);
+  Twiddles(kStage3, inverse, &w1[2], &w2[2]);
+  StageTwiddles(0, 6, inverse, &w1[3], &w2[3]);
+
+  for (i = 0; i < n; i += 16) {
+    __m256i v0 = _mm256_loadu_si256((const __m256i*) &frfi[2 * i]);
+    __m256i v1 = _mm256_loadu_si256((const __m256i*) &frfi[2 * i + 16]);
+    __m256i top, bottom;
+
+    if (stage == 0 || stage == 1) {
+      const __m256i s0 = _mm256_shuffle_epi32(v0, _MM_SHUFFLE(3, 1, 2, 0));
+      const __m256i s1 = _mm256_shuffle_epi32(v1, _MM_SHUFFLE(3, 1, 2, 0));
+      top = _mm256_unpacklo_epi64(s0, s1);
+      bottom = _mm256_unpackhi_epi64(s0, s1);
+      Butterfly(&top, &bottom, w1[0], w2[0], round, shift);
+      v0 = _mm256_unpacklo_epi32(top, bottom);
+      v1 = _mm256_unpackhi_epi32(top, bottom);
+    }
+    if (stage == 0 || stage == 2) {
+      top = _mm256_unpacklo_epi64(v0, v1);
+      bottom = _mm256_unpackhi_epi64(v0, v1);
+      Butterfly(&top, &bottom, w1[1], w2[1], round, shift);
+      v0 = _mm256_unpacklo_epi64(top, bottom);
+      v1 = _mm256_unpackhi_epi64(top, bottom);
+    }
+    if (stage == 0 || stage == 4) {
+      top = _mm256_permute2x128_si256(v0, v1, 0x20);
+      bottom = _mm256_permute2x128_si256(v0, v1, 0x31);
+      Butterfly(&top, &bottom, w1[2], w2[2], round, shift);
+      v0 = _mm256_permute2x128_si256(top, bottom, 0x20);
+      v1 = _mm256_permute2x128_si256(top, bottom, 0x31);
+    }
+    if (stage == 0 || stage == 8) {
+      Butterfly(&v0, &v1, w1[3], w2[3], round, shift);
+    }
+    _mm256_storeu_si256((__m256i*) &frfi[2 * i], v0);
+    _mm256_storeu_si256((__m256i*) &frfi[2 * i + 16], v1);
+  }
+}
+
+// Butterflies |l| >= 16 samples apart, with table positions m << k.
+static void Radix2Stage(int16_t* frfi, int n, int l, int k, int inverse,
+                        __m256i round, __m128i shift) {
+  const int istep = l << 1;
+  int i, m;
+
+  for (m = 0; m < l; m += 8) {
+    __m256i w1, w2;
+
+    StageTwiddles(m, k, inverse, &w1, &w2);
+    for (i = m; i < n; i += istep) {
+      __m256i top = _mm256_loadu_si256((const __m256i*) &frfi[2 * i]);
+      __m256i bottom =
+          _mm256_loadu_si256((const __m256i*) &frfi[2 * (i + l)]);
+
+      Butterfly(&top, &bottom, w1, w2, round, shift);
+      _mm256_storeu_si256((__m256i*) &frfi[2 * i], top);
+      _mm256_storeu_si256((__m256i*) &frfi[2 * (i + l)], bottom);
+    }
+  }
+}
+
+// The stages |l| and 2 * |l| apart in one pass, see complex_fft_sse2.c.
+static void Radix4Stages(int16_t* frfi, int n, int l, int k,
+                         __m256i round, __m128i shift) {
+  const int istep = l << 2;
+  int i, m;
+
+  for (m = 0; m < l; m += 8) {
+    __m256i w1[3], w2[3];
+
+    StageTwiddles(m, k, 0, &w1[0], &w2[0]);
+    StageTwiddles(m, k - 1, 0, &w1[1], &w2[1]);
+    StageTwiddles(m + l, k - 1, 0, &w1[2], &w2[2]);
+    for (i = m; i < n; i += istep) {
+      __m256i a = _mm256_loadu_si256((const __m256i*) &frfi[2 * i]);
+      __m256i b = _mm256_loadu_si256((const __m256i*) &frfi[2 * (i + l)]);
+      __m256i c =
+          _mm256_loadu_si256((const __m256i*) &frfi[2 * (i + 2 * l)]);
+      __m256i d =
+          _mm256_loadu_si256((const __m256i*) &frfi[2 * (i + 3 * l)]);
+
+      Butterfly(&a, &b, w1[0], w2[0], round, shift);
+      Butterfly(&c, &d, w1[0], w2[0], round, shift);
+      Butterfly(&a, &c, w1[1], w2[1], round, shift);
+      Butterfly(&b, &d, w1[2], w2[2], round, shift);
+      _mm256_storeu_si256((__m256i*) &frfi[2 * i], a);
+      _mm256_storeu_si256((__m256i*) &frfi[2 * (i + l)], b);
+      _mm256_storeu_si256((__m256i*) &frfi[2 * (i + 2 * l)], c);
+      _mm256_storeu_si256((__m256i*) &frfi[2 * (i + 3 * l)], d);
+    }
+  }
+}
+
+int WebRtcSpl_ComplexFFTAVX2(int16_t frfi[], int stages, int mode) {
+  const __m256i round = _mm256_set1_epi32(CFFTRND2);
+  const __m128i shift = _mm_cvtsi32_si128(1 + CFFTSFT);
+  int n = 1 << stages;
+  int l = 16;
+  int k = 10 - 5;  // Table step of the stage with l == 16.
+
+  if (n > 1024) {
+    return -1;
+  }
+  if (mode == 0 || stages < 4) {
+    return WebRtcSpl_ComplexFFT(frfi, stages, mode);
+  }
+
+  FirstStages(frfi, n, 0, 0, round, shift);
+  while (l < n) {
+    if (2 * l < n) {
+      Radix4Stages(frfi, n, l, k, round, shift);
+      l <<= 2;
+      k -= 2;
+    } else {
+      Radix2Stage(frfi, n, l, k, 0, round, shift);
+      l <<= 1;
+      k -= 1;
+    }
+  }
+  return 0;
+}
+
+int WebRtcSpl_ComplexIFFTAVX2(int16_t frfi[], int stages, int mode) {
+  int n = 1 << stages;
+  int l = 1;
+  int k = 10 - 1;
+  int scale = 0;
+
+  if (n > 1024) {
+    return -1;
+  }
+  if (mode == 0 || stages < 4) {
+    return WebRtcSpl_ComplexIFFT(frfi, stages, mode);
+  }
+
+  while (l < n) {
+    // variable scaling, depending upon data
+    int32_t tmp32 = (int32_t) WebRtcSpl_MaxAbsValueW16(frfi, 2 * n);
+    int shift = 0;
+    int32_t round2 = 8192;
+    __m256i round;
+    __m128i shift_vector;
+
+    if (tmp32 > 13573) {
+      shift++;
+      scale++;
+      round2 <<= 1;
+    }
+    if (tmp32 > 27146) {
+      shift++;
+      scale++;
+      round2 <<= 1;
+    }
+    round = _mm256_set1_epi32(round2);
+    shift_vector = _mm_cvtsi32_si128(shift + CIFFTSFT);
+
+    if (l < 16) {
+      FirstStages(frfi, n, 1, l, round, shift_vector);
+    } else {
+      Radix2Stage(frfi, n, l, k, 1, round, shift_vector);
+    }
+    --k;
+    l <<= 1;
+  }
+  return scale;
+}
@@ -0,0 +1,262 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 implementations of the functions
+ * WebRtcSpl_ComplexFFT() and WebRtcSpl_ComplexIFFT(), bit-exact with the
+ * generic C versions in complex_fft.c in the high accuracy mode. The low
+ * accuracy mode is left to the C versions.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "complex_fft_tables.h"
+#include "include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+#define CFFTSFT 14
+#define CFFTRND2 16384
+
+#define CIFFTSFT 14
+
+// Four complex samples, [Re Im] pairs, make up a vector. A butterfly is
+// computed on 32-bit values exactly as in the C version, and only the low 16
+// bits of each result are kept, which is the C version's cast.
+static __inline void Butterfly(__m128i* top, __m128i* bottom,
+                               __m128i w1, __m128i w2,
+                               __m128i round, __m128i shift) {
+  const __m128i one = _mm_set1_epi32(1);  // CFFTRND and CIFFTRND.
+  const __m128i low = _mm_set1_epi32(0xffff);
+  // |w1| holds wr and -wi, |w2| wi and wr, for each sample.
+  const __m128i tr = _mm_srai_epi32(
+      _mm_add_epi32(_mm_madd_epi16(*bottom, w1), one), 15 - CFFTSFT);
+  const __m128i ti = _mm_srai_epi32(
+      _mm_add_epi32(_mm_madd_epi16(*bottom, w2), one), 15 - CFFTSFT);
+  const __m128i qr = _mm_add_epi32(
+      _mm_srai_epi32(_mm_slli_epi32(*top, 16), 16 - CFFTSFT), round);
+  const __m128i qi = _mm_add_epi32(
+      _mm_slli_epi32(_mm_srai_epi32(*top, 16), CFFTSFT), round);
+
+  *top = _mm_or_si128(
+      _mm_and_si128(_mm_sra_epi32(_mm_add_epi32(qr, tr), shift), low),
+      _mm_slli_epi32(_mm_sra_epi32(_mm_add_epi32(qi, ti), shift), 16));
+  *bottom = _mm_or_si128(
+      _mm_and_si128(_mm_sra_epi32(_mm_sub_epi32(qr, tr), shift), low),
+      _mm_slli_epi32(_mm_sra_epi32(_mm_sub_epi32(qi, ti), shift), 16));
+}
+
+static __inline int32_t Pack(int16_t low, int16_t high) {
+  return (int32_t) ((uint32_t) (uint16_t) low |
+                    ((uint32_t) (uint16_t) high << 16));
+}
+
+// Twiddle factors of table positions j0..j3, see Butterfly().
+static __inline void Twiddles(int j0, int j1, int j2, int j3, int inverse,
+                              __m128i* w1, __m128i* w2) {
+  const int j[4] = { j0, j1, j2, j3 };
+  int32_t a[4], b[4];
+  int q;
+
+  for (q = 0; q < 4; q++) {
+    const int16_t wr = kSinTable1024[j[q] + 256];
+    const int16_t wi = inverse ? kSinTable1024[j[q]] : -kSinTable1024[j[q]];
+
+    a[q] = Pack(wr, (int16_t) -wi);
+    b[q] = Pack(wi, wr);
+  }
+  *w1 = _mm_loadu_si128((const __m128i*) a);
+  *w2 = _mm_loadu_si128((const __m128i*) b);
+}
+
+// The first stage pairs neighbours, the second the samples two apart, so a
+// block of eight samples is shuffled into top and bottom halves in registers.
+static __inline void Stage1(__m128i* v0, __m128i* v1,
+                            __m128i w1, __m128i w2,
+                            __m128i round, __m128i shift) {
+  const __m128i s0 = _mm_shuffle_epi32(*v0, _MM_SHUFFLE(3, 1, 2, 0));
+  const __m128i s1 = _mm_shuffle_epi32(*v1, _MM_SHUFFLE(3, 1, 2, 0));
+  __m128i top = _mm_unpacklo_epi64(s0, s1);
+  __m128i bottom = _mm_unpackhi_epi64(s0, s1);
+
+  Butterfly(&top, &bottom, w1, w2, round, shift);
+  *v0 = _mm_unpacklo_epi32(top, bottom);
+  *v1 = _mm_unpackhi_epi32(top, bottom);
+}
+
+static __inline void Stage2(__m128i* v0, __m128i* v1,
+                            __m128i w1, __m128i w2,
+                            __m128i round, __m128i shift) {
+  __m128i top = _mm_unpacklo_epi64(*v0, *v1);
+  __m128i bottom = _mm_unpackhi_epi64(*v0, *v1);
+
+  Butterfly(&top, &bottom, w1, w2, round, shift);
+  *v0 = _mm_unpacklo_epi64(top, bottom);
+  *v1 = _mm_unpackhi_epi64(top, bottom);
+}
+
+// The first two stages over the whole vector, one after the other or, with
+// |fused|, both on each block before it is stored.
+static void FirstStages(int16_t* frfi, int n, int inverse, int stage,
+                        __m128i round, __m128i shift) {
+  __m128i w1[2], w2[2];
+  int i;
+
+  // Stage 1 only uses table position 0, stage 2 positions 0 and 256.
+  Twiddles(0, 0, 0, 0, inverse, &w1[0], &w2[0]);
+  Twiddles(0, 256, 0, 256, inverse, &w1[1], &w2[1]);
+
+  for (i = 0; i < n; i += 8) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*) &frfi[2 * i]);
+    __m128i v1 = _mm_loadu_si128((const __m128i*) &frfi[2 * i + 8]);
+
+    if (stage != 2) {
+      Stage1(&v0, &v1, w1[0], w2[0], round, shift);
+    }
+    if (stage != 1) {
+      Stage2(&v0, &v1, w1[1], w2[1], round, shift);
+    }
+    _mm_storeu_si128((__m128i*) &frfi[2 * i], v0);
+    _mm_storeu_si128((__m128i*) &frfi[2 * i + 8], v1);
+  }
+}
+
+// Butterflies |l| >= 4 samples apart, with table positions m << k.
+static void Radix2Stage(int16_t* frfi, int n, int l, int k, int inverse,
+                        __m128i round, __m128i shift) {
+  const int istep = l << 1;
+  int i, m;
+
+  for (m = 0; m < l; m += 4) {
+    __m128i w1, w2;
+
+    Twiddles(m << k, (m + 1) << k, (m + 2) << k, (m + 3) << k, inverse,
+             &w1, &w2);
+    for (i = m; i < n; i += istep) {
+      __m128i top = _mm_loadu_si128((const __m128i*) &frfi[2 * i]);
+      __m128i bottom = _mm_loadu_si128((const __m128i*) &frfi[2 * (i + l)]);
+
+      Butterfly(&top, &bottom, w1, w2, round, shift);
+      _mm_storeu_si128((__m128i*) &frfi[2 * i], top);
+      _mm_storeu_si128((__m128i*) &frfi[2 * (i + l)], bottom);
+    }
+  }
+}
+
+// The stages |l| and 2 * |l| apart in one pass, a radix-4 butterfly made of
+// the four radix-2 ones with the rounding of the C version in between.
+static void Radix4Stages(int16_t* frfi, int n, int l, int k,
+                         __m128i round, __m128i shift) {
+  const int istep = l << 2;
+  int i, m;
+
+  for (m = 0; m < l; m += 4) {
+    __m128i w1[3], w2[3];
+
+    Twiddles(m << k, (m + 1) << k, (m + 2) << k, (m + 3) << k, 0,
+             &w1[0], &w2[0]);
+    Twiddles(m << (k - 1), (m + 1) << (k - 1), (m + 2) << (k - 1),
+             (m + 3) << (k - 1), 0, &w1[1], &w2[1]);
+    Twiddles((m + l) << (k - 1), (m + l + 1) << (k - 1),
+             (m + l + 2) << (k - 1), (m + l + 3) << (k - 1), 0,
+             &w1[2], &w2[2]);
+    for (i = m; i < n; i += istep) {
+      __m128i a = _mm_loadu_si128((const __m128i*) &frfi[2 * i]);
+      __m128i b = _mm_loadu_si128((const __m128i*) &frfi[2 * (i + l)]);
+      __m128i c = _mm_loadu_si128((const __m128i*) &frfi[2 * (i + 2 * l)]);
+      __m128i d = _mm_loadu_si128((const __m128i*) &frfi[2 * (i + 3 * l)]);
+
+      Butterfly(&a, &b, w1[0], w2[0], round, shift);
+      Butterfly(&c, &d, w1[0], w2[0], round, shift);
+      Butterfly(&a, &c, w1[1], w2[1], round, shift);
+      Butterfly(&b, &d, w1[2], w2[2], round, shift);
+      _mm_storeu_si128((__m128i*) &frfi[2 * i], a);
+      _mm_storeu_si128((__m128i*) &frfi[2 * (i + l)], b);
+      _mm_storeu_si128((__m128i*) &frfi[2 * (i + 2 * l)], c);
+      _mm_storeu_si128((__m128i*) &frfi[2 * (i + 3 * l)], d);
+    }
+  }
+}
+
+int WebRtcSpl_ComplexFFTSSE2(int16_t frfi[], int stages, int mode) {
+  const __m128i round = _mm_set1_epi32(CFFTRND2);
+  const __m128i shift = _mm_cvtsi32_si128(1 + CFFTSFT);
+  int n = 1 << stages;
+  int l = 4;
+  int k = 10 - 3;  // Table step of the stage with l == 4.
+
+  if (n > 1024) {
+    return -1;
+  }
+  if (mode == 0 || stages < 3) {
+    return WebRtcSpl_ComplexFFT(frfi, stages, mode);
+  }
+
+  // Without the data dependent scaling of the inverse, stages are done two
+  // at a time.
+  FirstStages(frfi, n, 0, 0, round, shift);
+  while (l < n) {
+    if (2 * l < n) {
+      Radix4Stages(frfi, n, l, k, round, shift);
+      l <<= 2;
+      k -= 2;
+    } else {
+      Radix2Stage(frfi, n, l, k, 0, round, shift);
+      l <<= 1;
+      k -= 1;
+    }
+  }
+  return 0;
+}
+
+int WebRtcSpl_ComplexIFFTSSE2(int16_t frfi[], int stages, int mode) {
+  int n = 1 << stages;
+  int l = 1;
+  int k = 10 - 1;
+  int scale = 0;
+
+  if (n > 1024) {
+    return -1;
+  }
+  if (mode == 0 || stages < 3) {
+    return WebRtcSpl_ComplexIFFT(frfi, stages, mode);
+  }
+
+  while (l < n) {
+    // variable scaling, depending upon data
+    int32_t tmp32 = (int32_t) WebRtcSpl_MaxAbsValueW16(frfi, 2 * n);
+    int shift = 0;
+    int32_t round2 = 8192;
+    __m128i round, shift_vector;
+
+    if (tmp32 > 13573) {
+      shift++;
+      scale++;
+      round2 <<= 1;
+    }
+    if (tmp32 > 27146) {
+      shift++;
+      scale++;
+      round2 <<= 1;
+    }
+    round = _mm_set1_epi32(round2);
+    shift_vector = _mm_cvtsi32_si128(shift + CIFFTSFT);
+
+    if (l < 4) {
+      FirstStages(frfi, n, 1, l, round, shift_vector);
+    } else {
+      Radix2Stage(frfi, n, l, k, 1, round, shift_vector);
+    }
+    --k;
+    l <<= 1;
+  }
+  return scale;
+}
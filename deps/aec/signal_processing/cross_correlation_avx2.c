@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementation of the function
+ * WebRtcSpl_CrossCorrelation(), bit-exact with the generic C version in
+ * cross_correlation.c.  It follows cross_correlation_sse2.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+static __inline int32_t HorizontalSum(__m256i y) {
+  __m128i x = _mm_add_epi32(_mm256_castsi256_si128(y),
+                            _mm256_extracti128_si256(y, 1));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2) {
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  int i = 0, j = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    const int16_t* seq2_i = &seq2[step_seq2 * i];
+    __m256i sum = _mm256_setzero_si256();
+    int32_t corr;
+
+    if (right_shifts == 0) {
+      for (j = 0; j + 16 <= dim_seq; j += 16) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)&seq1[j]);
+        const __m256i b = _mm256_loadu_si256((const __m256i*)&seq2_i[j]);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+      }
+    } else {
+      for (j = 0; j + 16 <= dim_seq; j += 16) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)&seq1[j]);
+        const __m256i b = _mm256_loadu_si256((const __m256i*)&seq2_i[j]);
+        const __m256i lo = _mm256_mullo_epi16(a, b);
+        const __m256i hi = _mm256_mulhi_epi16(a, b);
+        sum = _mm256_add_epi32(
+            sum, _mm256_sra_epi32(_mm256_unpacklo_epi16(lo, hi), shift));
+        sum = _mm256_add_epi32(
+            sum, _mm256_sra_epi32(_mm256_unpackhi_epi16(lo, hi), shift));
+      }
+    }
+    corr = HorizontalSum(sum);
+    for (; j < dim_seq; j++) {
+      corr += (seq1[j] * seq2_i[j]) >> right_shifts;
+    }
+    cross_correlation[i] = corr;
+  }
+}
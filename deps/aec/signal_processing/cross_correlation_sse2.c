@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 implementation of the function
+ * WebRtcSpl_CrossCorrelation(), bit-exact with the generic C version in
+ * cross_correlation.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+// The sums wrap around at 32 bits as the C version's do, which makes the order
+// of the additions irrelevant.
+static __inline int32_t HorizontalSum(__m128i x) {
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2) {
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  int i = 0, j = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    const int16_t* seq2_i = &seq2[step_seq2 * i];
+    __m128i sum = _mm_setzero_si128();
+    int32_t corr;
+
+    if (right_shifts == 0) {
+      // Pairs of products can be added before the (lack of) shift.
+      for (j = 0; j + 8 <= dim_seq; j += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)&seq1[j]);
+        const __m128i b = _mm_loadu_si128((const __m128i*)&seq2_i[j]);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, b));
+      }
+    } else {
+      for (j = 0; j + 8 <= dim_seq; j += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)&seq1[j]);
+        const __m128i b = _mm_loadu_si128((const __m128i*)&seq2_i[j]);
+        const __m128i lo = _mm_mullo_epi16(a, b);
+        const __m128i hi = _mm_mulhi_epi16(a, b);
+        sum = _mm_add_epi32(
+            sum, _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift));
+        sum = _mm_add_epi32(
+            sum, _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift));
+      }
+    }
+    corr = HorizontalSum(sum);
+    for (; j < dim_seq; j++) {
+      corr += (seq1[j] * seq2_i[j]) >> right_shifts;
+    }
+    cross_correlation[i] = corr;
+  }
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementation of the function
+ * WebRtcSpl_DownsampleFast(), bit-exact with the generic C version in
+ * downsample_fast.c.  It follows downsample_fast_sse2.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+enum { kMaxCoefficients = 256 };
+
+static __inline int32_t HorizontalSum(__m128i x) {
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay) {
+  int16_t reversed[kMaxCoefficients];
+  int i = 0;
+  int j = 0;
+  int vectorized = 0;
+  int32_t out_s32 = 0;
+  int endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length <= 0 || coefficients_length <= 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+
+  if (coefficients_length <= kMaxCoefficients) {
+    vectorized = coefficients_length & ~7;
+    for (j = 0; j < coefficients_length; j++) {
+      reversed[j] = coefficients[coefficients_length - 1 - j];
+    }
+  }
+
+  for (i = delay; i < endpos; i += factor) {
+    const int16_t* window = &data_in[i - coefficients_length + 1];
+    __m256i sum256 = _mm256_setzero_si256();
+    __m128i sum;
+    int k = 0;
+
+    for (k = 0; k + 16 <= vectorized; k += 16) {
+      const __m256i c = _mm256_loadu_si256((const __m256i*)&reversed[k]);
+      const __m256i x = _mm256_loadu_si256((const __m256i*)&window[k]);
+      sum256 = _mm256_add_epi32(sum256, _mm256_madd_epi16(c, x));
+    }
+    sum = _mm_add_epi32(_mm256_castsi256_si128(sum256),
+                        _mm256_extracti128_si256(sum256, 1));
+    if (k < vectorized) {
+      const __m128i c = _mm_loadu_si128((const __m128i*)&reversed[k]);
+      const __m128i x = _mm_loadu_si128((const __m128i*)&window[k]);
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(c, x));
+    }
+    out_s32 = 2048 + HorizontalSum(sum);  // Round value, 0.5 in Q12.
+
+    for (j = vectorized; j < coefficients_length; j++) {
+      out_s32 += coefficients[coefficients_length - 1 - j] * window[j];  // Q12.
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    *data_out++ = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
@@ -87,6 +87,15 @@ int WebRtcSpl_RealForwardFFTNeon(struct RealFFT* self,
                                  int16_t* complex_data_out);
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_RealForwardFFTSSE2(struct RealFFT* self,
+                                 const int16_t* real_data_in,
+                                 int16_t* complex_data_out);
+int WebRtcSpl_RealForwardFFTAVX2(struct RealFFT* self,
+                                 const int16_t* real_data_in,
+                                 int16_t* complex_data_out);
+#endif
+
 // Compute the inverse FFT for a conjugate-symmetric input sequence of length of
 // 2^order, where 1 < order <= MAX_FFT_ORDER. Transform length is determined by
 // the specification structure, which must be initialized prior to calling the
@@ -121,6 +130,15 @@ int WebRtcSpl_RealInverseFFTNeon(struct RealFFT* self,
                                  int16_t* real_data_out);
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_RealInverseFFTSSE2(struct RealFFT* self,
+                                 const int16_t* complex_data_in,
+                                 int16_t* real_data_out);
+int WebRtcSpl_RealInverseFFTAVX2(struct RealFFT* self,
+                                 const int16_t* complex_data_in,
+                                 int16_t* real_data_out);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
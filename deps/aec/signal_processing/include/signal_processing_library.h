@@ -168,8 +168,9 @@ extern "C" {
 // If the underlying platform is known to be ARM-Neon (WEBRTC_ARCH_ARM_NEON
 // defined), the pointers will be assigned to code optimized for Neon; otherwise
 // if run-time Neon detection (WEBRTC_DETECT_ARM_NEON) is enabled, the pointers
-// will be assigned to either Neon code or generic C code; otherwise, generic C
-// code will be assigned.
+// will be assigned to either Neon code or generic C code; on x86 they will be
+// assigned to AVX2 or SSE2 code, whichever the CPU supports; otherwise, generic
+// C code will be assigned.
 // Note that this function MUST be called in any application that uses SPL
 // functions.
 void WebRtcSpl_Init();
@@ -224,6 +225,10 @@ int16_t WebRtcSpl_MaxAbsValueW16C(const int16_t* vector, int length);
 #if (defined WEBRTC_DETECT_ARM_NEON) || (defined WEBRTC_ARCH_ARM_NEON)
 int16_t WebRtcSpl_MaxAbsValueW16Neon(const int16_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MaxAbsValueW16SSE2(const int16_t* vector, int length);
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, int length);
+#endif
 #if defined(MIPS32_LE)
 int16_t WebRtcSpl_MaxAbsValueW16_mips(const int16_t* vector, int length);
 #endif
@@ -242,6 +247,10 @@ int32_t WebRtcSpl_MaxAbsValueW32C(const int32_t* vector, int length);
 #if (defined WEBRTC_DETECT_ARM_NEON) || (defined WEBRTC_ARCH_ARM_NEON)
 int32_t WebRtcSpl_MaxAbsValueW32Neon(const int32_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MaxAbsValueW32SSE2(const int32_t* vector, int length);
+int32_t WebRtcSpl_MaxAbsValueW32AVX2(const int32_t* vector, int length);
+#endif
 #if defined(MIPS_DSP_R1_LE)
 int32_t WebRtcSpl_MaxAbsValueW32_mips(const int32_t* vector, int length);
 #endif
@@ -262,6 +271,10 @@ int16_t WebRtcSpl_MaxValueW16C(const int16_t* vector, int length);
 #if (defined WEBRTC_DETECT_ARM_NEON) || (defined WEBRTC_ARCH_ARM_NEON)
 int16_t WebRtcSpl_MaxValueW16Neon(const int16_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MaxValueW16SSE2(const int16_t* vector, int length);
+int16_t WebRtcSpl_MaxValueW16AVX2(const int16_t* vector, int length);
+#endif
 #if defined(MIPS32_LE)
 int16_t WebRtcSpl_MaxValueW16_mips(const int16_t* vector, int length);
 #endif
@@ -282,6 +295,10 @@ int32_t WebRtcSpl_MaxValueW32C(const int32_t* vector, int length);
 #if (defined WEBRTC_DETECT_ARM_NEON) || (defined WEBRTC_ARCH_ARM_NEON)
 int32_t WebRtcSpl_MaxValueW32Neon(const int32_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MaxValueW32SSE2(const int32_t* vector, int length);
+int32_t WebRtcSpl_MaxValueW32AVX2(const int32_t* vector, int length);
+#endif
 #if defined(MIPS32_LE)
 int32_t WebRtcSpl_MaxValueW32_mips(const int32_t* vector, int length);
 #endif
@@ -302,6 +319,10 @@ int16_t WebRtcSpl_MinValueW16C(const int16_t* vector, int length);
 #if (defined WEBRTC_DETECT_ARM_NEON) || (defined WEBRTC_ARCH_ARM_NEON)
 int16_t WebRtcSpl_MinValueW16Neon(const int16_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MinValueW16SSE2(const int16_t* vector, int length);
+int16_t WebRtcSpl_MinValueW16AVX2(const int16_t* vector, int length);
+#endif
 #if defined(MIPS32_LE)
 int16_t WebRtcSpl_MinValueW16_mips(const int16_t* vector, int length);
 #endif
@@ -322,6 +343,10 @@ int32_t WebRtcSpl_MinValueW32C(const int32_t* vector, int length);
 #if (defined WEBRTC_DETECT_ARM_NEON) || (defined WEBRTC_ARCH_ARM_NEON)
 int32_t WebRtcSpl_MinValueW32Neon(const int32_t* vector, int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MinValueW32SSE2(const int32_t* vector, int length);
+int32_t WebRtcSpl_MinValueW32AVX2(const int32_t* vector, int length);
+#endif
 #if defined(MIPS32_LE)
 int32_t WebRtcSpl_MinValueW32_mips(const int32_t* vector, int length);
 #endif
@@ -459,6 +484,22 @@ int WebRtcSpl_ScaleAndAddVectorsWithRoundNeon(const int16_t* in_vector1,
                                               int16_t* out_vector,
                                               int length);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length);
+int WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length);
+#endif
 #if defined(MIPS_DSP_R1_LE)
 int WebRtcSpl_ScaleAndAddVectorsWithRound_mips(const int16_t* in_vector1,
                                                int16_t in_vector1_scale,
@@ -639,6 +680,22 @@ void WebRtcSpl_CrossCorrelationNeon(int32_t* cross_correlation,
                                     int16_t right_shifts,
                                     int16_t step_seq2);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2);
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2);
+#endif
 #if defined(MIPS32_LE)
 void WebRtcSpl_CrossCorrelation_mips(int32_t* cross_correlation,
                                      const int16_t* seq1,
@@ -792,6 +849,24 @@ int WebRtcSpl_DownsampleFastNeon(const int16_t* data_in,
                                  int factor,
                                  int delay);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay);
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay);
+#endif
 #if defined(MIPS32_LE)
 int WebRtcSpl_DownsampleFast_mips(const int16_t* data_in,
                                   int data_in_length,
@@ -809,6 +884,15 @@ int WebRtcSpl_DownsampleFast_mips(const int16_t* data_in,
 
 int WebRtcSpl_ComplexFFT(int16_t vector[], int stages, int mode);
 int WebRtcSpl_ComplexIFFT(int16_t vector[], int stages, int mode);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Bit-exact with the above in mode 1, which they fall back to in mode 0.
+// Picked by the x86 versions of WebRtcSpl_RealForwardFFT() and
+// WebRtcSpl_RealInverseFFT().
+int WebRtcSpl_ComplexFFTSSE2(int16_t vector[], int stages, int mode);
+int WebRtcSpl_ComplexIFFTSSE2(int16_t vector[], int stages, int mode);
+int WebRtcSpl_ComplexFFTAVX2(int16_t vector[], int stages, int mode);
+int WebRtcSpl_ComplexIFFTAVX2(int16_t vector[], int stages, int mode);
+#endif
 
 // Treat a 16-bit complex data buffer |complex_data| as an array of 32-bit
 // values, and swap elements whose indexes are bit-reverses of each other.
@@ -992,6 +1076,72 @@ void WebRtcSpl_DownsampleBy2(const int16_t* in, int16_t len,
 void WebRtcSpl_UpsampleBy2(const int16_t* in, int16_t len,
                            int16_t* out, int32_t* filtState);
 
+/*******************************************************************
+ * resample_polyphase.c
+ *
+ * Streaming polyphase resampler between any two rates, for several
+ * channels that share the filter. See the description at the bottom of the
+ * file.
+ *
+ ******************************************************************/
+
+struct PolyphaseResampler;
+
+struct PolyphaseResampler* WebRtcSpl_CreatePolyphaseResampler(int in_rate,
+                                                              int out_rate,
+                                                              int channels);
+void WebRtcSpl_FreePolyphaseResampler(struct PolyphaseResampler* self);
+void WebRtcSpl_ResetPolyphaseResampler(struct PolyphaseResampler* self);
+int WebRtcSpl_PolyphaseOutLength(const struct PolyphaseResampler* self,
+                                 int in_length);
+int WebRtcSpl_ResamplePolyphase(struct PolyphaseResampler* self,
+                                int channel,
+                                const int16_t* in,
+                                int in_length,
+                                int16_t* out);
+
+// The filter loop of WebRtcSpl_ResamplePolyphase(). |in_data| starts with
+// |taps| - 1 samples of history, |coefficients| holds |taps| reversed
+// coefficients for each of the |up| phases, |taps| is a multiple of 16.
+// Output sample n is taken at |*position| + n * |down|, in 1 / |up| input
+// samples, for as long as that is within |in_data|. Returns the number of
+// output samples and leaves |*position| at the next one.
+typedef int (*PolyphaseFIR)(const int16_t* in_data,
+                            int in_data_length,
+                            const int16_t* coefficients,
+                            int taps,
+                            int up,
+                            int down,
+                            int* position,
+                            int16_t* out_data);
+extern PolyphaseFIR WebRtcSpl_PolyphaseFIR;
+int WebRtcSpl_PolyphaseFIRC(const int16_t* in_data,
+                            int in_data_length,
+                            const int16_t* coefficients,
+                            int taps,
+                            int up,
+                            int down,
+                            int* position,
+                            int16_t* out_data);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int WebRtcSpl_PolyphaseFIRSSE2(const int16_t* in_data,
+                               int in_data_length,
+                               const int16_t* coefficients,
+                               int taps,
+                               int up,
+                               int down,
+                               int* position,
+                               int16_t* out_data);
+int WebRtcSpl_PolyphaseFIRAVX2(const int16_t* in_data,
+                               int in_data_length,
+                               const int16_t* coefficients,
+                               int taps,
+                               int up,
+                               int down,
+                               int* position,
+                               int16_t* out_data);
+#endif
+
 /************************************************************
  * END OF RESAMPLING FUNCTIONS
  ************************************************************/
@@ -1008,6 +1158,59 @@ void WebRtcSpl_SynthesisQMF(const int16_t* low_band,
                             int32_t* filter_state1,
                             int32_t* filter_state2);
 
+// Multi-channel QMF, see the description at the bottom of the file.
+#define WEBRTC_SPL_QMF_MAX_CHANNELS 4
+#define WEBRTC_SPL_QMF_LANES (2 * WEBRTC_SPL_QMF_MAX_CHANNELS)
+
+// Filter states of up to WEBRTC_SPL_QMF_MAX_CHANNELS channels in structure of
+// arrays form: lane |c| of each tap belongs to the first all-pass filter of
+// channel |c| and lane WEBRTC_SPL_QMF_MAX_CHANNELS + |c| to its second one.
+// Zero it before first use.
+typedef struct {
+  int32_t taps[6][WEBRTC_SPL_QMF_LANES];
+} QMFState;
+
+void WebRtcSpl_AnalysisQMFMulti(const int16_t* const* in_data,
+                                int channels,
+                                int in_data_length,
+                                int16_t* const* low_band,
+                                int16_t* const* high_band,
+                                QMFState* state);
+void WebRtcSpl_SynthesisQMFMulti(const int16_t* const* low_band,
+                                 const int16_t* const* high_band,
+                                 int channels,
+                                 int band_length,
+                                 int16_t* const* out_data,
+                                 QMFState* state);
+
+// The all-pass filter cascade of the multi-channel QMF, over all lanes.
+// |in_data| and |out_data| hold |data_length| samples of
+// WEBRTC_SPL_QMF_LANES lanes each, sample major, and |filter_coefficients|
+// the three coefficients of every lane, coefficient major.
+typedef void (*AllPassQMFMulti)(const int32_t* in_data,
+                                int data_length,
+                                int32_t* out_data,
+                                const uint16_t* filter_coefficients,
+                                QMFState* state);
+extern AllPassQMFMulti WebRtcSpl_AllPassQMFMulti;
+void WebRtcSpl_AllPassQMFMultiC(const int32_t* in_data,
+                                int data_length,
+                                int32_t* out_data,
+                                const uint16_t* filter_coefficients,
+                                QMFState* state);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcSpl_AllPassQMFMultiSSE2(const int32_t* in_data,
+                                   int data_length,
+                                   int32_t* out_data,
+                                   const uint16_t* filter_coefficients,
+                                   QMFState* state);
+void WebRtcSpl_AllPassQMFMultiAVX2(const int32_t* in_data,
+                                   int data_length,
+                                   int32_t* out_data,
+                                   const uint16_t* filter_coefficients,
+                                   QMFState* state);
+#endif
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -1743,6 +1946,72 @@ void WebRtcSpl_SynthesisQMF(const int16_t* low_band,
 //      - out_data      : Super-wideband speech signal, 0-16 kHz
 //
 
+//
+// WebRtcSpl_AnalysisQMFMulti(...)
+// WebRtcSpl_SynthesisQMFMulti(...)
+//
+// WebRtcSpl_AnalysisQMF() and WebRtcSpl_SynthesisQMF() for up to
+// WEBRTC_SPL_QMF_MAX_CHANNELS channels at once, with the same output. The
+// all-pass recursions can't be vectorized in time, so the channels and the two
+// filters of each run side by side in SIMD lanes instead, and splitting four
+// channels costs about as much as splitting one. Channels from |channels| on,
+// and those with a NULL input, are skipped and their lanes of |state| left as
+// they are.
+//
+// Input:
+//      - in_data       : |channels| signals of |in_data_length| samples
+//      - low_band      : |channels| lower-band signals of |band_length| samples
+//      - high_band     : |channels| upper-band signals of |band_length| samples
+//
+// Input & Output:
+//      - state         : Filter states of all channels
+//
+// Output:
+//      - low_band      : |channels| lower-band signals, |in_data_length| / 2
+//                        samples each
+//      - high_band     : |channels| upper-band signals, |in_data_length| / 2
+//                        samples each
+//      - out_data      : |channels| signals of 2 * |band_length| samples
+//
+
+//
+// WebRtcSpl_CreatePolyphaseResampler(...)
+//
+// Creates a resampler from |in_rate| to |out_rate| Hz for |channels|
+// independent signals. The ratio is reduced to up / down, and the input
+// interpolated by up with a windowed sinc filter that also keeps out what
+// would alias at the lower of the two rates, before every down-th sample is
+// taken. Only the needed phases of the filter are computed, with 32 taps
+// each, more when decimating.
+//
+// Input:
+//      - in_rate       : Input sample rate
+//      - out_rate      : Output sample rate
+//      - channels      : Number of signals
+//
+// Return value         : The resampler, or NULL if up is more than 1024 or
+//                        the memory can't be allocated
+//
+
+//
+// WebRtcSpl_ResamplePolyphase(...)
+//
+// Resamples the next |in_length| samples of |channel|. The history and the
+// position of each channel are kept apart, so they can be fed in any order.
+// The output is delayed by half the filter.
+//
+// Input:
+//      - channel       : Signal the input belongs to
+//      - in            : Input signal at the input rate
+//      - in_length     : Number of samples in |in|
+//
+// Output:
+//      - out           : Output signal at the output rate, room for
+//                        WebRtcSpl_PolyphaseOutLength(|in_length|) samples
+//
+// Return value         : Number of output samples
+//
+
 // int16_t WebRtcSpl_SatW32ToW16(...)
 //
 // This function saturates a 32-bit word into a 16-bit word.
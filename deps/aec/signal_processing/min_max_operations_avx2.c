@@ -0,0 +1,218 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementations of the functions
+ * WebRtcSpl_MaxAbsValueW16()
+ * WebRtcSpl_MaxAbsValueW32()
+ * WebRtcSpl_MaxValueW16()
+ * WebRtcSpl_MaxValueW32()
+ * WebRtcSpl_MinValueW16()
+ * WebRtcSpl_MinValueW32()
+ *
+ * They are bit-exact with the generic C versions in min_max_operations.c and
+ * follow min_max_operations_sse2.c.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+#include <stdlib.h>
+
+static __inline __m128i FoldMaxW16(__m256i x) {
+  return _mm_max_epi16(_mm256_castsi256_si128(x),
+                       _mm256_extracti128_si256(x, 1));
+}
+
+static __inline __m128i FoldMinW16(__m256i x) {
+  return _mm_min_epi16(_mm256_castsi256_si128(x),
+                       _mm256_extracti128_si256(x, 1));
+}
+
+static __inline int16_t HorizontalMaxW16(__m128i x) {
+  x = _mm_max_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_max_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  x = _mm_max_epi16(x, _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (int16_t)_mm_cvtsi128_si32(x);
+}
+
+static __inline int16_t HorizontalMinW16(__m128i x) {
+  x = _mm_min_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_min_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  x = _mm_min_epi16(x, _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (int16_t)_mm_cvtsi128_si32(x);
+}
+
+static __inline int32_t HorizontalMaxW32(__m256i y) {
+  __m128i x = _mm_max_epi32(_mm256_castsi256_si128(y),
+                            _mm256_extracti128_si256(y, 1));
+  x = _mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+static __inline int32_t HorizontalMinW32(__m256i y) {
+  __m128i x = _mm_min_epi32(_mm256_castsi256_si128(y),
+                            _mm256_extracti128_si256(y, 1));
+  x = _mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+static __inline uint32_t HorizontalMaxU32(__m256i y) {
+  __m128i x = _mm_max_epu32(_mm256_castsi256_si128(y),
+                            _mm256_extracti128_si256(y, 1));
+  x = _mm_max_epu32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_max_epu32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_cvtsi128_si32(x);
+}
+
+// Maximum absolute value of word16 vector.
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, int length) {
+  __m256i maximum = _mm256_setzero_si256();
+  int i = 0;
+  int16_t result;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // The saturating negation makes abs(-32768) 32767, as the C version does.
+  for (; i + 16 <= length; i += 16) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    maximum = _mm256_max_epi16(maximum, v);
+    maximum = _mm256_max_epi16(maximum,
+                               _mm256_subs_epi16(_mm256_setzero_si256(), v));
+  }
+  result = HorizontalMaxW16(FoldMaxW16(maximum));
+  for (; i < length; i++) {
+    int absolute = abs((int)vector[i]);
+    if (absolute > result) {
+      result = (int16_t)WEBRTC_SPL_MIN(absolute, WEBRTC_SPL_WORD16_MAX);
+    }
+  }
+
+  return result;
+}
+
+// Maximum absolute value of word32 vector.
+int32_t WebRtcSpl_MaxAbsValueW32AVX2(const int32_t* vector, int length) {
+  __m256i maximum = _mm256_setzero_si256();
+  int i = 0;
+  uint32_t result;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // abs(0x80000000) is 0x80000000, the largest unsigned absolute value.
+  for (; i + 8 <= length; i += 8) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    maximum = _mm256_max_epu32(maximum, _mm256_abs_epi32(v));
+  }
+  result = HorizontalMaxU32(maximum);
+  for (; i < length; i++) {
+    uint32_t absolute = abs((int)vector[i]);
+    if (absolute > result) {
+      result = absolute;
+    }
+  }
+
+  return (int32_t)WEBRTC_SPL_MIN(result, WEBRTC_SPL_WORD32_MAX);
+}
+
+// Maximum value of word16 vector.
+int16_t WebRtcSpl_MaxValueW16AVX2(const int16_t* vector, int length) {
+  __m256i maximum = _mm256_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  int i = 0;
+  int16_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD16_MIN;
+  }
+
+  for (; i + 16 <= length; i += 16) {
+    maximum = _mm256_max_epi16(
+        maximum, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  result = HorizontalMaxW16(FoldMaxW16(maximum));
+  for (; i < length; i++) {
+    if (vector[i] > result)
+      result = vector[i];
+  }
+  return result;
+}
+
+// Maximum value of word32 vector.
+int32_t WebRtcSpl_MaxValueW32AVX2(const int32_t* vector, int length) {
+  __m256i maximum = _mm256_set1_epi32(WEBRTC_SPL_WORD32_MIN);
+  int i = 0;
+  int32_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD32_MIN;
+  }
+
+  for (; i + 8 <= length; i += 8) {
+    maximum = _mm256_max_epi32(
+        maximum, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  result = HorizontalMaxW32(maximum);
+  for (; i < length; i++) {
+    if (vector[i] > result)
+      result = vector[i];
+  }
+  return result;
+}
+
+// Minimum value of word16 vector.
+int16_t WebRtcSpl_MinValueW16AVX2(const int16_t* vector, int length) {
+  __m256i minimum = _mm256_set1_epi16(WEBRTC_SPL_WORD16_MAX);
+  int i = 0;
+  int16_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD16_MAX;
+  }
+
+  for (; i + 16 <= length; i += 16) {
+    minimum = _mm256_min_epi16(
+        minimum, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  result = HorizontalMinW16(FoldMinW16(minimum));
+  for (; i < length; i++) {
+    if (vector[i] < result)
+      result = vector[i];
+  }
+  return result;
+}
+
+// Minimum value of word32 vector.
+int32_t WebRtcSpl_MinValueW32AVX2(const int32_t* vector, int length) {
+  __m256i minimum = _mm256_set1_epi32(WEBRTC_SPL_WORD32_MAX);
+  int i = 0;
+  int32_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD32_MAX;
+  }
+
+  for (; i + 8 <= length; i += 8) {
+    minimum = _mm256_min_epi32(
+        minimum, _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  result = HorizontalMinW32(minimum);
+  for (; i < length; i++) {
+    if (vector[i] < result)
+      result = vector[i];
+  }
+  return result;
+}
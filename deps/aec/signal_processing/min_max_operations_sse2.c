@@ -0,0 +1,208 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 implementations of the functions
+ * WebRtcSpl_MaxAbsValueW16()
+ * WebRtcSpl_MaxAbsValueW32()
+ * WebRtcSpl_MaxValueW16()
+ * WebRtcSpl_MaxValueW32()
+ * WebRtcSpl_MinValueW16()
+ * WebRtcSpl_MinValueW32()
+ *
+ * They are bit-exact with the generic C versions in min_max_operations.c.
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <emmintrin.h>
+#include <stdlib.h>
+
+// Largest and smallest of the eight 16-bit lanes, in the lowest lane.
+static __inline int16_t HorizontalMaxW16(__m128i x) {
+  x = _mm_max_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_max_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  x = _mm_max_epi16(x, _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (int16_t)_mm_cvtsi128_si32(x);
+}
+
+static __inline int16_t HorizontalMinW16(__m128i x) {
+  x = _mm_min_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_min_epi16(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  x = _mm_min_epi16(x, _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (int16_t)_mm_cvtsi128_si32(x);
+}
+
+// There are no 32-bit max and min before SSE4.1.
+static __inline __m128i MaxW32(__m128i a, __m128i b) {
+  const __m128i gt = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+static __inline __m128i MinW32(__m128i a, __m128i b) {
+  const __m128i gt = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+static __inline int32_t HorizontalMaxW32(__m128i x) {
+  x = MaxW32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = MaxW32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+static __inline int32_t HorizontalMinW32(__m128i x) {
+  x = MinW32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = MinW32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+// Maximum absolute value of word16 vector.
+int16_t WebRtcSpl_MaxAbsValueW16SSE2(const int16_t* vector, int length) {
+  __m128i maximum = _mm_setzero_si128();
+  int i = 0;
+  int16_t result;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // The saturating negation makes abs(-32768) 32767, as the C version does.
+  for (; i + 8 <= length; i += 8) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)&vector[i]);
+    maximum = _mm_max_epi16(maximum, v);
+    maximum = _mm_max_epi16(maximum, _mm_subs_epi16(_mm_setzero_si128(), v));
+  }
+  result = HorizontalMaxW16(maximum);
+  for (; i < length; i++) {
+    int absolute = abs((int)vector[i]);
+    if (absolute > result) {
+      result = (int16_t)WEBRTC_SPL_MIN(absolute, WEBRTC_SPL_WORD16_MAX);
+    }
+  }
+
+  return result;
+}
+
+// Maximum absolute value of word32 vector.
+int32_t WebRtcSpl_MaxAbsValueW32SSE2(const int32_t* vector, int length) {
+  __m128i maximum = _mm_setzero_si128();
+  int i = 0;
+  int32_t result;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  for (; i + 4 <= length; i += 4) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)&vector[i]);
+    const __m128i sign = _mm_srai_epi32(v, 31);
+    __m128i absolute = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+    // Only abs(0x80000000) is still negative, it becomes 0x7fffffff.
+    absolute = _mm_xor_si128(absolute, _mm_srai_epi32(absolute, 31));
+    maximum = MaxW32(maximum, absolute);
+  }
+  result = HorizontalMaxW32(maximum);
+  for (; i < length; i++) {
+    uint32_t absolute = abs((int)vector[i]);
+    if (absolute > (uint32_t)result) {
+      result = (int32_t)WEBRTC_SPL_MIN(absolute, WEBRTC_SPL_WORD32_MAX);
+    }
+  }
+
+  return result;
+}
+
+// Maximum value of word16 vector.
+int16_t WebRtcSpl_MaxValueW16SSE2(const int16_t* vector, int length) {
+  __m128i maximum = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  int i = 0;
+  int16_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD16_MIN;
+  }
+
+  for (; i + 8 <= length; i += 8) {
+    maximum = _mm_max_epi16(maximum,
+                            _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  result = HorizontalMaxW16(maximum);
+  for (; i < length; i++) {
+    if (vector[i] > result)
+      result = vector[i];
+  }
+  return result;
+}
+
+// Maximum value of word32 vector.
+int32_t WebRtcSpl_MaxValueW32SSE2(const int32_t* vector, int length) {
+  __m128i maximum = _mm_set1_epi32(WEBRTC_SPL_WORD32_MIN);
+  int i = 0;
+  int32_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD32_MIN;
+  }
+
+  for (; i + 4 <= length; i += 4) {
+    maximum = MaxW32(maximum, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  result = HorizontalMaxW32(maximum);
+  for (; i < length; i++) {
+    if (vector[i] > result)
+      result = vector[i];
+  }
+  return result;
+}
+
+// Minimum value of word16 vector.
+int16_t WebRtcSpl_MinValueW16SSE2(const int16_t* vector, int length) {
+  __m128i minimum = _mm_set1_epi16(WEBRTC_SPL_WORD16_MAX);
+  int i = 0;
+  int16_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD16_MAX;
+  }
+
+  for (; i + 8 <= length; i += 8) {
+    minimum = _mm_min_epi16(minimum,
+                            _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  result = HorizontalMinW16(minimum);
+  for (; i < length; i++) {
+    if (vector[i] < result)
+      result = vector[i];
+  }
+  return result;
+}
+
+// Minimum value of word32 vector.
+int32_t WebRtcSpl_MinValueW32SSE2(const int32_t* vector, int length) {
+  __m128i minimum = _mm_set1_epi32(WEBRTC_SPL_WORD32_MAX);
+  int i = 0;
+  int32_t result;
+
+  if (vector == NULL || length <= 0) {
+    return WEBRTC_SPL_WORD32_MAX;
+  }
+
+  for (; i + 4 <= length; i += 4) {
+    minimum = MinW32(minimum, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  result = HorizontalMinW32(minimum);
+  for (; i < length; i++) {
+    if (vector[i] < result)
+      result = vector[i];
+  }
+  return result;
+}
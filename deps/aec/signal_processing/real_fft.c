@@ -101,6 +101,107 @@ int WebRtcSpl_RealInverseFFTC(struct RealFFT* self,
   return result;
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+typedef int (*ComplexTransform)(int16_t* frfi, int stages, int mode);
+
+// Position of complex sample |i| after WebRtcSpl_ComplexBitReverse() of
+// 2^|order| samples.
+static __inline int BitReverse(int i, int order) {
+  int low = i & 0xff;
+  int high = (i >> 8) & 0x3;
+
+  low = ((low & 0x55) << 1) | ((low >> 1) & 0x55);
+  low = ((low & 0x33) << 2) | ((low >> 2) & 0x33);
+  low = ((low & 0x0f) << 4) | ((low >> 4) & 0x0f);
+  high = ((high & 0x1) << 1) | (high >> 1);
+  return ((low << 2) | high) >> (kMaxFFTOrder - order);
+}
+
+// Same as the C versions above, but the samples are scattered straight to
+// their bit reversed positions while the complex buffer is filled, instead
+// of in a separate WebRtcSpl_ComplexBitReverse() pass.
+static int RealForwardFFTX86(struct RealFFT* self,
+                             const int16_t* real_data_in,
+                             int16_t* complex_data_out,
+                             ComplexTransform fft) {
+  int i = 0;
+  int result = 0;
+  int n = 1 << self->order;
+  int16_t complex_buffer[2 << kMaxFFTOrder];
+
+  for (i = 0; i < n; i++) {
+    const int j = BitReverse(i, self->order);
+
+    complex_buffer[2 * j] = real_data_in[i];
+    complex_buffer[2 * j + 1] = 0;
+  }
+
+  result = fft(complex_buffer, self->order, 1);
+  memcpy(complex_data_out, complex_buffer, sizeof(int16_t) * (n + 2));
+
+  return result;
+}
+
+static int RealInverseFFTX86(struct RealFFT* self,
+                             const int16_t* complex_data_in,
+                             int16_t* real_data_out,
+                             ComplexTransform ifft) {
+  int i = 0;
+  int result = 0;
+  int n = 1 << self->order;
+  int16_t complex_buffer[2 << kMaxFFTOrder];
+
+  for (i = 0; i <= n / 2; i++) {
+    const int j = BitReverse(i, self->order);
+
+    complex_buffer[2 * j] = complex_data_in[2 * i];
+    complex_buffer[2 * j + 1] = complex_data_in[2 * i + 1];
+  }
+  for (i = n / 2 + 1; i < n; i++) {
+    const int j = BitReverse(i, self->order);
+
+    complex_buffer[2 * j] = complex_data_in[2 * (n - i)];
+    complex_buffer[2 * j + 1] = -complex_data_in[2 * (n - i) + 1];
+  }
+
+  result = ifft(complex_buffer, self->order, 1);
+
+  for (i = 0; i < n; i++) {
+    real_data_out[i] = complex_buffer[2 * i];
+  }
+
+  return result;
+}
+
+int WebRtcSpl_RealForwardFFTSSE2(struct RealFFT* self,
+                                 const int16_t* real_data_in,
+                                 int16_t* complex_data_out) {
+  return RealForwardFFTX86(self, real_data_in, complex_data_out,
+                           WebRtcSpl_ComplexFFTSSE2);
+}
+
+int WebRtcSpl_RealInverseFFTSSE2(struct RealFFT* self,
+                                 const int16_t* complex_data_in,
+                                 int16_t* real_data_out) {
+  return RealInverseFFTX86(self, complex_data_in, real_data_out,
+                           WebRtcSpl_ComplexIFFTSSE2);
+}
+
+int WebRtcSpl_RealForwardFFTAVX2(struct RealFFT* self,
+                                 const int16_t* real_data_in,
+                                 int16_t* complex_data_out) {
+  return RealForwardFFTX86(self, real_data_in, complex_data_out,
+                           WebRtcSpl_ComplexFFTAVX2);
+}
+
+int WebRtcSpl_RealInverseFFTAVX2(struct RealFFT* self,
+                                 const int16_t* complex_data_in,
+                                 int16_t* real_data_out) {
+  return RealInverseFFTX86(self, complex_data_in, real_data_out,
+                           WebRtcSpl_ComplexIFFTAVX2);
+}
+#endif  // WEBRTC_ARCH_X86_FAMILY
+
 #if defined(WEBRTC_DETECT_ARM_NEON) || defined(WEBRTC_ARCH_ARM_NEON)
 // TODO(kma): Replace the following function bodies into optimized functions
 // for ARM Neon.
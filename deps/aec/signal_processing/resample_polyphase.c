@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the polyphase resampler between arbitrary rates.
+ * The description header can be found in signal_processing_library.h
+ *
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/signal_processing_library.h"
+
+enum {
+  kMaxFactor = 1024,  // Largest up or down factor after the reduction.
+  kBaseTaps = 32,  // Taps per phase when interpolating.
+  kBlockLength = 512  // Input samples filtered per WebRtcSpl_PolyphaseFIR().
+};
+
+// Cutoff of the filter relative to the lower Nyquist frequency, and the
+// Kaiser window shape, which gives about 60 dB of stopband attenuation.
+static const double kRolloff = 0.9;
+static const double kKaiserBeta = 6.0;
+static const double kPi = 3.14159265358979323846;
+
+struct PolyphaseResampler {
+  int up;
+  int down;
+  int taps;
+  int channels;
+  // |taps| reversed coefficients per phase, Q14.
+  int16_t* coefficients;
+  // History of |taps| - 1 samples of each channel, followed by room for the
+  // next input block.
+  int16_t* buffers;
+  // Next output of each channel in 1 / |up| input samples from the start of
+  // its buffer.
+  int* positions;
+};
+
+static int GreatestCommonDivisor(int a, int b) {
+  while (b != 0) {
+    int r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+// Zeroth order modified Bessel function of the first kind.
+static double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  int k;
+
+  for (k = 1; k < 50 && term > 1e-12 * sum; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+// Low-pass prototype of up * taps coefficients at the interpolated rate,
+// Kaiser windowed sinc with a gain of |up|, so that every phase has unity
+// gain, split into phases.
+static void DesignFilter(struct PolyphaseResampler* self) {
+  const int length = self->up * self->taps;
+  const double center = (length - 1) / 2.0;
+  const int max_factor = self->up > self->down ? self->up : self->down;
+  const double cutoff = kRolloff * 0.5 / max_factor;  // Cycles per sample.
+  const double window_norm = BesselI0(kKaiserBeta);
+  int phase, j;
+
+  for (phase = 0; phase < self->up; phase++) {
+    int16_t* c = &self->coefficients[phase * self->taps];
+
+    for (j = 0; j < self->taps; j++) {
+      const int n = phase + (self->taps - 1 - j) * self->up;
+      const double t = n - center;
+      const double r = t / (center + 0.5);
+      const double window =
+          BesselI0(kKaiserBeta * sqrt(r * r < 1.0 ? 1.0 - r * r : 0.0)) /
+          window_norm;
+      double sinc = 2.0 * cutoff;
+      double h;
+
+      if (t != 0.0) {
+        sinc = sin(2.0 * kPi * cutoff * t) / (kPi * t);
+      }
+      h = sinc * window * self->up;
+      c[j] = (int16_t) floor(h * (1 << 14) + 0.5);
+    }
+  }
+}
+
+struct PolyphaseResampler* WebRtcSpl_CreatePolyphaseResampler(int in_rate,
+                                                              int out_rate,
+                                                              int channels) {
+  struct PolyphaseResampler* self = NULL;
+  int divisor;
+  int decimation;
+
+  if (in_rate <= 0 || out_rate <= 0 || channels <= 0) {
+    return NULL;
+  }
+  divisor = GreatestCommonDivisor(in_rate, out_rate);
+  if (out_rate / divisor > kMaxFactor || in_rate / divisor > kMaxFactor) {
+    return NULL;
+  }
+
+  self = calloc(1, sizeof(*self));
+  if (self == NULL) {
+    return NULL;
+  }
+  self->up = out_rate / divisor;
+  self->down = in_rate / divisor;
+  self->channels = channels;
+  // The filter has to get narrower in input samples as the output rate
+  // drops, keep its length in output samples instead.
+  decimation = (self->down + self->up - 1) / self->up;
+  self->taps = kBaseTaps * decimation;
+
+  self->coefficients =
+      malloc(sizeof(*self->coefficients) * self->up * self->taps);
+  self->buffers = malloc(sizeof(*self->buffers) * channels *
+                         (self->taps - 1 + kBlockLength));
+  self->positions = malloc(sizeof(*self->positions) * channels);
+  if (self->coefficients == NULL || self->buffers == NULL ||
+      self->positions == NULL) {
+    WebRtcSpl_FreePolyphaseResampler(self);
+    return NULL;
+  }
+
+  DesignFilter(self);
+  WebRtcSpl_ResetPolyphaseResampler(self);
+
+  return self;
+}
+
+void WebRtcSpl_FreePolyphaseResampler(struct PolyphaseResampler* self) {
+  if (self != NULL) {
+    free(self->coefficients);
+    free(self->buffers);
+    free(self->positions);
+    free(self);
+  }
+}
+
+void WebRtcSpl_ResetPolyphaseResampler(struct PolyphaseResampler* self) {
+  int channel;
+
+  memset(self->buffers, 0, sizeof(*self->buffers) * self->channels *
+                           (self->taps - 1 + kBlockLength));
+  // The first output lines up with the first input sample.
+  for (channel = 0; channel < self->channels; channel++) {
+    self->positions[channel] = (self->taps - 1) * self->up;
+  }
+}
+
+int WebRtcSpl_PolyphaseOutLength(const struct PolyphaseResampler* self,
+                                 int in_length) {
+  return (in_length * self->up + self->down - 1) / self->down;
+}
+
+int WebRtcSpl_PolyphaseFIRC(const int16_t* in_data,
+                            int in_data_length,
+                            const int16_t* coefficients,
+                            int taps,
+                            int up,
+                            int down,
+                            int* position,
+                            int16_t* out_data) {
+  const int step = down / up;
+  const int phase_step = down % up;
+  int i = *position / up;
+  int phase = *position % up;
+  int n = 0;
+  int j;
+
+  while (i < in_data_length) {
+    const int16_t* window = &in_data[i - taps + 1];
+    const int16_t* c = &coefficients[phase * taps];
+    int32_t sum = 1 << 13;  // Round value, 0.5 in Q14.
+
+    for (j = 0; j < taps; j++) {
+      sum += c[j] * window[j];
+    }
+    out_data[n++] = WebRtcSpl_SatW32ToW16(sum >> 14);
+
+    i += step;
+    phase += phase_step;
+    if (phase >= up) {
+      phase -= up;
+      i++;
+    }
+  }
+
+  *position = i * up + phase;
+  return n;
+}
+
+int WebRtcSpl_ResamplePolyphase(struct PolyphaseResampler* self,
+                                int channel,
+                                const int16_t* in,
+                                int in_length,
+                                int16_t* out) {
+  const int history = self->taps - 1;
+  int16_t* buffer = &self->buffers[channel * (history + kBlockLength)];
+  int* position = &self->positions[channel];
+  int out_length = 0;
+
+  while (in_length > 0) {
+    const int block = in_length < kBlockLength ? in_length : kBlockLength;
+
+    memcpy(&buffer[history], in, sizeof(*in) * block);
+    out_length += WebRtcSpl_PolyphaseFIR(buffer, history + block,
+                                         self->coefficients, self->taps,
+                                         self->up, self->down, position,
+                                         &out[out_length]);
+    *position -= block * self->up;
+    memmove(buffer, &buffer[block], sizeof(*buffer) * history);
+
+    in += block;
+    in_length -= block;
+  }
+
+  return out_length;
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementation of the function
+ * WebRtcSpl_PolyphaseFIR(), bit-exact with the generic C version in
+ * resample_polyphase.c.  It follows resample_polyphase_sse2.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+static __inline int32_t HorizontalSum(__m256i y) {
+  __m128i x = _mm_add_epi32(_mm256_castsi256_si128(y),
+                            _mm256_extracti128_si256(y, 1));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+int WebRtcSpl_PolyphaseFIRAVX2(const int16_t* in_data,
+                               int in_data_length,
+                               const int16_t* coefficients,
+                               int taps,
+                               int up,
+                               int down,
+                               int* position,
+                               int16_t* out_data) {
+  const int step = down / up;
+  const int phase_step = down % up;
+  int i = *position / up;
+  int phase = *position % up;
+  int n = 0;
+  int j;
+
+  while (i < in_data_length) {
+    const int16_t* window = &in_data[i - taps + 1];
+    const int16_t* c = &coefficients[phase * taps];
+    __m256i sum = _mm256_setzero_si256();
+
+    for (j = 0; j < taps; j += 16) {
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(
+          _mm256_loadu_si256((const __m256i*)&c[j]),
+          _mm256_loadu_si256((const __m256i*)&window[j])));
+    }
+    // Round value, 0.5 in Q14.
+    out_data[n++] = WebRtcSpl_SatW32ToW16(
+        ((1 << 13) + HorizontalSum(sum)) >> 14);
+
+    i += step;
+    phase += phase_step;
+    if (phase >= up) {
+      phase -= up;
+      i++;
+    }
+  }
+
+  *position = i * up + phase;
+  return n;
+}
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 implementation of the function
+ * WebRtcSpl_PolyphaseFIR(), bit-exact with the generic C version in
+ * resample_polyphase.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+static __inline int32_t HorizontalSum(__m128i x) {
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+int WebRtcSpl_PolyphaseFIRSSE2(const int16_t* in_data,
+                               int in_data_length,
+                               const int16_t* coefficients,
+                               int taps,
+                               int up,
+                               int down,
+                               int* position,
+                               int16_t* out_data) {
+  const int step = down / up;
+  const int phase_step = down % up;
+  int i = *position / up;
+  int phase = *position % up;
+  int n = 0;
+  int j;
+
+  while (i < in_data_length) {
+    const int16_t* window = &in_data[i - taps + 1];
+    const int16_t* c = &coefficients[phase * taps];
+    __m128i sum0 = _mm_setzero_si128();
+    __m128i sum1 = _mm_setzero_si128();
+
+    // |taps| is a multiple of 16, two accumulators hide the add latency.
+    for (j = 0; j < taps; j += 16) {
+      sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(
+          _mm_loadu_si128((const __m128i*)&c[j]),
+          _mm_loadu_si128((const __m128i*)&window[j])));
+      sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(
+          _mm_loadu_si128((const __m128i*)&c[j + 8]),
+          _mm_loadu_si128((const __m128i*)&window[j + 8])));
+    }
+    // Round value, 0.5 in Q14.
+    out_data[n++] = WebRtcSpl_SatW32ToW16(
+        ((1 << 13) + HorizontalSum(_mm_add_epi32(sum0, sum1))) >> 14);
+
+    i += step;
+    phase += phase_step;
+    if (phase >= up) {
+      phase -= up;
+      i++;
+    }
+  }
+
+  *position = i * up + phase;
+  return n;
+}
@@ -9,7 +9,7 @@
  */
 
 /* The global function contained in this file initializes SPL function
- * pointers, currently only for ARM platforms.
+ * pointers, for ARM, MIPS and x86 platforms.
  *
  * Some code came from common/rtcd.c in the WebM project.
  */
@@ -32,6 +32,8 @@ CreateRealFFT WebRtcSpl_CreateRealFFT;
 FreeRealFFT WebRtcSpl_FreeRealFFT;
 RealForwardFFT WebRtcSpl_RealForwardFFT;
 RealInverseFFT WebRtcSpl_RealInverseFFT;
+AllPassQMFMulti WebRtcSpl_AllPassQMFMulti;
+PolyphaseFIR WebRtcSpl_PolyphaseFIR;
 
 #if (defined(WEBRTC_DETECT_ARM_NEON) || !defined(WEBRTC_ARCH_ARM_NEON)) && \
      !defined(MIPS32_LE)
@@ -51,6 +53,8 @@ static void InitPointersToC() {
   WebRtcSpl_FreeRealFFT = WebRtcSpl_FreeRealFFTC;
   WebRtcSpl_RealForwardFFT = WebRtcSpl_RealForwardFFTC;
   WebRtcSpl_RealInverseFFT = WebRtcSpl_RealInverseFFTC;
+  WebRtcSpl_AllPassQMFMulti = WebRtcSpl_AllPassQMFMultiC;
+  WebRtcSpl_PolyphaseFIR = WebRtcSpl_PolyphaseFIRC;
 }
 #endif
 
@@ -71,6 +75,46 @@ static void InitPointersToNeon() {
   WebRtcSpl_FreeRealFFT = WebRtcSpl_FreeRealFFTNeon;
   WebRtcSpl_RealForwardFFT = WebRtcSpl_RealForwardFFTNeon;
   WebRtcSpl_RealInverseFFT = WebRtcSpl_RealInverseFFTNeon;
+  WebRtcSpl_AllPassQMFMulti = WebRtcSpl_AllPassQMFMultiC;
+  WebRtcSpl_PolyphaseFIR = WebRtcSpl_PolyphaseFIRC;
+}
+#endif
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+/* Override the C versions with the SSE2 ones. */
+static void InitPointersToSSE2() {
+  WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16SSE2;
+  WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32SSE2;
+  WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16SSE2;
+  WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32SSE2;
+  WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16SSE2;
+  WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32SSE2;
+  WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationSSE2;
+  WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastSSE2;
+  WebRtcSpl_ScaleAndAddVectorsWithRound =
+      WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2;
+  WebRtcSpl_AllPassQMFMulti = WebRtcSpl_AllPassQMFMultiSSE2;
+  WebRtcSpl_PolyphaseFIR = WebRtcSpl_PolyphaseFIRSSE2;
+  WebRtcSpl_RealForwardFFT = WebRtcSpl_RealForwardFFTSSE2;
+  WebRtcSpl_RealInverseFFT = WebRtcSpl_RealInverseFFTSSE2;
+}
+
+/* Override the SSE2 versions with the AVX2 ones. */
+static void InitPointersToAVX2() {
+  WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16AVX2;
+  WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32AVX2;
+  WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16AVX2;
+  WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32AVX2;
+  WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16AVX2;
+  WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32AVX2;
+  WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationAVX2;
+  WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastAVX2;
+  WebRtcSpl_ScaleAndAddVectorsWithRound =
+      WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2;
+  WebRtcSpl_AllPassQMFMulti = WebRtcSpl_AllPassQMFMultiAVX2;
+  WebRtcSpl_PolyphaseFIR = WebRtcSpl_PolyphaseFIRAVX2;
+  WebRtcSpl_RealForwardFFT = WebRtcSpl_RealForwardFFTAVX2;
+  WebRtcSpl_RealInverseFFT = WebRtcSpl_RealInverseFFTAVX2;
 }
 #endif
 
@@ -88,6 +132,8 @@ static void InitPointersToMIPS() {
   WebRtcSpl_FreeRealFFT = WebRtcSpl_FreeRealFFTC;
   WebRtcSpl_RealForwardFFT = WebRtcSpl_RealForwardFFTC;
   WebRtcSpl_RealInverseFFT = WebRtcSpl_RealInverseFFTC;
+  WebRtcSpl_AllPassQMFMulti = WebRtcSpl_AllPassQMFMultiC;
+  WebRtcSpl_PolyphaseFIR = WebRtcSpl_PolyphaseFIRC;
 #if defined(MIPS_DSP_R1_LE)
   WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32_mips;
   WebRtcSpl_ScaleAndAddVectorsWithRound =
@@ -113,6 +159,14 @@ static void InitFunctionPointers(void) {
   InitPointersToMIPS();
 #else
   InitPointersToC();
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    InitPointersToSSE2();
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    InitPointersToAVX2();
+  }
+#endif
 #endif  /* WEBRTC_DETECT_ARM_NEON */
 }
 
@@ -16,6 +16,7 @@
 #include "include/signal_processing_library.h"
 
 #include <assert.h>
+#include <string.h>
 
 // Maximum number of samples in a low/high-band frame.
 enum
@@ -202,3 +203,206 @@ void WebRtcSpl_SynthesisQMF(const int16_t* low_band, const int16_t* high_band,
     }
 
 }
+
+// Coefficients of the lanes of WebRtcSpl_AllPassQMFMulti(), the first filter
+// of every channel followed by the second one.
+#define QMF_LANES(a) a, a, a, a
+static const uint16_t kAnalysisCoefficients[3][WEBRTC_SPL_QMF_LANES] = {
+  { QMF_LANES(6418), QMF_LANES(21333) },
+  { QMF_LANES(36982), QMF_LANES(49062) },
+  { QMF_LANES(57261), QMF_LANES(63010) }
+};
+static const uint16_t kSynthesisCoefficients[3][WEBRTC_SPL_QMF_LANES] = {
+  { QMF_LANES(21333), QMF_LANES(6418) },
+  { QMF_LANES(49062), QMF_LANES(36982) },
+  { QMF_LANES(63010), QMF_LANES(57261) }
+};
+#undef QMF_LANES
+
+// Same recursion as WebRtcSpl_AllPassQMF(), one sample at a time through all
+// three cascades so that the SIMD versions can keep the state in registers.
+// The state is laid out as in WebRtcSpl_AllPassQMF().
+void WebRtcSpl_AllPassQMFMultiC(const int32_t* in_data, int data_length,
+                                int32_t* out_data,
+                                const uint16_t* filter_coefficients,
+                                QMFState* state)
+{
+    int lane;
+    int k;
+
+    for (lane = 0; lane < WEBRTC_SPL_QMF_LANES; lane++)
+    {
+        const uint16_t a1 = filter_coefficients[lane];
+        const uint16_t a2 = filter_coefficients[WEBRTC_SPL_QMF_LANES + lane];
+        const uint16_t a3 = filter_coefficients[2 * WEBRTC_SPL_QMF_LANES + lane];
+        int32_t x1 = state->taps[0][lane];  // x[n-1]
+        int32_t y1 = state->taps[1][lane];  // y_1[n-1]
+        int32_t x2 = state->taps[2][lane];  // y_1[n-1], input of the 2nd cascade
+        int32_t y2 = state->taps[3][lane];  // y_2[n-1]
+        int32_t x3 = state->taps[4][lane];  // y_2[n-1], input of the 3rd cascade
+        int32_t y3 = state->taps[5][lane];  // y[n-1]
+
+        for (k = 0; k < data_length; k++)
+        {
+            const int32_t x = in_data[k * WEBRTC_SPL_QMF_LANES + lane];
+            int32_t diff;
+
+            diff = WEBRTC_SPL_SUB_SAT_W32(x, y1);
+            y1 = WEBRTC_SPL_SCALEDIFF32(a1, diff, x1);
+            x1 = x;
+            diff = WEBRTC_SPL_SUB_SAT_W32(y1, y2);
+            y2 = WEBRTC_SPL_SCALEDIFF32(a2, diff, x2);
+            x2 = y1;
+            diff = WEBRTC_SPL_SUB_SAT_W32(y2, y3);
+            y3 = WEBRTC_SPL_SCALEDIFF32(a3, diff, x3);
+            x3 = y2;
+            out_data[k * WEBRTC_SPL_QMF_LANES + lane] = y3;
+        }
+
+        state->taps[0][lane] = x1;
+        state->taps[1][lane] = y1;
+        state->taps[2][lane] = x2;
+        state->taps[3][lane] = y2;
+        state->taps[4][lane] = x3;
+        state->taps[5][lane] = y3;
+    }
+}
+
+// Runs WebRtcSpl_AllPassQMFMulti() over all lanes and puts back the state of
+// the channels that are not in use.
+static void AllPassQMFChannels(const int32_t* in_data, int data_length,
+                               int32_t* out_data,
+                               const uint16_t* filter_coefficients,
+                               const int* active, QMFState* state)
+{
+    QMFState saved = *state;
+    int c;
+    int j;
+
+    WebRtcSpl_AllPassQMFMulti(in_data, data_length, out_data,
+                              filter_coefficients, state);
+    for (c = 0; c < WEBRTC_SPL_QMF_MAX_CHANNELS; c++)
+    {
+        if (active[c])
+            continue;
+        for (j = 0; j < 6; j++)
+        {
+            state->taps[j][c] = saved.taps[j][c];
+            state->taps[j][WEBRTC_SPL_QMF_MAX_CHANNELS + c] =
+                saved.taps[j][WEBRTC_SPL_QMF_MAX_CHANNELS + c];
+        }
+    }
+}
+
+void WebRtcSpl_AnalysisQMFMulti(const int16_t* const* in_data, int channels,
+                                int in_data_length, int16_t* const* low_band,
+                                int16_t* const* high_band, QMFState* state)
+{
+    int32_t half_in[kMaxBandFrameLength * WEBRTC_SPL_QMF_LANES];
+    int32_t filter[kMaxBandFrameLength * WEBRTC_SPL_QMF_LANES];
+    int active[WEBRTC_SPL_QMF_MAX_CHANNELS] = { 0 };
+    const int band_length = in_data_length / 2;
+    int32_t tmp;
+    int c;
+    int i;
+    assert(in_data_length % 2 == 0);
+    assert(band_length <= kMaxBandFrameLength);
+    assert(channels <= WEBRTC_SPL_QMF_MAX_CHANNELS);
+
+    // Odd samples of channel c go to lane c, even ones to the lane of its
+    // second filter, in Q10.
+    memset(half_in, 0, sizeof(*half_in) * band_length * WEBRTC_SPL_QMF_LANES);
+    for (c = 0; c < channels; c++)
+    {
+        const int16_t* in = in_data[c];
+        int32_t* lane = &half_in[c];
+
+        if (in == NULL)
+            continue;
+        active[c] = 1;
+        for (i = 0; i < band_length; i++, lane += WEBRTC_SPL_QMF_LANES)
+        {
+            lane[0] = WEBRTC_SPL_LSHIFT_W32((int32_t)in[2 * i + 1], 10);
+            lane[WEBRTC_SPL_QMF_MAX_CHANNELS] =
+                WEBRTC_SPL_LSHIFT_W32((int32_t)in[2 * i], 10);
+        }
+    }
+
+    AllPassQMFChannels(half_in, band_length, filter,
+                       &kAnalysisCoefficients[0][0], active, state);
+
+    for (c = 0; c < channels; c++)
+    {
+        const int32_t* lane = &filter[c];
+
+        if (!active[c])
+            continue;
+        for (i = 0; i < band_length; i++, lane += WEBRTC_SPL_QMF_LANES)
+        {
+            tmp = lane[0] + lane[WEBRTC_SPL_QMF_MAX_CHANNELS] + 1024;
+            tmp = WEBRTC_SPL_RSHIFT_W32(tmp, 11);
+            low_band[c][i] = WebRtcSpl_SatW32ToW16(tmp);
+
+            tmp = lane[0] - lane[WEBRTC_SPL_QMF_MAX_CHANNELS] + 1024;
+            tmp = WEBRTC_SPL_RSHIFT_W32(tmp, 11);
+            high_band[c][i] = WebRtcSpl_SatW32ToW16(tmp);
+        }
+    }
+}
+
+void WebRtcSpl_SynthesisQMFMulti(const int16_t* const* low_band,
+                                 const int16_t* const* high_band,
+                                 int channels, int band_length,
+                                 int16_t* const* out_data, QMFState* state)
+{
+    int32_t half_in[kMaxBandFrameLength * WEBRTC_SPL_QMF_LANES];
+    int32_t filter[kMaxBandFrameLength * WEBRTC_SPL_QMF_LANES];
+    int active[WEBRTC_SPL_QMF_MAX_CHANNELS] = { 0 };
+    int32_t tmp;
+    int c;
+    int i;
+    assert(band_length <= kMaxBandFrameLength);
+    assert(channels <= WEBRTC_SPL_QMF_MAX_CHANNELS);
+
+    // Sum of the bands of channel c goes to lane c, the difference to the lane
+    // of its second filter, in Q10.
+    memset(half_in, 0, sizeof(*half_in) * band_length * WEBRTC_SPL_QMF_LANES);
+    for (c = 0; c < channels; c++)
+    {
+        const int16_t* low = low_band[c];
+        const int16_t* high = high_band[c];
+        int32_t* lane = &half_in[c];
+
+        if (low == NULL)
+            continue;
+        active[c] = 1;
+        for (i = 0; i < band_length; i++, lane += WEBRTC_SPL_QMF_LANES)
+        {
+            tmp = (int32_t)low[i] + (int32_t)high[i];
+            lane[0] = WEBRTC_SPL_LSHIFT_W32(tmp, 10);
+            tmp = (int32_t)low[i] - (int32_t)high[i];
+            lane[WEBRTC_SPL_QMF_MAX_CHANNELS] = WEBRTC_SPL_LSHIFT_W32(tmp, 10);
+        }
+    }
+
+    AllPassQMFChannels(half_in, band_length, filter,
+                       &kSynthesisCoefficients[0][0], active, state);
+
+    for (c = 0; c < channels; c++)
+    {
+        const int32_t* lane = &filter[c];
+        int16_t* out = out_data[c];
+
+        if (!active[c])
+            continue;
+        for (i = 0; i < band_length; i++, lane += WEBRTC_SPL_QMF_LANES)
+        {
+            tmp = WEBRTC_SPL_RSHIFT_W32(lane[WEBRTC_SPL_QMF_MAX_CHANNELS] + 512,
+                                        10);
+            *out++ = WebRtcSpl_SatW32ToW16(tmp);
+
+            tmp = WEBRTC_SPL_RSHIFT_W32(lane[0] + 512, 10);
+            *out++ = WebRtcSpl_SatW32ToW16(tmp);
+        }
+    }
+}
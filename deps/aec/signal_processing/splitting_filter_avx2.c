@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementation of the function
+ * WebRtcSpl_AllPassQMFMulti(), bit-exact with the generic C version in
+ * splitting_filter.c.  It follows splitting_filter_sse2.c, with all eight
+ * lanes in one register.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+static __inline __m256i SubSat(__m256i a, __m256i b) {
+  const __m256i diff = _mm256_sub_epi32(a, b);
+  const __m256i overflow = _mm256_srai_epi32(
+      _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, diff)), 31);
+  const __m256i saturated = _mm256_xor_si256(_mm256_srai_epi32(a, 31),
+                                             _mm256_set1_epi32(0x7fffffff));
+  return _mm256_blendv_epi8(diff, saturated, overflow);
+}
+
+// The signed multiply needs no correction, unlike the SSE2 version.
+static __inline __m256i ScaleDiff(__m256i a, __m256i diff, __m256i c) {
+  const __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(diff, a), 16);
+  const __m256i odd = _mm256_slli_epi64(
+      _mm256_mul_epi32(_mm256_srli_epi64(diff, 32), _mm256_srli_epi64(a, 32)),
+      16);
+  return _mm256_add_epi32(c, _mm256_blend_epi32(even, odd, 0xaa));
+}
+
+void WebRtcSpl_AllPassQMFMultiAVX2(const int32_t* in_data,
+                                   int data_length,
+                                   int32_t* out_data,
+                                   const uint16_t* filter_coefficients,
+                                   QMFState* state) {
+  const __m256i a1 = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128((const __m128i*)&filter_coefficients[0]));
+  const __m256i a2 = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128((const __m128i*)&filter_coefficients[8]));
+  const __m256i a3 = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128((const __m128i*)&filter_coefficients[16]));
+  __m256i x1 = _mm256_loadu_si256((const __m256i*)state->taps[0]);
+  __m256i y1 = _mm256_loadu_si256((const __m256i*)state->taps[1]);
+  __m256i x2 = _mm256_loadu_si256((const __m256i*)state->taps[2]);
+  __m256i y2 = _mm256_loadu_si256((const __m256i*)state->taps[3]);
+  __m256i x3 = _mm256_loadu_si256((const __m256i*)state->taps[4]);
+  __m256i y3 = _mm256_loadu_si256((const __m256i*)state->taps[5]);
+  int k;
+
+  for (k = 0; k < data_length; k++) {
+    const __m256i x = _mm256_loadu_si256(
+        (const __m256i*)&in_data[k * WEBRTC_SPL_QMF_LANES]);
+
+    y1 = ScaleDiff(a1, SubSat(x, y1), x1);
+    x1 = x;
+    y2 = ScaleDiff(a2, SubSat(y1, y2), x2);
+    x2 = y1;
+    y3 = ScaleDiff(a3, SubSat(y2, y3), x3);
+    x3 = y2;
+    _mm256_storeu_si256((__m256i*)&out_data[k * WEBRTC_SPL_QMF_LANES], y3);
+  }
+
+  _mm256_storeu_si256((__m256i*)state->taps[0], x1);
+  _mm256_storeu_si256((__m256i*)state->taps[1], y1);
+  _mm256_storeu_si256((__m256i*)state->taps[2], x2);
+  _mm256_storeu_si256((__m256i*)state->taps[3], y2);
+  _mm256_storeu_si256((__m256i*)state->taps[4], x3);
+  _mm256_storeu_si256((__m256i*)state->taps[5], y3);
+}
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2011 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 implementation of the function
+ * WebRtcSpl_AllPassQMFMulti(), bit-exact with the generic C version in
+ * splitting_filter.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+// WEBRTC_SPL_SUB_SAT_W32(a, b): the difference overflows when the operands
+// have different signs and the result the sign of |b|.
+static __inline __m128i SubSat(__m128i a, __m128i b) {
+  const __m128i diff = _mm_sub_epi32(a, b);
+  const __m128i overflow = _mm_srai_epi32(
+      _mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, diff)), 31);
+  const __m128i saturated = _mm_xor_si128(_mm_srai_epi32(a, 31),
+                                          _mm_set1_epi32(0x7fffffff));
+  return _mm_or_si128(_mm_and_si128(overflow, saturated),
+                      _mm_andnot_si128(overflow, diff));
+}
+
+// WEBRTC_SPL_SCALEDIFF32(a, diff, c), that is c + ((int64_t)diff * a >> 16).
+// SSE2 only multiplies unsigned, which adds a << 32 to the product of a
+// negative |diff|, so a << 16 comes off the shifted result for those.
+static __inline __m128i ScaleDiff(__m128i a, __m128i diff, __m128i c) {
+  const __m128i low_mask = _mm_set_epi32(0, -1, 0, -1);
+  const __m128i even = _mm_srli_epi64(_mm_mul_epu32(diff, a), 16);
+  const __m128i odd = _mm_slli_epi64(
+      _mm_mul_epu32(_mm_srli_epi64(diff, 32), _mm_srli_epi64(a, 32)), 16);
+  const __m128i product = _mm_or_si128(_mm_and_si128(even, low_mask),
+                                       _mm_andnot_si128(low_mask, odd));
+  const __m128i correction = _mm_and_si128(_mm_srai_epi32(diff, 31),
+                                           _mm_slli_epi32(a, 16));
+  return _mm_add_epi32(c, _mm_sub_epi32(product, correction));
+}
+
+static __inline __m128i LoadCoefficients(const uint16_t* coefficients) {
+  return _mm_unpacklo_epi16(
+      _mm_loadl_epi64((const __m128i*)coefficients), _mm_setzero_si128());
+}
+
+void WebRtcSpl_AllPassQMFMultiSSE2(const int32_t* in_data,
+                                   int data_length,
+                                   int32_t* out_data,
+                                   const uint16_t* filter_coefficients,
+                                   QMFState* state) {
+  __m128i a[3][2];
+  __m128i taps[6][2];
+  int h, j, k;
+
+  for (j = 0; j < 3; j++) {
+    for (h = 0; h < 2; h++) {
+      a[j][h] = LoadCoefficients(
+          &filter_coefficients[j * WEBRTC_SPL_QMF_LANES + 4 * h]);
+    }
+  }
+  for (j = 0; j < 6; j++) {
+    for (h = 0; h < 2; h++) {
+      taps[j][h] = _mm_loadu_si128((const __m128i*)&state->taps[j][4 * h]);
+    }
+  }
+
+  // The two halves of the lanes, see WebRtcSpl_AllPassQMFMultiC() for the
+  // recursion.
+  for (k = 0; k < data_length; k++) {
+    for (h = 0; h < 2; h++) {
+      const __m128i x = _mm_loadu_si128(
+          (const __m128i*)&in_data[k * WEBRTC_SPL_QMF_LANES + 4 * h]);
+
+      taps[1][h] = ScaleDiff(a[0][h], SubSat(x, taps[1][h]), taps[0][h]);
+      taps[0][h] = x;
+      taps[3][h] = ScaleDiff(a[1][h], SubSat(taps[1][h], taps[3][h]),
+                             taps[2][h]);
+      taps[2][h] = taps[1][h];
+      taps[5][h] = ScaleDiff(a[2][h], SubSat(taps[3][h], taps[5][h]),
+                             taps[4][h]);
+      taps[4][h] = taps[3][h];
+      _mm_storeu_si128(
+          (__m128i*)&out_data[k * WEBRTC_SPL_QMF_LANES + 4 * h], taps[5][h]);
+    }
+  }
+
+  for (j = 0; j < 6; j++) {
+    for (h = 0; h < 2; h++) {
+      _mm_storeu_si128((__m128i*)&state->taps[j][4 * h], taps[j][h]);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the AVX2 implementation of the function
+ * WebRtcSpl_ScaleAndAddVectorsWithRound(), bit-exact with the generic C
+ * version in vector_scaling_operations.c.  It follows
+ * vector_scaling_operations_sse2.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+static __inline __m256i Truncate(__m256i x) {
+  return _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16);
+}
+
+int WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length) {
+  int i = 0;
+  int round_value = (1 << right_shifts) >> 1;
+  __m256i scales;
+  __m256i round;
+  __m128i shift;
+
+  if (in_vector1 == NULL || in_vector2 == NULL || out_vector == NULL ||
+      length <= 0 || right_shifts < 0) {
+    return -1;
+  }
+
+  // The unpacks and the pack all work within 128-bit halves, so the samples
+  // come out in the order they went in.
+  scales = _mm256_set1_epi32(
+      (int32_t)(((uint32_t)(uint16_t)in_vector2_scale << 16) |
+                (uint16_t)in_vector1_scale));
+  round = _mm256_set1_epi32(round_value);
+  shift = _mm_cvtsi32_si128(right_shifts);
+  for (; i + 16 <= length; i += 16) {
+    const __m256i a = _mm256_loadu_si256((const __m256i*)&in_vector1[i]);
+    const __m256i b = _mm256_loadu_si256((const __m256i*)&in_vector2[i]);
+    const __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), scales);
+    const __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), scales);
+    const __m256i out_lo =
+        _mm256_sra_epi32(_mm256_add_epi32(lo, round), shift);
+    const __m256i out_hi =
+        _mm256_sra_epi32(_mm256_add_epi32(hi, round), shift);
+    _mm256_storeu_si256(
+        (__m256i*)&out_vector[i],
+        _mm256_packs_epi32(Truncate(out_lo), Truncate(out_hi)));
+  }
+  for (; i < length; i++) {
+    out_vector[i] = (int16_t)((
+        WEBRTC_SPL_MUL_16_16(in_vector1[i], in_vector1_scale)
+        + WEBRTC_SPL_MUL_16_16(in_vector2[i], in_vector2_scale)
+        + round_value) >> right_shifts);
+  }
+
+  return 0;
+}
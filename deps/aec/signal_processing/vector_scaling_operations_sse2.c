@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the SSE2 implementation of the function
+ * WebRtcSpl_ScaleAndAddVectorsWithRound(), bit-exact with the generic C
+ * version in vector_scaling_operations.c.
+ *
+ * The description header can be found in signal_processing_library.h.
+ *
+ */
+
+#include "include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+// The C version truncates the result to 16 bits instead of saturating it, so
+// the upper half is dropped before the saturating pack.
+static __inline __m128i Truncate(__m128i x) {
+  return _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+}
+
+int WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2(const int16_t* in_vector1,
+                                              int16_t in_vector1_scale,
+                                              const int16_t* in_vector2,
+                                              int16_t in_vector2_scale,
+                                              int right_shifts,
+                                              int16_t* out_vector,
+                                              int length) {
+  int i = 0;
+  int round_value = (1 << right_shifts) >> 1;
+  __m128i scales;
+  __m128i round;
+  __m128i shift;
+
+  if (in_vector1 == NULL || in_vector2 == NULL || out_vector == NULL ||
+      length <= 0 || right_shifts < 0) {
+    return -1;
+  }
+
+  // Both products of a sample pair are added by one madd.
+  scales = _mm_set1_epi32(
+      (int32_t)(((uint32_t)(uint16_t)in_vector2_scale << 16) |
+                (uint16_t)in_vector1_scale));
+  round = _mm_set1_epi32(round_value);
+  shift = _mm_cvtsi32_si128(right_shifts);
+  for (; i + 8 <= length; i += 8) {
+    const __m128i a = _mm_loadu_si128((const __m128i*)&in_vector1[i]);
+    const __m128i b = _mm_loadu_si128((const __m128i*)&in_vector2[i]);
+    const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), scales);
+    const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), scales);
+    const __m128i out_lo = _mm_sra_epi32(_mm_add_epi32(lo, round), shift);
+    const __m128i out_hi = _mm_sra_epi32(_mm_add_epi32(hi, round), shift);
+    _mm_storeu_si128((__m128i*)&out_vector[i],
+                     _mm_packs_epi32(Truncate(out_lo), Truncate(out_hi)));
+  }
+  for (; i < length; i++) {
+    out_vector[i] = (int16_t)((
+        WEBRTC_SPL_MUL_16_16(in_vector1[i], in_vector1_scale)
+        + WEBRTC_SPL_MUL_16_16(in_vector2[i], in_vector2_scale)
+        + round_value) >> right_shifts);
+  }
+
+  return 0;
+}
@@ -0,0 +1,290 @@
+/*
+ * Bit-exactness of the SSE2 and AVX2 AGC kernels against the C path, first
+ * one kernel at a time on random and full scale input and then end to end,
+ * through WebRtcAgc_Process(), in the analog and the digital mode.
+ *
+ * Usage: agc_simd_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "agc/analog_agc.h"
+#include "agc/digital_agc.h"
+#include "agc/include/gain_control.h"
+#include "webrtc/cpu_features_wrapper.h"
+#include "test/test_util.h"
+
+static const int kTrials = 20000;
+static const int kFrames = 3000;
+// Longest run of samples the kernels are given, 20 sub frames of 16.
+enum { kMaxSamples = 320 };
+
+typedef struct {
+  const char* name;
+  WebRtc_CPUInfo cpu_info;
+  WebRtcAgc_Envelope_t envelope;
+  WebRtcAgc_BlockEnergy_t block_energy;
+  WebRtcAgc_ScaleSaturate_t scale_saturate;
+  WebRtcAgc_ApplyGains_t apply_gains;
+} Path;
+
+// Random samples within +-|range|, with a few at full scale so that both
+// ends of the 16-bit range are always covered.
+static void Fill(int16_t* x, int len, int range) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    x[i] = (int16_t) Uniform(-range, range);
+  }
+  for (i = 0; i < 4; i++) {
+    x[Uniform(0, len - 1)] = (int16_t) (Uniform(0, 1) ? 32767 : -32768);
+  }
+}
+
+static int Compare16(const int16_t* a, const int16_t* b, int len) {
+  int i, n = 0;
+
+  for (i = 0; i < len; i++) {
+    n += a[i] != b[i];
+  }
+  return n;
+}
+
+static int Compare32(const int32_t* a, const int32_t* b, int len) {
+  int i, n = 0;
+
+  for (i = 0; i < len; i++) {
+    n += a[i] != b[i];
+  }
+  return n;
+}
+
+// The kernels are picked in WebRtcAgc_Init(), so |cpu_info| only has to be in
+// place while the instance is initialized.
+static void* CreateInstance(int mode, int rate, WebRtc_CPUInfo cpu_info) {
+  void* agc;
+
+  WebRtc_GetCPUInfo = cpu_info;
+  if (WebRtcAgc_Create(&agc) != 0 ||
+      WebRtcAgc_Init(agc, 0, 255, mode, rate) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+
+  return agc;
+}
+
+static void Capture(Path* path) {
+  void* agc = CreateInstance(kAgcModeAdaptiveDigital, 8000, path->cpu_info);
+
+  path->envelope = WebRtcAgc_Envelope;
+  path->block_energy = WebRtcAgc_BlockEnergy;
+  path->scale_saturate = WebRtcAgc_ScaleSaturate;
+  path->apply_gains = WebRtcAgc_ApplyGains;
+  WebRtcAgc_Free(agc);
+}
+
+static void TestEnvelope(const Path* c, const Path* simd) {
+  int16_t in[kMaxSamples];
+  int32_t env_a[20];
+  int32_t env_b[20];
+  int mismatches = 0;
+  int i;
+
+  for (i = 0; i < kTrials; i++) {
+    int16_t len = Uniform(0, 1) ? 8 : 16;
+    int16_t subframes = (int16_t) Uniform(1, 20);
+
+    Fill(in, len * subframes, Uniform(1, 32767));
+    c->envelope(in, len, subframes, env_a);
+    simd->envelope(in, len, subframes, env_b);
+    mismatches += Compare32(env_a, env_b, subframes);
+  }
+  Check(simd->name, "Envelope", mismatches);
+}
+
+static void TestBlockEnergy(const Path* c, const Path* simd) {
+  int16_t in[kMaxSamples];
+  int32_t nrg_a[20];
+  int32_t nrg_b[20];
+  int mismatches = 0;
+  int i;
+
+  for (i = 0; i < kTrials; i++) {
+    int16_t blocks = (int16_t) Uniform(1, 20);
+
+    Fill(in, 16 * blocks, Uniform(1, 32767));
+    c->block_energy(in, blocks, nrg_a);
+    simd->block_energy(in, blocks, nrg_b);
+    mismatches += Compare32(nrg_a, nrg_b, blocks);
+  }
+  Check(simd->name, "BlockEnergy", mismatches);
+}
+
+static void TestScaleSaturate(const Path* c, const Path* simd) {
+  int16_t a[kMaxSamples];
+  int16_t b[kMaxSamples];
+  int mismatches = 0;
+  int i;
+
+  for (i = 0; i < kTrials; i++) {
+    // Any length, so that the scalar tails are covered too.
+    int16_t len = (int16_t) Uniform(1, kMaxSamples);
+    uint16_t gain = (uint16_t) Uniform(0, 32767);
+
+    Fill(a, len, Uniform(1, 32767));
+    memcpy(b, a, sizeof(*a) * len);
+    c->scale_saturate(a, len, gain);
+    simd->scale_saturate(b, len, gain);
+    mismatches += Compare16(a, b, len);
+  }
+  Check(simd->name, "ScaleSaturate", mismatches);
+}
+
+static void TestApplyGains(const Path* c, const Path* simd) {
+  int16_t a[160];
+  int16_t b[160];
+  int32_t gains[11];
+  int mismatches = 0;
+  int i, k;
+
+  for (i = 0; i < kTrials; i++) {
+    int16_t L2 = (int16_t) (Uniform(0, 1) ? 3 : 4);
+    // Gains up to 0 dB on full scale input, and up to 24 dB on input that
+    // leaves room for them; the C version overflows beyond that.
+    int loud = Uniform(0, 1);
+    int max_gain = loud ? 65536 : 65536 * 16;
+
+    for (k = 0; k < 11; k++) {
+      gains[k] = Uniform(0, max_gain);
+    }
+    if (loud) {
+      Fill(a, 10 << L2, 32767);
+    } else {
+      for (k = 0; k < 10 << L2; k++) {
+        a[k] = (int16_t) Uniform(-2047, 2047);
+      }
+    }
+    memcpy(b, a, sizeof(a));
+    c->apply_gains(gains, L2, a);
+    simd->apply_gains(gains, L2, b);
+    mismatches += Compare16(a, b, 10 << L2);
+  }
+  Check(simd->name, "ApplyGains", mismatches);
+}
+
+// Speech-like bursts of changing loudness over a noise floor, one 10 ms frame
+// per band at a time.
+static void Generate(int16_t* frame, int len, int index, unsigned* state) {
+  static const double kLevels[] = { 0.02, 0.3, 0.005, 1.0, 0.1 };
+  double env = kLevels[(index / 50) % 5];
+  int i;
+
+  for (i = 0; i < len; i++) {
+    double v;
+
+    *state = *state * 1103515245u + 12345u;
+    v = (((*state >> 8) & 0xffff) - 32768.0) / 64.0;
+    v += env * 32000.0 * sin((index * len + i) * 0.05);
+    frame[i] = (int16_t) WEBRTC_SPL_SAT(32767.0, v, -32768.0);
+  }
+}
+
+// The output of both bands followed by the mic levels, one per frame.
+static int16_t* Process(int mode, int rate, WebRtc_CPUInfo cpu_info) {
+  void* agc = CreateInstance(mode, rate, cpu_info);
+  const int len = rate == 32000 ? 160 : rate / 100;
+  int16_t* out = malloc(sizeof(*out) * (2 * len + 1) * kFrames);
+  int16_t lo[160];
+  int16_t hi[160];
+  int32_t level = 128;
+  unsigned state = 1;
+  int i;
+
+  for (i = 0; i < kFrames; i++) {
+    int16_t* frame = &out[i * (2 * len + 1)];
+    int16_t* frame_hi = rate == 32000 ? hi : NULL;
+    uint8_t warning;
+
+    Generate(lo, len, i, &state);
+    Generate(hi, len, i, &state);
+    if (mode == kAgcModeAdaptiveAnalog &&
+        WebRtcAgc_AddMic(agc, lo, frame_hi, len) != 0) {
+      abort();
+    }
+    if (WebRtcAgc_Process(agc, lo, frame_hi, len, frame, frame + len,
+                          level, &level, 0, &warning) != 0) {
+      abort();
+    }
+    if (rate != 32000) {
+      memset(frame + len, 0, sizeof(*frame) * len);
+    }
+    frame[2 * len] = (int16_t) level;
+  }
+  WebRtcAgc_Free(agc);
+
+  return out;
+}
+
+int main() {
+  static const int rates[] = { 8000, 16000, 32000 };
+  static const int modes[] = { kAgcModeAdaptiveAnalog,
+                               kAgcModeAdaptiveDigital,
+                               kAgcModeFixedDigital };
+  Path paths[3];
+  int count = 0;
+  size_t i, m;
+  int j;
+
+  host_cpu_info = WebRtc_GetCPUInfo;
+
+  paths[count].name = "c";
+  paths[count++].cpu_info = WebRtc_GetCPUInfoNoASM;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (host_cpu_info(kSSE2)) {
+    paths[count].name = "sse2";
+    paths[count++].cpu_info = SSE2Only;
+  }
+  if (host_cpu_info(kAVX2)) {
+    paths[count].name = "avx2";
+    paths[count++].cpu_info = host_cpu_info;
+  }
+#endif
+  for (j = 0; j < count; j++) {
+    Capture(&paths[j]);
+  }
+
+  printf("%-6s %-28s %12s\n", "path", "check", "mismatches");
+  for (j = 1; j < count; j++) {
+    TestEnvelope(&paths[0], &paths[j]);
+    TestBlockEnergy(&paths[0], &paths[j]);
+    TestScaleSaturate(&paths[0], &paths[j]);
+    TestApplyGains(&paths[0], &paths[j]);
+  }
+  for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+      const int len = rates[i] == 32000 ? 160 : rates[i] / 100;
+      int16_t* expected = Process(modes[m], rates[i], paths[0].cpu_info);
+
+      for (j = 1; j < count; j++) {
+        int16_t* actual = Process(modes[m], rates[i], paths[j].cpu_info);
+        char what[32];
+
+        snprintf(what, sizeof(what), "Process mode %d %d", modes[m], rates[i]);
+        Check(paths[j].name, what,
+              Compare16(expected, actual, (2 * len + 1) * kFrames));
+        free(actual);
+      }
+      free(expected);
+    }
+  }
+
+  if (failures != 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
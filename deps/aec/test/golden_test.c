@@ -0,0 +1,683 @@
+/*
+ * Every dispatch path against golden outputs checked in under test/golden.
+ * The signal processing library primitives, the multi-channel QMF, the
+ * polyphase resampler, NSX and AGC are fixed point and have to match
+ * bit-exactly, through a hash of everything they output.  The float NS and
+ * the AEC only have to stay within a tolerance of the golden output level
+ * of each half second, as their SIMD paths round differently from the C one.
+ * The inputs are synthetic and generated here: speech-like harmonics under a
+ * syllable envelope, noise, and the echo of the far end through a room
+ * impulse response.
+ *
+ * Each path runs in a child process with WEBRTC_DISPATCH set to it, as the
+ * dispatchers read the CPU features once.  Paths the CPU lacks are skipped.
+ * With WEBRTC_DISPATCH already set only that path runs, in this process.
+ * --update writes the golden outputs of the C path.
+ *
+ * Usage: golden_test [--update] [golden directory]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "aec/include/echo_cancellation.h"
+#include "agc/include/gain_control.h"
+#include "ns/include/noise_suppression.h"
+#include "ns/include/noise_suppression_x.h"
+#include "signal_processing/include/real_fft.h"
+#include "signal_processing/include/signal_processing_library.h"
+#include "webrtc/cpu_features_wrapper.h"
+#include "test/test_util.h"
+
+static const char kDefaultDirectory[] = "test/golden";
+static const int kRate = 16000;
+enum {
+  kFrame = 160,
+  kMaxLength = 600,
+  kLevelSegment = 8000,  // in samples, half a second
+  kMaxLevels = 64
+};
+
+typedef struct {
+  uint64_t hash;
+  double energy;  // of the current level segment
+  int filled;  // samples in the current level segment
+  double levels[kMaxLevels];  // in dB
+  int level_count;
+} Output;
+
+typedef struct {
+  const char* name;
+  double tolerance;  // in dB of each level, 0 for bit-exact
+  void (*run)(Output* out);
+} Kernel;
+
+static double Noise() {
+  return Uniform(-32768, 32767) / 32768.0;
+}
+
+static int16_t Saturate(double v) {
+  if (v > 32767) {
+    return 32767;
+  }
+  if (v < -32768) {
+    return -32768;
+  }
+  return (int16_t) floor(v + 0.5);
+}
+
+// Voiced syllables: a few harmonics of |f0| under a 4 Hz envelope.
+static double Voice(int sample, double f0) {
+  const double t = (double) sample / kRate;
+  double env = sin(2 * M_PI * 4 * t);
+  double v = 0;
+  int h;
+
+  if (env < 0) {
+    return 0;
+  }
+  for (h = 1; h <= 6; h++) {
+    v += sin(2 * M_PI * f0 * h * t) / h;
+  }
+  return env * v;
+}
+
+// FNV-1a, over the little endian bytes of |value|.
+static void Hash(Output* out, uint32_t value, int bytes) {
+  int i;
+
+  for (i = 0; i < bytes; i++) {
+    out->hash ^= (value >> (8 * i)) & 0xff;
+    out->hash *= 0x100000001b3ULL;
+  }
+}
+
+static void RecordW16(Output* out, const int16_t* x, int len) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    Hash(out, (uint16_t) x[i], 2);
+  }
+}
+
+static void RecordW32(Output* out, const int32_t* x, int len) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    Hash(out, (uint32_t) x[i], 4);
+  }
+}
+
+static void RecordLevel(Output* out, const int16_t* x, int len) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    out->energy += (double) x[i] * x[i];
+    if (++out->filled < kLevelSegment) {
+      continue;
+    }
+    if (out->level_count < kMaxLevels) {
+      out->levels[out->level_count++] =
+          10 * log10(out->energy / kLevelSegment + 1);
+    }
+    out->energy = 0;
+    out->filled = 0;
+  }
+}
+
+static void RunMinMax(Output* out) {
+  int16_t w16[kMaxLength];
+  int32_t w32[kMaxLength];
+  int32_t results[6];
+  int i;
+
+  for (i = 0; i < 5000; i++) {
+    int len = Length(kMaxLength);
+
+    FillW16(w16, len, Uniform(1, 32767));
+    FillW32(w32, len);
+    results[0] = WebRtcSpl_MaxAbsValueW16(w16, len);
+    results[1] = WebRtcSpl_MaxAbsValueW32(w32, len);
+    results[2] = WebRtcSpl_MaxValueW16(w16, len);
+    results[3] = WebRtcSpl_MaxValueW32(w32, len);
+    results[4] = WebRtcSpl_MinValueW16(w16, len);
+    results[5] = WebRtcSpl_MinValueW32(w32, len);
+    RecordW32(out, results, 6);
+  }
+}
+
+static void RunCrossCorrelation(Output* out) {
+  int16_t seq1[kMaxLength];
+  int16_t seq2[3 * kMaxLength];
+  int32_t cc[64];
+  int i;
+
+  for (i = 0; i < 2000; i++) {
+    int16_t dim_seq = (int16_t) Length(kMaxLength);
+    int16_t dim_cc = (int16_t) Uniform(1, 64);
+    int16_t shifts = (int16_t) (Uniform(0, 1) ? 0 : Uniform(1, 20));
+    int16_t step = (int16_t) (Uniform(0, 1) ? 1 : Uniform(-8, 8));
+    // seq2 starts far enough into the buffer for a negative step.
+    const int16_t* seq2_start = step < 0 ? &seq2[-step * (dim_cc - 1)] : seq2;
+
+    FillW16(seq1, dim_seq, Uniform(1, 32767));
+    FillW16(seq2, (int) (sizeof(seq2) / sizeof(seq2[0])), Uniform(1, 32767));
+    WebRtcSpl_CrossCorrelation(cc, seq1, seq2_start, dim_seq, dim_cc, shifts,
+                               step);
+    RecordW32(out, cc, dim_cc);
+  }
+}
+
+static void RunDownsampleFast(Output* out) {
+  int16_t data[2 * kMaxLength];
+  int16_t coefficients[300];
+  int16_t data_out[kMaxLength];
+  int i;
+
+  for (i = 0; i < 2000; i++) {
+    int coefficients_length = Uniform(0, 3) ? Uniform(1, 40)
+                                            : Uniform(1, 300);
+    int factor = Uniform(1, 6);
+    int data_out_length = Uniform(1, 80);
+    // The state in front of |data_in| covers the filter order.
+    int16_t* data_in = &data[coefficients_length - 1];
+    int delay = Uniform(0, 8);
+    int data_in_length = delay + factor * (data_out_length - 1) + 1;
+
+    FillW16(data, coefficients_length - 1 + data_in_length, Uniform(1, 32767));
+    FillW16(coefficients, coefficients_length, Uniform(1, 32767));
+    Hash(out,
+         WebRtcSpl_DownsampleFast(data_in, data_in_length, data_out,
+                                  data_out_length, coefficients,
+                                  coefficients_length, factor, delay),
+         4);
+    RecordW16(out, data_out, data_out_length);
+  }
+}
+
+static void RunScaleAndAdd(Output* out) {
+  int16_t in1[kMaxLength];
+  int16_t in2[kMaxLength];
+  int16_t sum[kMaxLength];
+  int i;
+
+  for (i = 0; i < 5000; i++) {
+    int len = Length(kMaxLength);
+    int16_t scale1 = (int16_t) Uniform(-32768, 32767);
+    int16_t scale2 = (int16_t) Uniform(-32768, 32767);
+    int shifts = Uniform(0, 30);
+
+    FillW16(in1, len, Uniform(1, 32767));
+    FillW16(in2, len, Uniform(1, 32767));
+    Hash(out,
+         WebRtcSpl_ScaleAndAddVectorsWithRound(in1, scale1, in2, scale2,
+                                               shifts, sum, len),
+         4);
+    RecordW16(out, sum, len);
+  }
+}
+
+static void RunRealFFT(Output* out) {
+  enum { kMaxOrder = 10 };
+  int16_t in[2 << kMaxOrder];
+  int16_t transformed[2 << kMaxOrder];
+  int order, i;
+
+  for (order = 1; order <= kMaxOrder; order++) {
+    const int n = 1 << order;
+    struct RealFFT* fft = WebRtcSpl_CreateRealFFT(order);
+
+    for (i = 0; i < 100; i++) {
+      FillW16(in, 2 * n, Uniform(1, 32767));
+      Hash(out, WebRtcSpl_RealForwardFFT(fft, in, transformed), 4);
+      RecordW16(out, transformed, n + 2);
+      Hash(out, WebRtcSpl_RealInverseFFT(fft, in, transformed), 4);
+      RecordW16(out, transformed, n);
+    }
+    WebRtcSpl_FreeRealFFT(fft);
+  }
+}
+
+// Speech through every device rate to 16 kHz and back, in pieces.
+static void RunResampler(Output* out) {
+  static const int kRates[] = { 8000, 11025, 22050, 44100, 48000, 96000 };
+  static int16_t in[96000 / 4];
+  static int16_t resampled[2 * 96000 / 4];
+  int r, d, k;
+
+  for (r = 0; r < (int) (sizeof(kRates) / sizeof(kRates[0])); r++) {
+    for (d = 0; d < 2; d++) {
+      const int in_rate = d == 0 ? kRates[r] : kRate;
+      const int out_rate = d == 0 ? kRate : kRates[r];
+      const int in_length = in_rate / 4;
+      struct PolyphaseResampler* resampler =
+          WebRtcSpl_CreatePolyphaseResampler(in_rate, out_rate, 1);
+      int offset;
+
+      for (k = 0; k < in_length; k++) {
+        in[k] = Saturate(12000 * Voice(k * kRate / in_rate, 150) +
+                         300 * Noise());
+      }
+      for (offset = 0; offset < in_length;) {
+        int piece = Uniform(1, 1500);
+        int n;
+
+        if (piece > in_length - offset) {
+          piece = in_length - offset;
+        }
+        n = WebRtcSpl_ResamplePolyphase(resampler, 0, &in[offset], piece,
+                                        resampled);
+        RecordW16(out, resampled, n);
+        offset += piece;
+      }
+      WebRtcSpl_FreePolyphaseResampler(resampler);
+    }
+  }
+}
+
+// Analysis and synthesis of every channel count, a frame at a time.
+static void RunQMF(Output* out) {
+  static int16_t in[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame];
+  static int16_t low[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame / 2];
+  static int16_t high[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame / 2];
+  static int16_t synthesized[WEBRTC_SPL_QMF_MAX_CHANNELS][kFrame];
+  const int16_t* in_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  const int16_t* low_in[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  const int16_t* high_in[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int16_t* low_out[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int16_t* high_out[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int16_t* synthesized_out[WEBRTC_SPL_QMF_MAX_CHANNELS];
+  int channels, c, f, k;
+
+  for (c = 0; c < WEBRTC_SPL_QMF_MAX_CHANNELS; c++) {
+    in_ptr[c] = in[c];
+    low_in[c] = low[c];
+    high_in[c] = high[c];
+    low_out[c] = low[c];
+    high_out[c] = high[c];
+    synthesized_out[c] = synthesized[c];
+  }
+  for (channels = 1; channels <= WEBRTC_SPL_QMF_MAX_CHANNELS; channels++) {
+    QMFState analysis;
+    QMFState synthesis;
+
+    memset(&analysis, 0, sizeof(analysis));
+    memset(&synthesis, 0, sizeof(synthesis));
+    for (f = 0; f < 200; f++) {
+      for (c = 0; c < channels; c++) {
+        for (k = 0; k < kFrame; k++) {
+          int sample = f * kFrame + k;
+          in[c][k] = Saturate(16000 * Voice(sample, 110 + 40 * c) +
+                              4000 * sin(2 * M_PI * 5000 * sample / kRate) +
+                              100 * Noise());
+        }
+      }
+      WebRtcSpl_AnalysisQMFMulti(in_ptr, channels, kFrame, low_out, high_out,
+                                 &analysis);
+      WebRtcSpl_SynthesisQMFMulti(low_in, high_in, channels, kFrame / 2,
+                                  synthesized_out, &synthesis);
+      for (c = 0; c < channels; c++) {
+        RecordW16(out, low[c], kFrame / 2);
+        RecordW16(out, high[c], kFrame / 2);
+        RecordW16(out, synthesized[c], kFrame);
+      }
+    }
+  }
+}
+
+// Speech in noise that steps up and down every second.
+static void NoisySpeech(int frame, int16_t* x) {
+  const double noise = (frame / 100) % 2 ? 2000 : 200;
+  int k;
+
+  for (k = 0; k < kFrame; k++) {
+    int sample = frame * kFrame + k;
+    x[k] = Saturate(10000 * Voice(sample, 130) + noise * Noise());
+  }
+}
+
+static void RunNSX(Output* out) {
+  int16_t in[kFrame];
+  int16_t processed[kFrame];
+  NsxHandle* nsx;
+  int f;
+
+  if (WebRtcNsx_Create(&nsx) != 0 ||
+      WebRtcNsx_Init(nsx, kRate) != 0 ||
+      WebRtcNsx_set_policy(nsx, 2) != 0) {
+    abort();
+  }
+  for (f = 0; f < 1000; f++) {
+    NoisySpeech(f, in);
+    if (WebRtcNsx_Process(nsx, in, NULL, processed, NULL) != 0) {
+      abort();
+    }
+    RecordW16(out, processed, kFrame);
+  }
+  WebRtcNsx_Free(nsx);
+}
+
+static void RunNS(Output* out) {
+  int16_t in[kFrame];
+  int16_t processed[kFrame];
+  NsHandle* ns;
+  int f;
+
+  if (WebRtcNs_Create(&ns) != 0 ||
+      WebRtcNs_Init(ns, kRate) != 0 ||
+      WebRtcNs_set_policy(ns, 1) != 0) {
+    abort();
+  }
+  for (f = 0; f < 1000; f++) {
+    NoisySpeech(f, in);
+    if (WebRtcNs_Process(ns, in, NULL, processed, NULL) != 0) {
+      abort();
+    }
+    RecordLevel(out, processed, kFrame);
+  }
+  WebRtcNs_Free(ns);
+}
+
+// Every mode on speech that gets quieter and louder every half second.
+static void RunAGC(Output* out) {
+  static const double kGains[] = { 0.02, 0.3, 1.0 };
+  int16_t in[kFrame];
+  int16_t processed[kFrame];
+  int mode, f, k;
+
+  for (mode = kAgcModeAdaptiveAnalog; mode <= kAgcModeFixedDigital; mode++) {
+    int32_t level = 128;
+    void* agc;
+
+    if (WebRtcAgc_Create(&agc) != 0 ||
+        WebRtcAgc_Init(agc, 0, 255, (int16_t) mode, kRate) != 0) {
+      abort();
+    }
+    for (f = 0; f < 600; f++) {
+      const double gain = kGains[(f / 50) % 3];
+      uint8_t saturation;
+
+      for (k = 0; k < kFrame; k++) {
+        in[k] = Saturate(gain * 30000 * Voice(f * kFrame + k, 120) +
+                         100 * Noise());
+      }
+      if (mode == kAgcModeAdaptiveAnalog &&
+          WebRtcAgc_AddMic(agc, in, NULL, kFrame) != 0) {
+        abort();
+      }
+      if (WebRtcAgc_Process(agc, in, NULL, kFrame, processed, NULL, level,
+                            &level, 0, &saturation) != 0) {
+        abort();
+      }
+      RecordW16(out, processed, kFrame);
+      Hash(out, (uint32_t) level, 4);
+    }
+    WebRtcAgc_Free(agc);
+  }
+}
+
+// Far-end speech and its echo through a decaying room impulse response, with
+// near-end speech over the far end in the middle.
+static void RunAEC(Output* out) {
+  enum { kEchoDelay = 320, kEchoLength = 1600 };
+  static double rir[kEchoLength];
+  static double history[kEchoLength];
+  int16_t far[kFrame];
+  int16_t near[kFrame];
+  int16_t processed[kFrame];
+  void* aec;
+  int f, k, j;
+
+  for (k = 0; k < kEchoLength; k++) {
+    rir[k] = k < kEchoDelay ? 0 : 0.08 * exp(-(k - kEchoDelay) / 400.0) *
+                                  Noise();
+  }
+  memset(history, 0, sizeof(history));
+  if (WebRtcAec_Create(&aec) != 0 || WebRtcAec_Init(aec, kRate, kRate) != 0) {
+    abort();
+  }
+  for (f = 0; f < 2000; f++) {
+    for (k = 0; k < kFrame; k++) {
+      int sample = f * kFrame + k;
+      double echo = 0;
+
+      far[k] = Saturate(8000 * Voice(sample, 120));
+      memmove(&history[1], history, sizeof(history) - sizeof(history[0]));
+      history[0] = far[k];
+      for (j = kEchoDelay; j < kEchoLength; j++) {
+        echo += rir[j] * history[j];
+      }
+      near[k] = Saturate(echo + 30 * Noise() +
+                         (f >= 1000 && f < 1300 ?
+                              6000 * Voice(sample + 1600, 210) : 0));
+    }
+    if (WebRtcAec_BufferFarend(aec, far, kFrame) != 0 ||
+        WebRtcAec_Process(aec, near, NULL, processed, NULL, kFrame, 0,
+                          0) != 0) {
+      abort();
+    }
+    RecordLevel(out, processed, kFrame);
+  }
+  WebRtcAec_Free(aec);
+}
+
+static const Kernel kKernels[] = {
+  { "spl_min_max", 0, RunMinMax },
+  { "spl_cross_correlation", 0, RunCrossCorrelation },
+  { "spl_downsample_fast", 0, RunDownsampleFast },
+  { "spl_scale_and_add", 0, RunScaleAndAdd },
+  { "spl_real_fft", 0, RunRealFFT },
+  { "spl_resample_polyphase", 0, RunResampler },
+  { "qmf", 0, RunQMF },
+  { "nsx", 0, RunNSX },
+  { "ns", 1.0, RunNS },
+  { "agc", 0, RunAGC },
+  { "aec", 1.0, RunAEC },
+};
+
+static void Run(const Kernel* kernel, Output* out) {
+  memset(out, 0, sizeof(*out));
+  out->hash = 0xcbf29ce484222325ULL;
+  seed = 1;
+  kernel->run(out);
+}
+
+static void GoldenPath(const char* directory,
+                       const Kernel* kernel,
+                       char* path,
+                       size_t size) {
+  snprintf(path, size, "%s/%s.txt", directory, kernel->name);
+}
+
+static int Write(const char* directory, const Kernel* kernel) {
+  char path[1024];
+  Output out;
+  FILE* f;
+  int i;
+
+  GoldenPath(directory, kernel, path, sizeof(path));
+  f = fopen(path, "w");
+  if (f == NULL) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return -1;
+  }
+  Run(kernel, &out);
+  if (kernel->tolerance == 0) {
+    fprintf(f, "exact %016llx\n", (unsigned long long) out.hash);
+  } else {
+    fprintf(f, "levels %d\n", out.level_count);
+    for (i = 0; i < out.level_count; i++) {
+      fprintf(f, "%.2f\n", out.levels[i]);
+    }
+  }
+  fclose(f);
+  printf("%-24s written\n", kernel->name);
+  return 0;
+}
+
+static int Read(const char* directory, const Kernel* kernel, Output* golden) {
+  char path[1024];
+  char kind[16];
+  unsigned long long hash;
+  FILE* f;
+  int ok = 0;
+  int i;
+
+  GoldenPath(directory, kernel, path, sizeof(path));
+  f = fopen(path, "r");
+  if (f == NULL) {
+    return -1;
+  }
+  memset(golden, 0, sizeof(*golden));
+  if (fscanf(f, "%15s", kind) == 1) {
+    if (strcmp(kind, "exact") == 0) {
+      ok = fscanf(f, "%llx", &hash) == 1;
+      golden->hash = hash;
+    } else if (strcmp(kind, "levels") == 0) {
+      ok = fscanf(f, "%d", &golden->level_count) == 1 &&
+           golden->level_count >= 0 && golden->level_count <= kMaxLevels;
+      for (i = 0; ok && i < golden->level_count; i++) {
+        ok = fscanf(f, "%lf", &golden->levels[i]) == 1;
+      }
+    }
+  }
+  fclose(f);
+  return ok ? 0 : -1;
+}
+
+// Returns the number of failed kernels.
+static int CheckKernels(const char* directory, const char* name) {
+  int failed = 0;
+  size_t k;
+  int i;
+
+  for (k = 0; k < sizeof(kKernels) / sizeof(kKernels[0]); k++) {
+    const Kernel* kernel = &kKernels[k];
+    Output golden;
+    Output out;
+    double err = 0;
+    int ok;
+
+    if (Read(directory, kernel, &golden) != 0) {
+      printf("%-6s %-24s missing golden output\n", name, kernel->name);
+      failed++;
+      continue;
+    }
+    Run(kernel, &out);
+    if (kernel->tolerance == 0) {
+      ok = out.hash == golden.hash;
+      printf("%-6s %-24s %016llx %s\n", name, kernel->name,
+             (unsigned long long) out.hash, ok ? "ok" : "FAIL");
+    } else {
+      ok = out.level_count == golden.level_count;
+      for (i = 0; ok && i < out.level_count; i++) {
+        double e = fabs(out.levels[i] - golden.levels[i]);
+        err = e > err ? e : err;
+      }
+      ok = ok && err <= kernel->tolerance;
+      printf("%-6s %-24s %13.2f dB %s\n", name, kernel->name, err,
+             ok ? "ok" : "FAIL");
+    }
+    failed += !ok;
+  }
+  return failed;
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+static const char* const kPaths[] = { "c", "sse2", "avx2" };
+
+static int HasPath(const char* name) {
+  if (strcmp(name, "sse2") == 0) {
+    return WebRtc_GetCPUInfo(kSSE2);
+  }
+  if (strcmp(name, "avx2") == 0) {
+    return WebRtc_GetCPUInfo(kAVX2);
+  }
+  return 1;
+}
+#else
+// WEBRTC_DISPATCH has no effect, the one path is whatever the build picks.
+static const char* const kPaths[] = { "c" };
+
+static int HasPath(const char* name) {
+  (void) name;
+  return 1;
+}
+#endif
+
+// In a child process, so that the dispatchers see the path.  Returns the
+// exit status: 0 if all kernels match, 1 if some do not, 2 if the CPU lacks
+// the path.
+static int RunPath(const char* directory, const char* name, int update) {
+  pid_t pid = fork();
+  int status;
+  size_t k;
+
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    setenv("WEBRTC_DISPATCH", name, 1);
+    if (!HasPath(name)) {
+      printf("%-6s skipped, not supported by the CPU\n", name);
+      _exit(2);
+    }
+    WebRtcSpl_Init();
+    if (update) {
+      for (k = 0; k < sizeof(kKernels) / sizeof(kKernels[0]); k++) {
+        if (Write(directory, &kKernels[k]) != 0) {
+          _exit(1);
+        }
+      }
+      _exit(0);
+    }
+    _exit(CheckKernels(directory, name) == 0 ? 0 : 1);
+  }
+  if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+    return 1;
+  }
+  return WEXITSTATUS(status);
+}
+
+int main(int argc, char** argv) {
+  const char* directory = kDefaultDirectory;
+  const char* forced = getenv("WEBRTC_DISPATCH");
+  int update = 0;
+  size_t p;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--update") == 0) {
+      update = 1;
+    } else {
+      directory = argv[i];
+    }
+  }
+
+  // The children share stdout and leave with _exit().
+  setvbuf(stdout, NULL, _IONBF, 0);
+  if (update) {
+    return RunPath(directory, "c", 1) == 0 ? 0 : 1;
+  }
+
+  printf("%-6s %-24s %16s\n", "path", "kernel", "result");
+  if (forced != NULL) {
+    WebRtcSpl_Init();
+    failures = CheckKernels(directory, forced);
+  } else {
+    for (p = 0; p < sizeof(kPaths) / sizeof(kPaths[0]); p++) {
+      failures += RunPath(directory, kPaths[p], 0) == 1;
+    }
+  }
+
+  if (failures != 0) {
+    printf("%d failure(s)\n", failures);
+    return 1;
+  }
+  return 0;
+}
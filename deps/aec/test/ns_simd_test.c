@@ -0,0 +1,364 @@
+/*
+ * Accuracy of the SSE2 and AVX2 float NS paths against the C path.  The SIMD
+ * kernels use polynomial log()/exp(), so they are compared with error bounds,
+ * first one kernel at a time on random input and then end to end.  The NS
+ * FFTs are checked against WebRtc_rdft() on every path.
+ *
+ * Usage: ns_simd_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ns/include/noise_suppression.h"
+#include "ns/ns_core.h"
+#include "ns/ns_rdft.h"
+#include "webrtc/cpu_features_wrapper.h"
+#include "webrtc/fft4g.h"
+#include "test/test_util.h"
+
+static const int kFrames = 3000;
+static const int kPolicy = 1;
+
+// Worst relative error allowed per kernel, and the lowest SNR of SIMD output
+// against the C output.
+static const double kMaxNoiseError = 1e-4;
+static const double kMaxSumError = 1e-5;
+static const double kMaxLrtError = 1e-5;
+static const double kMaxProbError = 1e-5;
+static const double kMinSnr = 60.0;
+// Worst FFT error relative to the largest output value.
+static const double kMaxFftError = 1e-5;
+
+typedef struct {
+  const char* name;
+  WebRtc_CPUInfo cpu_info;
+  WebRtcNs_NoiseEstimation_t noise_estimation;
+  WebRtcNs_SumLogMagnitude_t sum_log_magnitude;
+  WebRtcNs_UpdateLogLrt_t update_log_lrt;
+  WebRtcNs_SpeechProbability_t speech_probability;
+} Path;
+
+static double RelativeError(double actual, double expected) {
+  return fabs(actual - expected) / (fabs(expected) + 1e-20);
+}
+
+// The kernels are picked in WebRtcNs_Init(), so |cpu_info| only has to be in
+// place while the instance is initialized.
+static NSinst_t* CreateInstance(int rate, WebRtc_CPUInfo cpu_info) {
+  NsHandle* ns;
+
+  WebRtc_GetCPUInfo = cpu_info;
+  if (WebRtcNs_Create(&ns) != 0 ||
+      WebRtcNs_Init(ns, rate) != 0 ||
+      WebRtcNs_set_policy(ns, kPolicy) != 0) {
+    abort();
+  }
+  WebRtc_GetCPUInfo = host_cpu_info;
+
+  return (NSinst_t*) ns;
+}
+
+static void Capture(Path* path) {
+  NSinst_t* inst = CreateInstance(16000, path->cpu_info);
+
+  path->noise_estimation = WebRtcNs_NoiseEstimation;
+  path->sum_log_magnitude = WebRtcNs_SumLogMagnitude;
+  path->update_log_lrt = WebRtcNs_UpdateLogLrt;
+  path->speech_probability = WebRtcNs_SpeechProbability;
+  WebRtcNs_Free((NsHandle*) inst);
+}
+
+static void TestNoiseEstimation(const Path* c, const Path* simd) {
+  NSinst_t* a = CreateInstance(16000, c->cpu_info);
+  NSinst_t* b = CreateInstance(16000, simd->cpu_info);
+  float magn[HALF_ANAL_BLOCKL];
+  float noise_a[HALF_ANAL_BLOCKL];
+  float noise_b[HALF_ANAL_BLOCKL];
+  double err = 0;
+  int i, j;
+
+  for (i = 0; i < kFrames; i++) {
+    float level = UniformFloat(1.0f, 1000.0f);
+
+    for (j = 0; j < a->magnLen; j++) {
+      magn[j] = level * UniformFloat(0.01f, 10.0f);
+    }
+    c->noise_estimation(a, magn, noise_a);
+    simd->noise_estimation(b, magn, noise_b);
+    for (j = 0; j < a->magnLen; j++) {
+      double e = RelativeError(noise_b[j], noise_a[j]);
+      err = e > err ? e : err;
+    }
+  }
+  CheckError(simd->name, "NoiseEstimation", err, kMaxNoiseError);
+
+  WebRtcNs_Free((NsHandle*) a);
+  WebRtcNs_Free((NsHandle*) b);
+}
+
+static void TestSumLogMagnitude(const Path* c, const Path* simd) {
+  float in[HALF_ANAL_BLOCKL];
+  double err = 0;
+  double e;
+  float sum_a, sum_b;
+  int i, j, len;
+
+  for (i = 0; i < kFrames; i++) {
+    len = 1 + i % HALF_ANAL_BLOCKL;
+    for (j = 0; j < len; j++) {
+      in[j] = UniformFloat(1e-3f, 1e4f);
+    }
+    if (c->sum_log_magnitude(in, len, &sum_a) != 0 ||
+        simd->sum_log_magnitude(in, len, &sum_b) != 0) {
+      err = INFINITY;
+      break;
+    }
+    // The mean can be close to zero, so the error is taken relative to
+    // max(|mean|, 1).
+    e = fabs(sum_b - sum_a) / len / (fabs(sum_a) / len + 1.0);
+    err = e > err ? e : err;
+  }
+
+  // A zero anywhere, including the tail, must be reported.
+  for (len = 1; len <= 17; len++) {
+    for (j = 0; j < len; j++) {
+      in[j] = 1.0f;
+    }
+    in[len - 1] = 0.0f;
+    if (simd->sum_log_magnitude(in, len, &sum_b) != -1) {
+      err = INFINITY;
+    }
+  }
+  CheckError(simd->name, "SumLogMagnitude", err, kMaxSumError);
+}
+
+static void TestUpdateLogLrt(const Path* c, const Path* simd) {
+  NSinst_t* a = CreateInstance(16000, c->cpu_info);
+  NSinst_t* b = CreateInstance(16000, simd->cpu_info);
+  float prior[HALF_ANAL_BLOCKL];
+  float post[HALF_ANAL_BLOCKL];
+  double err = 0;
+  double sum_err = 0;
+  double e;
+  float sum_a, sum_b;
+  int i, j;
+
+  for (i = 0; i < kFrames; i++) {
+    for (j = 0; j < a->magnLen; j++) {
+      prior[j] = UniformFloat(0.0f, 100.0f);
+      post[j] = UniformFloat(0.0f, 100.0f);
+    }
+    sum_a = c->update_log_lrt(a, prior, post);
+    sum_b = simd->update_log_lrt(b, prior, post);
+    for (j = 0; j < a->magnLen; j++) {
+      e = fabs(b->logLrtTimeAvg[j] - a->logLrtTimeAvg[j]) /
+          (fabs(a->logLrtTimeAvg[j]) + 1.0);
+      err = e > err ? e : err;
+    }
+    sum_a /= a->magnLen;
+    sum_b /= a->magnLen;
+    e = fabs(sum_b - sum_a) / (fabs(sum_a) + 1.0);
+    sum_err = e > sum_err ? e : sum_err;
+  }
+  CheckError(simd->name, "UpdateLogLrt", err, kMaxLrtError);
+  CheckError(simd->name, "UpdateLogLrt sum", sum_err, kMaxLrtError);
+
+  WebRtcNs_Free((NsHandle*) a);
+  WebRtcNs_Free((NsHandle*) b);
+}
+
+static void TestSpeechProbability(const Path* c, const Path* simd) {
+  NSinst_t* inst = CreateInstance(16000, c->cpu_info);
+  float prob_a[HALF_ANAL_BLOCKL];
+  float prob_b[HALF_ANAL_BLOCKL];
+  double err = 0;
+  int i, j;
+
+  for (i = 0; i < kFrames; i++) {
+    float gain_prior = UniformFloat(0.0f, 20.0f);
+
+    for (j = 0; j < inst->magnLen; j++) {
+      inst->logLrtTimeAvg[j] = UniformFloat(-30.0f, 30.0f);
+    }
+    c->speech_probability(inst, gain_prior, prob_a);
+    simd->speech_probability(inst, gain_prior, prob_b);
+    for (j = 0; j < inst->magnLen; j++) {
+      // Probabilities are in [0, 1], absolute error is what matters.
+      double e = fabs(prob_b[j] - prob_a[j]);
+      err = e > err ? e : err;
+    }
+  }
+  CheckError(simd->name, "SpeechProbability", err, kMaxProbError);
+
+  WebRtcNs_Free((NsHandle*) inst);
+}
+
+// Forward and inverse transforms of random input against WebRtc_rdft().
+static void TestRdft(const Path* path, int n) {
+  float a[ANAL_BLOCKL_MAX];
+  float b[ANAL_BLOCKL_MAX];
+  int ip[ANAL_BLOCKL_MAX >> 1];
+  float w[ANAL_BLOCKL_MAX >> 1];
+  double forward_err = 0;
+  double inverse_err = 0;
+  char what[32];
+  int i, j;
+
+  WebRtc_GetCPUInfo = path->cpu_info;
+  ns_rdft_init();
+  WebRtc_GetCPUInfo = host_cpu_info;
+
+  ip[0] = 0;
+  for (i = 0; i < kFrames; i++) {
+    double max = 0;
+    double err = 0;
+
+    for (j = 0; j < n; j++) {
+      a[j] = b[j] = UniformFloat(-32768.0f, 32767.0f);
+    }
+
+    WebRtc_rdft(n, 1, a, ip, w);
+    if (n == 256) {
+      ns_rdft_forward_256(b);
+    } else {
+      ns_rdft_forward_128(b);
+    }
+    for (j = 0; j < n; j++) {
+      max = fabs(a[j]) > max ? fabs(a[j]) : max;
+      err = fabs(b[j] - a[j]) > err ? fabs(b[j] - a[j]) : err;
+    }
+    forward_err = err / max > forward_err ? err / max : forward_err;
+
+    // Same input for both, so that only the inverse is measured
+    memcpy(b, a, sizeof(*a) * n);
+    WebRtc_rdft(n, -1, a, ip, w);
+    if (n == 256) {
+      ns_rdft_inverse_256(b);
+    } else {
+      ns_rdft_inverse_128(b);
+    }
+    max = 0;
+    err = 0;
+    for (j = 0; j < n; j++) {
+      max = fabs(a[j]) > max ? fabs(a[j]) : max;
+      err = fabs(b[j] - a[j]) > err ? fabs(b[j] - a[j]) : err;
+    }
+    inverse_err = err / max > inverse_err ? err / max : inverse_err;
+  }
+
+  snprintf(what, sizeof(what), "rdft forward %d", n);
+  CheckError(path->name, what, forward_err, kMaxFftError);
+  snprintf(what, sizeof(what), "rdft inverse %d", n);
+  CheckError(path->name, what, inverse_err, kMaxFftError);
+}
+
+// Speech-like bursts over a noise floor, one 10 ms frame at a time.
+static void Generate(short* frame, int len, int index, unsigned* state) {
+  int i;
+  double env = (index / 50) % 2 ? 0.4 : 0.02;
+
+  for (i = 0; i < len; i++) {
+    double v;
+
+    *state = *state * 1103515245u + 12345u;
+    v = (((*state >> 8) & 0xffff) - 32768.0) / 32.0;
+    v += env * 20000.0 * sin((index * len + i) * 0.07);
+    frame[i] = (short) v;
+  }
+}
+
+static short* Process(int rate, WebRtc_CPUInfo cpu_info) {
+  NSinst_t* inst = CreateInstance(rate, cpu_info);
+  int len = rate / 100;
+  short* out = malloc(sizeof(*out) * len * kFrames);
+  short in[160];
+  unsigned state = 1;
+  int i;
+
+  for (i = 0; i < kFrames; i++) {
+    Generate(in, len, i, &state);
+    WebRtcNs_Process((NsHandle*) inst, in, NULL, &out[i * len], NULL);
+  }
+  WebRtcNs_Free((NsHandle*) inst);
+
+  return out;
+}
+
+static void TestProcess(int rate, const short* expected, const Path* simd) {
+  short* actual = Process(rate, simd->cpu_info);
+  int len = rate / 100 * kFrames;
+  double signal = 0;
+  double error = 0;
+  double snr;
+  char what[32];
+  int i;
+
+  for (i = 0; i < len; i++) {
+    double d = (double) actual[i] - expected[i];
+
+    signal += (double) expected[i] * expected[i];
+    error += d * d;
+  }
+  snr = error == 0 ? INFINITY : 10.0 * log10(signal / error);
+  free(actual);
+
+  // Checked as the inverse SNR, so that lower is better like the others
+  snprintf(what, sizeof(what), "Process %d 1/SNR", rate);
+  CheckError(simd->name, what,
+             pow(10.0, -snr / 10.0), pow(10.0, -kMinSnr / 10.0));
+}
+
+int main() {
+  static const int rates[] = { 8000, 16000 };
+  Path paths[3];
+  int count = 0;
+  size_t i;
+  int j;
+
+  host_cpu_info = WebRtc_GetCPUInfo;
+
+  paths[count].name = "c";
+  paths[count++].cpu_info = WebRtc_GetCPUInfoNoASM;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (host_cpu_info(kSSE2)) {
+    paths[count].name = "sse2";
+    paths[count++].cpu_info = SSE2Only;
+  }
+  if (host_cpu_info(kAVX2)) {
+    paths[count].name = "avx2";
+    paths[count++].cpu_info = host_cpu_info;
+  }
+#endif
+  for (j = 0; j < count; j++) {
+    Capture(&paths[j]);
+  }
+
+  printf("%-6s %-28s %12s\n", "path", "check", "error");
+  for (j = 1; j < count; j++) {
+    TestNoiseEstimation(&paths[0], &paths[j]);
+    TestSumLogMagnitude(&paths[0], &paths[j]);
+    TestUpdateLogLrt(&paths[0], &paths[j]);
+    TestSpeechProbability(&paths[0], &paths[j]);
+  }
+  for (j = 0; j < count; j++) {
+    TestRdft(&paths[j], 128);
+    TestRdft(&paths[j], 256);
+  }
+  for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    short* expected = Process(rates[i], paths[0].cpu_info);
+
+    for (j = 1; j < count; j++) {
+      TestProcess(rates[i], expected, &paths[j]);
+    }
+    free(expected);
+  }
+
+  if (failures != 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,510 @@
+/*
+ * Bit-exactness of the SSE2 and AVX2 signal processing library primitives
+ * against the generic C versions, on random vectors of random lengths, with
+ * full scale values mixed in so that the abs() and overflow corner cases are
+ * covered.  The multi-channel QMF is checked on every path, the C one
+ * included, against the single channel WebRtcSpl_AnalysisQMF() and
+ * WebRtcSpl_SynthesisQMF().  The polyphase resampler is checked to give the
+ * same output however the input is split into calls, and to pass a tone in
+ * the passband at the right level.  The complex FFTs are checked in both
+ * modes on every order, and the real FFTs through them, including the bit
+ * reversal folded into the x86 versions.
+ *
+ * Usage: spl_simd_test
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "signal_processing/include/real_fft.h"
+#include "signal_processing/include/signal_processing_library.h"
+#include "webrtc/cpu_features_wrapper.h"
+#include "test/test_util.h"
+
+static const int kTrials = 20000;
+enum { kMaxLength = 600 };
+
+typedef int (*ComplexTransform)(int16_t* frfi, int stages, int mode);
+
+typedef struct {
+  const char* name;
+  MaxAbsValueW16 max_abs_w16;
+  MaxAbsValueW32 max_abs_w32;
+  MaxValueW16 max_w16;
+  MaxValueW32 max_w32;
+  MinValueW16 min_w16;
+  MinValueW32 min_w32;
+  CrossCorrelation cross_correlation;
+  DownsampleFast downsample_fast;
+  ScaleAndAddVectorsWithRound scale_and_add;
+  AllPassQMFMulti all_pass_qmf;
+  PolyphaseFIR polyphase_fir;
+  ComplexTransform complex_fft;
+  ComplexTransform complex_ifft;
+  RealForwardFFT real_forward_fft;
+  RealInverseFFT real_inverse_fft;
+} Path;
+
+// FillW32() and a full scale value half of the time, which it does not give.
+static void FillW32Full(int32_t* x, int len) {
+  FillW32(x, len);
+  if (Uniform(0, 1)) {
+    x[Uniform(0, len - 1)] = Uniform(0, 1) ? WEBRTC_SPL_WORD32_MAX
+                                           : WEBRTC_SPL_WORD32_MIN + 1;
+  }
+}
+
+static void TestMinMax(const Path* c, const Path* simd) {
+  int16_t w16[kMaxLength];
+  int32_t w32[kMaxLength];
+  int mismatches[6] = { 0 };
+  int i;
+
+  for (i = 0; i < kTrials; i++) {
+    int len = Length(kMaxLength);
+
+    FillW16(w16, len, Uniform(1, 32767));
+    FillW32Full(w32, len);
+    mismatches[0] += c->max_abs_w16(w16, len) != simd->max_abs_w16(w16, len);
+    mismatches[1] += c->max_abs_w32(w32, len) != simd->max_abs_w32(w32, len);
+    mismatches[2] += c->max_w16(w16, len) != simd->max_w16(w16, len);
+    mismatches[3] += c->max_w32(w32, len) != simd->max_w32(w32, len);
+    mismatches[4] += c->min_w16(w16, len) != simd->min_w16(w16, len);
+    mismatches[5] += c->min_w32(w32, len) != simd->min_w32(w32, len);
+  }
+  // The error values for empty vectors.
+  mismatches[0] += c->max_abs_w16(w16, 0) != simd->max_abs_w16(w16, 0);
+  mismatches[1] += c->max_abs_w32(NULL, 4) != simd->max_abs_w32(NULL, 4);
+  mismatches[2] += c->max_w16(w16, 0) != simd->max_w16(w16, 0);
+  mismatches[3] += c->max_w32(w32, 0) != simd->max_w32(w32, 0);
+  mismatches[4] += c->min_w16(w16, 0) != simd->min_w16(w16, 0);
+  mismatches[5] += c->min_w32(w32, 0) != simd->min_w32(w32, 0);
+
+  Check(simd->name, "MaxAbsValueW16", mismatches[0]);
+  Check(simd->name, "MaxAbsValueW32", mismatches[1]);
+  Check(simd->name, "MaxValueW16", mismatches[2]);
+  Check(simd->name, "MaxValueW32", mismatches[3]);
+  Check(simd->name, "MinValueW16", mismatches[4]);
+  Check(simd->name, "MinValueW32", mismatches[5]);
+}
+
+static void TestCrossCorrelation(const Path* c, const Path* simd) {
+  int16_t seq1[kMaxLength];
+  int16_t seq2[3 * kMaxLength];
+  int32_t a[64];
+  int32_t b[64];
+  int mismatches = 0;
+  int i, k;
+
+  for (i = 0; i < kTrials / 4; i++) {
+    int16_t dim_seq = (int16_t) Length(kMaxLength);
+    int16_t dim_cc = (int16_t) Uniform(1, 64);
+    int16_t shifts = (int16_t) (Uniform(0, 1) ? 0 : Uniform(1, 20));
+    int16_t step = (int16_t) (Uniform(0, 1) ? 1 : Uniform(-8, 8));
+    // seq2 starts far enough into the buffer for a negative step.
+    const int16_t* seq2_start = step < 0 ? &seq2[-step * (dim_cc - 1)] : seq2;
+
+    FillW16(seq1, dim_seq, Uniform(1, 32767));
+    FillW16(seq2, (int) (sizeof(seq2) / sizeof(seq2[0])), Uniform(1, 32767));
+    c->cross_correlation(a, seq1, seq2_start, dim_seq, dim_cc, shifts, step);
+    simd->cross_correlation(b, seq1, seq2_start, dim_seq, dim_cc, shifts,
+                            step);
+    for (k = 0; k < dim_cc; k++) {
+      mismatches += a[k] != b[k];
+    }
+  }
+  Check(simd->name, "CrossCorrelation", mismatches);
+}
+
+static void TestDownsampleFast(const Path* c, const Path* simd) {
+  int16_t data[2 * kMaxLength];
+  int16_t coefficients[300];
+  int16_t a[kMaxLength];
+  int16_t b[kMaxLength];
+  int mismatches = 0;
+  int i, k;
+
+  for (i = 0; i < kTrials / 4; i++) {
+    int coefficients_length = Uniform(0, 3) ? Uniform(1, 40)
+                                            : Uniform(1, 300);
+    int factor = Uniform(1, 6);
+    int data_out_length = Uniform(1, 80);
+    // The state in front of |data_in| covers the filter order.
+    int16_t* data_in = &data[coefficients_length - 1];
+    int delay = Uniform(0, 8);
+    int data_in_length = delay + factor * (data_out_length - 1) + 1;
+    int ret_a, ret_b;
+
+    FillW16(data, coefficients_length - 1 + data_in_length, Uniform(1, 32767));
+    FillW16(coefficients, coefficients_length, Uniform(1, 32767));
+    ret_a = c->downsample_fast(data_in, data_in_length, a, data_out_length,
+                               coefficients, coefficients_length, factor,
+                               delay);
+    ret_b = simd->downsample_fast(data_in, data_in_length, b, data_out_length,
+                                  coefficients, coefficients_length, factor,
+                                  delay);
+    mismatches += ret_a != ret_b;
+    for (k = 0; k < data_out_length; k++) {
+      mismatches += a[k] != b[k];
+    }
+  }
+  Check(simd->name, "DownsampleFast", mismatches);
+}
+
+static void TestScaleAndAdd(const Path* c, const Path* simd) {
+  int16_t in1[kMaxLength];
+  int16_t in2[kMaxLength];
+  int16_t a[kMaxLength];
+  int16_t b[kMaxLength];
+  int mismatches = 0;
+  int i, k;
+
+  for (i = 0; i < kTrials; i++) {
+    int len = Length(kMaxLength);
+    int16_t scale1 = (int16_t) Uniform(-32768, 32767);
+    int16_t scale2 = (int16_t) Uniform(-32768, 32767);
+    int shifts = Uniform(0, 30);
+
+    FillW16(in1, len, Uniform(1, 32767));
+    FillW16(in2, len, Uniform(1, 32767));
+    mismatches += c->scale_and_add(in1, scale1, in2, scale2, shifts, a, len) !=
+                  simd->scale_and_add(in1, scale1, in2, scale2, shifts, b, len);
+    for (k = 0; k < len; k++) {
+      mismatches += a[k] != b[k];
+    }
+  }
+  Check(simd->name, "ScaleAndAddVectorsWithRound", mismatches);
+}
+
+// Random filter states for the channels, |single| holds them as
+// filter_state1 and filter_state2 of each channel.
+static void FillQMFState(QMFState* state,
+                         int32_t single[][2][6]) {
+  int c, j;
+
+  for (j = 0; j < 6; j++) {
+    for (c = 0; c < WEBRTC_SPL_QMF_MAX_CHANNELS; c++) {
+      int32_t v = Uniform32();
+      single[c][0][j] = v >> Uniform(4, 31);
+      v = Uniform32();
+      single[c][1][j] = v >> Uniform(4, 31);
+      state->taps[j][c] = single[c][0][j];
+      state->taps[j][WEBRTC_SPL_QMF_MAX_CHANNELS + c] = single[c][1][j];
+    }
+  }
+}
+
+static int CompareQMFState(const QMFState* state,
+                           int32_t single[][2][6]) {
+  int mismatches = 0;
+  int c, j;
+
+  for (j = 0; j < 6; j++) {
+    for (c = 0; c < WEBRTC_SPL_QMF_MAX_CHANNELS; c++) {
+      mismatches += state->taps[j][c] != single[c][0][j];
+      mismatches +=
+          state->taps[j][WEBRTC_SPL_QMF_MAX_CHANNELS + c] != single[c][1][j];
+    }
+  }
+  return mismatches;
+}
+
+// A few frames in a row per trial, so that the states carry over, with some
+// channels left out of the call.
+static void TestQMF(const Path* path) {
+  enum { kBand = 240, kFrames = 4 };
+  static int16_t in[WEBRTC_SPL_QMF_MAX_CHANNELS][2 * kBand];
+  static int16_t low[2][WEBRTC_SPL_QMF_MAX_CHANNELS][kBand];
+  static int16_t high[2][WEBRTC_SPL_QMF_MAX_CHANNELS][kBand];
+  static int16_t out[2][WEBRTC_SPL_QMF_MAX_CHANNELS][2 * kBand];
+  int32_t analysis[WEBRTC_SPL_QMF_MAX_CHANNELS][2][6];
+  int32_t synthesis[WEBRTC_SPL_QMF_MAX_CHANNELS][2][6];
+  QMFState analysis_state;
+  QMFState synthesis_state;
+  int mismatches[2] = { 0 };
+  int i, c, f, k;
+
+  WebRtcSpl_AllPassQMFMulti = path->all_pass_qmf;
+  for (i = 0; i < kTrials / 40; i++) {
+    int channels = Uniform(1, WEBRTC_SPL_QMF_MAX_CHANNELS);
+    int band = Uniform(0, 3) ? Uniform(1, 40) : Uniform(1, kBand);
+
+    FillQMFState(&analysis_state, analysis);
+    FillQMFState(&synthesis_state, synthesis);
+    for (f = 0; f < kFrames; f++) {
+      const int16_t* in_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+      const int16_t* low_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+      const int16_t* high_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+      int16_t* low_out[WEBRTC_SPL_QMF_MAX_CHANNELS];
+      int16_t* high_out[WEBRTC_SPL_QMF_MAX_CHANNELS];
+      int16_t* out_ptr[WEBRTC_SPL_QMF_MAX_CHANNELS];
+
+      for (c = 0; c < channels; c++) {
+        int skip = Uniform(0, 7) == 0;
+
+        FillW16(in[c], 2 * band, Uniform(1, 32767));
+        in_ptr[c] = skip ? NULL : in[c];
+        low_ptr[c] = skip ? NULL : low[0][c];
+        high_ptr[c] = high[0][c];
+        low_out[c] = low[1][c];
+        high_out[c] = high[1][c];
+        out_ptr[c] = out[1][c];
+        if (skip) {
+          continue;
+        }
+        WebRtcSpl_AnalysisQMF(in[c], 2 * band, low[0][c], high[0][c],
+                              analysis[c][0], analysis[c][1]);
+        WebRtcSpl_SynthesisQMF(low[0][c], high[0][c], band, out[0][c],
+                               synthesis[c][0], synthesis[c][1]);
+      }
+      WebRtcSpl_AnalysisQMFMulti(in_ptr, channels, 2 * band, low_out,
+                                 high_out, &analysis_state);
+      WebRtcSpl_SynthesisQMFMulti(low_ptr, high_ptr, channels, band, out_ptr,
+                                  &synthesis_state);
+      for (c = 0; c < channels; c++) {
+        if (in_ptr[c] == NULL) {
+          continue;
+        }
+        for (k = 0; k < band; k++) {
+          mismatches[0] += low[0][c][k] != low[1][c][k];
+          mismatches[0] += high[0][c][k] != high[1][c][k];
+        }
+        for (k = 0; k < 2 * band; k++) {
+          mismatches[1] += out[0][c][k] != out[1][c][k];
+        }
+      }
+      mismatches[0] += CompareQMFState(&analysis_state, analysis);
+      mismatches[1] += CompareQMFState(&synthesis_state, synthesis);
+    }
+  }
+  Check(path->name, "AnalysisQMFMulti", mismatches[0]);
+  Check(path->name, "SynthesisQMFMulti", mismatches[1]);
+}
+
+static void TestPolyphaseFIR(const Path* c, const Path* simd) {
+  static const int kRates[] = {
+    8000, 11025, 16000, 22050, 32000, 44100, 48000, 96000
+  };
+  int16_t in[2 * kMaxLength];
+  int16_t coefficients[16 * 1024];
+  // Up to 96 / 8 outputs per input sample.
+  int16_t a[13 * kMaxLength];
+  int16_t b[13 * kMaxLength];
+  int mismatches = 0;
+  int i, k;
+
+  for (i = 0; i < kTrials / 4; i++) {
+    int up = kRates[Uniform(0, 7)] / 1000;
+    int down = kRates[Uniform(0, 7)] / 1000;
+    int taps = 16 * Uniform(1, 6);
+    int in_length = taps - 1 + Length(kMaxLength);
+    int position_a = (taps - 1) * up + Uniform(0, up - 1);
+    int position_b = position_a;
+    int n_a, n_b;
+
+    FillW16(in, in_length, Uniform(1, 32767));
+    // A phase of the real filter adds up to about one in Q14, keep the sum
+    // as far from overflowing, which is undefined in the C version.
+    FillW16(coefficients, taps * up, Uniform(1, (1 << 14) / taps));
+    n_a = c->polyphase_fir(in, in_length, coefficients, taps, up, down,
+                           &position_a, a);
+    n_b = simd->polyphase_fir(in, in_length, coefficients, taps, up, down,
+                              &position_b, b);
+    mismatches += n_a != n_b || position_a != position_b;
+    for (k = 0; k < n_a && k < n_b; k++) {
+      mismatches += a[k] != b[k];
+    }
+  }
+  Check(simd->name, "PolyphaseFIR", mismatches);
+}
+
+static void TestFFT(const Path* c, const Path* simd) {
+  int16_t a[2 << kMaxFFTOrder];
+  int16_t b[2 << kMaxFFTOrder];
+  int16_t in[2 << kMaxFFTOrder];
+  int complex_mismatches = 0;
+  int real_mismatches = 0;
+  int i, k;
+
+  for (i = 0; i < kTrials / 10; i++) {
+    const int order = Uniform(1, kMaxFFTOrder);
+    const int n = 1 << order;
+    const int mode = Uniform(0, 1);
+    const int inverse = Uniform(0, 1);
+    struct RealFFT* fft = WebRtcSpl_CreateRealFFTC(order);
+
+    FillW16(in, 2 * n, Uniform(1, 32767));
+    memcpy(a, in, sizeof(int16_t) * 2 * n);
+    memcpy(b, in, sizeof(int16_t) * 2 * n);
+    if (inverse) {
+      complex_mismatches += c->complex_ifft(a, order, mode) !=
+                            simd->complex_ifft(b, order, mode);
+    } else {
+      complex_mismatches += c->complex_fft(a, order, mode) !=
+                            simd->complex_fft(b, order, mode);
+    }
+    complex_mismatches += memcmp(a, b, sizeof(int16_t) * 2 * n) != 0;
+
+    if (inverse) {
+      real_mismatches += c->real_inverse_fft(fft, in, a) !=
+                         simd->real_inverse_fft(fft, in, b);
+      for (k = 0; k < n; k++) {
+        real_mismatches += a[k] != b[k];
+      }
+    } else {
+      real_mismatches += c->real_forward_fft(fft, in, a) !=
+                         simd->real_forward_fft(fft, in, b);
+      for (k = 0; k < n + 2; k++) {
+        real_mismatches += a[k] != b[k];
+      }
+    }
+    WebRtcSpl_FreeRealFFTC(fft);
+  }
+  Check(simd->name, "ComplexFFT/IFFT", complex_mismatches);
+  Check(simd->name, "RealForwardFFT/InverseFFT", real_mismatches);
+}
+
+// 1 kHz at half scale through every device rate to 16 kHz and back, fed in
+// random pieces on one channel and at once on the other.
+static void TestResampler(const Path* path) {
+  static const int kRates[] = { 8000, 11025, 22050, 44100, 48000, 96000 };
+  enum { kSeconds = 1 };
+  static int16_t in[96000 * kSeconds];
+  static int16_t whole[2 * 96000 * kSeconds];
+  static int16_t pieces[2 * 96000 * kSeconds];
+  int mismatches = 0;
+  int bad_level = 0;
+  int r, d, k;
+
+  WebRtcSpl_PolyphaseFIR = path->polyphase_fir;
+  for (r = 0; r < (int) (sizeof(kRates) / sizeof(kRates[0])); r++) {
+    for (d = 0; d < 2; d++) {
+      const int in_rate = d == 0 ? kRates[r] : 16000;
+      const int out_rate = d == 0 ? 16000 : kRates[r];
+      const int in_length = in_rate * kSeconds;
+      struct PolyphaseResampler* resampler =
+          WebRtcSpl_CreatePolyphaseResampler(in_rate, out_rate, 2);
+      int whole_length, pieces_length = 0;
+      double sum = 0;
+      int offset;
+
+      for (k = 0; k < in_length; k++) {
+        in[k] = (int16_t) floor(16384 * sin(2 * 3.14159265358979 * 1000 * k /
+                                             in_rate) + 0.5);
+      }
+      whole_length = WebRtcSpl_ResamplePolyphase(resampler, 0, in, in_length,
+                                                 whole);
+      for (offset = 0; offset < in_length;) {
+        int piece = Uniform(1, 1500);
+        if (piece > in_length - offset) {
+          piece = in_length - offset;
+        }
+        pieces_length += WebRtcSpl_ResamplePolyphase(resampler, 1,
+                                                     &in[offset], piece,
+                                                     &pieces[pieces_length]);
+        offset += piece;
+      }
+      WebRtcSpl_FreePolyphaseResampler(resampler);
+
+      mismatches += whole_length != pieces_length;
+      mismatches += whole_length > (int64_t) in_length * out_rate / in_rate + 1;
+      for (k = 0; k < whole_length && k < pieces_length; k++) {
+        mismatches += whole[k] != pieces[k];
+      }
+      // RMS of the second half, past the filter delay.
+      for (k = whole_length / 2; k < whole_length; k++) {
+        sum += (double) whole[k] * whole[k];
+      }
+      sum = sqrt(sum / (whole_length - whole_length / 2));
+      bad_level += fabs(sum - 16384 / sqrt(2.0)) > 0.02 * 16384 / sqrt(2.0);
+    }
+  }
+  Check(path->name, "ResamplePolyphase pieces", mismatches);
+  Check(path->name, "ResamplePolyphase level", bad_level);
+}
+
+int main() {
+  Path paths[3];
+  int count = 0;
+  int j;
+
+  // The complex IFFTs scale through WebRtcSpl_MaxAbsValueW16().
+  WebRtcSpl_Init();
+
+  paths[count].name = "c";
+  paths[count].max_abs_w16 = WebRtcSpl_MaxAbsValueW16C;
+  paths[count].max_abs_w32 = WebRtcSpl_MaxAbsValueW32C;
+  paths[count].max_w16 = WebRtcSpl_MaxValueW16C;
+  paths[count].max_w32 = WebRtcSpl_MaxValueW32C;
+  paths[count].min_w16 = WebRtcSpl_MinValueW16C;
+  paths[count].min_w32 = WebRtcSpl_MinValueW32C;
+  paths[count].cross_correlation = WebRtcSpl_CrossCorrelationC;
+  paths[count].downsample_fast = WebRtcSpl_DownsampleFastC;
+  paths[count].scale_and_add = WebRtcSpl_ScaleAndAddVectorsWithRoundC;
+  paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiC;
+  paths[count].polyphase_fir = WebRtcSpl_PolyphaseFIRC;
+  paths[count].complex_fft = WebRtcSpl_ComplexFFT;
+  paths[count].complex_ifft = WebRtcSpl_ComplexIFFT;
+  paths[count].real_forward_fft = WebRtcSpl_RealForwardFFTC;
+  paths[count++].real_inverse_fft = WebRtcSpl_RealInverseFFTC;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    paths[count].name = "sse2";
+    paths[count].max_abs_w16 = WebRtcSpl_MaxAbsValueW16SSE2;
+    paths[count].max_abs_w32 = WebRtcSpl_MaxAbsValueW32SSE2;
+    paths[count].max_w16 = WebRtcSpl_MaxValueW16SSE2;
+    paths[count].max_w32 = WebRtcSpl_MaxValueW32SSE2;
+    paths[count].min_w16 = WebRtcSpl_MinValueW16SSE2;
+    paths[count].min_w32 = WebRtcSpl_MinValueW32SSE2;
+    paths[count].cross_correlation = WebRtcSpl_CrossCorrelationSSE2;
+    paths[count].downsample_fast = WebRtcSpl_DownsampleFastSSE2;
+    paths[count].scale_and_add = WebRtcSpl_ScaleAndAddVectorsWithRoundSSE2;
+    paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiSSE2;
+    paths[count].polyphase_fir = WebRtcSpl_PolyphaseFIRSSE2;
+    paths[count].complex_fft = WebRtcSpl_ComplexFFTSSE2;
+    paths[count].complex_ifft = WebRtcSpl_ComplexIFFTSSE2;
+    paths[count].real_forward_fft = WebRtcSpl_RealForwardFFTSSE2;
+    paths[count++].real_inverse_fft = WebRtcSpl_RealInverseFFTSSE2;
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    paths[count].name = "avx2";
+    paths[count].max_abs_w16 = WebRtcSpl_MaxAbsValueW16AVX2;
+    paths[count].max_abs_w32 = WebRtcSpl_MaxAbsValueW32AVX2;
+    paths[count].max_w16 = WebRtcSpl_MaxValueW16AVX2;
+    paths[count].max_w32 = WebRtcSpl_MaxValueW32AVX2;
+    paths[count].min_w16 = WebRtcSpl_MinValueW16AVX2;
+    paths[count].min_w32 = WebRtcSpl_MinValueW32AVX2;
+    paths[count].cross_correlation = WebRtcSpl_CrossCorrelationAVX2;
+    paths[count].downsample_fast = WebRtcSpl_DownsampleFastAVX2;
+    paths[count].scale_and_add = WebRtcSpl_ScaleAndAddVectorsWithRoundAVX2;
+    paths[count].all_pass_qmf = WebRtcSpl_AllPassQMFMultiAVX2;
+    paths[count].polyphase_fir = WebRtcSpl_PolyphaseFIRAVX2;
+    paths[count].complex_fft = WebRtcSpl_ComplexFFTAVX2;
+    paths[count].complex_ifft = WebRtcSpl_ComplexIFFTAVX2;
+    paths[count].real_forward_fft = WebRtcSpl_RealForwardFFTAVX2;
+    paths[count++].real_inverse_fft = WebRtcSpl_RealInverseFFTAVX2;
+  }
+#endif
+
+  printf("%-6s %-28s %12s\n", "path", "check", "mismatches");
+  for (j = 1; j < count; j++) {
+    TestMinMax(&paths[0], &paths[j]);
+    TestCrossCorrelation(&paths[0], &paths[j]);
+    TestDownsampleFast(&paths[0], &paths[j]);
+    TestScaleAndAdd(&paths[0], &paths[j]);
+    TestPolyphaseFIR(&paths[0], &paths[j]);
+    TestFFT(&paths[0], &paths[j]);
+  }
+  for (j = 0; j < count; j++) {
+    TestQMF(&paths[j]);
+    TestResampler(&paths[j]);
+  }
+
+  if (failures != 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Scaffolding shared by the tests: the random number generator, the random
+ * vectors, the result table and the CPU feature override of the SSE2 path.
+ *
+ * The generator is a plain LCG so that the draws, and with them the golden
+ * outputs, are the same on every platform.  The tests reset |seed| where
+ * they need a known sequence.
+ */
+
+#ifndef TEST_TEST_UTIL_H_
+#define TEST_TEST_UTIL_H_
+
+#include <stdio.h>
+
+#include "signal_processing/include/signal_processing_library.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+static WebRtc_CPUInfo host_cpu_info;
+static unsigned seed = 1;
+static int failures = 0;
+
+// The SSE2 path on a host that has more, for the |cpu_info| of the paths.
+// |host_cpu_info| has to be set first.
+static inline int SSE2Only(CPUFeature feature) {
+  return feature == kSSE2 && host_cpu_info(kSSE2);
+}
+
+static inline unsigned NextSeed(void) {
+  seed = seed * 1103515245u + 12345u;
+  return seed;
+}
+
+// In [lo, hi].
+static inline int Uniform(int lo, int hi) {
+  unsigned s = NextSeed();
+
+  return lo + (int) (((s >> 8) & 0xffffff) % (unsigned) (hi - lo + 1));
+}
+
+// In [lo, hi].
+static inline float UniformFloat(float lo, float hi) {
+  return lo + (hi - lo) * ((NextSeed() >> 8) & 0xffffff) / (float) 0xffffff;
+}
+
+static inline int32_t Uniform32(void) {
+  unsigned s = NextSeed();
+
+  return (int32_t) ((s & 0xffff0000u) | ((s * 69069u) >> 16));
+}
+
+// Mostly short vectors, where the scalar tails matter, and sometimes long
+// ones.
+static inline int Length(int max) {
+  return Uniform(0, 3) ? Uniform(1, 40) : Uniform(1, max);
+}
+
+// Within +-|range|, and half of the time with one sample at full scale.
+static inline void FillW16(int16_t* x, int len, int range) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    x[i] = (int16_t) Uniform(-range, range);
+  }
+  if (Uniform(0, 1)) {
+    x[Uniform(0, len - 1)] = (int16_t) (Uniform(0, 1) ? 32767 : -32768);
+  }
+}
+
+// Of every magnitude, without WEBRTC_SPL_WORD32_MIN, abs() of which is
+// undefined.
+static inline void FillW32(int32_t* x, int len) {
+  int i;
+
+  for (i = 0; i < len; i++) {
+    // Two statements, the order of the draws is part of the goldens
+    int32_t v = Uniform32();
+    x[i] = v >> Uniform(0, 31);
+    if (x[i] == WEBRTC_SPL_WORD32_MIN) {
+      x[i]++;
+    }
+  }
+}
+
+// A row of the result table of a bit-exact check.
+static inline void Check(const char* path, const char* what, int mismatches) {
+  printf("%-6s %-28s %12d %s\n",
+         path, what, mismatches, mismatches == 0 ? "ok" : "FAIL");
+  if (mismatches != 0) {
+    failures++;
+  }
+}
+
+// A row of the result table of a check within |max|.
+static inline void CheckError(const char* path, const char* what,
+                              double err, double max) {
+  int ok = err <= max;
+
+  printf("%-6s %-28s %12g %s\n", path, what, err, ok ? "ok" : "FAIL");
+  if (!ok) {
+    failures++;
+  }
+}
+
+#endif  // TEST_TEST_UTIL_H_
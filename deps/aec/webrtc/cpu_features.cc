@@ -16,6 +16,9 @@
 #include <intrin.h>
 #endif
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "webrtc/typedefs.h"
 
 // No CPU feature is available => straight C path.
@@ -28,28 +31,38 @@ int GetCPUInfoNoASM(CPUFeature feature) {
 #ifndef _MSC_VER
 // Intrinsic for "cpuid".
 #if defined(__pic__) && defined(__i386__)
-static inline void __cpuid(int cpu_info[4], int info_type) {
+static inline void __cpuidex(int cpu_info[4], int info_type, int info_index) {
   __asm__ volatile(
     "mov %%ebx, %%edi\n"
     "cpuid\n"
     "xchg %%edi, %%ebx\n"
     : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
-    : "a"(info_type));
+    : "a"(info_type), "c"(info_index));
 }
 #else
-static inline void __cpuid(int cpu_info[4], int info_type) {
+static inline void __cpuidex(int cpu_info[4], int info_type, int info_index) {
   __asm__ volatile(
     "cpuid\n"
     : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
-    : "a"(info_type));
+    : "a"(info_type), "c"(info_index));
 }
 #endif
+static inline void __cpuid(int cpu_info[4], int info_type) {
+  __cpuidex(cpu_info, info_type, 0);
+}
+
+// Intrinsic for "xgetbv".
+static inline uint64_t _xgetbv(uint32_t xcr) {
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
 #endif  // _MSC_VER
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
 // Actual feature detection for x86.
-static int GetCPUInfo(CPUFeature feature) {
+static int ProbeCPUInfo(CPUFeature feature) {
   int cpu_info[4];
   __cpuid(cpu_info, 1);
   if (feature == kSSE2) {
@@ -58,8 +71,65 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kPOPCNT) {
+    return 0 != (cpu_info[2] & 0x00800000);
+  }
+  if (feature == kAVX2) {
+    // The OS has to save the YMM registers (OSXSAVE + XCR0 bits 1 and 2)
+    // before the AVX2 bit in leaf 7 means anything.
+    int max_info_type;
+    if ((cpu_info[2] & 0x18000000) != 0x18000000 ||
+        (_xgetbv(0) & 0x6) != 0x6) {
+      return 0;
+    }
+    __cpuid(cpu_info, 0);
+    max_info_type = cpu_info[0];
+    if (max_info_type < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info, 7, 0);
+    return 0 != (cpu_info[1] & 0x00000020);
+  }
   return 0;
 }
+
+// The features WEBRTC_DISPATCH leaves to the dispatchers, all of them if it
+// is unset or unknown. It cannot turn on a feature the CPU does not have.
+static int DispatchMask() {
+  const char* path = getenv("WEBRTC_DISPATCH");
+
+  if (path == NULL) {
+    return ~0;
+  }
+  if (strcmp(path, "c") == 0) {
+    return 0;
+  }
+  if (strcmp(path, "sse2") == 0) {
+    return 1 << kSSE2;
+  }
+  return ~0;
+}
+
+// Probes all the features once, as a bitmask indexed by CPUFeature.  cpuid
+// traps to the hypervisor in virtual machines, at a few microseconds a leaf,
+// and every AEC, NS and AGC instance asks for several features when it is
+// initialized.
+static int ProbeCPUFeatures() {
+  int features = 0;
+  int feature;
+
+  for (feature = kSSE2; feature <= kAVX2; feature++) {
+    if (ProbeCPUInfo(static_cast<CPUFeature>(feature))) {
+      features |= 1 << feature;
+    }
+  }
+  return features & DispatchMask();
+}
+
+static int GetCPUInfo(CPUFeature feature) {
+  static const int features = ProbeCPUFeatures();
+  return 0 != (features & (1 << feature));
+}
 #else
 // Default to straight C for other platforms.
 static int GetCPUInfo(CPUFeature feature) {
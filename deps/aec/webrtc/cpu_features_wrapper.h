@@ -20,7 +20,9 @@ extern "C" {
 // List of features in x86.
 typedef enum {
   kSSE2,
-  kSSE3
+  kSSE3,
+  kPOPCNT,
+  kAVX2
 } CPUFeature;
 
 // List of features in ARM.
@@ -33,7 +35,9 @@ enum {
 
 typedef int (*WebRtc_CPUInfo)(CPUFeature feature);
 
-// Returns true if the CPU supports the feature.
+// Returns true if the CPU supports the feature. On x86 the WEBRTC_DISPATCH
+// environment variable, "c", "sse2" or "avx2", caps the features reported so
+// that the dispatchers pick that path. It is read once, by the first call.
 extern WebRtc_CPUInfo WebRtc_GetCPUInfo;
 
 // No CPU feature is available => straight C path.
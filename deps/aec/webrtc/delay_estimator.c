@@ -14,6 +14,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "webrtc/cpu_features_wrapper.h"
+
 // Number of right shifts for scaling is linearly depending on number of bits in
 // the far-end binary spectrum.
 static const int kShiftsAtZero = 13;  // Right shifts at zero binary spectrum.
@@ -71,6 +73,8 @@ static void BitCountComparison(uint32_t binary_vector,
   }
 }
 
+WebRtc_BitCountComparison_t WebRtc_BitCountComparison;
+
 // Collects necessary statistics for the HistogramBasedValidation().  This
 // function has to be called prior to calling HistogramBasedValidation().  The
 // statistics updated and used by the HistogramBasedValidation() are:
@@ -302,6 +306,51 @@ void WebRtc_InitBinaryDelayEstimatorFarend(BinaryDelayEstimatorFarend* self) {
   assert(self != NULL);
   memset(self->binary_far_history, 0, sizeof(uint32_t) * self->history_size);
   memset(self->far_bit_counts, 0, sizeof(int) * self->history_size);
+
+  // Assembly optimization
+  WebRtc_BitCountComparison = BitCountComparison;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kPOPCNT) && WebRtc_GetCPUInfo(kAVX2)) {
+    WebRtc_InitBinaryDelayEstimator_AVX2();
+  }
+#endif
+}
+
+void WebRtc_SoftResetBinaryDelayEstimatorFarend(
+    BinaryDelayEstimatorFarend* self, int delay_shift) {
+  int abs_shift = abs(delay_shift);
+  int shift_size = 0;
+  int dest_index = 0;
+  int src_index = 0;
+  int padding_index = 0;
+
+  assert(self != NULL);
+  if (delay_shift == 0) {
+    return;
+  }
+  if (abs_shift >= self->history_size) {
+    WebRtc_InitBinaryDelayEstimatorFarend(self);
+    return;
+  }
+  shift_size = self->history_size - abs_shift;
+  if (delay_shift > 0) {
+    dest_index = abs_shift;
+  } else {
+    src_index = abs_shift;
+    padding_index = shift_size;
+  }
+
+  // Shift and zero pad buffers.
+  memmove(&self->binary_far_history[dest_index],
+          &self->binary_far_history[src_index],
+          sizeof(*self->binary_far_history) * shift_size);
+  memset(&self->binary_far_history[padding_index], 0,
+         sizeof(*self->binary_far_history) * abs_shift);
+  memmove(&self->far_bit_counts[dest_index],
+          &self->far_bit_counts[src_index],
+          sizeof(*self->far_bit_counts) * shift_size);
+  memset(&self->far_bit_counts[padding_index], 0,
+         sizeof(*self->far_bit_counts) * abs_shift);
 }
 
 void WebRtc_AddBinaryFarSpectrum(BinaryDelayEstimatorFarend* handle,
@@ -410,6 +459,65 @@ void WebRtc_InitBinaryDelayEstimator(BinaryDelayEstimator* self) {
   self->last_delay_histogram = 0.f;
 }
 
+void WebRtc_SoftResetBinaryDelayEstimator(BinaryDelayEstimator* self,
+                                          int delay_shift) {
+  int history_size = 0;
+  int abs_shift = abs(delay_shift);
+  int shift_size = 0;
+  int dest_index = 0;
+  int src_index = 0;
+  int padding_index = 0;
+  int i = 0;
+
+  assert(self != NULL);
+  history_size = self->farend->history_size;
+  if (delay_shift == 0) {
+    return;
+  }
+  if (abs_shift >= history_size) {
+    WebRtc_InitBinaryDelayEstimator(self);
+    return;
+  }
+  shift_size = history_size - abs_shift;
+  if (delay_shift > 0) {
+    dest_index = abs_shift;
+  } else {
+    src_index = abs_shift;
+    padding_index = shift_size;
+  }
+
+  // The cost function and the histogram are indexed by delay, hence they move
+  // along with the far-end history.  Vacated bins start over from their
+  // initial values.
+  memmove(&self->mean_bit_counts[dest_index],
+          &self->mean_bit_counts[src_index],
+          sizeof(*self->mean_bit_counts) * shift_size);
+  memmove(&self->histogram[dest_index],
+          &self->histogram[src_index],
+          sizeof(*self->histogram) * shift_size);
+  for (i = padding_index; i < padding_index + abs_shift; ++i) {
+    self->mean_bit_counts[i] = (20 << 9);  // 20 in Q9.
+    self->histogram[i] = 0.f;
+  }
+
+  if (self->last_delay >= 0) {
+    self->last_delay += delay_shift;
+    if (self->last_delay < 0 || self->last_delay >= history_size) {
+      self->last_delay = -2;
+    }
+  }
+  if (self->last_candidate_delay >= 0) {
+    self->last_candidate_delay += delay_shift;
+    if (self->last_candidate_delay < 0 ||
+        self->last_candidate_delay >= history_size) {
+      self->last_candidate_delay = -2;
+    }
+  }
+  self->compare_delay = (self->last_delay >= 0 ? self->last_delay :
+      history_size);
+  self->candidate_hits = 0;
+}
+
 int WebRtc_ProcessBinarySpectrum(BinaryDelayEstimator* self,
                                  uint32_t binary_near_spectrum) {
   int i = 0;
@@ -432,8 +540,9 @@ int WebRtc_ProcessBinarySpectrum(BinaryDelayEstimator* self,
   }
 
   // Compare with delayed spectra and store the |bit_counts| for each delay.
-  BitCountComparison(binary_near_spectrum, self->farend->binary_far_history,
-                     self->farend->history_size, self->bit_counts);
+  WebRtc_BitCountComparison(binary_near_spectrum,
+                            self->farend->binary_far_history,
+                            self->farend->history_size, self->bit_counts);
 
   // Update |mean_bit_counts|, which is the smoothed version of |bit_counts|.
   for (i = 0; i < self->farend->history_size; i++) {
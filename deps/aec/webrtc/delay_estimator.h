@@ -55,6 +55,19 @@ typedef struct {
   BinaryDelayEstimatorFarend* farend;
 } BinaryDelayEstimator;
 
+// Compares |binary_vector| with each of the |matrix_size| rows of
+// |binary_matrix| and writes the number of differing bits per row to
+// |bit_counts|.
+typedef void (*WebRtc_BitCountComparison_t)(uint32_t binary_vector,
+                                             const uint32_t* binary_matrix,
+                                             int matrix_size,
+                                             int32_t* bit_counts);
+extern WebRtc_BitCountComparison_t WebRtc_BitCountComparison;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtc_InitBinaryDelayEstimator_AVX2(void);
+#endif
+
 // Releases the memory allocated by
 // WebRtc_CreateBinaryDelayEstimatorFarend(...).
 // Input:
@@ -91,6 +104,18 @@ BinaryDelayEstimatorFarend* WebRtc_CreateBinaryDelayEstimatorFarend(
 //
 void WebRtc_InitBinaryDelayEstimatorFarend(BinaryDelayEstimatorFarend* self);
 
+// Soft resets the delay estimation far-end instance created with
+// WebRtc_CreateBinaryDelayEstimatorFarend(...).  The binary spectrum history is
+// shifted |delay_shift| blocks towards older (positive) or newer (negative)
+// delays and the vacated entries are zeroed.  Use this when the far-end read
+// position has been moved by |delay_shift| blocks.
+//
+// Input:
+//    - delay_shift       : The amount of blocks to shift history buffers.
+//
+void WebRtc_SoftResetBinaryDelayEstimatorFarend(
+    BinaryDelayEstimatorFarend* self, int delay_shift);
+
 // Adds the binary far-end spectrum to the internal far-end history buffer. This
 // spectrum is used as reference when calculating the delay using
 // WebRtc_ProcessBinarySpectrum().
@@ -166,6 +191,18 @@ BinaryDelayEstimator* WebRtc_CreateBinaryDelayEstimator(
 //
 void WebRtc_InitBinaryDelayEstimator(BinaryDelayEstimator* self);
 
+// Soft resets the delay estimation instance created with
+// WebRtc_CreateBinaryDelayEstimator(...) to follow a far-end history that was
+// shifted with WebRtc_SoftResetBinaryDelayEstimatorFarend(...).  The cost
+// function, the histogram and the delay memory are moved |delay_shift| blocks,
+// so the estimator keeps its convergence instead of starting over.
+//
+// Input:
+//    - delay_shift       : The amount of blocks to shift.
+//
+void WebRtc_SoftResetBinaryDelayEstimator(BinaryDelayEstimator* self,
+                                          int delay_shift);
+
 // Estimates and returns the delay between the binary far-end and binary near-
 // end spectra. It is assumed the binary far-end spectrum has been added using
 // WebRtc_AddBinaryFarSpectrum() prior to this call. The value will be offset by
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * Binary delay estimator, AVX2/POPCNT version of the history comparison.
+ */
+
+#include "webrtc/delay_estimator.h"
+
+#include <immintrin.h>
+
+// Scores |binary_vector| against the whole far-end history in bulk.  Eight
+// rows are XORed at a time and their bits counted with a nibble lookup
+// (vpshufb); the per-byte counts are then summed into 32-bit lanes with two
+// multiply-adds.  A remainder of less than eight rows is handled with the
+// scalar popcnt instruction.
+static void BitCountComparisonAVX2(uint32_t binary_vector,
+                                   const uint32_t* binary_matrix,
+                                   int matrix_size,
+                                   int32_t* bit_counts) {
+  const __m256i nibble_bits = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+  const __m256i ones_8 = _mm256_set1_epi8(1);
+  const __m256i ones_16 = _mm256_set1_epi16(1);
+  const __m256i vector = _mm256_set1_epi32((int)binary_vector);
+  int n = 0;
+
+  for (; n + 8 <= matrix_size; n += 8) {
+    const __m256i rows =
+        _mm256_loadu_si256((const __m256i*)&binary_matrix[n]);
+    const __m256i diff = _mm256_xor_si256(vector, rows);
+    const __m256i lo = _mm256_shuffle_epi8(
+        nibble_bits, _mm256_and_si256(diff, low_nibble));
+    const __m256i hi = _mm256_shuffle_epi8(
+        nibble_bits,
+        _mm256_and_si256(_mm256_srli_epi16(diff, 4), low_nibble));
+    const __m256i bytes = _mm256_add_epi8(lo, hi);
+    const __m256i words = _mm256_maddubs_epi16(bytes, ones_8);
+    _mm256_storeu_si256((__m256i*)&bit_counts[n],
+                        _mm256_madd_epi16(words, ones_16));
+  }
+  for (; n < matrix_size; n++) {
+    bit_counts[n] = _mm_popcnt_u32(binary_vector ^ binary_matrix[n]);
+  }
+}
+
+void WebRtc_InitBinaryDelayEstimator_AVX2(void) {
+  WebRtc_BitCountComparison = BitCountComparisonAVX2;
+}
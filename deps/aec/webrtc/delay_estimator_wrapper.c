@@ -190,6 +190,12 @@ int WebRtc_InitDelayEstimatorFarend(void* handle) {
   return 0;
 }
 
+void WebRtc_SoftResetDelayEstimatorFarend(void* handle, int delay_shift) {
+  DelayEstimatorFarend* self = (DelayEstimatorFarend*) handle;
+  assert(self != NULL);
+  WebRtc_SoftResetBinaryDelayEstimatorFarend(self->binary_farend, delay_shift);
+}
+
 int WebRtc_AddFarSpectrumFix(void* handle, uint16_t* far_spectrum,
                              int spectrum_size, int far_q) {
   DelayEstimatorFarend* self = (DelayEstimatorFarend*) handle;
@@ -311,6 +317,12 @@ int WebRtc_InitDelayEstimator(void* handle) {
   return 0;
 }
 
+void WebRtc_SoftResetDelayEstimator(void* handle, int delay_shift) {
+  DelayEstimator* self = (DelayEstimator*) handle;
+  assert(self != NULL);
+  WebRtc_SoftResetBinaryDelayEstimator(self->binary_handle, delay_shift);
+}
+
 int WebRtc_set_allowed_offset(void* handle, int allowed_offset) {
   DelayEstimator* self = (DelayEstimator*) handle;
 
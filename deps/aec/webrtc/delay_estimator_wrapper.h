@@ -52,6 +52,15 @@ void* WebRtc_CreateDelayEstimatorFarend(int spectrum_size, int history_size);
 //
 int WebRtc_InitDelayEstimatorFarend(void* handle);
 
+// Soft resets the far-end part of the delay estimation instance returned by
+// WebRtc_CreateDelayEstimatorFarend(...).  Call this after moving the far-end
+// read position |delay_shift| blocks, so that the history stays aligned with
+// the new position.
+// Input:
+//      - delay_shift   : The amount of blocks to shift history buffers.
+//
+void WebRtc_SoftResetDelayEstimatorFarend(void* handle, int delay_shift);
+
 // Adds the far-end spectrum to the far-end history buffer. This spectrum is
 // used as reference when calculating the delay using
 // WebRtc_ProcessSpectrum().
@@ -123,6 +132,14 @@ void* WebRtc_CreateDelayEstimator(void* farend_handle, int lookahead);
 //
 int WebRtc_InitDelayEstimator(void* handle);
 
+// Soft resets the delay estimation instance returned by
+// WebRtc_CreateDelayEstimator(...) by |delay_shift| blocks, keeping the
+// estimation state consistent with WebRtc_SoftResetDelayEstimatorFarend(...).
+// Input:
+//      - delay_shift   : The amount of blocks to shift.
+//
+void WebRtc_SoftResetDelayEstimator(void* handle, int delay_shift);
+
 // Sets the |allowed_offset| used in the robust validation scheme.  If the
 // delay estimator is used in an echo control component, this parameter is
 // related to the filter length.  In principle |allowed_offset| should be set to
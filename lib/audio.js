@@ -0,0 +1,116 @@
+var stream = require('stream');
+var util = require('util');
+var binding = require('bindings')('audio');
+
+var Unit = binding.Unit;
+
+exports.Unit = Unit;
+exports.startTrace = binding.startTrace;
+exports.stopTrace = binding.stopTrace;
+
+// Dispatch the callbacks of the unit to the streams of its channels
+function streams(unit) {
+  if (unit._streams)
+    return unit._streams;
+
+  unit._streams = { input: [], output: [] };
+  unit.oninput = function oninput(channel, buf, event) {
+    var input = this._streams.input[channel];
+    if (!input)
+      return;
+    return input._onInput(buf, event);
+  };
+  unit.ondrain = function ondrain(channel) {
+    var output = this._streams.output[channel];
+    if (output)
+      output._onDrain();
+  };
+  return unit._streams;
+}
+
+// Processed capture of one channel of the unit. The native side stops
+// delivering when the stream's buffer is full and continues on the next
+// read(), the chunks wait in the unit meanwhile and the `overflow` option of
+// the unit decides what happens once they do not fit there either. Emits
+// 'event' with the decisions of the DSP stages before each chunk.
+function InputStream(unit, channel, options) {
+  stream.Readable.call(this, options);
+
+  this.unit = unit;
+  this.channel = channel;
+  streams(unit).input[channel] = this;
+}
+util.inherits(InputStream, stream.Readable);
+exports.InputStream = InputStream;
+
+InputStream.prototype._onInput = function _onInput(buf, event) {
+  this.emit('event', event);
+  return this.push(buf);
+};
+
+InputStream.prototype._read = function _read() {
+  this.unit.resume(this.channel);
+};
+
+// Counters of the channel, see Unit::GetCounters()
+InputStream.prototype.counters = function counters() {
+  return this.unit.getCounters(this.channel);
+};
+
+// Playback of one channel of the unit. A write completes once all of it is
+// queued in the unit, so that at most highWaterMark bytes wait on top of what
+// the unit holds, and 'drain' tells the producer when to go on.
+function OutputStream(unit, channel, options) {
+  stream.Writable.call(this, options);
+
+  this.unit = unit;
+  this.channel = channel;
+  this._pending = null;
+  this._odd = null;
+  streams(unit).output[channel] = this;
+}
+util.inherits(OutputStream, stream.Writable);
+exports.OutputStream = OutputStream;
+
+OutputStream.prototype._write = function _write(chunk, encoding, cb) {
+  // Samples may be split between the writes
+  if (this._odd) {
+    chunk = Buffer.concat([ this._odd, chunk ]);
+    this._odd = null;
+  }
+  if (chunk.length % 2 !== 0) {
+    this._odd = chunk.slice(chunk.length - 1);
+    chunk = chunk.slice(0, chunk.length - 1);
+  }
+
+  var written = this.unit.play(this.channel, chunk);
+  if (written === chunk.length)
+    return cb();
+
+  // The rest goes in on ondrain
+  this._pending = { chunk: chunk.slice(written), cb: cb };
+};
+
+OutputStream.prototype._onDrain = function _onDrain() {
+  var pending = this._pending;
+  if (!pending)
+    return;
+
+  this._pending = null;
+  var written = this.unit.play(this.channel, pending.chunk);
+  if (written === pending.chunk.length)
+    return pending.cb();
+  this._pending = { chunk: pending.chunk.slice(written), cb: pending.cb };
+};
+
+OutputStream.prototype.counters = InputStream.prototype.counters;
+
+Unit.prototype.createInputStream = function createInputStream(channel,
+                                                              options) {
+  return new InputStream(this, channel, options);
+};
+
+Unit.prototype.createOutputStream = function createOutputStream(channel,
+                                                                options) {
+  return new OutputStream(this, channel, options);
+};
@@ -1,6 +1,7 @@
 #include "node.h"
 #include "uv.h"
 
+#include "trace.h"
 #include "unit.h"
 
 using namespace node;
@@ -8,10 +9,32 @@ using namespace v8;
 
 namespace audio {
 
+// startTrace(path), see Trace::Start()
+static Handle<Value> StartTrace(const Arguments& args) {
+  HandleScope scope;
+
+  String::Utf8Value path(args[0]);
+  bool ok = *path != NULL && Trace::Start(*path);
+
+  return scope.Close(Boolean::New(ok));
+}
+
+
+static Handle<Value> StopTrace(const Arguments& args) {
+  HandleScope scope;
+
+  Trace::Stop();
+
+  return scope.Close(Undefined());
+}
+
+
 static Handle<Value> Initialize(Handle<Object> target) {
   HandleScope scope;
 
   Unit::Initialize(target);
+  NODE_SET_METHOD(target, "startTrace", StartTrace);
+  NODE_SET_METHOD(target, "stopTrace", StopTrace);
 
   return Null();
 }
@@ -1,49 +1,124 @@
 #include "channel.h"
 #include "common.h"
-#include "unit.h"
+#include "recorder.h"
+#include "session-log.h"
+#include "trace.h"
 
 #include "aec/include/echo_cancellation.h"
 #include "agc/include/gain_control.h"
 #include "signal_processing/include/signal_processing_library.h"
+#include "webrtc/cpu_features_wrapper.h"
+
+#include <math.h>
 
 namespace audio {
 
-Channel::Channel() : has_echo_(false), agc_(NULL), agc_level_(0), ns_(NULL) {
+Channel::Channel() : has_echo_(false),
+                     low_latency_(false),
+                     chunk_size_(kChunkSize),
+                     overflow_(kDropNewest),
+                     agc_(NULL),
+                     agc_level_(0),
+                     post_filter_(false),
+                     ns_(NULL),
+                     nsx_(NULL),
+                     cycles_(0),
+                     recorder_(NULL),
+                     recording_start_(0) {
   // Clear filters for QMF
-  memset(filters_.a_lo, 0, sizeof(filters_.a_lo));
-  memset(filters_.a_hi, 0, sizeof(filters_.a_hi));
+  memset(&filters_.analysis, 0, sizeof(filters_.analysis));
   memset(filters_.s_lo, 0, sizeof(filters_.s_lo));
   memset(filters_.s_hi, 0, sizeof(filters_.s_hi));
+  metrics_.last.delay_median = -1;
+  metrics_.last.delay_std = -1;
+  metrics_.last.gated = 0;
+  metrics_.chunks = 0;
+  gate_.threshold = 0;
+  gate_.quiet = 0;
+  gate_.count = 0;
+  counters_.capture_overrun = 0;
+  counters_.render_overrun = 0;
+  counters_.dropped = 0;
+  counters_.blocked = 0;
+  counters_.record_dropped = 0;
 }
 
 
-void Channel::Init(Unit* unit) {
+void Channel::Init(const Config& config) {
+  config_ = config;
+  low_latency_ = config.low_latency;
+  chunk_size_ = low_latency_ ? kLowLatencyChunkSize : kChunkSize;
+  post_filter_ = config.post_filter;
+  overflow_ = config.overflow;
+
+  // Pick the SIMD versions of the QMF and other primitives
+  WebRtcSpl_Init();
+
+  // Mean square of a full scale square wave is 2^30
+  if (config.gate_level < 0) {
+    gate_.threshold = static_cast<int64_t>(
+        1073741824.0 * pow(10.0, config.gate_level / 10.0));
+  }
+
   // Initialize buffers
   PaUtilRingBuffer* rings[] = { &aec_.in, &aec_.out, &io_.in, &io_.out };
   for (size_t i = 0; i < ARRAY_SIZE(rings); i++) {
     PaUtil_InitializeRingBuffer(rings[i],
-                                Unit::kSampleSize,
+                                kSampleSize,
                                 kBufferCapacity,
-                                new char[Unit::kSampleSize * kBufferCapacity]);
+                                new char[kSampleSize * kBufferCapacity]);
   }
+  PaUtil_InitializeRingBuffer(&metrics_.ring,
+                              sizeof(Metrics),
+                              kMetricsCapacity,
+                              new char[sizeof(Metrics) * kMetricsCapacity]);
+  PaUtil_InitializeRingBuffer(&events_.ring,
+                              sizeof(Event),
+                              kEventCapacity,
+                              new char[sizeof(Event) * kEventCapacity]);
 
   // Initailize AEC
   int err;
+  ASSERT(0 == uv_mutex_init(&io_.lock), "uv_mutex_init");
+  ASSERT(0 == uv_mutex_init(&aec_.lock), "uv_mutex_init");
   ASSERT(0 == WebRtcAec_Create(&aec_.handle), "Failed to create AEC");
-  err = WebRtcAec_Init(
-      aec_.handle,
-      Unit::kSampleRate,
-      static_cast<int32_t>(unit->GetHWSampleRate(Unit::kOutput)));
+  err = WebRtcAec_Init(aec_.handle, kSampleRate / 2, config.render_rate);
   ASSERT(err == 0, "Failed to initialize AEC");
 
+  // There is no reported playout delay, let AEC find it from the signals
+  AecConfig aec_config;
+  aec_config.nlpMode = kAecNlpModerate;
+  aec_config.skewMode = kAecFalse;
+  aec_config.metricsMode = kAecMetricsLight;
+  aec_config.delay_logging = kAecTrue;
+  aec_config.delay_agnostic = kAecTrue;
+  // Same gain limits as the default NS policy
+  aec_config.post_filter = post_filter_ ? kAecPostFilterMild :
+                                          kAecPostFilterOff;
+  ASSERT(0 == WebRtcAec_set_config(aec_.handle, aec_config),
+         "Failed to configure AEC");
+
+  // Start with the "no data" values until the first snapshot
+  ASSERT(0 == WebRtcAec_GetMetrics(aec_.handle, &metrics_.last.aec),
+         "Failed to fetch AEC metrics");
+
   // Initialize AGC
   ASSERT(0 == WebRtcAgc_Create(&agc_), "Failed to create AGC");
-  ASSERT(0 == WebRtcAgc_Init(agc_, 0, 255, 1, Unit::kSampleRate / 2),
+  ASSERT(0 == WebRtcAgc_Init(agc_, 0, 255, 1, kSampleRate / 2),
          "Failed to init AGC");
 
-  // Initialize NS
-  ASSERT(0 == WebRtcNs_Create(&ns_), "Failed to create NS");
-  ASSERT(0 == WebRtcNs_Init(ns_, Unit::kSampleRate / 2), "Failed to init NS");
+  // Initialize NS, unless the AEC post-filter takes its place
+  if (post_filter_)
+    return;
+  if (config.fixed_ns) {
+    ASSERT(0 == WebRtcNsx_Create(&nsx_), "Failed to create NSX");
+    ASSERT(0 == WebRtcNsx_Init(nsx_, kSampleRate / 2),
+           "Failed to init NSX");
+  } else {
+    ASSERT(0 == WebRtcNs_Create(&ns_), "Failed to create NS");
+    ASSERT(0 == WebRtcNs_Init(ns_, kSampleRate / 2),
+           "Failed to init NS");
+  }
 }
 
 
@@ -53,82 +128,190 @@ Channel::~Channel() {
     delete[] rings[i]->buffer;
     rings[i]->buffer = NULL;
   }
+  StopRecording();
+
+  delete[] metrics_.ring.buffer;
+  metrics_.ring.buffer = NULL;
+  delete[] events_.ring.buffer;
+  events_.ring.buffer = NULL;
 
   ASSERT(0 == WebRtcAec_Free(aec_.handle), "Failed to destroy AEC");
   aec_.handle = NULL;
+  uv_mutex_destroy(&aec_.lock);
+  uv_mutex_destroy(&io_.lock);
 
   ASSERT(0 == WebRtcAgc_Free(agc_), "Faield to destroy AGC");
   agc_ = NULL;
 
-  ASSERT(0 == WebRtcNs_Free(ns_), "Failed to free NS");
-  ns_ = NULL;
+  if (nsx_ != NULL) {
+    ASSERT(0 == WebRtcNsx_Free(nsx_), "Failed to free NSX");
+    nsx_ = NULL;
+  }
+  if (ns_ != NULL) {
+    ASSERT(0 == WebRtcNs_Free(ns_), "Failed to free NS");
+    ns_ = NULL;
+  }
 }
 
 
-void Channel::Cycle(ring_buffer_size_t avail_in, ring_buffer_size_t avail_out) {
-  int16_t buf[Unit::kChunkSize];
+bool Channel::Cycle(ring_buffer_size_t avail_in, ring_buffer_size_t avail_out) {
+  int16_t buf[kChunkSize];
+  int16_t far[kChunkSize];
+  int16_t near[kChunkSize];
+  int16_t lo[ARRAY_SIZE(buf) / 2];
+  int16_t hi[ARRAY_SIZE(lo)];
+  int16_t far_lo[ARRAY_SIZE(lo)];
+  int16_t far_hi[ARRAY_SIZE(lo)];
+  const int16_t* in[2] = { NULL, NULL };
+  int16_t* lo_out[2] = { lo, far_lo };
+  int16_t* hi_out[2] = { hi, far_hi };
+  size_t len = chunk_size_ / 2;
   ring_buffer_size_t avail;
+  TraceScope trace("Cycle");
 
-  // Feed playback data into AEC
-  if (avail_out >= Unit::kChunkSize) {
-    avail = PaUtil_ReadRingBuffer(&aec_.out, buf, Unit::kChunkSize);
-    ASSERT(avail == Unit::kChunkSize, "Read less than expected");
-    ASSERT(0 == WebRtcAec_BufferFarend(aec_.handle, buf, Unit::kChunkSize),
-           "Failed to queue AEC far end");
-  }
+  uv_mutex_lock(&aec_.lock);
 
-  if ((size_t) avail_in >= ARRAY_SIZE(buf)) {
-    // Feed capture data into AEC
-    avail = PaUtil_ReadRingBuffer(&aec_.in, buf, ARRAY_SIZE(buf));
-    ASSERT(avail == ARRAY_SIZE(buf), "Read less than expected");
+  // Nowhere to put the output, leave both ends in their rings for later
+  if (overflow_ == kBlock &&
+      avail_in >= chunk_size_ &&
+      PaUtil_GetRingBufferWriteAvailable(&io_.in) < chunk_size_) {
+    counters_.blocked++;
+    uv_mutex_unlock(&aec_.lock);
+    return false;
+  }
 
-    int16_t lo[ARRAY_SIZE(buf) / 2];
-    int16_t hi[ARRAY_SIZE(lo)];
+  if (avail_out >= chunk_size_) {
+    avail = PaUtil_ReadRingBuffer(&aec_.out, far, chunk_size_);
+    ASSERT(avail == chunk_size_, "Read less than expected");
+    in[kFar] = far;
+  }
+  if (avail_in >= chunk_size_) {
+    avail = PaUtil_ReadRingBuffer(&aec_.in, buf, chunk_size_);
+    ASSERT(avail == chunk_size_, "Read less than expected");
+    in[kNear] = buf;
+    // |buf| turns into the output, the recording needs both
+    if (recorder_ != NULL)
+      memcpy(near, buf, sizeof(*buf) * chunk_size_);
+  }
 
-    // Split signal
-    WebRtcSpl_AnalysisQMF(buf,
-                          ARRAY_SIZE(buf),
-                          lo,
-                          hi,
-                          filters_.a_lo,
-                          filters_.a_hi);
+  // AEC runs on the lower band only, split far end the same way as near end
+  // and in the same pass
+  if (in[kNear] != NULL || in[kFar] != NULL) {
+    TraceScope trace("AnalysisQMF");
+    WebRtcSpl_AnalysisQMFMulti(in,
+                               ARRAY_SIZE(in),
+                               chunk_size_,
+                               lo_out,
+                               hi_out,
+                               &filters_.analysis);
+  }
 
-    PreAGC(lo, hi, ARRAY_SIZE(lo));
-    AEC(lo, hi, ARRAY_SIZE(lo));
-    NS(lo, hi);
-    PostAGC(lo, hi, ARRAY_SIZE(lo));
+  // Feed playback data into AEC
+  if (in[kFar] != NULL) {
+    TraceScope trace("BufferFarend");
+    if (low_latency_) {
+      ASSERT(0 == WebRtcAec_BufferFarendPartitions(aec_.handle,
+                                                   far_lo,
+                                                   len),
+             "Failed to queue AEC far end");
+    } else {
+      ASSERT(0 == WebRtcAec_BufferFarend(aec_.handle, far_lo, len),
+             "Failed to queue AEC far end");
+    }
+  }
 
-    // Join signal
-    WebRtcSpl_SynthesisQMF(lo,
-                           hi,
-                           ARRAY_SIZE(lo),
-                           buf,
-                           filters_.s_lo,
-                           filters_.s_hi);
+  if (in[kNear] != NULL) {
+    Event* ev = &events_.current;
+    ev->vad = -1;
+    ev->vad_ratio = -1;
+    ev->speech_probability = -1;
+    ev->echo = -1;
+    ev->saturated = -1;
+
+    if (Gate(buf)) {
+      Idle(lo, hi, len);
+      memset(buf, 0, sizeof(*buf) * chunk_size_);
+    } else {
+      if (low_latency_) {
+        AEC(lo, hi, len);
+      } else {
+        PreAGC(lo, hi, len);
+        AEC(lo, hi, len);
+        if (!post_filter_)
+          NS(lo, hi);
+        PostAGC(lo, hi, len);
+      }
+
+      // Join signal
+      TraceScope trace("SynthesisQMF");
+      WebRtcSpl_SynthesisQMF(lo,
+                             hi,
+                             len,
+                             buf,
+                             filters_.s_lo,
+                             filters_.s_hi);
+    }
+
+    // Write it out, the event goes first so that the event loop finds it as
+    // soon as it sees the chunk
+    if (Reserve()) {
+      PaUtil_WriteRingBuffer(&events_.ring, ev, 1);
+      PaUtil_WriteRingBuffer(&io_.in, buf, chunk_size_);
+    }
+  }
 
-    // Write it out
-    PaUtil_WriteRingBuffer(&io_.in, buf, ARRAY_SIZE(buf));
+  bool progress = in[kNear] != NULL || in[kFar] != NULL;
+  if (progress) {
+    if (recorder_ != NULL)
+      Record(in[kFar], in[kNear] != NULL ? near : NULL, buf);
+    cycles_++;
   }
+
+  uv_mutex_unlock(&aec_.lock);
+  return progress;
 }
 
 
 void Channel::AEC(int16_t* lo, int16_t* hi, size_t len) {
-  ASSERT(0 == WebRtcAec_Process(aec_.handle, lo, hi, lo, hi, len, 0, 0),
-         "Failed to queue AEC near end");
+  TraceScope trace("AEC");
+
+  if (low_latency_) {
+    int err = WebRtcAec_ProcessPartitions(aec_.handle, lo, hi, lo, hi, len, 0);
+    ASSERT(0 == err, "Failed to queue AEC near end");
+  } else {
+    ASSERT(0 == WebRtcAec_Process(aec_.handle, lo, hi, lo, hi, len, 0, 0),
+           "Failed to queue AEC near end");
+  }
 
   int status = 0;
   ASSERT(0 == WebRtcAec_get_echo_status(aec_.handle, &status),
          "Failed to fetch AEC status");
   has_echo_ = status == 1;
+  events_.current.echo = has_echo_;
+
+  if (++metrics_.chunks == kMetricsInterval) {
+    metrics_.chunks = 0;
+    PublishMetrics();
+  }
 }
 
 
 void Channel::PreAGC(int16_t* lo, int16_t* hi, size_t len) {
+  TraceScope trace("PreAGC");
+
   ASSERT(0 == WebRtcAgc_AddMic(agc_, lo, hi, len), "Failed to add AGC mic");
+
+  int16_t ratio;
+  int16_t active;
+  ASSERT(0 == WebRtcAgc_get_vad(agc_, &ratio, &active),
+         "Failed to fetch AGC VAD");
+  events_.current.vad = active;
+  events_.current.vad_ratio = ratio;
 }
 
 
 void Channel::PostAGC(int16_t* lo, int16_t* hi, size_t len) {
+  TraceScope trace("PostAGC");
   uint8_t wrn;
 
   int err = WebRtcAgc_Process(agc_,
@@ -142,12 +325,330 @@ void Channel::PostAGC(int16_t* lo, int16_t* hi, size_t len) {
                               has_echo_,
                               &wrn);
   ASSERT(0 == err, "Failed to apply AGC");
+  events_.current.saturated = wrn;
 }
 
 
 void Channel::NS(int16_t* lo, int16_t* hi) {
-  ASSERT(0 == WebRtcNs_Process(ns_, lo, hi, lo, hi),
-         "Failed to apply NS");
+  TraceScope trace("NS");
+
+  if (nsx_ != NULL) {
+    ASSERT(0 == WebRtcNsx_Process(nsx_, lo, hi, lo, hi),
+           "Failed to apply NSX");
+    events_.current.speech_probability = WebRtcNsx_speech_probability(nsx_);
+  } else {
+    ASSERT(0 == WebRtcNs_Process(ns_, lo, hi, lo, hi),
+           "Failed to apply NS");
+    events_.current.speech_probability = WebRtcNs_speech_probability(ns_);
+  }
+}
+
+// Cheap check on the capture chunk, before any of the stages run. The gate
+// closes after kGateHangover chunks below the threshold and opens again with
+// the first one above it.
+bool Channel::Gate(const int16_t* buf) {
+  if (gate_.threshold == 0)
+    return false;
+
+  int scale;
+  int32_t energy = WebRtcSpl_Energy(const_cast<int16_t*>(buf),
+                                    chunk_size_,
+                                    &scale);
+  if ((static_cast<int64_t>(energy) << scale) >=
+      gate_.threshold * chunk_size_) {
+    gate_.quiet = 0;
+    return false;
+  }
+
+  if (gate_.quiet < kGateHangover) {
+    gate_.quiet++;
+    return false;
+  }
+
+  gate_.count++;
+  return true;
+}
+
+
+// Gated chunk: the AEC keeps up with the far end and the NS keeps tracking
+// the noise, AGC, suppression and synthesis are skipped
+void Channel::Idle(int16_t* lo, int16_t* hi, size_t len) {
+  TraceScope trace("Idle");
+
+  // The idle AEC outputs silence, the NS has to see the near end as captured.
+  // Its output is dropped.
+  if (!low_latency_ && !post_filter_) {
+    int16_t ns_lo[kChunkSize / 2];
+    int16_t ns_hi[kChunkSize / 2];
+    memcpy(ns_lo, lo, sizeof(*lo) * len);
+    memcpy(ns_hi, hi, sizeof(*hi) * len);
+    NS(ns_lo, ns_hi);
+  }
+
+  ASSERT(0 == WebRtcAec_set_nearend_idle(aec_.handle, 1),
+         "Failed to gate AEC");
+  AEC(lo, hi, len);
+  ASSERT(0 == WebRtcAec_set_nearend_idle(aec_.handle, 0),
+         "Failed to gate AEC");
+
+  // The output is silence, start the next synthesis from it
+  memset(filters_.s_lo, 0, sizeof(filters_.s_lo));
+  memset(filters_.s_hi, 0, sizeof(filters_.s_hi));
+}
+
+
+void Channel::PublishMetrics() {
+  Metrics m;
+
+  ASSERT(0 == WebRtcAec_GetMetrics(aec_.handle, &m.aec),
+         "Failed to fetch AEC metrics");
+  if (0 != WebRtcAec_GetDelayMetrics(aec_.handle,
+                                     &m.delay_median,
+                                     &m.delay_std)) {
+    m.delay_median = -1;
+    m.delay_std = -1;
+  }
+  m.gated = gate_.count;
+
+  // Full - event loop isn't reading them, drop the snapshot
+  PaUtil_WriteRingBuffer(&metrics_.ring, &m, 1);
+}
+
+
+const Channel::Metrics* Channel::GetMetrics() {
+  // Only the most recent snapshot is interesting
+  while (PaUtil_ReadRingBuffer(&metrics_.ring, &metrics_.last, 1) == 1) {
+  }
+  return &metrics_.last;
+}
+
+
+bool Channel::ReadEvent(Event* event) {
+  return PaUtil_ReadRingBuffer(&events_.ring, event, 1) == 1;
+}
+
+
+// Makes room for a chunk and its event in |io_.in|. Returns false if the
+// chunk has to be dropped instead. |events_.ring| holds as many events as
+// |io_.in| holds chunks, it is never full on its own.
+bool Channel::Reserve() {
+  if (PaUtil_GetRingBufferWriteAvailable(&io_.in) >= chunk_size_)
+    return true;
+
+  counters_.dropped++;
+  if (overflow_ != kDropOldest)
+    return false;
+
+  // Consumer side of the rings, the event loop may be in Read()
+  uv_mutex_lock(&io_.lock);
+  PaUtil_AdvanceRingBufferReadIndex(&io_.in, chunk_size_);
+  PaUtil_AdvanceRingBufferReadIndex(&events_.ring, 1);
+  uv_mutex_unlock(&io_.lock);
+  return true;
+}
+
+
+bool Channel::Read(int16_t* out, Event* event) {
+  uv_mutex_lock(&io_.lock);
+
+  bool ok = PaUtil_GetRingBufferReadAvailable(&io_.in) >= chunk_size_;
+  if (ok) {
+    PaUtil_ReadRingBuffer(&io_.in, out, chunk_size_);
+    ASSERT(ReadEvent(event), "Chunk without event");
+  }
+
+  uv_mutex_unlock(&io_.lock);
+  return ok;
+}
+
+
+
+char* Channel::SaveState(int* size) {
+  uv_mutex_lock(&aec_.lock);
+  char* state = CopyState(size);
+  uv_mutex_unlock(&aec_.lock);
+
+  return state;
+}
+
+
+char* Channel::CopyState(int* size) {
+  char* state = NULL;
+  *size = WebRtcAec_GetStateSize(aec_.handle);
+  if (*size > 0) {
+    state = new char[*size];
+    if (WebRtcAec_SaveState(aec_.handle, state, *size) != *size) {
+      delete[] state;
+      state = NULL;
+    }
+  }
+  return state;
+}
+
+
+bool Channel::RestoreState(const char* state, int size) {
+  uv_mutex_lock(&aec_.lock);
+  int err = WebRtcAec_RestoreState(aec_.handle, state, size);
+  if (err == 0 && recorder_ != NULL) {
+    struct iovec part;
+    part.iov_base = const_cast<char*>(state);
+    part.iov_len = size;
+    LogRecord(session::kState, &part, 1);
+  }
+  uv_mutex_unlock(&aec_.lock);
+
+  return err == 0;
+}
+
+
+bool Channel::StartRecording(const char* prefix) {
+  if (recorder_ != NULL)
+    return false;
+
+  Recorder* recorder = new Recorder();
+  if (!recorder->Start(prefix, kSampleRate)) {
+    delete recorder;
+    return false;
+  }
+
+  // Cycle() only looks at |recorder_| under the lock, the session log starts
+  // before it gets to the next chunk
+  uv_mutex_lock(&aec_.lock);
+  recorder_ = recorder;
+  recording_start_ = uv_hrtime();
+  StartSessionLog();
+  uv_mutex_unlock(&aec_.lock);
+
+  return true;
+}
+
+
+void Channel::StopRecording() {
+  uv_mutex_lock(&aec_.lock);
+  Recorder* recorder = recorder_;
+  recorder_ = NULL;
+  uv_mutex_unlock(&aec_.lock);
+
+  // Writes out the rest
+  delete recorder;
+}
+
+
+void Channel::StartSessionLog() {
+  session::FileHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, session::kMagic, sizeof(h.magic));
+  h.version = session::kVersion;
+  h.sample_rate = kSampleRate;
+  for (int i = kSSE2; i <= kAVX2; i++) {
+    if (WebRtc_GetCPUInfo(static_cast<CPUFeature>(i)))
+      h.cpu_features |= 1 << i;
+  }
+
+  struct iovec part;
+  part.iov_base = &h;
+  part.iov_len = sizeof(h);
+  recorder_->Write(Recorder::kSession, &part, 1);
+
+  session::ConfigRecord c;
+  memset(&c, 0, sizeof(c));
+  c.low_latency = config_.low_latency;
+  c.fixed_ns = config_.fixed_ns;
+  c.post_filter = config_.post_filter;
+  c.gate_level = config_.gate_level;
+  c.render_rate = config_.render_rate;
+  c.chunk_size = chunk_size_;
+  c.cycles = cycles_;
+  c.overflow = config_.overflow;
+  part.iov_base = &c;
+  part.iov_len = sizeof(c);
+  LogRecord(session::kConfig, &part, 1);
+
+  // Midway through the call, start the replay from where the AEC is now
+  if (cycles_ == 0)
+    return;
+
+  int size;
+  char* state = CopyState(&size);
+  if (state == NULL)
+    return;
+  part.iov_base = state;
+  part.iov_len = size;
+  LogRecord(session::kState, &part, 1);
+  delete[] state;
+}
+
+
+// The WAV files and the session log lose a cycle each on their own, the
+// session log has its sequence numbers for the gaps
+void Channel::Record(const int16_t* far,
+                     const int16_t* near,
+                     const int16_t* out) {
+  bool wav = recorder_->WriteChunks(near,
+                                    far,
+                                    near != NULL ? out : NULL,
+                                    chunk_size_);
+  bool log = LogCycle(far, near, out);
+  if (!wav || !log)
+    counters_.record_dropped++;
+}
+
+
+bool Channel::LogCycle(const int16_t* far,
+                       const int16_t* near,
+                       const int16_t* out) {
+  size_t chunk = sizeof(*far) * chunk_size_;
+  struct iovec parts[kMaxLogParts];
+  int count = 0;
+
+  // Delay and skew as passed in AEC()
+  session::CycleRecord r;
+  memset(&r, 0, sizeof(r));
+  r.sequence = cycles_;
+  r.has_far = far != NULL;
+  r.has_near = near != NULL;
+  r.delay = 0;
+  r.skew = 0;
+  parts[count].iov_base = &r;
+  parts[count++].iov_len = sizeof(r);
+
+  if (far != NULL) {
+    parts[count].iov_base = const_cast<int16_t*>(far);
+    parts[count++].iov_len = chunk;
+  }
+  if (near != NULL) {
+    parts[count].iov_base = const_cast<int16_t*>(near);
+    parts[count++].iov_len = chunk;
+    parts[count].iov_base = const_cast<int16_t*>(out);
+    parts[count++].iov_len = chunk;
+  }
+  return LogRecord(session::kCycle, parts, count);
+}
+
+
+// Header, payload and padding go into the ring together or not at all, the
+// replay finds the gap from the sequence numbers
+bool Channel::LogRecord(uint32_t type,
+                        const struct iovec* parts,
+                        int count) {
+  static const char kPadding[session::kAlignment] = { 0 };
+  struct iovec all[kMaxLogParts + 2];
+  session::RecordHeader h;
+
+  ASSERT(count <= kMaxLogParts, "Too many parts");
+  h.type = type;
+  h.size = 0;
+  h.timestamp = uv_hrtime() - recording_start_;
+  all[0].iov_base = &h;
+  all[0].iov_len = sizeof(h);
+  for (int i = 0; i < count; i++) {
+    all[i + 1] = parts[i];
+    h.size += parts[i].iov_len;
+  }
+  all[count + 1].iov_base = const_cast<char*>(kPadding);
+  all[count + 1].iov_len = session::Padded(h.size) - h.size;
+
+  return recorder_->Write(Recorder::kSession, all, count + 2);
 }
 
 }  // namespace audio
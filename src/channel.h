@@ -1,60 +1,223 @@
 #ifndef SRC_CHANNEL_H_
 #define SRC_CHANNEL_H_
 
+#include "aec/include/echo_cancellation.h"
 #include "ns/include/noise_suppression.h"
+#include "ns/include/noise_suppression_x.h"
 #include "pa_ringbuffer.h"
+#include "signal_processing/include/signal_processing_library.h"
+#include "uv.h"
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 namespace audio {
 
 // Forward declaration
-class Unit;
+class Recorder;
 
 class Channel {
  public:
+  // Format of the audio the stages run on, the devices are resampled to it
+  static const int kSampleRate = 16000;
+  static const int kSampleSize = sizeof(int16_t);
+  static const int kChunkSize = 160;
+  // One 64 sample AEC partition per band, see Cycle()
+  static const int kLowLatencyChunkSize = 128;
+
+  // What Cycle() does with a processed chunk when |io_.in| is full, i.e.
+  // when the event loop does not keep up
+  enum Overflow {
+    kDropNewest,
+    kDropOldest,
+    // Holds the cycle back, near and far end, until there is room. The device
+    // callbacks can not wait, so the audio backs up into |aec_.in| and
+    // |aec_.out| and is lost only when those are full too.
+    kBlock
+  };
+
+  // Per-unit settings, see Unit::Options
+  struct Config {
+    Config() : low_latency(false),
+               fixed_ns(false),
+               post_filter(false),
+               gate_level(0),
+               render_rate(kSampleRate),
+               overflow(kDropNewest) {}
+
+    bool low_latency;
+    bool fixed_ns;
+    bool post_filter;
+    int gate_level;
+    // Playback device rate, only used by the AEC to track the clock drift
+    int render_rate;
+    Overflow overflow;
+  };
+
   Channel();
   ~Channel();
 
-  void Init(Unit* unit);
+  void Init(const Config& config);
+
+  // Processes a chunk of the near end if |avail_in| holds one and a chunk of
+  // the far end if |avail_out| does. Returns false if it took neither.
+  bool Cycle(ring_buffer_size_t avail_in, ring_buffer_size_t avail_out);
+
+  struct Metrics {
+    AecMetrics aec;
+    int delay_median;  // in ms, -1 if unknown
+    int delay_std;  // in ms, -1 if unknown
+    int gated;  // chunks gated since the start, see Cycle()
+  };
+
+  // Returns the latest metrics published by the AEC thread. Should be called
+  // only from the event loop.
+  const Metrics* GetMetrics();
+
+  // Per-chunk decisions of the DSP stages. Stages that did not run for the
+  // chunk leave their fields at -1.
+  struct Event {
+    int vad;  // AGC voice activity on the microphone signal, 0 or 1
+    int vad_ratio;  // log(P(speech) / P(non-speech)) of the AGC VAD, in Q10
+    float speech_probability;  // NS, averaged over frequency
+    int echo;  // AEC echo status, 0 or 1
+    int saturated;  // AGC saturation warning, 0 or 1
+  };
+
+  // Reads the decisions for the chunk that was just read from |io_.in|. Should
+  // be called only from the event loop, once per chunk.
+  bool ReadEvent(Event* event);
+
+  // Reads the next processed chunk from |io_.in| and its decisions, safe
+  // against kDropOldest. Returns false if there is none. Should be called
+  // only from the event loop.
+  bool Read(int16_t* out, Event* event);
+
+  // Serializes the converged AEC state, so that a later call in the same room
+  // can start warm. Returns NULL on failure, the caller owns the result.
+  char* SaveState(int* size);
+
+  // Restores a state returned by SaveState(). Works only before the AEC has
+  // processed any audio, i.e. before the unit is started.
+  bool RestoreState(const char* state, int size);
 
-  void Cycle(ring_buffer_size_t avail_in, ring_buffer_size_t avail_out);
+  // Copies the near end, the far end and the output of every chunk into
+  // |prefix|-near.wav, |prefix|-far.wav and |prefix|-output.wav, see
+  // Recorder, and logs the cycles for bench/replay.cc into
+  // |prefix|-session.log, see session-log.h. Returns false if already
+  // recording or a file can not be created. Should be called only from the
+  // event loop.
+  bool StartRecording(const char* prefix);
+  void StopRecording();
 
   // IO
   struct {
     PaUtilRingBuffer in;
     PaUtilRingBuffer out;
     void* handle;
+    uv_mutex_t lock;  // guards |handle| between AEC thread and event loop
   } aec_;
   struct {
     PaUtilRingBuffer in;
     PaUtilRingBuffer out;
+    uv_mutex_t lock;  // guards the read side of |in|, see Read()
   } io_;
 
+  // Audio lost on the way, each written by one thread and read by the event
+  // loop
+  struct {
+    volatile int capture_overrun;  // device samples |aec_.in| had no room for
+    volatile int render_overrun;  // playback samples |aec_.out| had no room for
+    volatile int dropped;  // chunks |io_.in| had no room for, see Overflow
+    volatile int blocked;  // cycles held back by kBlock
+    // Cycles the recording lost some of, because the writer thread of the
+    // Recorder fell behind
+    volatile int record_dropped;
+  } counters_;
+
  protected:
   static const int kBufferCapacity = 16 * 1024;  // in samples
+  static const int kMetricsCapacity = 4;  // in snapshots
+  static const int kMetricsInterval = 100;  // in chunks
+  // One per chunk in |io_.in|, even with kLowLatencyChunkSize
+  static const int kEventCapacity = 128;  // in events
+  // Quiet chunks in a row before the gate closes, so that the tail of a word
+  // and short pauses still go through the whole chain
+  static const int kGateHangover = 30;  // in chunks
 
   void AEC(int16_t* lo, int16_t* hi, size_t len);
   void PreAGC(int16_t* lo, int16_t* hi, size_t len);
   void PostAGC(int16_t* lo, int16_t* hi, size_t len);
   void NS(int16_t* lo, int16_t* hi);
+  bool Gate(const int16_t* buf);
+  void Idle(int16_t* lo, int16_t* hi, size_t len);
+  void PublishMetrics();
+  bool Reserve();
+  char* CopyState(int* size);
+
+  // Session log, only with |recorder_| and under |aec_.lock|
+  static const int kMaxLogParts = 4;
+  void StartSessionLog();
+  void Record(const int16_t* far, const int16_t* near, const int16_t* out);
+  bool LogCycle(const int16_t* far, const int16_t* near, const int16_t* out);
+  bool LogRecord(uint32_t type, const struct iovec* parts, int count);
 
   // AEC
   struct {
-    int32_t a_lo[6];
-    int32_t a_hi[6];
+    // Near end in channel kNear, far end in kFar, split together
+    QMFState analysis;
     int32_t s_lo[6];
     int32_t s_hi[6];
   } filters_;
+  enum { kNear = 0, kFar = 1 };
   bool has_echo_;
 
+  // Low latency mode: the AEC is fed whole partitions of |chunk_size_|
+  // samples without regrouping them into 10 ms frames. NS and AGC only work
+  // on 10 ms frames and are skipped.
+  bool low_latency_;
+  ring_buffer_size_t chunk_size_;
+  Overflow overflow_;
+
   // AGC
   void* agc_;
   int32_t agc_level_;
 
-  // NS
+  // NS, only one of these is created depending on Config::fixed_ns, and none
+  // when the AEC post-filter suppresses the noise, see Config::post_filter
+  bool post_filter_;
   NsHandle* ns_;
+  NsxHandle* nsx_;
+
+  // Gate: chunks with a mean square below |threshold| are only used to keep
+  // the AEC far end and the NS noise estimate going, the output is silence.
+  // See Config::gate_level
+  struct {
+    int64_t threshold;  // 0 if disabled
+    int quiet;  // quiet chunks in a row
+    int count;  // gated chunks
+  } gate_;
+
+  // Metrics
+  struct {
+    PaUtilRingBuffer ring;
+    Metrics last;
+    int chunks;
+  } metrics_;
+
+  // Events, filled in by the stages while a chunk is processed
+  struct {
+    PaUtilRingBuffer ring;
+    Event current;
+  } events_;
+
+  Config config_;
+  uint32_t cycles_;  // that had a chunk, since Init()
+
+  // Recording tap, NULL unless recording. Guarded by |aec_.lock|
+  Recorder* recorder_;
+  uint64_t recording_start_;  // uv_hrtime()
 };
 
 } // namespace audio
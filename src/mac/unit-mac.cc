@@ -1,5 +1,6 @@
 #include "unit-mac.h"
 #include "common.h"
+#include "trace.h"
 
 #include <assert.h>
 #include <math.h>
@@ -14,7 +15,9 @@ AudioDeviceID PlatformUnit::plugin_ = kAudioObjectUnknown;
 AudioDeviceID PlatformUnit::aggregate_ = kAudioObjectUnknown;
 
 
-PlatformUnit::PlatformUnit() : in_channels_(0), out_channels_(0) {
+PlatformUnit::PlatformUnit(const Options& options) : Unit(options),
+                                                     in_channels_(0),
+                                                     out_channels_(0) {
   // Find Remote IO audio component
   AudioComponentDescription desc;
 
@@ -82,8 +85,9 @@ PlatformUnit::PlatformUnit() : in_channels_(0), out_channels_(0) {
     else
       out_channels_ = desc.mChannelsPerFrame;
 
-    // Set the rest of format
-    desc.mSampleRate = kSampleRate;
+    // Set the rest of format, at the device's own rate, Unit resamples it
+    Side side = scopes[i] == kAudioUnitScope_Input ? kInput : kOutput;
+    desc.mSampleRate = GetHWSampleRate(side);
     desc.mFormatID = kAudioFormatLinearPCM;
     desc.mFormatFlags = kAudioFormatFlagsNativeEndian |
                         kAudioFormatFlagIsSignedInteger |
@@ -104,7 +108,7 @@ PlatformUnit::PlatformUnit() : in_channels_(0), out_channels_(0) {
     OSERR_CHECK(err, "Failed to set input/output format");
 
     // Set buffer size
-    UInt32 chunk_size = kChunkSize;
+    UInt32 chunk_size = GetHWChunkSize(side);
     err = AudioUnitSetProperty(unit_,
                                kAudioDevicePropertyBufferFrameSize,
                                scopes[i],
@@ -114,9 +118,6 @@ PlatformUnit::PlatformUnit() : in_channels_(0), out_channels_(0) {
     OSERR_CHECK(err, "Failed to set buffer frame size");
   }
 
-  // Set HW Sample rate
-  SetHWSampleRate(kInput, kSampleRate);
-
   // Set callbacks
   AURenderCallbackStruct cb;
 
@@ -199,12 +200,13 @@ AudioBufferList* PlatformUnit::AllocateBuffer(Unit::Side side) {
       reinterpret_cast<AudioBufferList*>(new char[buffer_size]);
   res->mNumberBuffers = channels;
 
+  UInt32 frames = GetHWChunkSize(side);
   for (size_t i = 0; i < channels; i++) {
-    int16_t* data = new int16_t[kChunkSize];
+    int16_t* data = new int16_t[frames];
 
     res->mBuffers[i].mNumberChannels = 1;
     res->mBuffers[i].mData = data;
-    res->mBuffers[i].mDataByteSize = sizeof(*data) * kChunkSize;
+    res->mBuffers[i].mDataByteSize = sizeof(*data) * frames;
   }
 
   return res;
@@ -229,6 +231,9 @@ OSStatus PlatformUnit::InputCallback(void* arg,
                                      AudioBufferList* list) {
   PlatformUnit* unit = reinterpret_cast<PlatformUnit*>(arg);
 
+  Trace::SetThreadName("input");
+  TraceScope trace("InputCallback");
+
   OSStatus err = AudioUnitRender(unit->unit_,
                                  flags,
                                  ts,
@@ -260,6 +265,9 @@ OSStatus PlatformUnit::RenderCallback(void* arg,
   PlatformUnit* unit = reinterpret_cast<PlatformUnit*>(arg);
   UInt32 i;
 
+  Trace::SetThreadName("render");
+  TraceScope trace("RenderCallback");
+
   for (i = 0; i < list->mNumberBuffers; i++) {
     AudioBuffer* buf = &list->mBuffers[i];
 
@@ -299,22 +307,9 @@ double PlatformUnit::GetHWSampleRate(Unit::Side side) {
 }
 
 
-void PlatformUnit::SetHWSampleRate(Unit::Side side, double sample_rate) {
-  static AudioObjectPropertyAddress addr = {
-    kAudioDevicePropertyNominalSampleRate,
-    kAudioObjectPropertyScopeGlobal,
-    kAudioObjectPropertyElementMaster
-  };
-
-  Float64 rate = sample_rate;
-  UInt32 size = sizeof(rate);
-  OSStatus err = AudioObjectSetPropertyData(GetDevice(side),
-                                            &addr,
-                                            0,
-                                            NULL,
-                                            size,
-                                            &rate);
-  OSERR_CHECK(err, "Failed to set device's sample rate");
+UInt32 PlatformUnit::GetHWChunkSize(Unit::Side side) {
+  return static_cast<UInt32>(
+      ceil(chunk_size() * GetHWSampleRate(side) / kSampleRate));
 }
 
 
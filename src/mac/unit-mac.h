@@ -11,7 +11,7 @@ namespace audio {
 
 class PlatformUnit : public Unit {
  public:
-  PlatformUnit();
+  explicit PlatformUnit(const Options& options);
   ~PlatformUnit();
 
   void Start();
@@ -25,7 +25,7 @@ class PlatformUnit : public Unit {
   static AudioDeviceID GetPlugin();
   static CFMutableDictionaryRef GetAggregateDictionary();
   static CFStringRef GetDeviceUID(AudioDeviceID device);
-  static void SetHWSampleRate(Side side, double sample_rate);
+  UInt32 GetHWChunkSize(Side side);
   static void AddSubdevices(AudioDeviceID aggr,
                             AudioDeviceID in,
                             AudioDeviceID out);
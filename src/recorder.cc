@@ -0,0 +1,239 @@
+#include "recorder.h"
+#include "common.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace audio {
+
+static const char* const kSuffixes[] = {
+  "near.wav", "far.wav", "output.wav", "session.log"
+};
+
+
+Recorder::Recorder() : sample_rate_(0), stopping_(false) {
+  for (size_t i = 0; i < ARRAY_SIZE(files_); i++) {
+    int capacity = i == kSession ? kSessionCapacity : kWavCapacity;
+    files_[i].data = new char[capacity];
+    files_[i].fd = -1;
+    files_[i].header_size = i == kSession ? 0 : kHeaderSize;
+    files_[i].size = 0;
+    PaUtil_InitializeRingBuffer(&files_[i].ring,
+                                1,
+                                capacity,
+                                files_[i].data);
+  }
+  ASSERT(0 == uv_mutex_init(&lock_), "uv_mutex_init");
+  ASSERT(0 == uv_cond_init(&cond_), "uv_cond_init");
+}
+
+
+Recorder::~Recorder() {
+  Stop();
+
+  uv_cond_destroy(&cond_);
+  uv_mutex_destroy(&lock_);
+  for (size_t i = 0; i < ARRAY_SIZE(files_); i++) {
+    delete[] files_[i].data;
+    files_[i].data = NULL;
+  }
+}
+
+
+bool Recorder::Start(const char* prefix, int sample_rate) {
+  sample_rate_ = sample_rate;
+
+  for (size_t i = 0; i < ARRAY_SIZE(files_); i++) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s-%s", prefix, kSuffixes[i]);
+
+    files_[i].fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (files_[i].fd == -1) {
+      for (size_t j = 0; j < i; j++) {
+        close(files_[j].fd);
+        files_[j].fd = -1;
+      }
+      return false;
+    }
+    files_[i].size = 0;
+    PaUtil_FlushRingBuffer(&files_[i].ring);
+    WriteHeader(&files_[i]);
+  }
+
+  stopping_ = false;
+  ASSERT(0 == uv_thread_create(&thread_, WriterThread, this),
+         "uv_thread_create");
+  return true;
+}
+
+
+void Recorder::Stop() {
+  if (files_[0].fd == -1)
+    return;
+
+  uv_mutex_lock(&lock_);
+  stopping_ = true;
+  uv_cond_signal(&cond_);
+  uv_mutex_unlock(&lock_);
+  uv_thread_join(&thread_);
+
+  for (size_t i = 0; i < ARRAY_SIZE(files_); i++) {
+    close(files_[i].fd);
+    files_[i].fd = -1;
+  }
+}
+
+
+bool Recorder::Write(Stream stream, const struct iovec* parts, int count) {
+  PaUtilRingBuffer* ring = &files_[stream].ring;
+  ring_buffer_size_t size = 0;
+
+  for (int i = 0; i < count; i++)
+    size += parts[i].iov_len;
+  if (PaUtil_GetRingBufferWriteAvailable(ring) < size) {
+    Trace::Instant("RecorderOverflow");
+    return false;
+  }
+
+  // Single producer, the space can only grow until the last part is in
+  for (int i = 0; i < count; i++) {
+    PaUtil_WriteRingBuffer(ring,
+                           parts[i].iov_base,
+                           static_cast<ring_buffer_size_t>(parts[i].iov_len));
+  }
+  return true;
+}
+
+
+bool Recorder::WriteChunks(const int16_t* near,
+                           const int16_t* far,
+                           const int16_t* output,
+                           ring_buffer_size_t n) {
+  const int16_t* chunks[] = { near, far, output };
+  ring_buffer_size_t size = n * sizeof(*near);
+
+  for (size_t i = 0; i < ARRAY_SIZE(chunks); i++) {
+    if (chunks[i] != NULL &&
+        PaUtil_GetRingBufferWriteAvailable(&files_[i].ring) < size) {
+      Trace::Instant("RecorderOverflow");
+      return false;
+    }
+  }
+
+  // Single producer, the space can only grow until the last chunk is in
+  for (size_t i = 0; i < ARRAY_SIZE(chunks); i++) {
+    if (chunks[i] != NULL)
+      PaUtil_WriteRingBuffer(&files_[i].ring, chunks[i], size);
+  }
+  return true;
+}
+
+
+void Recorder::WriterThread(void* arg) {
+  Recorder* r = reinterpret_cast<Recorder*>(arg);
+
+  Trace::SetThreadName("recorder");
+  uv_mutex_lock(&r->lock_);
+  while (true) {
+    bool stopping = r->stopping_;
+    if (!stopping)
+      uv_cond_timedwait(&r->cond_, &r->lock_, kWriteInterval);
+    uv_mutex_unlock(&r->lock_);
+
+    // One more pass after the stop, for what the AEC thread wrote last
+    for (size_t i = 0; i < ARRAY_SIZE(r->files_); i++)
+      r->Drain(&r->files_[i]);
+
+    uv_mutex_lock(&r->lock_);
+    if (stopping)
+      break;
+  }
+  uv_mutex_unlock(&r->lock_);
+  Trace::ReleaseThread();
+}
+
+
+void Recorder::Drain(File* f) {
+  TraceScope trace("RecorderDrain");
+  ring_buffer_size_t avail = PaUtil_GetRingBufferReadAvailable(&f->ring);
+  if (avail == 0)
+    return;
+
+  // At most two regions, the second one only when the data wraps around
+  void* data[2];
+  ring_buffer_size_t size[2];
+  PaUtil_GetRingBufferReadRegions(&f->ring,
+                                  avail,
+                                  &data[0],
+                                  &size[0],
+                                  &data[1],
+                                  &size[1]);
+  ring_buffer_size_t written = 0;
+  for (size_t i = 0; i < ARRAY_SIZE(data); i++) {
+    size_t len = size[i];
+    char* p = reinterpret_cast<char*>(data[i]);
+
+    while (len > 0) {
+      ssize_t n = pwrite(f->fd, p, len, f->header_size + f->size);
+      if (n <= 0)
+        break;
+      p += n;
+      len -= n;
+      f->size += n;
+      written += n;
+    }
+
+    // A full disk or some such, the rest stays in the ring for the next
+    // pass. Meanwhile the ring fills up and the writes to it are dropped.
+    if (len > 0)
+      break;
+  }
+  PaUtil_AdvanceRingBufferReadIndex(&f->ring, written);
+
+  WriteHeader(f);
+}
+
+
+static void Put16(unsigned char* p, uint32_t v) {
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+}
+
+
+static void Put32(unsigned char* p, uint32_t v) {
+  Put16(p, v & 0xffff);
+  Put16(p + 2, v >> 16);
+}
+
+
+void Recorder::WriteHeader(File* f) {
+  unsigned char h[kHeaderSize];
+
+  // The session log has a header of its own, in the data
+  if (f->header_size == 0)
+    return;
+
+  uint32_t size = static_cast<uint32_t>(f->size);
+
+  memcpy(h, "RIFF", 4);
+  Put32(h + 4, 36 + size);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  Put32(h + 16, 16);  // fmt chunk size
+  Put16(h + 20, 1);  // PCM
+  Put16(h + 22, 1);  // mono
+  Put32(h + 24, sample_rate_);
+  Put32(h + 28, sample_rate_ * sizeof(int16_t));
+  Put16(h + 32, sizeof(int16_t));
+  Put16(h + 34, 16);
+  memcpy(h + 36, "data", 4);
+  Put32(h + 40, size);
+
+  // Samples past a failed header update are still in the file, most players
+  // stop at the size in the header though
+  if (pwrite(f->fd, h, sizeof(h), 0) != sizeof(h))
+    return;
+}
+
+}  // namespace audio
@@ -0,0 +1,87 @@
+#ifndef SRC_RECORDER_H_
+#define SRC_RECORDER_H_
+
+#include "pa_ringbuffer.h"
+#include "trace.h"
+#include "uv.h"
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace audio {
+
+// Recording tap of a Channel: the near end as captured, the far end as fed
+// to the AEC and the processed output, each into a 16-bit mono WAV file, and
+// the session log, see session-log.h.
+//
+// Write() only copies into a ring, on the AEC thread. A writer thread drains
+// the rings every kWriteInterval with one positioned write per contiguous
+// region, straight from the ring memory, and keeps the WAV headers up to
+// date so that the files stay playable if the process dies.
+class Recorder {
+ public:
+  enum Stream {
+    kNear,
+    kFar,
+    kOutput,
+    kSession,
+    kStreamCount
+  };
+
+  Recorder();
+  ~Recorder();
+
+  // Creates |prefix|-near.wav, |prefix|-far.wav, |prefix|-output.wav and
+  // |prefix|-session.log and starts the writer thread. Returns false if a
+  // file can not be created.
+  bool Start(const char* prefix, int sample_rate);
+
+  // Writes out what is left and closes the files
+  void Stop();
+
+  // Never blocks: writes all of |parts|, or none of them and marks the trace
+  // if they do not fit into the ring
+  bool Write(Stream stream, const struct iovec* parts, int count);
+
+  // Never blocks: writes |n| samples of each of |near|, |far| and |output|
+  // that is not NULL into its WAV file, or none of them if one does not fit,
+  // so that the files stay aligned
+  bool WriteChunks(const int16_t* near,
+                   const int16_t* far,
+                   const int16_t* output,
+                   ring_buffer_size_t n);
+
+ private:
+  // In bytes, a power of two. 8 s of samples for each WAV file, and 10 s of
+  // cycles with all three chunks for the session log.
+  static const int kWavCapacity = 256 * 1024;
+  static const int kSessionCapacity = 1024 * 1024;
+  static const uint64_t kWriteInterval = 500000000;  // in ns
+  static const int kHeaderSize = 44;
+
+  struct File {
+    PaUtilRingBuffer ring;
+    char* data;
+    int fd;
+    off_t header_size;  // kHeaderSize for WAV files, 0 for the session log
+    off_t size;  // written so far, after the header, in bytes
+  };
+
+  static void WriterThread(void* arg);
+  void Drain(File* f);
+  void WriteHeader(File* f);
+
+  File files_[kStreamCount];
+  int sample_rate_;
+
+  // Writer thread
+  uv_thread_t thread_;
+  uv_mutex_t lock_;
+  uv_cond_t cond_;
+  bool stopping_;
+};
+
+}  // namespace audio
+
+#endif  // SRC_RECORDER_H_
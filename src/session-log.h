@@ -0,0 +1,83 @@
+#ifndef SRC_SESSION_LOG_H_
+#define SRC_SESSION_LOG_H_
+
+#include <stdint.h>
+
+namespace audio {
+namespace session {
+
+// Binary log of everything Channel::Cycle() consumes, written next to the WAV
+// files of a recording, see Channel::StartRecording(), and read back by
+// bench/replay.cc. Host byte order, the hosts are all little endian.
+//
+// A FileHeader, then records: a RecordHeader and |size| bytes of payload,
+// padded with zeroes to a multiple of kAlignment so that every record can be
+// read in place from a mapping of the file.
+//
+// Started before the first chunk the log reproduces the output bit for bit on
+// the same dispatch path. Started later it begins with the AEC state, see
+// ConfigRecord::cycles, the NS and AGC still start cold.
+
+static const char kMagic[8] = { 'A', 'U', 'D', 'I', 'O', 'L', 'O', 'G' };
+static const uint32_t kVersion = 2;
+static const uint32_t kAlignment = 8;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t sample_rate;
+  // WebRtc_GetCPUInfo() of the recording process, a bit per CPUFeature
+  uint32_t cpu_features;
+  uint32_t reserved;
+};
+
+enum RecordType {
+  // ConfigRecord, once, right after the header
+  kConfig = 1,
+  // Channel::SaveState() blob, restored with Channel::RestoreState()
+  kState = 2,
+  // CycleRecord, then the far chunk, the near chunk and the output chunk of
+  // the cycle, the ones it had
+  kCycle = 3
+};
+
+struct RecordHeader {
+  uint32_t type;
+  uint32_t size;  // of the payload, without the padding
+  uint64_t timestamp;  // in ns since the start of the recording
+};
+
+// Channel::Config
+struct ConfigRecord {
+  int32_t low_latency;
+  int32_t fixed_ns;
+  int32_t post_filter;
+  int32_t gate_level;
+  int32_t render_rate;
+  int32_t chunk_size;  // in samples, of every chunk in the log
+  // Cycles the channel ran before the recording started, 0 for an exact log
+  uint32_t cycles;
+  int32_t overflow;  // Channel::Overflow
+};
+
+struct CycleRecord {
+  // Counts the cycles of the channel, a gap means that records were dropped
+  // because the writer thread fell behind
+  uint32_t sequence;
+  uint8_t has_far;
+  uint8_t has_near;  // and output
+  // Reported playout delay and clock skew as passed to the AEC, both 0 while
+  // it finds the delay from the signals and does not compensate for skew
+  int16_t delay;  // in ms
+  int32_t skew;
+  uint32_t reserved;
+};
+
+static inline uint32_t Padded(uint32_t size) {
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}  // namespace session
+}  // namespace audio
+
+#endif  // SRC_SESSION_LOG_H_
@@ -0,0 +1,264 @@
+#include "trace.h"
+#include "common.h"
+
+namespace audio {
+
+volatile bool Trace::enabled_ = false;
+__thread Trace::Buffer* Trace::current_ = NULL;
+__thread const char* Trace::thread_name_ = NULL;
+__thread bool Trace::over_limit_ = false;
+Trace::Buffer Trace::buffers_[kMaxThreads];
+int Trace::buffer_count_ = 0;
+int Trace::next_tid_ = 1;
+volatile int Trace::lost_threads_ = 0;
+int Trace::reported_lost_ = 0;
+uv_mutex_t Trace::register_lock_;
+bool Trace::initialized_ = false;
+FILE* Trace::file_ = NULL;
+bool Trace::first_ = true;
+uint64_t Trace::start_ = 0;
+uv_thread_t Trace::thread_;
+uv_mutex_t Trace::lock_;
+uv_cond_t Trace::cond_;
+bool Trace::stopping_ = false;
+
+
+bool Trace::Start(const char* path) {
+  if (file_ != NULL)
+    return false;
+
+  if (!initialized_) {
+    ASSERT(0 == uv_mutex_init(&register_lock_), "uv_mutex_init");
+    ASSERT(0 == uv_mutex_init(&lock_), "uv_mutex_init");
+    ASSERT(0 == uv_cond_init(&cond_), "uv_cond_init");
+    initialized_ = true;
+  }
+
+  file_ = fopen(path, "w");
+  if (file_ == NULL)
+    return false;
+
+  // The array may be left unterminated if the process dies, the viewers
+  // accept that
+  fputs("[\n", file_);
+  first_ = true;
+  start_ = uv_hrtime();
+
+  // Events left from the previous trace are older than |start_| and skipped,
+  // the names have to be in the new file too
+  uv_mutex_lock(&register_lock_);
+  for (int i = 0; i < buffer_count_; i++) {
+    buffers_[i].named = false;
+    buffers_[i].reported = buffers_[i].dropped;
+  }
+  reported_lost_ = lost_threads_;
+  uv_mutex_unlock(&register_lock_);
+
+  stopping_ = false;
+  ASSERT(0 == uv_thread_create(&thread_, FlushThread, NULL),
+         "uv_thread_create");
+  enabled_ = true;
+
+  return true;
+}
+
+
+void Trace::Stop() {
+  if (file_ == NULL)
+    return;
+
+  enabled_ = false;
+
+  uv_mutex_lock(&lock_);
+  stopping_ = true;
+  uv_cond_signal(&cond_);
+  uv_mutex_unlock(&lock_);
+  uv_thread_join(&thread_);
+
+  Flush();
+  fputs("\n]\n", file_);
+  fclose(file_);
+  file_ = NULL;
+}
+
+
+void Trace::SetThreadName(const char* name) {
+  thread_name_ = name;
+  if (current_ != NULL)
+    current_->thread_name = name;
+}
+
+
+void Trace::ReleaseThread() {
+  Buffer* buf = current_;
+
+  current_ = NULL;
+  over_limit_ = false;
+  if (buf == NULL)
+    return;
+
+  uv_mutex_lock(&register_lock_);
+  buf->released = true;
+  uv_mutex_unlock(&register_lock_);
+}
+
+
+void Trace::Record(const char* name, char phase) {
+  Buffer* buf = current_;
+  if (buf == NULL) {
+    if (over_limit_)
+      return;
+    buf = Register();
+    if (buf == NULL)
+      return;
+  }
+
+  Event ev;
+  ev.ts = uv_hrtime();
+  ev.name = name;
+  ev.phase = phase;
+  if (PaUtil_WriteRingBuffer(&buf->ring, &ev, 1) != 1)
+    buf->dropped++;
+}
+
+
+Trace::Buffer* Trace::Register() {
+  Buffer* buf = NULL;
+
+  uv_mutex_lock(&register_lock_);
+  for (int i = 0; i < buffer_count_; i++) {
+    if (buffers_[i].free) {
+      buf = &buffers_[i];
+      break;
+    }
+  }
+  if (buf == NULL && buffer_count_ < kMaxThreads) {
+    buf = &buffers_[buffer_count_];
+    PaUtil_InitializeRingBuffer(&buf->ring,
+                                sizeof(Event),
+                                kBufferCapacity,
+                                new char[sizeof(Event) * kBufferCapacity]);
+    buf->tid = next_tid_++;
+    buf->named = false;
+    buf->dropped = 0;
+    buf->reported = 0;
+    buffer_count_++;
+  }
+  if (buf != NULL) {
+    buf->thread_name = thread_name_;
+    buf->free = false;
+    buf->released = false;
+  } else {
+    lost_threads_++;
+  }
+  uv_mutex_unlock(&register_lock_);
+
+  current_ = buf;
+  over_limit_ = buf == NULL;
+  return buf;
+}
+
+
+void Trace::FlushThread(void* arg) {
+  uv_mutex_lock(&lock_);
+  while (!stopping_) {
+    uv_cond_timedwait(&cond_, &lock_, kFlushInterval);
+    if (stopping_)
+      break;
+
+    uv_mutex_unlock(&lock_);
+    Flush();
+    uv_mutex_lock(&lock_);
+  }
+  uv_mutex_unlock(&lock_);
+}
+
+
+void Trace::Flush() {
+  uv_mutex_lock(&register_lock_);
+  int count = buffer_count_;
+  uv_mutex_unlock(&register_lock_);
+
+  for (int i = 0; i < count; i++) {
+    Buffer* buf = &buffers_[i];
+    int tid = buf->tid;
+    const char* thread_name = buf->thread_name;
+
+    if (!buf->named && thread_name != NULL) {
+      fprintf(file_,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+              first_ ? "" : ",\n",
+              tid,
+              thread_name);
+      first_ = false;
+      buf->named = true;
+    }
+
+    Event ev;
+    while (PaUtil_ReadRingBuffer(&buf->ring, &ev, 1) == 1) {
+      if (ev.ts < start_)
+        continue;
+
+      fprintf(file_,
+              "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,"
+              "\"ts\":%.3f%s}",
+              first_ ? "" : ",\n",
+              ev.name,
+              ev.phase,
+              tid,
+              (ev.ts - start_) / 1e3,
+              ev.phase == 'i' ? ",\"s\":\"t\"" : "");
+      first_ = false;
+    }
+
+    // Begin and end events may be unpaired around the gap
+    int dropped = buf->dropped;
+    if (dropped != buf->reported) {
+      fprintf(file_,
+              "%s{\"name\":\"dropped\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,"
+              "\"ts\":%.3f,\"args\":{\"events\":%d}}",
+              first_ ? "" : ",\n",
+              tid,
+              (uv_hrtime() - start_) / 1e3,
+              dropped - buf->reported);
+      first_ = false;
+      buf->reported = dropped;
+    }
+
+    Free(buf);
+  }
+
+  // Threads that are missing from the trace
+  int lost = lost_threads_;
+  if (lost != reported_lost_) {
+    fprintf(file_,
+            "%s{\"name\":\"lost threads\",\"ph\":\"C\",\"pid\":1,"
+            "\"ts\":%.3f,\"args\":{\"threads\":%d}}",
+            first_ ? "" : ",\n",
+            (uv_hrtime() - start_) / 1e3,
+            lost);
+    first_ = false;
+    reported_lost_ = lost;
+  }
+  fflush(file_);
+}
+
+
+// Hands the buffer of an exited thread to the next one, once its events are
+// all in the file. The next thread gets a tid of its own.
+void Trace::Free(Buffer* buf) {
+  uv_mutex_lock(&register_lock_);
+  if (buf->released && PaUtil_GetRingBufferReadAvailable(&buf->ring) == 0) {
+    buf->thread_name = NULL;
+    buf->released = false;
+    buf->tid = next_tid_++;
+    buf->named = false;
+    buf->dropped = 0;
+    buf->reported = 0;
+    buf->free = true;
+  }
+  uv_mutex_unlock(&register_lock_);
+}
+
+}  // namespace audio
@@ -0,0 +1,131 @@
+#ifndef SRC_TRACE_H_
+#define SRC_TRACE_H_
+
+#include "pa_ringbuffer.h"
+#include "uv.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace audio {
+
+// Opt-in tracing of the device callbacks, the AEC thread and the event loop,
+// in the Chrome trace event format: the JSON file opens in chrome://tracing
+// and in the Perfetto UI.
+//
+// Every thread records into a ring of its own, which a background thread
+// drains to the file every kFlushInterval. Nothing is locked on the way,
+// except for the first event of a thread. When tracing is off an event costs
+// a load and a branch.
+//
+// There are kMaxThreads rings. Threads that exit give theirs back with
+// ReleaseThread(), threads that find none left are counted in the trace.
+class Trace {
+ public:
+  // Starts writing to |path|, returns false if it can not be opened or the
+  // trace is already running. Should be called only from the event loop.
+  static bool Start(const char* path);
+  // Writes out the remaining events and closes the file
+  static void Stop();
+
+  static inline bool enabled() { return enabled_; }
+
+  // Names the calling thread in the trace, cheap enough for every callback
+  static void SetThreadName(const char* name);
+
+  // Gives the ring of the calling thread back, should be called by threads
+  // that recorded events right before they exit. The events are still
+  // written out.
+  static void ReleaseThread();
+
+  // |name| has to be a string literal, only the pointer is recorded
+  static inline void Begin(const char* name) {
+    if (enabled_)
+      Record(name, 'B');
+  }
+  static inline void End(const char* name) {
+    if (enabled_)
+      Record(name, 'E');
+  }
+  static inline void Instant(const char* name) {
+    if (enabled_)
+      Record(name, 'i');
+  }
+
+ private:
+  static const int kMaxThreads = 16;
+  static const int kBufferCapacity = 8192;  // in events, per thread
+  static const uint64_t kFlushInterval = 100000000;  // in ns
+
+  struct Event {
+    uint64_t ts;  // uv_hrtime()
+    const char* name;
+    char phase;  // 'B'egin, 'E'nd or 'i'nstant
+  };
+
+  struct Buffer {
+    PaUtilRingBuffer ring;
+    const char* thread_name;
+    volatile int dropped;  // events that did not fit into |ring|
+
+    // Under |register_lock_|
+    bool free;  // can be claimed by a thread
+    bool released;  // the thread exited, free once |ring| is written out
+
+    // Only touched by the flush thread, and by Register() on a new buffer
+    int tid;  // in the trace, a new one for every thread
+    bool named;  // |thread_name| is in the file already
+    int reported;  // |dropped| in the file already
+  };
+
+  static void Record(const char* name, char phase);
+  static Buffer* Register();
+  static void Free(Buffer* buf);
+  static void FlushThread(void* arg);
+  static void Flush();
+
+  static volatile bool enabled_;
+
+  // Of the calling thread, NULL until its first event
+  static __thread Buffer* current_;
+  static __thread const char* thread_name_;
+  static __thread bool over_limit_;  // no buffer left for the thread
+
+  // Claimed by the threads in order, never released
+  static Buffer buffers_[kMaxThreads];
+  static int buffer_count_;
+  static int next_tid_;
+  static volatile int lost_threads_;  // found no buffer left
+  static int reported_lost_;  // |lost_threads_| in the file already
+  static uv_mutex_t register_lock_;
+  static bool initialized_;  // the locks
+
+  static FILE* file_;
+  static bool first_;  // no event in |file_| yet
+  static uint64_t start_;  // uv_hrtime() at Start(), the zero of the trace
+
+  // Flush thread
+  static uv_thread_t thread_;
+  static uv_mutex_t lock_;
+  static uv_cond_t cond_;
+  static bool stopping_;
+};
+
+// Begin and end events around the enclosing block
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name) : name_(name) {
+    Trace::Begin(name_);
+  }
+
+  ~TraceScope() {
+    Trace::End(name_);
+  }
+
+ private:
+  const char* name_;
+};
+
+}  // namespace audio
+
+#endif  // SRC_TRACE_H_
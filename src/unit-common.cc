@@ -5,15 +5,31 @@
 
 #include "common.h"
 #include "node_buffer.h"
+#include "trace.h"
 
 #include <assert.h>
+#include <string.h>
 
 using namespace node;
 using namespace v8;
 
 namespace audio {
 
-Unit::Unit() : on_incoming_(NULL), running_(false), destroying_(false) {
+Unit::Unit(const Options& options) : on_incoming_(NULL),
+                                     running_(false),
+                                     options_(options),
+                                     in_resampler_(NULL),
+                                     out_resampler_(NULL),
+                                     destroying_(false) {
+  for (size_t i = 0; i < ARRAY_SIZE(render_); i++) {
+    render_[i].data = NULL;
+    render_[i].offset = 0;
+    render_[i].avail = 0;
+  }
+  for (size_t i = 0; i < ARRAY_SIZE(paused_); i++) {
+    paused_[i] = false;
+    drain_[i] = false;
+  }
 }
 
 
@@ -25,8 +41,37 @@ void Unit::Init() {
   if (out_count > kChannelCount)
     out_count = kChannelCount;
 
+  // Let the devices run at their own rates
+  int in_rate = static_cast<int>(GetHWSampleRate(kInput));
+  int out_rate = static_cast<int>(GetHWSampleRate(kOutput));
+  ASSERT(in_rate >= kMinHWSampleRate && out_rate >= kMinHWSampleRate,
+         "Unsupported device sample rate");
+
+  Channel::Config config;
+  config.low_latency = low_latency();
+  config.fixed_ns = fixed_ns();
+  config.post_filter = post_filter();
+  config.gate_level = gate_level();
+  config.render_rate = out_rate;
+  config.overflow = overflow();
   for (size_t i = 0; i < ARRAY_SIZE(channels_); i++)
-    channels_[i].Init(this);
+    channels_[i].Init(config);
+
+  if (in_rate != kSampleRate) {
+    in_resampler_ =
+        WebRtcSpl_CreatePolyphaseResampler(in_rate, kSampleRate, kChannelCount);
+    ASSERT(in_resampler_ != NULL, "Failed to create input resampler");
+  }
+  if (out_rate != kSampleRate) {
+    out_resampler_ = WebRtcSpl_CreatePolyphaseResampler(kSampleRate,
+                                                        out_rate,
+                                                        kChannelCount);
+    ASSERT(out_resampler_ != NULL, "Failed to create output resampler");
+    for (size_t i = 0; i < ARRAY_SIZE(render_); i++) {
+      render_[i].data = new int16_t[
+          WebRtcSpl_PolyphaseOutLength(out_resampler_, kChunkSize)];
+    }
+  }
 
   // Initialize AEC thread
   ASSERT(0 == uv_sem_init(&aec_sem_, 0), "uv_sem_init");
@@ -52,6 +97,15 @@ Unit::~Unit() {
 
   uv_sem_destroy(&aec_sem_);
   uv_close(reinterpret_cast<uv_handle_t*>(aec_async_), CloseCb);
+
+  WebRtcSpl_FreePolyphaseResampler(in_resampler_);
+  in_resampler_ = NULL;
+  WebRtcSpl_FreePolyphaseResampler(out_resampler_);
+  out_resampler_ = NULL;
+  for (size_t i = 0; i < ARRAY_SIZE(render_); i++) {
+    delete[] render_[i].data;
+    render_[i].data = NULL;
+  }
 }
 
 
@@ -63,6 +117,13 @@ void Unit::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "start", Unit::Start);
   NODE_SET_PROTOTYPE_METHOD(tpl, "stop", Unit::Stop);
   NODE_SET_PROTOTYPE_METHOD(tpl, "play", Unit::Play);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "resume", Unit::Resume);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getCounters", Unit::GetCounters);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getMetrics", Unit::GetMetrics);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "saveState", Unit::SaveState);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "restoreState", Unit::RestoreState);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "record", Unit::Record);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "stopRecording", Unit::StopRecording);
 
   target->Set(String::NewSymbol("Unit"), tpl->GetFunction());
 }
@@ -71,7 +132,24 @@ void Unit::Initialize(Handle<Object> target) {
 Handle<Value> Unit::New(const Arguments &args) {
   HandleScope scope;
 
-  Unit* unit = new PlatformUnit();
+  Options options;
+  if (args[0]->IsObject()) {
+    Local<Object> obj = args[0]->ToObject();
+    options.low_latency =
+        obj->Get(String::NewSymbol("lowLatency"))->BooleanValue();
+    options.fixed_ns = obj->Get(String::NewSymbol("fixedNs"))->BooleanValue();
+    options.post_filter =
+        obj->Get(String::NewSymbol("postFilter"))->BooleanValue();
+    options.gate_level = obj->Get(String::NewSymbol("gate"))->Int32Value();
+
+    String::Utf8Value policy(obj->Get(String::NewSymbol("overflow")));
+    if (*policy != NULL && strcmp(*policy, "drop-oldest") == 0)
+      options.overflow = Channel::kDropOldest;
+    else if (*policy != NULL && strcmp(*policy, "block") == 0)
+      options.overflow = Channel::kBlock;
+  }
+
+  Unit* unit = new PlatformUnit(options);
   unit->Wrap(args.This());
 
   return scope.Close(args.This());
@@ -98,15 +176,218 @@ Handle<Value> Unit::Stop(const Arguments &args) {
 }
 
 
+bool Unit::ChannelArgument(Handle<Value> arg, size_t* channel) {
+  if (!arg->IsNumber()) {
+    ThrowException(Exception::TypeError(
+        String::New("Channel should be a number")));
+    return false;
+  }
+
+  int64_t index = arg->IntegerValue();
+  if (index < 0 || index >= kChannelCount) {
+    ThrowException(Exception::RangeError(
+        String::New("Channel out of range")));
+    return false;
+  }
+
+  *channel = static_cast<size_t>(index);
+  return true;
+}
+
+
+// play(channel, buffer), returns the number of bytes taken. If it is short
+// of the length, ondrain(channel) follows once there is room.
 Handle<Value> Unit::Play(const Arguments &args) {
   HandleScope scope;
   Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
 
-  size_t channel = args[0]->IntegerValue();
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  if (!Buffer::HasInstance(args[1])) {
+    return ThrowException(Exception::TypeError(
+        String::New("Data should be a Buffer")));
+  }
+
+  Channel* chan = &unit->channels_[channel];
+  ring_buffer_size_t size = Buffer::Length(args[1]) / kSampleSize;
+  ring_buffer_size_t written = PaUtil_WriteRingBuffer(&chan->io_.out,
+                                                      Buffer::Data(args[1]),
+                                                      size);
+  if (written < size)
+    unit->drain_[channel] = true;
+
+  return scope.Close(Integer::New(written * kSampleSize));
+}
+
+
+// resume(channel), after oninput returned false
+Handle<Value> Unit::Resume(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  if (unit->paused_[channel]) {
+    unit->paused_[channel] = false;
+
+    // Deliver what piled up in the meantime
+    uv_async_send(unit->aec_async_);
+  }
+
+  return scope.Close(Undefined());
+}
+
+
+Handle<Value> Unit::GetCounters(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
   Channel* chan = &unit->channels_[channel];
-  PaUtil_WriteRingBuffer(&chan->io_.out,
-                         Buffer::Data(args[1]),
-                         Buffer::Length(args[1]) / kSampleSize);
+
+  Local<Object> res = Object::New();
+  res->Set(String::NewSymbol("captureOverrun"),
+           Integer::New(chan->counters_.capture_overrun));
+  res->Set(String::NewSymbol("renderOverrun"),
+           Integer::New(chan->counters_.render_overrun));
+  res->Set(String::NewSymbol("dropped"),
+           Integer::New(chan->counters_.dropped));
+  res->Set(String::NewSymbol("blocked"),
+           Integer::New(chan->counters_.blocked));
+  res->Set(String::NewSymbol("recordDropped"),
+           Integer::New(chan->counters_.record_dropped));
+  res->Set(String::NewSymbol("inputQueued"),
+           Integer::New(PaUtil_GetRingBufferReadAvailable(&chan->io_.in) *
+                        kSampleSize));
+  res->Set(String::NewSymbol("outputQueued"),
+           Integer::New(PaUtil_GetRingBufferReadAvailable(&chan->io_.out) *
+                        kSampleSize));
+
+  return scope.Close(res);
+}
+
+
+// Fields of stages that did not run are null
+static Local<Object> EventToObject(const Channel::Event& event) {
+  Local<Object> res = Object::New();
+  Handle<Value> null = Null();
+  Handle<Value> vad = Boolean::New(event.vad == 1);
+  Handle<Value> vad_ratio = Number::New(event.vad_ratio / 1024.0);
+  Handle<Value> speech = Number::New(event.speech_probability);
+  Handle<Value> echo = Boolean::New(event.echo == 1);
+  Handle<Value> saturated = Boolean::New(event.saturated == 1);
+
+  res->Set(String::NewSymbol("vad"), event.vad < 0 ? null : vad);
+  res->Set(String::NewSymbol("vadRatio"), event.vad < 0 ? null : vad_ratio);
+  res->Set(String::NewSymbol("speechProbability"),
+           event.speech_probability < 0 ? null : speech);
+  res->Set(String::NewSymbol("echo"), event.echo < 0 ? null : echo);
+  res->Set(String::NewSymbol("saturated"),
+           event.saturated < 0 ? null : saturated);
+
+  return res;
+}
+
+
+static Local<Object> LevelToObject(const AecLevel& level) {
+  Local<Object> res = Object::New();
+
+  res->Set(String::NewSymbol("instant"), Integer::New(level.instant));
+  res->Set(String::NewSymbol("average"), Integer::New(level.average));
+  res->Set(String::NewSymbol("max"), Integer::New(level.max));
+  res->Set(String::NewSymbol("min"), Integer::New(level.min));
+
+  return res;
+}
+
+
+Handle<Value> Unit::GetMetrics(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  const Channel::Metrics* m = unit->channels_[channel].GetMetrics();
+
+  Local<Object> res = Object::New();
+  res->Set(String::NewSymbol("rerl"), LevelToObject(m->aec.rerl));
+  res->Set(String::NewSymbol("erl"), LevelToObject(m->aec.erl));
+  res->Set(String::NewSymbol("erle"), LevelToObject(m->aec.erle));
+  res->Set(String::NewSymbol("aNlp"), LevelToObject(m->aec.aNlp));
+  res->Set(String::NewSymbol("delayMedian"), Integer::New(m->delay_median));
+  res->Set(String::NewSymbol("delayStd"), Integer::New(m->delay_std));
+  res->Set(String::NewSymbol("gated"), Integer::New(m->gated));
+
+  return scope.Close(res);
+}
+
+
+Handle<Value> Unit::SaveState(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  int size;
+  char* state = unit->channels_[channel].SaveState(&size);
+  if (state == NULL)
+    return scope.Close(Null());
+
+  Buffer* raw = Buffer::New(state, size);
+  delete[] state;
+
+  return scope.Close(raw->handle_);
+}
+
+
+Handle<Value> Unit::RestoreState(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  if (!Buffer::HasInstance(args[1]))
+    return scope.Close(False());
+
+  bool ok = unit->channels_[channel].RestoreState(
+      Buffer::Data(args[1]),
+      static_cast<int>(Buffer::Length(args[1])));
+
+  return scope.Close(Boolean::New(ok));
+}
+
+
+// record(channel, prefix), see Channel::StartRecording()
+Handle<Value> Unit::Record(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  String::Utf8Value prefix(args[1]);
+  bool ok = *prefix != NULL &&
+            unit->channels_[channel].StartRecording(*prefix);
+
+  return scope.Close(Boolean::New(ok));
+}
+
+
+Handle<Value> Unit::StopRecording(const Arguments &args) {
+  HandleScope scope;
+  Unit* unit = ObjectWrap::Unwrap<Unit>(args.This());
+
+  size_t channel;
+  if (!ChannelArgument(args[0], &channel))
+    return scope.Close(Undefined());
+  unit->channels_[channel].StopRecording();
 
   return scope.Close(Undefined());
 }
@@ -114,15 +395,35 @@ Handle<Value> Unit::Play(const Arguments &args) {
 
 void Unit::CommitInput(size_t channel, const int16_t* in, size_t size) {
   Channel* chan = &channels_[channel];
+  ring_buffer_size_t written;
 
   // TODO(indutny): Support output/input channel count mismatch
-  // Already full, ignore
-  if (0 == PaUtil_WriteRingBuffer(&chan->aec_.in, in, size))
+  if (in_resampler_ == NULL) {
+    // Already full, ignore
+    written = PaUtil_WriteRingBuffer(&chan->aec_.in, in, size);
+    chan->counters_.capture_overrun += size - written;
     return;
+  }
+
+  int16_t buf[kResampleBlock * kSampleRate / kMinHWSampleRate + 1];
+  while (size > 0) {
+    int block = static_cast<int>(
+        size < static_cast<size_t>(kResampleBlock) ? size : kResampleBlock);
+    int len = WebRtcSpl_ResamplePolyphase(in_resampler_,
+                                          channel,
+                                          in,
+                                          block,
+                                          buf);
+    written = PaUtil_WriteRingBuffer(&chan->aec_.in, buf, len);
+    chan->counters_.capture_overrun += len - written;
+    in += block;
+    size -= block;
+  }
 }
 
 
 void Unit::FlushInput() {
+  Trace::Instant("FlushInput");
   uv_sem_post(&aec_sem_);
 }
 
@@ -130,41 +431,95 @@ void Unit::FlushInput() {
 void Unit::RenderOutput(size_t channel, int16_t* out, size_t size) {
   Channel* chan = &channels_[channel];
   ring_buffer_size_t avail;
-  avail = PaUtil_ReadRingBuffer(&chan->io_.out, out, size);
 
-  // Zero-ify rest
-  for (size_t i = avail; i < size; i++)
-    out[i] = 0;
+  if (out_resampler_ == NULL) {
+    avail = PaUtil_ReadRingBuffer(&chan->io_.out, out, size);
+
+    // Zero-ify rest
+    for (size_t i = avail; i < size; i++)
+      out[i] = 0;
 
-  // Notify AEC thread about write
-  PaUtil_WriteRingBuffer(&chan->aec_.out, out, size);
+    // Notify AEC thread about write
+    avail = PaUtil_WriteRingBuffer(&chan->aec_.out, out, size);
+    chan->counters_.render_overrun += size - avail;
+    return;
+  }
+
+  // Take the playback a chunk at a time, the AEC gets it before resampling
+  int16_t* data = render_[channel].data;
+  size_t& offset = render_[channel].offset;
+  size_t& pending = render_[channel].avail;
+  while (size > 0) {
+    if (pending == 0) {
+      int16_t buf[kChunkSize];
+      ring_buffer_size_t chunk = chunk_size();
+
+      avail = PaUtil_ReadRingBuffer(&chan->io_.out, buf, chunk);
+      for (ring_buffer_size_t i = avail; i < chunk; i++)
+        buf[i] = 0;
+      avail = PaUtil_WriteRingBuffer(&chan->aec_.out, buf, chunk);
+      chan->counters_.render_overrun += chunk - avail;
+
+      pending = WebRtcSpl_ResamplePolyphase(out_resampler_,
+                                            channel,
+                                            buf,
+                                            chunk,
+                                            data);
+      offset = 0;
+    }
+
+    size_t len = size < pending ? size : pending;
+    memcpy(out, data + offset, len * kSampleSize);
+    offset += len;
+    pending -= len;
+    out += len;
+    size -= len;
+  }
 }
 
 
 void Unit::AECThread(void* arg) {
   Unit* unit = reinterpret_cast<Unit*>(arg);
 
+  Trace::SetThreadName("aec");
   while (true) {
     uv_sem_wait(&unit->aec_sem_);
+    Trace::Instant("Wake");
 
     if (unit->destroying_)
       break;
 
     unit->DoAEC();
   }
+  Trace::ReleaseThread();
 }
 
 
 void Unit::DoAEC() {
+  TraceScope trace("DoAEC");
   Channel* last_in = &channels_[GetChannelCount(kInput) - 1];
   Channel* last_out = &channels_[GetChannelCount(kOutput) - 1];
-  ring_buffer_size_t avail_in =
-      PaUtil_GetRingBufferReadAvailable(&last_in->aec_.out);
-  ring_buffer_size_t avail_out =
-      PaUtil_GetRingBufferReadAvailable(&last_out->aec_.out);
+  ring_buffer_size_t chunk = chunk_size();
+
+  // One cycle per capture callback, and more while both ends still hold a
+  // chunk: a device buffer holds a bit more than one when its rate is not a
+  // multiple of kSampleRate, or when the device did not grant the requested
+  // size, see PlatformUnit::GetHWChunkSize()
+  for (bool first = true; ; first = false) {
+    ring_buffer_size_t avail_in =
+        PaUtil_GetRingBufferReadAvailable(&last_in->aec_.in);
+    ring_buffer_size_t avail_out =
+        PaUtil_GetRingBufferReadAvailable(&last_out->aec_.out);
+    if (!first && (avail_in < chunk || avail_out < chunk))
+      break;
 
-  for (size_t i = 0; i < kChannelCount; i++)
-    channels_[i].Cycle(avail_in, avail_out);
+    // Held back by Channel::kBlock, see CatchUp()
+    bool progress = false;
+    for (size_t i = 0; i < kChannelCount; i++)
+      progress |= channels_[i].Cycle(avail_in, avail_out);
+    if (!progress)
+      break;
+  }
 
   // Communicate back to the event loop
   uv_async_send(aec_async_);
@@ -178,24 +533,83 @@ void Unit::AsyncCb(uv_async_t* handle, int status) {
   HandleScope scope;
   Unit* unit = reinterpret_cast<Unit*>(handle->data);
 
-  size_t channels = unit->GetChannelCount(kInput);
+  Trace::SetThreadName("loop");
+  TraceScope trace("AsyncCb");
+
+  unit->DeliverInput();
+  unit->NotifyDrain();
+  unit->CatchUp();
+}
+
+
+// A chunk of every channel in turn, until they are empty or paused. oninput
+// returning false pauses its channel until resume(), the chunks wait in
+// |io_.in| meanwhile, see Channel::Overflow.
+void Unit::DeliverInput() {
+  size_t channels = GetChannelCount(kInput);
   int16_t buf[kChunkSize];
+  ring_buffer_size_t chunk = chunk_size();
 
-  Channel* last = &unit->channels_[channels - 1];
-  while (PaUtil_GetRingBufferReadAvailable(&last->io_.in) > 0) {
+  bool more = true;
+  while (more) {
+    more = false;
     for (size_t i = 0; i < channels; i++) {
-      ring_buffer_size_t avail;
-      Channel* chan = &unit->channels_[i];
+      Channel* chan = &channels_[i];
+      Channel::Event event;
 
-      avail = PaUtil_ReadRingBuffer(&chan->io_.in, buf, ARRAY_SIZE(buf));
-      ASSERT(avail == ARRAY_SIZE(buf), "Read less than expected");
+      if (paused_[i] || !chan->Read(buf, &event))
+        continue;
+      more = true;
 
-      Buffer* raw = Buffer::New(reinterpret_cast<char*>(buf), sizeof(buf));
+      Buffer* raw = Buffer::New(reinterpret_cast<char*>(buf),
+                                chunk * kSampleSize);
       Local<Value> buf = Local<Value>::New(raw->handle_);
 
-      Local<Value> argv[] = { Integer::New(i), buf };
-      MakeCallback(unit->handle_, "oninput", ARRAY_SIZE(argv), argv);
+      Local<Value> argv[] = { Integer::New(i), buf, EventToObject(event) };
+      TraceScope trace("oninput");
+      Handle<Value> res =
+          MakeCallback(handle_, "oninput", ARRAY_SIZE(argv), argv);
+      if (!res.IsEmpty() && res->IsFalse())
+        paused_[i] = true;
+    }
+  }
+}
+
+
+void Unit::NotifyDrain() {
+  ring_buffer_size_t chunk = chunk_size();
+
+  for (size_t i = 0; i < ARRAY_SIZE(drain_); i++) {
+    Channel* chan = &channels_[i];
+    if (!drain_[i] ||
+        PaUtil_GetRingBufferWriteAvailable(&chan->io_.out) < chunk) {
+      continue;
     }
+    drain_[i] = false;
+
+    // Callers that ignore what play() returns may not have one
+    if (!handle_->Get(String::NewSymbol("ondrain"))->IsFunction())
+      continue;
+
+    Local<Value> argv[] = { Integer::New(i) };
+    MakeCallback(handle_, "ondrain", ARRAY_SIZE(argv), argv);
+  }
+}
+
+
+// The AEC thread runs a cycle per capture callback. Once Channel::kBlock has
+// held cycles back, it takes extra ones to work off the backlog. Only posted
+// when the next cycle takes a near chunk, see Channel::Cycle(), so that the
+// AEC thread and the event loop do not wake each other up for nothing.
+void Unit::CatchUp() {
+  if (overflow() != Channel::kBlock)
+    return;
+
+  ring_buffer_size_t chunk = chunk_size();
+  Channel* last_in = &channels_[GetChannelCount(kInput) - 1];
+  if (PaUtil_GetRingBufferReadAvailable(&last_in->aec_.in) >= chunk &&
+      PaUtil_GetRingBufferWriteAvailable(&last_in->io_.in) >= chunk) {
+    uv_sem_post(&aec_sem_);
   }
 }
 
@@ -20,7 +20,29 @@ class Unit : public node::ObjectWrap {
 
   typedef void (*IncomingCallback)(const unsigned char* data, size_t size);
 
-  Unit();
+  // Set from the JS options object, see Unit::New()
+  struct Options {
+    Options() : low_latency(false),
+                fixed_ns(false),
+                post_filter(false),
+                gate_level(0),
+                overflow(Channel::kDropNewest) {}
+
+    bool low_latency;
+    // Fixed-point noise suppression (NSX) instead of the float one
+    bool fixed_ns;
+    // Noise suppression inside the AEC, on its error spectrum, instead of a
+    // separate NS stage. Takes precedence over |fixed_ns|.
+    bool post_filter;
+    // Capture level, in dBFS, below which the chunks are gated, see
+    // Channel::Cycle(). 0 disables the gate.
+    int gate_level;
+    // What happens to the capture when the event loop falls behind,
+    // "drop-newest", "drop-oldest" or "block", see Channel::Overflow
+    Channel::Overflow overflow;
+  };
+
+  explicit Unit(const Options& options);
   virtual ~Unit();
   void Init();
 
@@ -32,18 +54,41 @@ class Unit : public node::ObjectWrap {
   static void Initialize(v8::Handle<v8::Object> target);
 
   inline void on_incoming(IncomingCallback cb) { on_incoming_ = cb; }
-
-  static const int kSampleRate = 16000;
-  static const int kSampleSize = sizeof(int16_t);
-  static const int kChunkSize = 160;
+  inline bool low_latency() const { return options_.low_latency; }
+  inline bool fixed_ns() const { return options_.fixed_ns; }
+  inline bool post_filter() const { return options_.post_filter; }
+  inline int gate_level() const { return options_.gate_level; }
+  inline Channel::Overflow overflow() const { return options_.overflow; }
+  inline int chunk_size() const {
+    return low_latency() ? kLowLatencyChunkSize : kChunkSize;
+  }
+
+  static const int kSampleRate = Channel::kSampleRate;
+  static const int kSampleSize = Channel::kSampleSize;
+  static const int kChunkSize = Channel::kChunkSize;
+  static const int kLowLatencyChunkSize = Channel::kLowLatencyChunkSize;
+  // Devices may run at any rate from this one up, see Unit::CommitInput()
+  static const int kMinHWSampleRate = 8000;
 
  protected:
   static const int kChannelCount = 2;
+  // Device samples resampled at once in Unit::CommitInput()
+  static const int kResampleBlock = 256;
 
   static v8::Handle<v8::Value> New(const v8::Arguments &args);
   static v8::Handle<v8::Value> Start(const v8::Arguments &args);
   static v8::Handle<v8::Value> Stop(const v8::Arguments &args);
   static v8::Handle<v8::Value> Play(const v8::Arguments &args);
+  static v8::Handle<v8::Value> Resume(const v8::Arguments &args);
+  static v8::Handle<v8::Value> GetCounters(const v8::Arguments &args);
+  static v8::Handle<v8::Value> GetMetrics(const v8::Arguments &args);
+  static v8::Handle<v8::Value> SaveState(const v8::Arguments &args);
+  static v8::Handle<v8::Value> RestoreState(const v8::Arguments &args);
+  static v8::Handle<v8::Value> Record(const v8::Arguments &args);
+  static v8::Handle<v8::Value> StopRecording(const v8::Arguments &args);
+  // Reads the channel index the methods above take first, throws and returns
+  // false if |arg| is not one
+  static bool ChannelArgument(v8::Handle<v8::Value> arg, size_t* channel);
 
   void CommitInput(size_t channel, const int16_t* in, size_t size);
   void FlushInput();
@@ -53,11 +98,32 @@ class Unit : public node::ObjectWrap {
   static void AECThread(void* arg);
   void DoAEC();
   static void AsyncCb(uv_async_t* handle, int status);
+  void DeliverInput();
+  void NotifyDrain();
+  void CatchUp();
 
   IncomingCallback on_incoming_;
 
   Channel channels_[kChannelCount];
   bool running_;
+  const Options options_;
+
+  // Flow control, only touched by the event loop: no oninput until resume()
+  // after oninput returned false, and ondrain once play() has not taken all
+  // of the data and there is room again
+  bool paused_[kChannelCount];
+  bool drain_[kChannelCount];
+
+  // Conversion between the device rates and kSampleRate, NULL when a device
+  // already runs at kSampleRate
+  PolyphaseResampler* in_resampler_;
+  PolyphaseResampler* out_resampler_;
+  // Playback resampled to the device rate, not rendered yet
+  struct {
+    int16_t* data;
+    size_t offset;
+    size_t avail;
+  } render_[kChannelCount];
 
   // AEC
   uv_sem_t aec_sem_;
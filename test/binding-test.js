@@ -15,3 +15,113 @@ describe('Audio binding', function() {
     }, 5000);
   });
 });
+
+describe('Audio streams', function() {
+  var lib = require('../');
+  var stream = require('stream');
+
+  // Passes everything on and counts the bytes
+  function counter() {
+    var t = new stream.Transform();
+    t.bytes = 0;
+    t._transform = function _transform(chunk, encoding, cb) {
+      t.bytes += chunk.length;
+      cb(null, chunk);
+    };
+    return t;
+  }
+
+  // Counts the bytes the unit takes for playback
+  function countPlayed(u) {
+    var play = u.play;
+    u.played = 0;
+    u.play = function(channel, buf) {
+      var written = play.call(this, channel, buf);
+      this.played += written;
+      return written;
+    };
+  }
+
+  it('should pace playback and capture', function(cb) {
+    this.timeout(10000);
+
+    var u = new lib.Unit({ overflow: 'block' });
+    var input = u.createInputStream(0);
+    var output = u.createOutputStream(0);
+    var captured = counter();
+
+    countPlayed(u);
+    u.start();
+    input.pipe(captured).pipe(output);
+    setTimeout(function() {
+      u.stop();
+      input.unpipe(captured);
+
+      var counters = input.counters();
+      if (captured.bytes === 0)
+        return cb(new Error('Nothing captured'));
+      if (u.played === 0)
+        return cb(new Error('Nothing played'));
+      if (counters.dropped !== 0)
+        return cb(new Error('Dropped ' + counters.dropped + ' chunks'));
+      cb();
+    }, 5000);
+  });
+
+  // Leaves the input unread for long enough to fill the stream, the unit and
+  // the capture ring behind it, then reads for a second
+  function stall(overflow, cb) {
+    var u = new lib.Unit({ overflow: overflow });
+    var input = u.createInputStream(0);
+
+    u.start();
+    setTimeout(function() {
+      var stalled = input.counters();
+      var bytes = 0;
+
+      input.on('data', function(chunk) {
+        bytes += chunk.length;
+      });
+      setTimeout(function() {
+        u.stop();
+        if (bytes === 0)
+          return cb(new Error('Nothing captured after the stall'));
+        cb(null, stalled);
+      }, 1000);
+    }, 4000);
+  }
+
+  [ 'drop-newest', 'drop-oldest' ].forEach(function(overflow) {
+    it('should drop chunks with ' + overflow, function(cb) {
+      this.timeout(10000);
+
+      stall(overflow, function(err, counters) {
+        if (err)
+          return cb(err);
+        if (counters.dropped === 0)
+          return cb(new Error('Dropped nothing'));
+        if (counters.blocked !== 0)
+          return cb(new Error('Blocked ' + counters.blocked + ' cycles'));
+        cb();
+      });
+    });
+  });
+
+  it('should hold the cycles back with block', function(cb) {
+    this.timeout(10000);
+
+    stall('block', function(err, counters) {
+      if (err)
+        return cb(err);
+      if (counters.dropped !== 0)
+        return cb(new Error('Dropped ' + counters.dropped + ' chunks'));
+      if (counters.blocked === 0)
+        return cb(new Error('Blocked nothing'));
+      // The device callbacks can not wait, with everything full the
+      // capture is lost before the AEC
+      if (counters.captureOverrun === 0)
+        return cb(new Error('No capture overrun'));
+      cb();
+    });
+  });
+});
@@ -0,0 +1,115 @@
+// Channel checks that need the whole chain and no audio device. The chunks
+// are fed through the rings the way the device callbacks and replay.cc do,
+// and Cycle() runs on this thread.
+//
+// gate: a noise floor below the gate level, so that all but the first
+// kGateHangover chunks are gated, that steps up halfway. The NS noise
+// estimate, as the NS sees its input while the gate is closed, has to follow
+// the step.
+//
+// Usage: channel-test
+
+#include "channel.h"
+#include "ns/ns_core.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using audio::Channel;
+
+static const int kChunk = Channel::kChunkSize;
+static const int kGateLevel = -40;  // in dBFS
+// Noise floors of the two halves, both well below the gate
+static const double kQuietLevel = 30;  // rms
+static const double kStepLevel = 150;  // rms
+static const int kHalfChunks = 1000;  // 10 s
+
+static int failures = 0;
+
+// For the NS instance of the channel
+class TestChannel : public Channel {
+ public:
+  // Mean of the noise spectrum the NS estimated on its last frame
+  double NoiseEstimate() {
+    const NSinst_t* inst = reinterpret_cast<const NSinst_t*>(ns_);
+    double sum = 0;
+    for (int i = 0; i < inst->magnLen; i++)
+      sum += inst->noisePrev[i];
+    return sum / inst->magnLen;
+  }
+
+  int gated() { return gate_.count; }
+
+  static const int kHangover = kGateHangover;
+};
+
+static double Noise(unsigned* seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return (((*seed >> 8) & 0xffff) - 32768.0) / 32768.0;
+}
+
+static void Check(const char* what, double value, bool ok) {
+  printf("%-32s %12.2f %s\n", what, value, ok ? "ok" : "FAIL");
+  if (!ok)
+    failures++;
+}
+
+// Runs |chunks| chunks of white noise at |rms| through |ch|
+static void Feed(TestChannel* ch, double rms, int chunks, unsigned* seed) {
+  int16_t near[kChunk];
+  int16_t far[kChunk];
+  int16_t out[kChunk];
+  Channel::Event ev;
+
+  memset(far, 0, sizeof(far));
+  for (int c = 0; c < chunks; c++) {
+    // Uniform noise, sqrt(3) times the rms at its peak
+    for (int i = 0; i < kChunk; i++)
+      near[i] = static_cast<int16_t>(rms * sqrt(3.0) * Noise(seed));
+    PaUtil_WriteRingBuffer(&ch->aec_.out, far, kChunk);
+    PaUtil_WriteRingBuffer(&ch->aec_.in, near, kChunk);
+    ch->Cycle(kChunk, kChunk);
+    while (ch->Read(out, &ev)) {
+    }
+  }
+}
+
+static void TestGate() {
+  Channel::Config config;
+  config.gate_level = kGateLevel;
+
+  TestChannel* ch = new TestChannel();
+  ch->Init(config);
+
+  unsigned seed = 1;
+  Feed(ch, kQuietLevel, kHalfChunks, &seed);
+  double quiet = ch->NoiseEstimate();
+  Feed(ch, kStepLevel, kHalfChunks, &seed);
+  double step = ch->NoiseEstimate();
+
+  // All of the second half is gated, the estimate can only have moved through
+  // Idle()
+  Check("gated chunks", ch->gated(),
+        ch->gated() == 2 * kHalfChunks - TestChannel::kHangover);
+  Check("noise estimate, quiet", quiet, quiet > 0);
+  // The noise estimate is a magnitude, it has to rise about as much as the
+  // rms. With the NS on the output of the idle AEC it stays where it was.
+  double ratio = step / quiet;
+  Check("noise estimate, step / quiet", ratio,
+        ratio > 0.5 * kStepLevel / kQuietLevel &&
+        ratio < 2 * kStepLevel / kQuietLevel);
+
+  delete ch;
+}
+
+int main() {
+  printf("%-32s %12s\n", "check", "value");
+  TestGate();
+
+  if (failures != 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  return 0;
+}
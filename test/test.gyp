@@ -0,0 +1,34 @@
+{
+  "targets": [{
+    # Channel checks without an audio device, exits with non-zero status on
+    # any failure
+    "target_name": "channel_test",
+    "type": "executable",
+
+    "variables": {
+      "library": "static_library",
+    },
+
+    "dependencies": [
+      "../deps/aec/aec.gyp:aec",
+      "../deps/aec/aec.gyp:agc",
+      "../deps/aec/aec.gyp:ns",
+      "../deps/aec/aec.gyp:signal_processing",
+      "../deps/pa_ringbuffer/pa_ringbuffer.gyp:pa_ringbuffer",
+    ],
+
+    "include_dirs": [ "../src" ],
+    "sources": [
+      "channel-test.cc",
+      "../src/channel.cc",
+      "../src/recorder.cc",
+      "../src/trace.cc",
+    ],
+    "conditions": [
+      ["OS == 'linux'", {
+        "defines": [ "WEBRTC_LINUX" ],
+        "libraries": [ "-luv", "-lm", "-lrt" ],
+      }],
+    ],
+  }]
+}